@@ -49,6 +49,8 @@
 	typedef float                     fuzzvar;
 	/** Descriptor que identifica un objeto de esta librera */
 	typedef unsigned int              fzhndl;
+	/** Smbolo que identifica un nombre normalizado (ver TFuzzySymbols) */
+	typedef unsigned int              fzsymbol;
 	/** Tipo que define una lista de parmetros */
 	typedef std::vector<fuzzvar>      fuzzlist;
 	/** Tipo que define un mapa de parmetros */
@@ -61,6 +63,10 @@
 
 /** Descriptor incorrecto o invlido */
 #define FL_INVALID_HANDLE	0x80000000
+/** Smbolo incorrecto o invlido */
+#define FL_INVALID_SYMBOL	0x80000000
+/** Smbolo de la cadena vaca */
+#define FL_EMPTY_SYMBOL		0
 //-----------------------------------------------------------------------------
 
 // Para cada clase derivada de TFuzzyBase debe existir un identificador...
@@ -0,0 +1,403 @@
+/**
+ * \file fzaccuracy.cpp
+ *
+ *  Differential accuracy harness. Runs the same inputs through the reference
+ *  engine (TFuzzyExec over a TFuzzyModel) and through an alternative one and
+ *  measures how far the outputs of the alternative move from the reference.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzaccuracy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <set>
+//-----------------------------------------------------------------------------
+/** Mximo de entradas para probar todas las esquinas en edges() */
+#define FL_ACC_MAXCORNERS	10
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] feReference Ejecutor de referencia, sobre un modelo
+ * \param [in] feCandidate Ejecutor a comparar con la referencia
+ *
+ * Toma las entradas y los conjuntos calculados del modelo de referencia.
+ * Lanza TFuzzyError si la referencia no ejecuta un modelo o si a la
+ * alternativa le falta alguna entrada.
+ */
+TFuzzyAccuracy::TFuzzyAccuracy(TFuzzyExec& feReference, TFuzzyExec& feCandidate)
+			: m_feReference(feReference), m_feCandidate(feCandidate), m_uiCases(0)
+{
+	TFuzzyModel* fm_model = feReference.model();
+
+	if(!fm_model || feReference.image())
+		throw TFuzzyError("TFuzzyAccuracy", "La referencia debe ejecutar un modelo", __LINE__, __FILE__);
+
+	std::set<fzhndl> s_outputs;
+	TFuzzyRules&     fr_rules = fm_model->rules();
+
+	for(size_t i = 0; i < fr_rules.size(); ++i)
+	{
+		const SFuzzyRule& fr_rule = fr_rules[i];
+		s_outputs.insert(fr_rules.value(fr_rules.atoms(fr_rule)[fr_rule.AtomCount - 1])->parent()->handle());
+	}
+
+	for(size_t j = 0; j < fm_model->sets().size(); ++j)
+	{
+		TFuzzySet& fs_set = fm_model->sets()[int(j)];
+
+		if(s_outputs.count(fs_set.handle()))
+		{
+			SAccuracyError ae_error;
+
+			ae_error.Set     = fs_set.name();
+			ae_error.Missing = !feCandidate.require(fs_set.name());
+			m_vErrors.push_back(ae_error);
+			continue;
+		}
+
+		if(!feCandidate.require(fs_set.name()))
+			throw TFuzzyError("TFuzzyAccuracy", "A la alternativa le falta una entrada", __LINE__, __FILE__);
+
+		SAccuracyInput ai_input;
+
+		ai_input.Set = fs_set.name();
+		ai_input.Min = fs_set.min();
+		ai_input.Max = fs_set.max();
+		for(size_t k = 0; k < fs_set.size(); ++k)
+		{
+			TFuzzyVal& fv_val = fs_set[int(k)];
+
+			ai_input.Points.push_back(fv_val.min());
+			ai_input.Points.push_back(fv_val.max());
+			for(size_t p = 0; p < fv_val.size(); ++p)
+				ai_input.Points.push_back(fv_val.param(int(p)));
+		}
+		std::sort(ai_input.Points.begin(), ai_input.Points.end());
+		ai_input.Points.erase(std::unique(ai_input.Points.begin(), ai_input.Points.end()), ai_input.Points.end());
+		m_vInputs.push_back(ai_input);
+	}
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyAccuracy::~TFuzzyAccuracy()
+{
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Los nombres de las entradas, en el orden en que check() recibe sus
+ * valores.
+ */
+std::vector<std::string> TFuzzyAccuracy::inputs() const
+{
+	std::vector<std::string> v_ret;
+
+	for(size_t i = 0; i < m_vInputs.size(); ++i)
+		v_ret.push_back(m_vInputs[i].Set);
+
+	return v_ret;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Olvida los casos comparados y sus errores.
+ */
+void TFuzzyAccuracy::reset()
+{
+	for(size_t i = 0; i < m_vErrors.size(); ++i)
+	{
+		SAccuracyError ae_error;
+
+		ae_error.Set     = m_vErrors[i].Set;
+		ae_error.Missing = m_vErrors[i].Missing;
+		m_vErrors[i]     = ae_error;
+	}
+	m_uiCases = 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] vInputs Valor de cada entrada, en el orden de inputs()
+ *
+ * Calcula el caso con los dos ejecutores y acumula el error de cada conjunto
+ * calculado.
+ */
+void TFuzzyAccuracy::check(const std::vector<fuzzvar>& vInputs)
+{
+	if(vInputs.size() != m_vInputs.size())
+		throw TFuzzyError("check", "Nmero de entradas incorrecto", __LINE__, __FILE__);
+
+	for(size_t i = 0; i < m_vInputs.size(); ++i)
+	{
+		m_feReference.input(m_vInputs[i].Set, vInputs[i]);
+		m_feCandidate.input(m_vInputs[i].Set, vInputs[i]);
+	}
+	m_feReference.calculate();
+	m_feCandidate.calculate();
+	++m_uiCases;
+
+	for(size_t i = 0; i < m_vErrors.size(); ++i)
+	{
+		SAccuracyError& ae_error = m_vErrors[i];
+
+		if(ae_error.Missing)
+			continue;
+
+		fuzzvar fv_ref  = m_feReference.output(ae_error.Set);
+		fuzzvar fv_cand = m_feCandidate.output(ae_error.Set);
+		double  d_max   = ae_error.Max;
+
+		if(ae_error.add(fv_cand, fv_ref) > d_max || ae_error.Worst.empty())
+		{
+			ae_error.Worst     = vInputs;
+			ae_error.Reference = fv_ref;
+			ae_error.Candidate = fv_cand;
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szCases Casos a comparar
+ * \param [in] uSeed   Semilla del generador pseudoaleatorio
+ *
+ * Compara szCases casos con cada entrada al azar (uniforme) en su rango. La
+ * misma semilla da siempre los mismos casos.
+ */
+void TFuzzyAccuracy::random(size_t szCases, unsigned uSeed)
+{
+	std::vector<fuzzvar> v_case(m_vInputs.size());
+
+	for(size_t k = 0; k < szCases; ++k)
+	{
+		for(size_t i = 0; i < m_vInputs.size(); ++i)
+		{
+			uSeed = uSeed * 1103515245u + 12345u;
+			v_case[i] = m_vInputs[i].Min + (m_vInputs[i].Max - m_vInputs[i].Min)
+					  * fuzzvar((uSeed >> 8) & 0xFFFFFF) / fuzzvar(0xFFFFFF);
+		}
+		check(v_case);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szPoints Puntos por entrada, de su mnimo a su mximo
+ *
+ * Compara la rejilla de szPoints puntos por entrada. Si pasa de
+ * FL_ACC_MAXGRID casos se reducen los puntos por entrada y, si ni con dos
+ * puntos cabe, se recorre cada entrada por separado (con szPoints puntos)
+ * con las dems en el centro de su rango.
+ */
+void TFuzzyAccuracy::grid(size_t szPoints)
+{
+	std::vector<fuzzvar> v_case(m_vInputs.size());
+	std::vector<size_t>  v_index(m_vInputs.size(), 0);
+	size_t               sz_points = szPoints < 2 ? 2 : szPoints;
+	double               d_cases   = pow(double(sz_points), double(m_vInputs.size()));
+
+	while(sz_points > 2 && d_cases > FL_ACC_MAXGRID)
+		d_cases = pow(double(--sz_points), double(m_vInputs.size()));
+
+	if(d_cases > FL_ACC_MAXGRID)
+	{
+		sz_points = szPoints < 2 ? 2 : szPoints;
+		for(size_t i = 0; i < m_vInputs.size(); ++i)
+			v_case[i] = (m_vInputs[i].Min + m_vInputs[i].Max) / 2;
+		for(size_t i = 0; i < m_vInputs.size(); ++i)
+		{
+			for(size_t k = 0; k < sz_points; ++k)
+			{
+				v_case[i] = m_vInputs[i].Min + (m_vInputs[i].Max - m_vInputs[i].Min)
+						  * fuzzvar(k) / fuzzvar(sz_points - 1);
+				check(v_case);
+			}
+			v_case[i] = (m_vInputs[i].Min + m_vInputs[i].Max) / 2;
+		}
+		return;
+	}
+
+	//-- Todas las combinaciones, como un contador en base sz_points
+	for(;;)
+	{
+		size_t i = 0;
+
+		for(size_t j = 0; j < m_vInputs.size(); ++j)
+			v_case[j] = m_vInputs[j].Min + (m_vInputs[j].Max - m_vInputs[j].Min)
+					  * fuzzvar(v_index[j]) / fuzzvar(sz_points - 1);
+		check(v_case);
+
+		while(i < v_index.size() && ++v_index[i] == sz_points)
+			v_index[i++] = 0;
+		if(i == v_index.size())
+			break;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Compara los casos lmite: todas las entradas en el centro de su rango y,
+ * para cada entrada por separado, sus extremos, un poco fuera del rango, y
+ * los lmites y parmetros de sus valores y un poco a cada lado de ellos
+ * (donde las funciones cambian de tramo). Con hasta FL_ACC_MAXCORNERS
+ * entradas, tambin todas las esquinas del rango.
+ */
+void TFuzzyAccuracy::edges()
+{
+	std::vector<fuzzvar> v_centre(m_vInputs.size());
+	std::vector<fuzzvar> v_case;
+
+	for(size_t i = 0; i < m_vInputs.size(); ++i)
+		v_centre[i] = (m_vInputs[i].Min + m_vInputs[i].Max) / 2;
+	check(v_centre);
+
+	for(size_t i = 0; i < m_vInputs.size(); ++i)
+	{
+		const SAccuracyInput& ai_input = m_vInputs[i];
+		fuzzvar               fv_range = ai_input.Max - ai_input.Min;
+		fuzzvar               fv_delta = fv_range > 0 ? fv_range * fuzzvar(1.0E-4) : fuzzvar(1.0E-4);
+		std::vector<fuzzvar>  v_points;
+
+		v_points.push_back(ai_input.Min - fv_range / 10);
+		v_points.push_back(ai_input.Max + fv_range / 10);
+		for(size_t k = 0; k < ai_input.Points.size(); ++k)
+		{
+			v_points.push_back(ai_input.Points[k] - fv_delta);
+			v_points.push_back(ai_input.Points[k]);
+			v_points.push_back(ai_input.Points[k] + fv_delta);
+		}
+
+		v_case = v_centre;
+		for(size_t k = 0; k < v_points.size(); ++k)
+		{
+			v_case[i] = v_points[k];
+			check(v_case);
+		}
+	}
+
+	if(m_vInputs.size() <= FL_ACC_MAXCORNERS)
+	{
+		v_case = v_centre;
+		for(size_t k = 0; k < (size_t(1) << m_vInputs.size()); ++k)
+		{
+			for(size_t i = 0; i < m_vInputs.size(); ++i)
+				v_case[i] = (k >> i) & 1 ? m_vInputs[i].Max : m_vInputs[i].Min;
+			check(v_case);
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return El mayor error de todos los conjuntos comparados.
+ */
+double TFuzzyAccuracy::maxError() const
+{
+	double d_max = 0.0;
+
+	for(size_t i = 0; i < m_vErrors.size(); ++i)
+		d_max = m_vErrors[i].Max > d_max ? m_vErrors[i].Max : d_max;
+
+	return d_max;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return El error medio de todas las salidas comparadas.
+ */
+double TFuzzyAccuracy::meanError() const
+{
+	double   d_sum    = 0.0;
+	uint64_t ui_count = 0;
+
+	for(size_t i = 0; i < m_vErrors.size(); ++i)
+	{
+		d_sum    += m_vErrors[i].Sum;
+		ui_count += m_vErrors[i].Count;
+	}
+
+	return ui_count ? d_sum / double(ui_count) : 0.0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return El conjunto con el mayor error (NULL si no se ha comparado nada).
+ */
+const SAccuracyError* TFuzzyAccuracy::worst() const
+{
+	const SAccuracyError* ae_worst = NULL;
+
+	for(size_t i = 0; i < m_vErrors.size(); ++i)
+	{
+		if(m_vErrors[i].Count && (!ae_worst || m_vErrors[i].Max > ae_worst->Max))
+			ae_worst = &m_vErrors[i];
+	}
+
+	return ae_worst;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Casos comparados, errores mximo y medio, el caso con el mayor error (sus
+ * entradas y las dos salidas) y una fila por conjunto calculado.
+ *
+ * \return La comparacin como texto.
+ */
+std::string TFuzzyAccuracy::text() const
+{
+	std::string           str_ret;
+	char                  c_line[192];
+	const SAccuracyError* ae_worst = worst();
+
+	snprintf(c_line, sizeof(c_line), "compared %llu cases, %zu inputs, %zu outputs\n",
+			 (unsigned long long)m_uiCases, m_vInputs.size(), m_vErrors.size());
+	str_ret += c_line;
+	snprintf(c_line, sizeof(c_line), "error: max %.9g mean %.9g\n", maxError(), meanError());
+	str_ret += c_line;
+
+	if(ae_worst)
+	{
+		snprintf(c_line, sizeof(c_line), "worst: %s reference %.9g candidate %.9g at",
+				 ae_worst->Set.c_str(), double(ae_worst->Reference), double(ae_worst->Candidate));
+		str_ret += c_line;
+		for(size_t i = 0; i < ae_worst->Worst.size(); ++i)
+		{
+			snprintf(c_line, sizeof(c_line), " %s=%.9g", m_vInputs[i].Set.c_str(), double(ae_worst->Worst[i]));
+			str_ret += c_line;
+		}
+		str_ret += "\n";
+	}
+
+	snprintf(c_line, sizeof(c_line), "%-24s %12s %16s %16s\n", "set", "compared", "max", "mean");
+	str_ret += c_line;
+	for(size_t i = 0; i < m_vErrors.size(); ++i)
+		str_ret += m_vErrors[i].text();
+
+	return str_ret;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+/**
+ * \file fzaccuracy.hpp
+ *
+ *  Differential accuracy harness. Runs the same inputs through the reference
+ *  engine (TFuzzyExec over a TFuzzyModel) and through an alternative one and
+ *  measures how far the outputs of the alternative move from the reference.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZACCURACY_HPP__
+#define __FZACCURACY_HPP__
+//-----------------------------------------------------------------------------
+#include "fzexecution.hpp"
+#include "fzreplay.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+/** Mximo de casos de grid() (se reducen los puntos por entrada) */
+#ifndef FL_ACC_MAXGRID
+#define FL_ACC_MAXGRID		100000
+#endif
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/** Error de las salidas de un conjunto respecto a la referencia */
+	struct SAccuracyError : public SOutputDeviation
+	{
+		/** Entradas del caso con el mayor error (en el orden de inputs()) */
+		std::vector<fuzzvar> Worst;
+		/** Salidas de la referencia y de la alternativa en ese caso */
+		fuzzvar     Reference;
+		fuzzvar     Candidate;
+
+		SAccuracyError() : Reference(0.0), Candidate(0.0) {}
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Comparacin diferencial de un motor alternativo con el de referencia.
+	 *
+	 * La referencia es un TFuzzyExec sobre un TFuzzyModel, que calcula con
+	 * TExecData::fuzzyfy() y defuzzyfy(). La alternativa es cualquier otro
+	 * TFuzzyExec con los mismos conjuntos: sobre una imagen (TFuzzyImage),
+	 * sobre el modelo optimizado o cargado del formato binario o sobre una
+	 * versin de la librera con otro FL_CRV_COUNT o con otros caminos
+	 * rpidos.
+	 *
+	 * Las entradas son los conjuntos del modelo de referencia que no calcula
+	 * ninguna regla, con el rango de sus valores, y se comparan todos los
+	 * conjuntos calculados. random(), grid() y edges() generan los casos y
+	 * acumulan los errores; check() compara un caso concreto. El error es la
+	 * diferencia absoluta entre las salidas. Un resultado no numrico slo
+	 * coincide con otro igual: si no, el error es infinito.
+	 */
+	class TFuzzyAccuracy
+	{
+	private:
+		/** Una entrada: su nombre y su rango */
+		struct SAccuracyInput
+		{
+			std::string Set;
+			fuzzvar     Min;
+			fuzzvar     Max;
+			/** Lmites y parmetros de sus valores, sin repetir */
+			std::vector<fuzzvar> Points;
+		};
+
+		TFuzzyExec&                 m_feReference;
+		TFuzzyExec&                 m_feCandidate;
+		std::vector<SAccuracyInput> m_vInputs;
+		std::vector<SAccuracyError> m_vErrors;
+		uint64_t                    m_uiCases;
+
+		TFuzzyAccuracy(const TFuzzyAccuracy&);
+		TFuzzyAccuracy& operator=(const TFuzzyAccuracy&);
+
+	public:
+		TFuzzyAccuracy(TFuzzyExec& feReference, TFuzzyExec& feCandidate);
+		virtual ~TFuzzyAccuracy();
+
+		/** Casos comparados */
+		inline uint64_t cases() const { return m_uiCases; }
+		/** Nombres de las entradas, en el orden de los casos */
+		std::vector<std::string> inputs() const;
+		/** Error de cada conjunto calculado */
+		inline const std::vector<SAccuracyError>& errors() const { return m_vErrors; }
+
+		void reset();
+		void check(const std::vector<fuzzvar>& vInputs);
+		void random(size_t szCases, unsigned uSeed = 1);
+		void grid(size_t szPoints);
+		void edges();
+
+		double             maxError() const;
+		double             meanError() const;
+		const SAccuracyError* worst() const;
+		std::string        text() const;
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZACCURACY_HPP__ */
+//-----------------------------------------------------------------------------
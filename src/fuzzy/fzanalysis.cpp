@@ -0,0 +1,378 @@
+/**
+ * \file fzanalysis.cpp
+ *
+ *  Static cost analysis of a model. Estimates the work and memory that
+ *  TFuzzyExec needs per inference without executing the model.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzanalysis.hpp"
+#include "fzexecution.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <unordered_set>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+/** Tamao estimado de un nodo de std::unordered_map (siguiente, hash y cubo)
+ * sin contar su contenido */
+#define FA_HASH_NODE	(3 * sizeof(void*))
+//-----------------------------------------------------------------------------
+
+SSetCost::SSetCost()
+{
+	Output            = false;
+	Depth             = 0;
+	Values            = 0;
+	Definitions       = 0;
+	Rules             = 0;
+	Evaluations       = 0;
+	RuleAtoms         = 0;
+	Modifiers         = 0;
+	SamplePoints      = 0;
+	SampleEvaluations = 0;
+	DefuzzySteps      = 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Las operaciones del conjunto por inferencia, sumando todas las
+ * fases.
+ */
+uint64_t SSetCost::operations() const
+{
+	return Evaluations + RuleAtoms + Modifiers + SamplePoints + SampleEvaluations + DefuzzySteps;
+}
+//-----------------------------------------------------------------------------
+
+SModelCost::SModelCost()
+{
+	Sets              = 0;
+	Values            = 0;
+	Definitions       = 0;
+	Rules             = 0;
+	Atoms             = 0;
+	Inputs            = 0;
+	Outputs           = 0;
+	Unused            = 0;
+	Depth             = 0;
+	Cyclic            = false;
+	Evaluations       = 0;
+	RuleAtoms         = 0;
+	Modifiers         = 0;
+	SamplePoints      = 0;
+	SampleEvaluations = 0;
+	DefuzzySteps      = 0;
+	ModelBytes        = 0;
+	ExecBytes         = 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Las operaciones del modelo por inferencia, sumando todas las fases.
+ */
+uint64_t SModelCost::operations() const
+{
+	return Evaluations + RuleAtoms + Modifiers + SamplePoints + SampleEvaluations + DefuzzySteps;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Un resumen del modelo, las operaciones por fase, las evaluaciones por
+ * funcin, la memoria y una tabla con el coste de cada conjunto que se
+ * calcula en cada inferencia.
+ *
+ * \return El coste como texto.
+ */
+std::string SModelCost::text() const
+{
+	std::string str_ret;
+	char        c_line[192];
+
+	snprintf(c_line, sizeof(c_line),
+			 "sets %zu (inputs %zu, computed %zu, unused %zu), values %zu, definitions %zu, "
+			 "rules %zu, atoms %zu\n",
+			 Sets, Inputs, Outputs, Unused, Values, Definitions, Rules, Atoms);
+	str_ret += c_line;
+	snprintf(c_line, sizeof(c_line), "depth %u%s\n", Depth, Cyclic ? " (cyclic)" : "");
+	str_ret += c_line;
+
+	snprintf(c_line, sizeof(c_line),
+			 "operations per inference %llu\n"
+			 "  evaluations        %12llu\n"
+			 "  rule atoms         %12llu\n"
+			 "  modifiers          %12llu\n",
+			 (unsigned long long)operations(), (unsigned long long)Evaluations,
+			 (unsigned long long)RuleAtoms, (unsigned long long)Modifiers);
+	str_ret += c_line;
+	snprintf(c_line, sizeof(c_line),
+			 "  sample points      %12llu\n"
+			 "  sample evaluations %12llu\n"
+			 "  defuzzy steps      %12llu\n",
+			 (unsigned long long)SamplePoints, (unsigned long long)SampleEvaluations,
+			 (unsigned long long)DefuzzySteps);
+	str_ret += c_line;
+
+	str_ret += "evaluations per function\n";
+	for(std::map<std::string, uint64_t>::const_iterator iter = Functions.begin();
+			iter != Functions.end(); ++iter)
+	{
+		snprintf(c_line, sizeof(c_line), "  %-18s %12llu\n", iter->first.c_str(),
+				 (unsigned long long)iter->second);
+		str_ret += c_line;
+	}
+
+	snprintf(c_line, sizeof(c_line), "memory: model %zu bytes, executor %zu bytes\n",
+			 ModelBytes, ExecBytes);
+	str_ret += c_line;
+
+	snprintf(c_line, sizeof(c_line), "%-24s %5s %6s %5s %6s %12s\n",
+			 "set", "depth", "values", "defs", "rules", "operations");
+	str_ret += c_line;
+	for(size_t i = 0; i < SetCosts.size(); ++i)
+	{
+		const SSetCost& sc_set = SetCosts[i];
+
+		if(!sc_set.operations())
+			continue;
+		snprintf(c_line, sizeof(c_line), "%-24s %5u %6zu %5zu %6zu %12llu\n",
+				 sc_set.Set.c_str(), sc_set.Depth, sc_set.Values, sc_set.Definitions,
+				 sc_set.Rules, (unsigned long long)sc_set.operations());
+		str_ret += c_line;
+	}
+
+	return str_ret;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     szSet   Conjunto
+ * \param [in]     vInputs Conjuntos de los que depende cada conjunto
+ * \param [in,out] vState  0 sin visitar, 1 en visita, 2 visitado
+ * \param [in,out] vDepth  Profundidad de cada conjunto ya visitado
+ * \param [in,out] bCyclic Se pone a true si se encuentra un ciclo
+ *
+ * \return La profundidad del conjunto szSet. Las dependencias que cierran un
+ * ciclo no se cuentan.
+ */
+static unsigned setDepth(size_t szSet, const std::vector<std::vector<size_t> >& vInputs,
+		std::vector<int>& vState, std::vector<unsigned>& vDepth, bool& bCyclic)
+{
+	if(vState[szSet] == 2)
+		return vDepth[szSet];
+	if(vState[szSet] == 1)
+	{
+		bCyclic = true;
+		return 0;
+	}
+
+	unsigned u_depth = 0;
+
+	vState[szSet] = 1;
+	for(size_t i = 0; i < vInputs[szSet].size(); ++i)
+	{
+		unsigned u_in = setDepth(vInputs[szSet][i], vInputs, vState, vDepth, bCyclic) + 1;
+		u_depth = u_in > u_depth ? u_in : u_depth;
+	}
+	vState[szSet] = 2;
+	vDepth[szSet] = u_depth;
+
+	return u_depth;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fmModel Modelo a analizar. Si se carg de forma perezosa, se
+ *                     completa (TFuzzyModel::require()).
+ *
+ * Estima el coste de una inferencia con TFuzzyExec sobre el modelo tal como
+ * lo ejecuta:
+ *
+ * \li Cada conjunto de entrada evala una vez cada definicin distinta de
+ *     sus valores.
+ * \li Cada conjunto calculado evala los antecedentes de sus reglas y sus
+ *     modificadores, muestrea su curva de salida en FL_CRV_COUNT + 1 puntos
+ *     para cada valor, la integra y evala sus valores en el resultado. Las
+ *     curvas de las definiciones compartidas se calculan una sola vez y se
+ *     reutilizan, por lo que slo los valores sin definicin evalan su
+ *     funcin al muestrear.
+ *
+ * La memoria es una estimacin a partir del tamao de las estructuras de la
+ * librera; no incluye la reserva de ms de los contenedores.
+ *
+ * \return El coste del modelo.
+ */
+SModelCost TFuzzyAnalysis::cost(TFuzzyModel& fmModel)
+{
+	SModelCost   mc_cost;
+	TFuzzySets&  fs_sets  = fmModel.sets();
+	TFuzzyRules& fr_rules = fmModel.rules();
+
+	fmModel.require();
+
+	std::unordered_map<TFuzzySet*, size_t> m_index;
+	std::vector<std::vector<size_t> >      v_inputs(fs_sets.size());
+	std::vector<bool>                      v_antecedent(fs_sets.size(), false);
+	std::unordered_set<const SFuzzyDef*>   s_defs;
+	size_t                                 sz_plain = 0;
+
+	for(size_t i = 0; i < fs_sets.size(); ++i)
+		m_index[&fs_sets[int(i)]] = i;
+
+	mc_cost.SetCosts.resize(fs_sets.size());
+
+	//-- Reglas, antecedentes y modificadores de cada conjunto calculado
+	for(size_t i = 0; i < fr_rules.size(); ++i)
+	{
+		SFuzzyRule&      fr_rule = fr_rules[i];
+		const SRuleAtom* ra_atom = fr_rules.atoms(fr_rule);
+		size_t           sz_out  = m_index[static_cast<TFuzzySet*>(fr_rules.value(ra_atom[fr_rule.AtomCount - 1])->parent())];
+		SSetCost&        sc_out  = mc_cost.SetCosts[sz_out];
+
+		++sc_out.Rules;
+		for(uint32_t k = 0; k + 1 < fr_rule.AtomCount; ++k)
+		{
+			size_t sz_in = m_index[static_cast<TFuzzySet*>(fr_rules.value(ra_atom[k])->parent())];
+
+			++sc_out.RuleAtoms;
+			for(uint32_t ui_mods = ra_atom[k].Modifiers; ui_mods; ui_mods >>= FL_MOD_BITS)
+				++sc_out.Modifiers;
+
+			v_antecedent[sz_in] = true;
+			if(std::find(v_inputs[sz_out].begin(), v_inputs[sz_out].end(), sz_in) == v_inputs[sz_out].end())
+				v_inputs[sz_out].push_back(sz_in);
+		}
+		mc_cost.Atoms += fr_rule.AtomCount;
+	}
+
+	//-- Evaluaciones y muestreo de cada conjunto
+	for(size_t i = 0; i < fs_sets.size(); ++i)
+	{
+		TFuzzySet& fs_set = fs_sets[int(i)];
+		SSetCost&  sc_set = mc_cost.SetCosts[i];
+		std::unordered_set<const SFuzzyDef*> s_first;
+		size_t     sz_setplain = 0;
+
+		sc_set.Set    = fs_set.name();
+		sc_set.Values = fs_set.size();
+		sc_set.Output = sc_set.Rules > 0;
+
+		mc_cost.Values += fs_set.size();
+		mc_cost.ModelBytes += sizeof(TFuzzySet) + fs_set.size() * (sizeof(TFuzzyVal*)
+							+ 2 * (FA_HASH_NODE + sizeof(fzhndl) + sizeof(TFuzzyVal*)));
+
+		bool b_exec = sc_set.Output || v_antecedent[i];
+		for(size_t j = 0; j < fs_set.size(); ++j)
+		{
+			TFuzzyVal&       fv_val = fs_set[int(j)];
+			const SFuzzyDef* fd_def = fv_val.definition();
+			bool             b_eval = !fd_def || s_first.insert(fd_def).second;
+
+			mc_cost.ModelBytes += sizeof(TFuzzyVal);
+			if(!fd_def)
+			{
+				++sz_setplain;
+				mc_cost.ModelBytes += (fv_val.size() + 2) * sizeof(fuzzvar);
+			}
+			else if(s_defs.insert(fd_def).second)
+				mc_cost.ModelBytes += sizeof(SFuzzyDef) + fd_def->Params.size() * sizeof(fuzzvar);
+
+			if(!b_exec || !fv_val.function())
+				continue;
+			if(b_eval)
+			{
+				++sc_set.Evaluations;
+				++mc_cost.Functions[fv_val.function()->name()];
+			}
+			if(sc_set.Output && !fd_def)
+				mc_cost.Functions[fv_val.function()->name()] += FL_CRV_COUNT + 1;
+		}
+		sc_set.Definitions = s_first.size() + sz_setplain;
+		sz_plain          += sz_setplain;
+
+		if(sc_set.Output)
+		{
+			sc_set.SamplePoints      = uint64_t(FL_CRV_COUNT + 1) * fs_set.size();
+			sc_set.SampleEvaluations = uint64_t(FL_CRV_COUNT + 1) * sz_setplain;
+			sc_set.DefuzzySteps      = FL_CRV_COUNT;
+			++mc_cost.Outputs;
+
+			//-- Curvas muestreadas de las definiciones compartidas
+			mc_cost.ExecBytes += s_first.size() * (FL_CRV_COUNT + 1) * sizeof(fuzzvar);
+		}
+		else if(v_antecedent[i])
+			++mc_cost.Inputs;
+		else
+			++mc_cost.Unused;
+
+		//-- TExecData del conjunto y su puesto en el ejecutor: lmite,
+		//   definicin, nmero de serie, primer valor igual, curva y
+		//   resultado de cada valor, reglas y entradas. La vista del modelo
+		//   (TModelView) indexa adems la posicin del conjunto
+		mc_cost.ExecBytes += sizeof(TExecData) + sizeof(TExecData*)
+						   + fs_set.size() * (2 * sizeof(fuzzvar) + sizeof(const SFuzzyDef*)
+							 + sizeof(uint64_t) + sizeof(int) + sizeof(const fuzzvar*))
+						   + sc_set.Rules * sizeof(size_t)
+						   + v_inputs[i].size() * sizeof(TExecData*)
+						   + FA_HASH_NODE + sizeof(TFuzzyBase*) + sizeof(uint32_t);
+
+		mc_cost.Evaluations       += sc_set.Evaluations;
+		mc_cost.RuleAtoms         += sc_set.RuleAtoms;
+		mc_cost.Modifiers         += sc_set.Modifiers;
+		mc_cost.SamplePoints      += sc_set.SamplePoints;
+		mc_cost.SampleEvaluations += sc_set.SampleEvaluations;
+		mc_cost.DefuzzySteps      += sc_set.DefuzzySteps;
+	}
+
+	//-- Curva de salida del conjunto en clculo
+	if(mc_cost.Outputs)
+		mc_cost.ExecBytes += 2 * (FL_CRV_COUNT + 1) * sizeof(fuzzvar);
+
+	//-- Reglas: registro, tomos, ndice de valores y de claves y textos
+	mc_cost.ModelBytes += fr_rules.size() * (sizeof(SFuzzyRule) + FA_HASH_NODE + 2 * sizeof(size_t))
+						+ mc_cost.Atoms * sizeof(SRuleAtom);
+	if(fr_rules.keepText())
+	{
+		for(size_t i = 0; i < fr_rules.size(); ++i)
+			mc_cost.ModelBytes += fr_rules.text(i).size() + 1;
+	}
+
+	//-- Profundidad del grafo
+	std::vector<int>      v_state(fs_sets.size(), 0);
+	std::vector<unsigned> v_depth(fs_sets.size(), 0);
+	for(size_t i = 0; i < fs_sets.size(); ++i)
+	{
+		mc_cost.SetCosts[i].Depth = setDepth(i, v_inputs, v_state, v_depth, mc_cost.Cyclic);
+		mc_cost.Depth = mc_cost.SetCosts[i].Depth > mc_cost.Depth ? mc_cost.SetCosts[i].Depth : mc_cost.Depth;
+	}
+
+	mc_cost.Sets        = fs_sets.size();
+	mc_cost.Rules       = fr_rules.size();
+	mc_cost.Definitions = s_defs.size() + sz_plain;
+
+	return mc_cost;
+}
+//-----------------------------------------------------------------------------
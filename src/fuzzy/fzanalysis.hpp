@@ -0,0 +1,160 @@
+/**
+ * \file fzanalysis.hpp
+ *
+ *  Static cost analysis of a model. Estimates the work and memory that
+ *  TFuzzyExec needs per inference without executing the model.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZANALYSIS_HPP__
+#define __FZANALYSIS_HPP__
+//-----------------------------------------------------------------------------
+#include "fzmodel.hpp"
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Coste por inferencia de un conjunto (ver SModelCost). Las operaciones
+	 * se cuentan por unidades de trabajo de cada fase, sin ponderar.
+	 */
+	struct SSetCost
+	{
+		/** Nombre del conjunto */
+		std::string Set;
+		/** true si lo calculan reglas (conjunto de salida o intermedio) */
+		bool        Output;
+		/** Profundidad en el grafo: 0 para las entradas, 1 + la mayor
+		 * profundidad de sus antecedentes para los dems */
+		unsigned    Depth;
+		/** Valores del conjunto */
+		size_t      Values;
+		/** Definiciones distintas de sus valores (cada una se evala una sola
+		 * vez, ver TFuzzyVal::share()) */
+		size_t      Definitions;
+		/** Reglas que lo calculan */
+		size_t      Rules;
+
+		/** Evaluaciones de funciones de pertenencia (TExecData::execute) */
+		uint64_t    Evaluations;
+		/** Antecedentes evaluados (TExecData::setLimits) */
+		uint64_t    RuleAtoms;
+		/** Modificadores aplicados a los antecedentes */
+		uint64_t    Modifiers;
+		/** Puntos de la curva de salida por valores (TExecData::fuzzyfy) */
+		uint64_t    SamplePoints;
+		/** Evaluaciones de funciones durante el muestreo (las de los valores
+		 * sin definicin compartida, cuya curva no se guarda) */
+		uint64_t    SampleEvaluations;
+		/** Tramos integrados al obtener el resultado (TExecData::defuzzyfy) */
+		uint64_t    DefuzzySteps;
+
+		SSetCost();
+
+		uint64_t operations() const;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Coste estimado de un modelo (TFuzzyAnalysis::cost()): trabajo por
+	 * inferencia (una entrada por conjunto de entrada y un calculate()),
+	 * desglosado por fase y por conjunto, memoria y forma del grafo de
+	 * conjuntos que recorre el ejecutor.
+	 */
+	struct SModelCost
+	{
+		/** Conjuntos, valores, definiciones distintas, reglas y antecedentes */
+		size_t   Sets;
+		size_t   Values;
+		size_t   Definitions;
+		size_t   Rules;
+		size_t   Atoms;
+		/** Conjuntos de entrada (antecedentes que no calcula ninguna regla) */
+		size_t   Inputs;
+		/** Conjuntos calculados por reglas */
+		size_t   Outputs;
+		/** Conjuntos que no aparecen en ninguna regla */
+		size_t   Unused;
+
+		/** Mayor profundidad del grafo (nmero de conjuntos calculados
+		 * encadenados) */
+		unsigned Depth;
+		/** true si algn conjunto depende de s mismo */
+		bool     Cyclic;
+
+		/** Totales por fase (ver SSetCost) */
+		uint64_t Evaluations;
+		uint64_t RuleAtoms;
+		uint64_t Modifiers;
+		uint64_t SamplePoints;
+		uint64_t SampleEvaluations;
+		uint64_t DefuzzySteps;
+
+		/** Evaluaciones de funciones de pertenencia por inferencia, por
+		 * funcin (incluidas las del muestreo) */
+		std::map<std::string, uint64_t> Functions;
+
+		/** Memoria estimada del modelo (conjuntos, valores, definiciones y
+		 * reglas), en bytes */
+		size_t   ModelBytes;
+		/** Memoria estimada de un ejecutor del modelo, incluidas las curvas
+		 * muestreadas de las definiciones compartidas */
+		size_t   ExecBytes;
+
+		/** Coste de cada conjunto, en el orden del modelo */
+		std::vector<SSetCost> SetCosts;
+
+		SModelCost();
+
+		uint64_t    operations() const;
+		std::string text() const;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Anlisis esttico de modelos.
+	 *
+	 * Recorre los conjuntos, valores, funciones y reglas de un modelo y el
+	 * grafo de conjuntos que construye TFuzzyExec (ver
+	 * TFuzzyExec::setProcessChain()) para estimar, sin ejecutarlo, lo que
+	 * cuesta cada inferencia. El resultado sirve para comparar versiones de
+	 * un modelo o para rechazar las que superen un presupuesto.
+	 */
+	class TFuzzyAnalysis
+	{
+	public:
+		static SModelCost cost(TFuzzyModel& fmModel);
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZANALYSIS_HPP__ */
+//-----------------------------------------------------------------------------
@@ -29,14 +29,14 @@
 //-----------------------------------------------------------------------------
 #include "fzbase.hpp"
 #include <sstream>
-#include <locale>
 //-----------------------------------------------------------------------------
 using namespace nsFuzzy;
 //-----------------------------------------------------------------------------
 
 std::map<fzhndl, TFuzzyBase*> TFuzzyBase::m_mObjects;
-fzhndl                        TFuzzyBase::m_fhLastHandle = 0;
-fuzzvar                       TFuzzyBase::m_fvInvalid    = 0xffffffff;
+std::mutex                    TFuzzyBase::m_mtObjects;
+std::atomic<fzhndl>           TFuzzyBase::m_fhLastHandle(0);
+thread_local fuzzvar          TFuzzyBase::m_fvInvalid    = 0xffffffff;
 TFuzzyBase                    TFuzzyBase::m_fbInvalid;
 //-----------------------------------------------------------------------------
 
@@ -56,6 +56,10 @@ TFuzzyBase                    TFuzzyBase::m_fbInvalid;
  * \li FL_ID_RUL       Una regla
  * \li FL_ID_MOD       Un mdulo
  *
+ * El descriptor se obtiene de un contador atmico y la lista de objetos est
+ * protegida por un cerrojo, por lo que se pueden crear objetos desde varios
+ * hilos a la vez.
+ *
  * \return nada
  * \sa ~TFuzzyBase(), m_mObjects
  */
@@ -64,8 +68,9 @@ TFuzzyBase::TFuzzyBase(int Tipo)
 	m_fzHandle = ++m_fhLastHandle;
 	m_pParent  = NULL;
 	m_iType    = Tipo;
-	m_strName  = "";
+	m_fsSymbol = FL_EMPTY_SYMBOL;
 
+	std::lock_guard<std::mutex> lock(m_mtObjects);
 	m_mObjects[m_fzHandle] = this;
 }
 //-----------------------------------------------------------------------------
@@ -83,6 +88,7 @@ TFuzzyBase::TFuzzyBase(int Tipo)
  */
 TFuzzyBase::~TFuzzyBase()
 {
+	std::lock_guard<std::mutex>             lock(m_mtObjects);
 	std::map<fzhndl, TFuzzyBase*>::iterator found = m_mObjects.find(m_fzHandle);
 
 	m_iType = FL_ID_UNDEFINED;
@@ -94,16 +100,14 @@ TFuzzyBase::~TFuzzyBase()
 /**
  * \param [in] strText Cadena a convertir
  *
+ * La conversin se hace sobre la propia cadena, sin crear copias.
+ *
  * \return Devuelve strText convertida a minsculas
  */
 std::string& TFuzzyBase::toLower(std::string& strText)
 {
-	std::locale loc;
-	std::string aux = "";
-
 	for(size_t i = 0; i < strText.size(); ++i)
-		aux += (tolower(strText[i], loc));
-	strText = aux;
+		strText[i] = TFuzzySymbols::lower(strText[i]);
 
 	return strText;
 }
@@ -116,20 +120,34 @@ std::string& TFuzzyBase::toLower(std::string& strText)
  */
 std::string& TFuzzyBase::trim(std::string& strText)
 {
-	size_t pos = strText.find_first_not_of(" ");
-	if(pos != std::string::npos)
-		strText = strText.substr(pos);
-
-	pos = strText.size() - 1;
-	while(strText[pos] == ' ' && pos != 0)
-		--pos;
-	if(pos >= 0)
-		strText = strText.substr(0, pos + 1);
+	size_t pos = strText.find_last_not_of(' ');
+	if(pos == std::string::npos)
+	{
+		strText.clear();
+		return strText;
+	}
+	strText.erase(pos + 1);
+	strText.erase(0, strText.find_first_not_of(' '));
 
 	return strText;
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in] fbChild Objeto hijo que ha cambiado de nombre
+ * \param [in] fsOld   Smbolo del nombre anterior del hijo
+ *
+ * Las clases que indexan a sus hijos por nombre (TFuzzySet, TFuzzySets...)
+ * sobrecargan este mtodo para mantener actualizados sus ndices. Por
+ * defecto no hace nada.
+ *
+ * \sa name()
+ */
+void TFuzzyBase::renamed(TFuzzyBase* /*fbChild*/, fzsymbol /*fsOld*/)
+{
+}
+//-----------------------------------------------------------------------------
+
 /**
  * \param [in] fhHandle Descriptor del objeto a obtener
  *
@@ -152,12 +170,17 @@ TFuzzyBase* TFuzzyBase::operator[](fzhndl fhHandle)
 /**
  *  \param [in] strName Nombre a asignar a la funcin
  *
- * Este mtodo asigna un nuevo nommbre al objeto.
+ * Este mtodo asigna un nuevo nommbre al objeto. El nombre se normaliza y se
+ * registra en la tabla de smbolos. Si el objeto tiene padre, se le notifica
+ * el cambio para que actualice sus ndices.
  */
-void TFuzzyBase::name(std::string strName)
+void TFuzzyBase::name(const std::string& strName)
 {
-	m_strName = strName;
-	toLower(trim(m_strName));
+	fzsymbol fs_old = m_fsSymbol;
+
+	m_fsSymbol = TFuzzySymbols::intern(strName);
+	if(m_pParent && fs_old != m_fsSymbol)
+		m_pParent->renamed(this, fs_old);
 }
 //-----------------------------------------------------------------------------
 
@@ -173,7 +196,7 @@ void TFuzzyBase::name(std::string strName)
  */
 bool TFuzzyBase::operator==(TFuzzyBase& cmp)
 {
-	return this == &cmp ? true : (m_iType == cmp.m_iType && m_strName == cmp.m_strName);
+	return this == &cmp ? true : (m_iType == cmp.m_iType && m_fsSymbol == cmp.m_fsSymbol);
 }
 //-----------------------------------------------------------------------------
 
@@ -191,7 +214,7 @@ bool TFuzzyBase::operator==(TFuzzyBase& cmp)
  */
 bool TFuzzyBase::operator!=(TFuzzyBase& cmp)
 {
-	return this == &cmp ? false : (m_iType != cmp.m_iType || m_strName != cmp.m_strName);
+	return this == &cmp ? false : (m_iType != cmp.m_iType || m_fsSymbol != cmp.m_fsSymbol);
 }
 //-----------------------------------------------------------------------------
 
@@ -234,6 +257,7 @@ TFuzzyObjects::~TFuzzyObjects()
  */
 TFuzzyBase& TFuzzyObjects::operator[](fzhndl fzId)
 {
+	std::lock_guard<std::mutex>             lock(objectsLock());
 	std::map<fzhndl, TFuzzyBase*>::iterator found = objects().find(fzId);
 
 	return found == objects().end() ? invalidObject() : *found->second;
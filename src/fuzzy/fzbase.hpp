@@ -33,7 +33,10 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <atomic>
+#include <mutex>
 #include "fuzzy.hpp"
+#include "fzsymbols.hpp"
 //-----------------------------------------------------------------------------
 
 /**
@@ -50,15 +53,17 @@ namespace nsFuzzy
 	class TFuzzyBase
     {
     private:
-		/** Nmero invlido */
-		static fuzzvar m_fvInvalid;
+		/** Nmero invlido (uno por hilo, pues se devuelve por referencia) */
+		static thread_local fuzzvar m_fvInvalid;
 		/** Objeto invlido */
         static TFuzzyBase m_fbInvalid;
 
 		/** Lista de objetos "fuzzy" creados */
         static std::map<fzhndl, TFuzzyBase*> m_mObjects;
+        /** Cerrojo de m_mObjects, para poder crear objetos desde varios hilos */
+        static std::mutex                    m_mtObjects;
         /** ltimo descriptor asignado a un objeto registrado */
-        static fzhndl                        m_fhLastHandle;
+        static std::atomic<fzhndl>           m_fhLastHandle;
 
 		/** Objeto padre de ste */
 		TFuzzyBase* m_pParent;
@@ -66,26 +71,34 @@ namespace nsFuzzy
         fzhndl m_fzHandle;
         /** Tipo de objeto "fuzzy" */
         int    m_iType;
+        /** Smbolo del nombre del objeto (ver TFuzzySymbols) */
+        fzsymbol m_fsSymbol;
 
     protected:
-        /** Nombre del objeto */
-        std::string m_strName;
         /** Devuelve la lista con todos los objetos registrados.
          *
          * Todos los objetos de tipo "fuzzy" creados se registran en una lista.
          * Esto permite llevar un control de los objetos existentes, memoria
          * usada, e incluso memoria perdida.
          *
+         * La lista no debe recorrerse mientras otros hilos crean o destruyen
+         * objetos.
+         *
          * \return mapa con la lista de objetos registrados del sistema.
          * \sa m_mObjects
          */
         inline std::map<fzhndl, TFuzzyBase*>& objects() { return m_mObjects; }
+        /** Devuelve el cerrojo de la lista de objetos registrados */
+        static inline std::mutex& objectsLock() { return m_mtObjects; }
 
         /** Convierte una cadena de texto a minsculas */
 		std::string& toLower(std::string& strRule);
 		/** Elimina los espacios al principio y fin de una cadena */
 		std::string& trim(std::string& strRule);
 
+		/** Notifica al objeto padre que un hijo ha cambiado de nombre */
+		virtual void renamed(TFuzzyBase* fbChild, fzsymbol fsOld);
+
         /** Devuelve el objeto con handle especificado */
         //TFuzzyBase* operator[](fzhndl fhHandle);
 
@@ -110,7 +123,17 @@ namespace nsFuzzy
          *
          * \return Nombre del objeto.
          */
-        inline std::string name() { return m_strName; }
+        inline const std::string& name() { return TFuzzySymbols::name(m_fsSymbol); }
+        /** Devuelve el smbolo del nombre del objeto.
+         *
+         * El nombre de cada objeto se registra, normalizado, en la tabla de
+         * smbolos (TFuzzySymbols). Dos objetos con nombres equivalentes
+         * tienen el mismo smbolo.
+         *
+         * \return Smbolo del nombre del objeto.
+         * \sa TFuzzySymbols
+         */
+        inline fzsymbol symbol() { return m_fsSymbol; }
         /** Devuelve el objeto padre de esta instancia, en caso de existir
          *
          * Muchos de los objetos en esta librera estn organizados
@@ -147,7 +170,7 @@ namespace nsFuzzy
         inline int type() { return m_iType; }
 
         /** Cambia el nombre del objeto */
-        void name(std::string strName);
+        void name(const std::string& strName);
 
         /** Compara dos objetos de tipo Fuzzy y determina si son iguales */
         virtual bool operator==(TFuzzyBase& cmp);
@@ -0,0 +1,257 @@
+/**
+ * \file fzbinary.hpp
+ *
+ *  Binary model format. Layout of the records stored by
+ *  TFuzzyModel::saveToBinary() and helpers to read and write them in
+ *  little-endian byte order.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZBINARY_HPP__
+#define __FZBINARY_HPP__
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <string.h>
+#include "fuzzy.hpp"
+//-----------------------------------------------------------------------------
+/** Identificador de los archivos binarios de modelo */
+#define FL_BIN_MAGIC		"YAFL"
+/** Versin actual del formato binario */
+#define FL_BIN_VERSION		3
+/** Alineacin (en bytes) del comienzo de cada tabla */
+#define FL_BIN_ALIGN		8
+/** ndice nulo (funcin no asignada...) */
+#define FL_BIN_NONE			0xFFFFFFFF
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Posicin de una tabla dentro del archivo.
+	 */
+	struct SBinTable
+	{
+		/** Desplazamiento desde el inicio del archivo (mltiplo de FL_BIN_ALIGN) */
+		uint32_t Offset;
+		/** Nmero de registros (bytes en el caso de la tabla de cadenas) */
+		uint32_t Count;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Cabecera del archivo binario de modelo.
+	 *
+	 * El archivo es una cabecera seguida de tablas de registros de tamao fijo.
+	 * Todos los enteros y nmeros de coma flotante (IEEE 754 de 32 bits) se
+	 * guardan en little-endian. Los registros se refieren unos a otros por su
+	 * ndice dentro de la tabla y a los textos por su desplazamiento dentro de
+	 * la tabla de cadenas (terminadas en '\0'; el desplazamiento 0 es la
+	 * cadena vaca).
+	 *
+	 * Como todas las referencias son ndices y desplazamientos, el archivo
+	 * puede leerse de una sola vez y usarse sin ningn tipo de anlisis.
+	 *
+	 * Adems del modelo, el archivo guarda lo que TFuzzyExec necesita para
+	 * ejecutarlo: las reglas agrupadas por conjunto consecuente, el orden en
+	 * que deben calcularse los conjuntos, un ndice de los conjuntos por
+	 * nombre, los lmites de cada conjunto y los tomos resueltos a conjunto
+	 * y posicin. Con ello el archivo puede proyectarse en memoria
+	 * (TFuzzyImage) y ejecutarse tal cual, sin construir ningn objeto.
+	 *
+	 * Historial de versiones:
+	 * \li 1 Primera versin.
+	 * \li 2 Tablas de ejecucin (RuleRefs, Order, SetNames) y reglas de cada
+	 *        conjunto en SBinSet.
+	 * \li 3 Lmites de los conjuntos en SBinSet; conjunto, posicin y
+	 *        modificadores empaquetados en SBinAtom, que sustituyen a la
+	 *        tabla de modificadores.
+	 *
+	 * \sa TFuzzyModel::saveToBinary(), TFuzzyModel::loadFromBinary(),
+	 * TFuzzyImage
+	 */
+	struct SBinHeader
+	{
+		/** FL_BIN_MAGIC */
+		char      Magic[4];
+		/** Versin del formato (FL_BIN_VERSION) */
+		uint16_t  Version;
+		/** Reservado (0) */
+		uint16_t  Flags;
+		/** Tamao total del archivo en bytes */
+		uint32_t  Size;
+		/** Nombre del modelo (cadena) */
+		uint32_t  Name;
+		/** Descripcin del modelo (cadena) */
+		uint32_t  Description;
+		/** Reservado (0) */
+		uint32_t  Reserved;
+		/** Conjuntos (SBinSet) */
+		SBinTable Sets;
+		/** Valores (SBinValue) de todos los conjuntos, consecutivos por conjunto */
+		SBinTable Values;
+		/** Funciones usadas por los valores (SBinFunction) */
+		SBinTable Functions;
+		/** Parmetros de los valores (float) */
+		SBinTable Params;
+		/** Reglas (SBinRule) */
+		SBinTable Rules;
+		/** tomos de las reglas (SBinAtom), consecutivos por regla */
+		SBinTable Atoms;
+		/** Tabla de cadenas */
+		SBinTable Strings;
+		/** ndices de las reglas (uint32_t), agrupadas por conjunto consecuente */
+		SBinTable RuleRefs;
+		/** ndices de los conjuntos calculados por las reglas (uint32_t), en el
+		 * orden en que deben calcularse (cada uno despus de sus entradas) */
+		SBinTable Order;
+		/** ndices de todos los conjuntos (uint32_t), ordenados por nombre */
+		SBinTable SetNames;
+	};
+	//-------------------------------------------------------------------------
+
+	/** Registro de un conjunto */
+	struct SBinSet
+	{
+		/** Nombre (cadena) */
+		uint32_t Name;
+		/** ndice del primer valor del conjunto */
+		uint32_t FirstValue;
+		/** Nmero de valores del conjunto */
+		uint32_t ValueCount;
+		/** Posicin en RuleRefs de la primera regla cuyo consecuente es un
+		 * valor de este conjunto */
+		uint32_t FirstRule;
+		/** Nmero de reglas cuyo consecuente es un valor de este conjunto. Si
+		 * es 0, el conjunto es una entrada del modelo */
+		uint32_t RuleCount;
+		/** Mnimo y mximo de los valores del conjunto (ver TFuzzySet::min()) */
+		uint32_t Min;
+		uint32_t Max;
+		/** Reservado (0) */
+		uint32_t Reserved;
+	};
+	//-------------------------------------------------------------------------
+
+	/** Registro de un valor */
+	struct SBinValue
+	{
+		/** Nombre (cadena) */
+		uint32_t Name;
+		/** ndice de la funcin en la tabla de funciones, FL_BIN_NONE si no
+		 * tiene */
+		uint32_t Function;
+		/** ndice del primer parmetro (mnimo, mximo y los de la funcin) */
+		uint32_t FirstParam;
+		/** Nmero de parmetros, incluidos el mnimo y el mximo */
+		uint32_t ParamCount;
+	};
+	//-------------------------------------------------------------------------
+
+	/** Registro de una funcin. Se guarda el nombre, pues los descriptores
+	 * slo son vlidos durante la ejecucin. */
+	struct SBinFunction
+	{
+		/** Nombre (cadena) */
+		uint32_t Name;
+	};
+	//-------------------------------------------------------------------------
+
+	/** Registro de una regla */
+	struct SBinRule
+	{
+		/** ndice del primer tomo de la regla */
+		uint32_t FirstAtom;
+		/** Nmero de tomos. El ltimo es el consecuente */
+		uint32_t AtomCount;
+		/** Texto de la regla (cadena) */
+		uint32_t Text;
+		/** Reservado (0) */
+		uint32_t Reserved;
+	};
+	//-------------------------------------------------------------------------
+
+	/** Registro de un tomo de regla, ya resuelto */
+	struct SBinAtom
+	{
+		/** ndice del valor en la tabla de valores */
+		uint32_t Value;
+		/** ndice del conjunto del valor */
+		uint32_t Set;
+		/** Posicin del valor dentro de su conjunto */
+		uint32_t Position;
+		/** Modificadores, empaquetados como en SRuleAtom */
+		uint32_t Modifiers;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Conversin entre el orden de bytes del sistema y el del archivo
+	 * (little-endian). En sistemas little-endian no hacen nada.
+	 */
+	class TBinOrder
+	{
+	public:
+		/** Indica si el sistema es little-endian */
+		static inline bool little()
+		{
+			const uint16_t ui_one = 1;
+			return *((const unsigned char*)&ui_one) == 1;
+		}
+		/** Convierte un entero de 16 bits */
+		static inline uint16_t swap16(uint16_t uiValue)
+		{
+			return little() ? uiValue : uint16_t((uiValue >> 8) | (uiValue << 8));
+		}
+		/** Convierte un entero de 32 bits */
+		static inline uint32_t swap32(uint32_t uiValue)
+		{
+			return little() ? uiValue
+					: ((uiValue >> 24) | ((uiValue >> 8) & 0x0000FF00u)
+					  | ((uiValue << 8) & 0x00FF0000u) | (uiValue << 24));
+		}
+		/** Convierte un fuzzvar a su representacin en el archivo */
+		static inline uint32_t toFile(fuzzvar fvValue)
+		{
+			float    f_value = float(fvValue);
+			uint32_t ui_bits;
+			memcpy(&ui_bits, &f_value, sizeof(ui_bits));
+			return swap32(ui_bits);
+		}
+		/** Convierte la representacin en el archivo a fuzzvar */
+		static inline fuzzvar fromFile(uint32_t uiBits)
+		{
+			float f_value;
+			uiBits = swap32(uiBits);
+			memcpy(&f_value, &uiBits, sizeof(f_value));
+			return fuzzvar(f_value);
+		}
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZBINARY_HPP__ */
+//-----------------------------------------------------------------------------
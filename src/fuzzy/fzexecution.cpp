@@ -41,17 +41,29 @@ using namespace nsFuzzy;
 #define FZ_EXE_DELTA_EXEC	0.01	//-- En porcentaje (al cuadrado)
 #define FZ_INVALID_RESULT	9.8E56
 //-----------------------------------------------------------------------------
-fuzzmap TExecData::m_fmResults;
-static TFuzzyObjects Objects = TFuzzyObjects();
-//-----------------------------------------------------------------------------
 
-TExecData::TExecData(TFuzzySet* fsSet)
+/**
+ * \param [in] evView Vista del modelo
+ * \param [in] uiSet  Posicin del conjunto en la vista
+ * \param [in] elSets Datos de ejecucin de todos los conjuntos del mismo
+ *                    ejecutor, por posicin en la vista
+ */
+TExecData::TExecData(TExecView* evView, uint32_t uiSet, fuzzexelist* elSets)
 {
-	m_fsSet    = fsSet;
+	m_evView    = evView;
+	m_uiSet     = uiSet;
+	m_elSets    = elSets;
+	m_fsStats   = NULL;
+	m_ptProfile = NULL;
+	m_fhLatency = NULL;
+	m_lcLog     = NULL;
 	m_fvResult = FZ_INVALID_RESULT;
-	clear();
+	m_esStatus = esUnset;
+	m_fvCrvMin = 0.0;
+	m_fvCrvMax = 0.0;
 
-	initialize();
+	//-- Hasta su primera entrada, el grado de verdad de los valores es 0
+	refreshDefs();
 }
 //-----------------------------------------------------------------------------
 
@@ -61,172 +73,214 @@ TExecData::~TExecData()
 }
 //-----------------------------------------------------------------------------
 
-void TExecData::initialize()
+/**
+ * Comprueba si ha cambiado la definicin de algn valor del conjunto (ver
+ * TFuzzyVal::share()) y, en tal caso, vuelve a agrupar los valores que
+ * comparten definicin y olvida las curvas muestreadas. Se compara el nmero
+ * de serie y no slo la direccin: una definicin nueva puede ocupar la de
+ * otra ya liberada.
+ */
+void TExecData::refreshDefs()
 {
-	m_fmLimits.clear();
-	for(int i = 0; i < int(m_fsSet->size()); ++i)
+	int  i_size    = int(m_evView->valueCount(m_uiSet));
+	bool b_changed = int(m_vDefs.size()) != i_size;
+
+	for(int i = 0; i < i_size && !b_changed; ++i)
 	{
-		m_fmLimits[fuzzySet()[i].handle()]  = 0.0;
-		m_fmResults[fuzzySet()[i].handle()] = 0.0;
+		const SFuzzyDef* fd_def = m_evView->definition(m_uiSet, i);
+
+		b_changed = m_vDefs[i] != fd_def || (fd_def && m_vSerials[i] != fd_def->Serial);
 	}
-}
-//-----------------------------------------------------------------------------
 
-void TExecData::clearInputs()
-{
-	while(!m_emInputs.empty())
+	if(!b_changed)
+		return;
+
+	std::unordered_map<const SFuzzyDef*, int> m_first;
+
+	m_vDefs.resize(i_size);
+	m_vSerials.resize(i_size);
+	m_vFirst.resize(i_size);
+	m_vCurves.assign(i_size, (const fuzzvar*)NULL);
+	m_vResults.resize(i_size);
+	for(int i = 0; i < i_size; ++i)
 	{
-		//-- Do NOT delete the TExecData of our siblings, as we did not create
-		//   them. They were given to us in our add() method
-//		delete m_emInputs.begin()->second;
-		m_emInputs.begin()->second = NULL;
-		m_emInputs.erase(m_emInputs.begin());
+		m_vDefs[i]    = m_evView->definition(m_uiSet, i);
+		m_vSerials[i] = m_vDefs[i] ? m_vDefs[i]->Serial : 0;
+		m_vFirst[i]   = i;
+		if(m_vDefs[i])
+			m_vFirst[i] = m_first.insert(std::make_pair(m_vDefs[i], i)).first->second;
 	}
 }
 //-----------------------------------------------------------------------------
 
-void TExecData::clearRules()
+/**
+ * \param [in] fvValue Grado de verdad
+ * \param [in] vmMod   Modificador a aplicar
+ *
+ * \return El grado de verdad modificado.
+ */
+fuzzvar TExecData::modify(fuzzvar fvValue, TValModifier vmMod)
 {
-	//-- Do NOT delete the SRuleAtom* as it was not created by us.
-	m_rlRules.clear();
-}
-//-----------------------------------------------------------------------------
+	switch(vmMod)
+	{
+	case vmVery:
+		return pow(double(fvValue), double(2.0));
 
-void TExecData::clearResults()
-{
-	fuzzmap::iterator iter;
+	case vmSlightly:
+		return sqrt(fvValue);
 
-	for(int i = 0; i < int(m_fsSet->size()); ++i)
-	{
-		iter = m_fmResults.find(fuzzySet()[i].handle());
-		if(iter != m_fmResults.end())
-			m_fmResults.erase(iter);
+	case vmNot:
+		return 1.0 - fvValue;
+
+	case vmNone:
+	default:
+		break;
 	}
+
+	return fvValue;
 }
 //-----------------------------------------------------------------------------
 
-void TExecData::resetLimits()
+/**
+ * \param [in] iValue Posicin del valor en el conjunto
+ * \param [in] x      Valor de entrada del conjunto
+ *
+ * Con la definicin compartida se usan sus coeficientes precalculados, como
+ * en TFuzzyVal::execute(). Sin ella, el grado de verdad lo calcula la vista.
+ *
+ * \return Grado de verdad del valor.
+ */
+fuzzvar TExecData::evaluate(int iValue, fuzzvar x)
 {
-	fuzzmap::iterator iter = m_fmLimits.begin();
+	const SFuzzyDef* fd_def = m_vDefs[iValue];
 
-	while(iter != m_fmLimits.end())
-	{
-		iter->second = 0.0;
-		++iter;
-	}
+	if(!fd_def)
+		return m_evView->execute(m_uiSet, uint32_t(iValue), x);
+	if(fd_def->Compiled)
+		return fd_def->Compiled(fd_def->Coefs, x);
+
+	return fd_def->Call ? fd_def->Call(const_cast<fuzzlist&>(fd_def->Params), x) : 0.0;
 }
 //-----------------------------------------------------------------------------
 
-fuzzvar TExecData::ruleResult(SRuleAtom* raAtom)
+fuzzvar TExecData::ruleResult(const SViewAtom& vaAtom)
 {
-	fuzzvar fv_ret = FZ_INVALID_RESULT;
+	if(vaAtom.Set >= m_elSets->size())
+		throw TFuzzyError("ruleResult", "No set to apply the rule to found.", __LINE__, __FILE__);
 
-	if(raAtom)
-	{
-		fuzzmap::iterator fm_val = m_fmResults.find(raAtom->Value->handle());
-		if(fm_val != m_fmResults.end())
-		{
-			fv_ret = fm_val->second;
+	fuzzvar fv_ret = (*m_elSets)[vaAtom.Set]->degree(vaAtom.Value);
 
-			for(size_t i = 0; i < raAtom->Modifiers.size(); ++i)
-			{
-				switch(raAtom->Modifiers[i])
-				{
-				case vmVery:
-					fv_ret = pow(double(fv_ret), double(2.0));
-					break;
-
-				case vmSlightly:
-					fv_ret = sqrt(fv_ret);
-					break;
-
-				case vmNot:
-					fv_ret = 1.0 - fv_ret;
-					break;
-
-				case vmNone:
-				default:
-					break;
-				}
-			}
-		}
-		else
-		{
-			std::string str_why = std::string("No result stored for the value '")
-								+ raAtom->Value->parent()->name()
-								+ std::string(".")
-								+ raAtom->Value->name()
-								+ std::string("'.");
-			throw TFuzzyError("ruleResult", str_why.c_str(), __LINE__, __FILE__);
-		}
-	}
-	else
-	{
-		throw TFuzzyError("ruleResult", "No rule to apply modifiers found.", __LINE__, __FILE__);
-	}
+	//-- Modificadores empaquetados, el primero en los bits bajos
+	for(uint32_t ui_mods = vaAtom.Modifiers; ui_mods; ui_mods >>= FL_MOD_BITS)
+		fv_ret = modify(fv_ret, TValModifier(ui_mods & FL_MOD_MASK));
 
 	return fv_ret;
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * Fija el lmite de cada valor del conjunto aplicando sus reglas. Si se
+ * recogen estadsticas (m_fsStats), anota adems la fuerza de cada regla y
+ * cul ha ganado en cada valor.
+ */
 void TExecData::setLimits()
 {
-	fuzzmap::iterator     fm_val;
-	fuzzmap::iterator     fm_lim;
+	SViewAtom             va_atom;
+	uint32_t              ui_count;
 	fuzzvar               fv_aux;
 	fuzzvar               fv_res;
-	SRuleAtom*            ra_rule = NULL;
 	fuzzrullist::iterator iter    = m_rlRules.begin();
 
-	resetLimits();
+	FL_PROFILE(m_ptProfile, ppRules);
+	m_flLimits.assign(m_evView->valueCount(m_uiSet), 0.0);
+	if(m_fsStats)
+		m_vWinners.assign(m_flLimits.size(), size_t(FL_VIEW_NONE));
 	while(iter != m_rlRules.end())
 	{
-		fv_aux  = 1.0;
-		ra_rule = *iter;
+		ui_count = m_evView->atomCount(uint32_t(*iter));
+		fv_aux   = 1.0;
 
 		//-- Apply the 'ands' of the rule (keep the lowest value)
-		while(ra_rule && ra_rule->Next)
+		for(uint32_t i = 0; i + 1 < ui_count; ++i)
 		{
-			fv_res  = ruleResult(ra_rule);
-			fv_aux  = fv_res < fv_aux ? fv_res : fv_aux;
-			ra_rule = ra_rule->Next;
+			m_evView->atom(uint32_t(*iter), i, va_atom);
+			fv_res = ruleResult(va_atom);
+			fv_aux = fv_res < fv_aux ? fv_res : fv_aux;
 		}
 
 		//-- Apply the 'or' of the rules (keep the highest)
-		fm_lim = m_fmLimits.find(ra_rule->Value->handle());
-		fm_lim->second = fv_aux > fm_lim->second ? fv_aux : fm_lim->second;
+		m_evView->atom(uint32_t(*iter), ui_count - 1, va_atom);
+		fuzzvar& fv_lim = m_flLimits[va_atom.Value];
+		if(m_lcLog)
+			m_lcLog->Rules.push_back(SLogValue(uint32_t(*iter), fv_aux));
+		if(m_fsStats)
+		{
+			(*m_fsStats)[*iter].add(fv_aux);
+			if(fv_aux > fv_lim)
+				m_vWinners[va_atom.Value] = *iter;
+		}
+		fv_lim = fv_aux > fv_lim ? fv_aux : fv_lim;
 
 		++iter;
 	}
+
+	if(m_fsStats)
+	{
+		for(size_t i = 0; i < m_vWinners.size(); ++i)
+		{
+			if(m_vWinners[i] != size_t(FL_VIEW_NONE))
+				++(*m_fsStats)[m_vWinners[i]].Wins;
+		}
+	}
 }
 //-----------------------------------------------------------------------------
 
 fuzzlist& TExecData::fuzzyfy(fuzzlist& flOutput)
 {
-	TFuzzyVal* fs_val = NULL;
 	int        i_index;
 	fuzzvar    x_tmp;
 	fuzzvar    fv_tmp;
 	fuzzvar    fv_val;
 
-	fuzzmap::iterator fl_lim;
+	FL_PROFILE(m_ptProfile, ppSample);
+
+	//-- Los lmites del conjunto y de cada valor no cambian durante el
+	//-- muestreo: se obtienen una sola vez, fuera del bucle.
+	fuzzvar fv_min = m_evView->min(m_uiSet);
+	fuzzvar fv_max = m_evView->max(m_uiSet);
+	fuzzvar fv_rng = fv_max - fv_min;
+
+	//-- Las definiciones compartidas no cambian: su curva muestreada se
+	//-- calcula una sola vez (TFuzzyDefs::curve()) y se reutiliza.
+	refreshDefs();
+	if(fv_min != m_fvCrvMin || fv_max != m_fvCrvMax)
+	{
+		m_vCurves.assign(m_vDefs.size(), (const fuzzvar*)NULL);
+		m_fvCrvMin = fv_min;
+		m_fvCrvMax = fv_max;
+	}
+
+	int i_size = int(m_vDefs.size());
+	for(int j = 0; j < i_size; ++j)
+	{
+		if(m_vDefs[j] && !m_vCurves[j])
+			m_vCurves[j] = TFuzzyVal::definitions().curve(m_vDefs[j], m_fvCrvMin,
+														  m_fvCrvMax, FL_CRV_COUNT);
+	}
 
 	flOutput.clear();
+	flOutput.reserve(2 * (FL_CRV_COUNT + 1));
 	for(int i = 0; i < FL_CRV_COUNT + 1; ++i)
 	{
 		i_index = 2 * i;
-		x_tmp   = m_fsSet->min() + i * (m_fsSet->max() - m_fsSet->min()) / FL_CRV_COUNT;
+		x_tmp   = fv_min + i * fv_rng / FL_CRV_COUNT;
 		flOutput.push_back(x_tmp);
 		flOutput.push_back(0.0);
 
-		for(int j = 0; j < int(m_fsSet->size()); ++j)
+		for(int j = 0; j < i_size; ++j)
 		{
-			fs_val = &(fuzzySet()[j]);
-			fl_lim = m_fmLimits.find(fs_val->handle());
-			fv_val = fs_val->execute(x_tmp);
-			fv_tmp = 0.0;
-
-			fv_tmp = fv_val < fl_lim->second ? fv_val : fl_lim->second;
+			fv_val = m_vCurves[j] ? m_vCurves[j][i] : evaluate(j, x_tmp);
+			fv_tmp = fv_val < m_flLimits[j] ? fv_val : m_flLimits[j];
 
 			flOutput[i_index + 1] = flOutput[i_index + 1] > fv_tmp
 							   ? flOutput[i_index + 1] : fv_tmp;
@@ -274,48 +328,67 @@ fuzzvar TExecData::defuzzyfy(fuzzlist& flData)
 
 std::string TExecData::name()
 {
-	return m_fsSet ? m_fsSet->name() : std::string("");
+	return m_evView->setName(m_uiSet);
 }
 //-----------------------------------------------------------------------------
 
-void TExecData::add(fzhndl fhId, TExecData* edData)
+/**
+ * \param [in] edData Conjunto de cuyos valores depende alguna regla del
+ *                    conjunto. No es propiedad de este TExecData.
+ */
+void TExecData::add(TExecData* edData)
 {
-	if(m_emInputs.find(fhId) == m_emInputs.end())
+	for(size_t i = 0; i < m_elInputs.size(); ++i)
 	{
-		m_emInputs[fhId] = edData ? edData : new TExecData((TFuzzySet*)&Objects[fhId]);
+		if(m_elInputs[i] == edData)
+			return;
 	}
+	m_elInputs.push_back(edData);
 }
 //-----------------------------------------------------------------------------
 
-void TExecData::del(fzhndl fhId)
+void TExecData::clear()
 {
-	fuzzexemap::iterator found = m_emInputs.find(fhId);
-	if(found != m_emInputs.end())
-	{
-		delete found->second;
-		m_emInputs.erase(found);
-	}
+	//-- Do NOT delete the TExecData of our siblings, as we did not create
+	//   them. They were given to us in our add() method
+	m_elInputs.clear();
+	m_rlRules.clear();
 }
 //-----------------------------------------------------------------------------
 
-void TExecData::clear()
+/**
+ * \param [in] uiValue Posicin del valor en el conjunto
+ *
+ * \return Grado de verdad del valor para la ltima entrada del conjunto.
+ */
+fuzzvar TExecData::degree(uint32_t uiValue)
 {
-	clearResults();
-	clearInputs();
-	clearRules();
+	if(uiValue >= m_vResults.size())
+	{
+		std::string str_why = std::string("No result stored for a value of the set '")
+							+ name()
+							+ std::string("'.");
+		throw TFuzzyError("degree", str_why.c_str(), __LINE__, __FILE__);
+	}
+
+	return m_vResults[uiValue];
 }
 //-----------------------------------------------------------------------------
 
 fuzzvar TExecData::execute(fuzzvar x)
 {
+	//-- Las entradas las anota TFuzzyExec::logWrite() al final del clculo
+	if(m_lcLog && !m_elInputs.empty())
+		m_lcLog->Outputs.push_back(SLogValue(m_uiSet, x));
+
 	if(m_fvResult != x)
 	{
-		TFuzzyVal* fz_val = NULL;
-		for(int i = 0; i < int(m_fsSet->size()); ++i)
-		{
-			fz_val = &(fuzzySet()[i]);
-			m_fmResults[fz_val->handle()] = fz_val->execute(x);
-		}
+		FL_PROFILE(m_ptProfile, ppExecute);
+
+		//-- Los valores con la misma definicin se evalan una sola vez
+		refreshDefs();
+		for(int i = 0; i < int(m_vResults.size()); ++i)
+			m_vResults[i] = m_vFirst[i] < i ? m_vResults[m_vFirst[i]] : evaluate(i, x);
 
 		m_fvResult = x;
 	}
@@ -330,7 +403,7 @@ fuzzvar TExecData::calculate()
 {
 	//-- If we have no Inputs it means we are a pure input and need no
 	//   further calculation. m_fvResult already has the value for this set.
-	if(m_emInputs.empty())
+	if(m_elInputs.empty())
 		return m_fvResult;
 
 	//-- If we already have been calculated, do not do it again.
@@ -345,19 +418,22 @@ fuzzvar TExecData::calculate()
 	}
 
 	//-- If we have inputs we depend upon, calculate them first
-	fuzzexemap::iterator iter = m_emInputs.begin();
-
-	while(iter != m_emInputs.end())
-	{
-		iter->second->calculate();
-		++iter;
-	}
+	for(size_t i = 0; i < m_elInputs.size(); ++i)
+		m_elInputs[i]->calculate();
 
 	//-- Once all my inputs have been set to their values, we can proceed
 	//   to calculate my outcome.
+	FL_LATENCY(m_fhLatency);
 	setLimits();
 	fuzzlist fl_outcurve;
-	return execute(defuzzyfy(fuzzyfy(fl_outcurve)));
+	fuzzvar  fv_out;
+
+	fuzzyfy(fl_outcurve);
+	{
+		FL_PROFILE(m_ptProfile, ppDefuzzy);
+		fv_out = defuzzyfy(fl_outcurve);
+	}
+	return execute(fv_out);
 }
 //-----------------------------------------------------------------------------
 
@@ -371,6 +447,20 @@ fuzzvar TExecData::calculate()
 TFuzzyExec::TFuzzyExec() : TFuzzyBase(FL_ID_EXEC)
 {
 	m_fmModel  = NULL;
+	m_fiImage  = NULL;
+	m_evView   = NULL;
+	m_szSets   = 0;
+	m_szRules  = 0;
+	m_uiRevision      = 0;
+	m_uiAtomsRevision = 0;
+	m_uiSetsRevision  = 0;
+	m_bStats   = false;
+	m_bProfile = false;
+	m_ftTrace  = NULL;
+	m_ftActive = NULL;
+	m_flLatency   = NULL;
+	m_fhCalculate = NULL;
+	m_flLog       = NULL;
 }
 //-----------------------------------------------------------------------------
 
@@ -378,89 +468,190 @@ TFuzzyExec::~TFuzzyExec()
 {
 	logClose();
 	destroyData();
+	delete m_evView;
 	m_fmModel = NULL;
+	delete m_ftTrace;
+	delete m_flLatency;
 }
 //-----------------------------------------------------------------------------
 
 void TFuzzyExec::createData()
 {
-	destroyData();
-
-	if(!m_fmModel)
+	if(!m_evView)
 		return;
 
-	TFuzzySet* fs_set = NULL;
-	for(int i = 0; i < int(m_fmModel->sets().size()); ++i)
+	//-- Slo los conjuntos aadidos a la vista desde la ltima llamada (un
+	//   modelo cargado de forma perezosa crece al pedirle conjuntos)
+	TExecData* ed_data = NULL;
+	for(uint32_t i = uint32_t(m_szSets); i < m_evView->setCount(); ++i)
 	{
-		fs_set = &(m_fmModel->sets()[i]);
-		m_mExecData[fs_set->handle()] = new TExecData(fs_set);
+		ed_data = new TExecData(m_evView, i, &m_elExecData);
+		ed_data->stats(m_bStats ? &m_fsStats : NULL);
+		ed_data->log(m_flLog ? &m_lcLog : NULL);
+		m_elExecData.push_back(ed_data);
 	}
+	m_szSets = m_elExecData.size();
+	if(m_fmModel)
+		m_uiSetsRevision = m_fmModel->sets().revision();
 }
 //-----------------------------------------------------------------------------
 
 void TFuzzyExec::destroyData()
 {
-	while(!m_mExecData.empty())
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+		delete m_elExecData[i];
+	m_elExecData.clear();
+	m_szSets  = 0;
+	m_szRules = 0;
+	m_vRuleAtoms.clear();
+	if(m_fmModel)
+	{
+		m_uiRevision      = m_fmModel->rules().revision();
+		m_uiAtomsRevision = m_fmModel->rules().atomsRevision();
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Las reglas del modelo han cambiado de posicin (un modelo cargado de forma
+ * perezosa coloca las reglas que se crean en su posicin del archivo) o se
+ * han eliminado: la cadena se vuelve a construir desde la primera regla. Las
+ * estadsticas siguen a cada regla a su nueva posicin mientras no se
+ * reconstruya el almacn de tomos; si se reconstruye, se pierden.
+ */
+void TFuzzyExec::resetProcessChain()
+{
+	TFuzzyRules& fr_rules = m_fmModel->rules();
+
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+		m_elExecData[i]->rules().clear();
+
+	if(!m_fsStats.empty())
 	{
-		delete m_mExecData.begin()->second;
-		m_mExecData.erase(m_mExecData.begin());
+		fuzzstats fs_old;
+
+		fs_old.swap(m_fsStats);
+		if(fr_rules.atomsRevision() == m_uiAtomsRevision)
+		{
+			std::unordered_map<uint32_t, size_t> m_pos;
+
+			for(size_t i = 0; i < m_vRuleAtoms.size() && i < fs_old.size(); ++i)
+				m_pos[m_vRuleAtoms[i]] = i;
+
+			m_fsStats.resize(fr_rules.size());
+			for(size_t i = 0; i < fr_rules.size(); ++i)
+			{
+				std::unordered_map<uint32_t, size_t>::iterator found = m_pos.find(fr_rules[i].FirstAtom);
+				if(found != m_pos.end())
+					m_fsStats[i] = fs_old[found->second];
+			}
+		}
 	}
+
+	m_szRules         = 0;
+	m_uiRevision      = fr_rules.revision();
+	m_uiAtomsRevision = fr_rules.atomsRevision();
+	m_vRuleAtoms.clear();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return true si se ha eliminado algn conjunto del modelo desde que se
+ * crearon los datos (TFuzzyModel::optimize()...), por lo que los datos ya no
+ * estn en la posicin de su conjunto. Los conjuntos que slo se aaden al
+ * final no mueven a los dems.
+ */
+bool TFuzzyExec::setsMoved()
+{
+	return m_fmModel && m_fmModel->sets().revision() - m_uiSetsRevision
+			!= uint32_t(m_fmModel->sets().size() - m_szSets);
 }
 //-----------------------------------------------------------------------------
 
 void TFuzzyExec::setProcessChain()
 {
-	if(!m_fmModel)
+	if(!m_evView)
 		return;
 
-	createData();
+	SViewAtom  va_atom;
+	uint32_t   ui_count;
+	TExecData* ed_out;
 
-	SRuleAtom* fl_link = NULL;
-	SRuleAtom* fl_out  = NULL;
-	fzhndl     fh_id, fh_out;
+	if(m_fmModel && m_fmModel->rules().revision() != m_uiRevision)
+		resetProcessChain();
+	//-- Los datos se crean de nuevo, desde la primera regla; el perfil, que
+	//   es por posicin, empieza de cero
+	if(setsMoved())
+	{
+		destroyData();
+		m_mProfile.clear();
+	}
+	createData();
 
 	//-- First step: Fill the input and output trees from
 	//   the rules.
-	for(size_t i = 0; i < m_fmModel->rules().size(); ++i)
+	for(uint32_t i = uint32_t(m_szRules); i < m_evView->ruleCount(); ++i)
 	{
-		fl_link = m_fmModel->rules()[i].Links;
-		fl_out  = fl_link;
-
-		while(fl_out->Next)
-			fl_out = fl_out->Next;
-
-		fh_out = fl_out->Value->parent()->handle();
+		ui_count = m_evView->atomCount(i);
+		m_evView->atom(i, ui_count - 1, va_atom);
 
-		m_mExecData[fh_out]->rules().push_back(fl_link);
+		ed_out = m_elExecData[va_atom.Set];
+		ed_out->rules().push_back(i);
+		if(m_fmModel)
+			m_vRuleAtoms.push_back(m_fmModel->rules()[i].FirstAtom);
 
-		while(fl_link->Next)
+		for(uint32_t k = 0; k + 1 < ui_count; ++k)
 		{
-			fh_id = fl_link->Value->parent()->handle();
+			m_evView->atom(i, k, va_atom);
 
 			//-- Add the inputs as siblings of the output of this rule.
-			m_mExecData[fh_out]->add(fh_id, m_mExecData[fh_id]);
-
-			fl_link = fl_link->Next;
+			ed_out->add(m_elExecData[va_atom.Set]);
 		}
 	}
+	m_szRules = m_evView->ruleCount();
+	statsResize();
+	profileAttach();
+	logAttach();
 }
 //-----------------------------------------------------------------------------
 
 TExecData* TFuzzyExec::operator[](fzhndl fhId)
 {
-	fuzzexemap::iterator found = m_mExecData.find(fhId);
-	return found == m_mExecData.end() ? NULL : found->second;
+	if(setsMoved())
+		setProcessChain();
+
+	uint32_t ui_set = m_evView ? m_evView->set(fhId) : FL_VIEW_NONE;
+
+	return ui_set < m_elExecData.size() ? m_elExecData[ui_set] : NULL;
 }
 //-----------------------------------------------------------------------------
 
-TExecData* TFuzzyExec::operator[](std::string& strName)
+TExecData* TFuzzyExec::operator[](const std::string& strName)
 {
-	fuzzexemap::iterator iter = m_mExecData.begin();
+	if(setsMoved())
+		setProcessChain();
 
-	while(iter != m_mExecData.end() && iter->second->name() != strName)
-		++iter;
+	uint32_t ui_set = m_evView ? m_evView->set(strName) : FL_VIEW_NONE;
 
-	return iter == m_mExecData.end() ? NULL : iter->second;
+	return ui_set < m_elExecData.size() ? m_elExecData[ui_set] : NULL;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] evView Vista a ejecutar (NULL para ninguna). Pasa a ser
+ *                    propiedad del ejecutor.
+ *
+ * Cambia lo que se ejecuta: la cadena de ejecucin, las estadsticas y el
+ * perfil empiezan de cero.
+ */
+void TFuzzyExec::view(TExecView* evView)
+{
+	destroyData();
+	delete m_evView;
+	m_evView = evView;
+	m_fsStats.clear();
+	m_mProfile.clear();
+	setProcessChain();
 }
 //-----------------------------------------------------------------------------
 
@@ -468,13 +659,131 @@ void TFuzzyExec::model(TFuzzyModel* fmModel)
 {
 	if(m_fmModel != fmModel)
 	{
+		m_fiImage = NULL;
 		m_fmModel = fmModel;
 		parent()  = m_fmModel;
-		setProcessChain();
+		view(m_fmModel ? new TModelView(m_fmModel) : NULL);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fiImage Imagen a ejecutar (NULL para dejar de usarla)
+ *
+ * Ejecuta la imagen de un modelo (TFuzzyImage) en lugar de un TFuzzyModel,
+ * con el mismo cdigo (ver TImageView). La imagen no se copia ni se
+ * modifica: el ejecutor slo guarda el estado de la ejecucin (resultados de
+ * los valores y conjuntos), de manera que varios ejecutores pueden compartir
+ * la misma imagen. La imagen debe seguir proyectada mientras se use.
+ *
+ * La imagen no tiene descriptores: input(fzhndl), output(fzhndl) y
+ * operator[](fzhndl) no encuentran sus conjuntos. Se buscan por nombre o,
+ * para no buscarlos en cada clculo, por posicin (index(), inputAt() y
+ * outputAt()).
+ *
+ * \sa model(), TFuzzyImage
+ */
+void TFuzzyExec::image(TFuzzyImage* fiImage)
+{
+	if(fiImage && !fiImage->mapped())
+		fiImage = NULL;
+	if(!fiImage && !m_fiImage)
+		return;
+
+	TExecView* ev_view = fiImage ? new TImageView(fiImage) : NULL;
+
+	m_fmModel = NULL;
+	m_fiImage = fiImage;
+	parent()  = NULL;
+	view(ev_view);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strSet Nombre del conjunto
+ *
+ * Pide al modelo el conjunto strSet y todo lo necesario para calcularlo
+ * (TFuzzyModel::require()) y lo aade a la cadena de ejecucin. Con un modelo
+ * cargado de forma perezosa, las salidas deben pedirse antes de calculate();
+ * input() y output() tambin las piden, y output() calcula en ese momento
+ * el conjunto que ha tenido que pedir. Una imagen siempre est completa.
+ *
+ * \return true si el conjunto existe.
+ */
+bool TFuzzyExec::require(const std::string& strSet)
+{
+	if(!m_evView || (m_fmModel && !m_fmModel->require(strSet)))
+		return false;
+
+	setProcessChain();
+
+	return m_evView->set(strSet) != FL_VIEW_NONE;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Entradas de la cadena de ejecucin que necesita el clculo: conjuntos que
+ * ninguna regla calcula y que aparecen en el antecedente de alguna. Con un
+ * modelo cargado de forma perezosa, slo las de los conjuntos ya pedidos
+ * (require()).
+ *
+ * \return Nombres de las entradas, por posicin (ver index()).
+ */
+std::vector<std::string> TFuzzyExec::inputs()
+{
+	std::vector<std::string> v_ret;
+	std::vector<bool>        v_input(m_elExecData.size(), false);
+
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+	{
+		fuzzexelist& el_inputs = m_elExecData[i]->inputs();
+
+		for(size_t j = 0; j < el_inputs.size(); ++j)
+		{
+			if(el_inputs[j]->inputs().empty())
+				v_input[el_inputs[j]->index()] = true;
+		}
+	}
+	for(size_t i = 0; i < v_input.size(); ++i)
+	{
+		if(v_input[i])
+			v_ret.push_back(m_elExecData[i]->name());
 	}
+
+	return v_ret;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strSet Nombre del conjunto
+ *
+ * Posicin del conjunto en la cadena de ejecucin, con un modelo y con una
+ * imagen. Con inputAt() y outputAt() evita buscar el conjunto en cada
+ * clculo. Como input(), pide el conjunto si an no est en la cadena
+ * (require()). Las posiciones cambian si se eliminan conjuntos del modelo
+ * (TFuzzyModel::optimize()).
+ *
+ * \return Posicin del conjunto, FL_VIEW_NONE si no existe.
+ */
+uint32_t TFuzzyExec::index(const std::string& strSet)
+{
+	if(setsMoved())
+		setProcessChain();
+
+	uint32_t ui_set = m_evView ? m_evView->set(strSet) : FL_VIEW_NONE;
+
+	if(ui_set >= m_elExecData.size() && require(strSet))
+		ui_set = m_evView->set(strSet);
+
+	return ui_set < m_elExecData.size() ? ui_set : FL_VIEW_NONE;
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in] fhSet Descriptor del conjunto en el modelo. Con una imagen,
+ *                   que no tiene descriptores, no hace nada (ver inputAt()).
+ * \param [in] x     Valor de entrada del conjunto
+ */
 void TFuzzyExec::input(fzhndl fhSet, fuzzvar x)
 {
 	TExecData* ed_data = (*this)[fhSet];
@@ -484,15 +793,27 @@ void TFuzzyExec::input(fzhndl fhSet, fuzzvar x)
 }
 //-----------------------------------------------------------------------------
 
-void TFuzzyExec::input(std::string strSet, fuzzvar x)
+void TFuzzyExec::input(const std::string& strSet, fuzzvar x)
 {
-	TExecData* ed_data = (*this)[strSet];
+	inputAt(index(strSet), x);
+}
+//-----------------------------------------------------------------------------
 
-	if(ed_data)
-		ed_data->execute(x);
+/**
+ * \param [in] uiSet Posicin del conjunto (ver index())
+ * \param [in] x     Valor de entrada del conjunto
+ */
+void TFuzzyExec::inputAt(uint32_t uiSet, fuzzvar x)
+{
+	if(uiSet < m_elExecData.size())
+		m_elExecData[uiSet]->execute(x);
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in] fhSet Descriptor del conjunto en el modelo. Con una imagen,
+ *                   que no tiene descriptores, devuelve 0 (ver outputAt()).
+ */
 fuzzvar TFuzzyExec::output(fzhndl fhSet)
 {
 	TExecData* ed_data = (*this)[fhSet];
@@ -501,55 +822,364 @@ fuzzvar TFuzzyExec::output(fzhndl fhSet)
 }
 //-----------------------------------------------------------------------------
 
-fuzzvar TFuzzyExec::output(std::string strSet)
+/**
+ * \param [in] strSet Nombre del conjunto
+ *
+ * Resultado del ltimo calculate(). Si el conjunto an no estaba en la
+ * cadena (modelo cargado de forma perezosa), se pide y se calcula en ese
+ * momento con las entradas que ya tiene la cadena; el resto de conjuntos no
+ * se vuelve a calcular.
+ */
+fuzzvar TFuzzyExec::output(const std::string& strSet)
 {
-	TExecData* ed_data = (*this)[strSet];
+	uint32_t ui_set = index(strSet);
 
-	return ed_data ? ed_data->result() : 0.0;
+	//-- Slo calcula si el conjunto no se ha calculado (ver TExecData::calculate())
+	if(ui_set < m_elExecData.size())
+		m_elExecData[ui_set]->calculate();
+
+	return outputAt(ui_set);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiSet Posicin del conjunto (ver index())
+ */
+fuzzvar TFuzzyExec::outputAt(uint32_t uiSet)
+{
+	return uiSet < m_elExecData.size() ? m_elExecData[uiSet]->result() : 0.0;
 }
 //-----------------------------------------------------------------------------
 
 void TFuzzyExec::calculate()
 {
-	if(!m_fmModel)
+	FL_PROFILE(m_ftActive ? &m_ptCalculate : NULL, FL_TRACE_CALCULATE);
+	FL_LATENCY(m_fhCalculate);
+
+	m_lcLog.clear();
+
+	if(!m_evView)
 		return;
+	//-- El modelo puede haber movido sus reglas o eliminado conjuntos desde la
+	//   ltima vez (ver resetProcessChain() y setsMoved())
+	if((m_fmModel && m_fmModel->rules().revision() != m_uiRevision) || setsMoved())
+		setProcessChain();
 	//-- All sets should have their input set by now
 
 	//-- 1st: Starting from the output tree, travel down calculating its output
-	fuzzexemap::iterator iter = m_mExecData.begin();
 
 	//-- Assign all output sets the "unset" status so that they are all
 	//   recalculated
-	while(iter != m_mExecData.end())
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+	{
+		if(!m_elExecData[i]->inputs().empty())
+			m_elExecData[i]->unset();
+	}
+
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+		m_elExecData[i]->calculate();
+	logWrite();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strLogFile Archivo del registro (se sobrescribe)
+ * \param [in] szBytes    Tamao del buffer del registro, en bytes
+ *
+ * Abre el registro binario de la ejecucin (TFuzzyLog). A partir de ahora
+ * cada calculate() anota el valor de todas las entradas, la fuerza de cada
+ * regla evaluada y el resultado de cada conjunto calculado. Los conjuntos se
+ * identifican por su posicin (ver index()), con un modelo y con una imagen,
+ * y sus nombres se anotan antes de usarlos. La escritura al disco la hace un
+ * hilo de fondo: si no da abasto se pierden clculos, nunca se espera.
+ * Si el registro ya estaba abierto no hace nada.
+ *
+ * \return true si el registro est abierto.
+ *
+ * \sa TFuzzyLogReader
+ */
+bool TFuzzyExec::logOpen(std::string strLogFile, size_t szBytes)
+{
+	if(!m_flLog)
+	{
+		m_flLog = new TFuzzyLog();
+		if(!m_flLog->open(strLogFile, szBytes))
+		{
+			delete m_flLog;
+			m_flLog = NULL;
+		}
+		m_lcLog.clear();
+		logAttach();
+	}
+
+	return m_flLog != NULL;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Cierra el registro despus de escribir todo lo anotado.
+ *
+ * \return false si ha habido errores al escribir el archivo.
+ */
+bool TFuzzyExec::logClose()
+{
+	bool b_ret = true;
+
+	if(m_flLog)
+	{
+		b_ret = m_flLog->close();
+		delete m_flLog;
+		m_flLog = NULL;
+		logAttach();
+	}
+
+	return b_ret;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Conecta el clculo en curso del registro (si est abierto) a los datos de
+ * ejecucin de cada conjunto y anota los nombres de los conjuntos.
+ */
+void TFuzzyExec::logAttach()
+{
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+	{
+		m_elExecData[i]->log(m_flLog ? &m_lcLog : NULL);
+		if(m_flLog)
+			m_flLog->name(uint32_t(i), m_elExecData[i]->name());
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Pasa al registro (si est abierto) el clculo que acaba de terminar, con
+ * el valor actual de cada entrada (conjunto sin reglas que lo calculen) y no
+ * slo de las que han cambiado desde el anterior. As cada clculo se puede
+ * reproducir por s solo. Las entradas que an no han recibido ningn valor
+ * no se anotan.
+ */
+void TFuzzyExec::logWrite()
+{
+	if(!m_flLog)
+		return;
+
+	m_lcLog.Inputs.clear();
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+	{
+		TExecData* ed_data = m_elExecData[i];
+
+		if(ed_data->inputs().empty() && ed_data->result() != fuzzvar(FZ_INVALID_RESULT))
+			m_lcLog.Inputs.push_back(SLogValue(uint32_t(i), ed_data->result()));
+	}
+
+	m_flLog->write(m_lcLog);
+	m_lcLog.clear();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] bEnable true para recoger estadsticas de las reglas
+ *
+ * Activa o desactiva las estadsticas de disparo de las reglas (SRuleStats).
+ * Las estadsticas son propias de cada ejecutor, por lo que varios
+ * ejecutores pueden recogerlas a la vez en hilos distintos sin competir
+ * entre s. Desactivadas, calculate() no hace ningn trabajo adicional.
+ *
+ * Al activarlas se conservan las ya recogidas; para empezar de cero debe
+ * llamarse a statsReset().
+ *
+ * \sa stats(), statsRare()
+ */
+void TFuzzyExec::statsEnable(bool bEnable)
+{
+	m_bStats = bEnable;
+	statsResize();
+
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+		m_elExecData[i]->stats(m_bStats ? &m_fsStats : NULL);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Pone a cero las estadsticas de todas las reglas.
+ */
+void TFuzzyExec::statsReset()
+{
+	m_fsStats.clear();
+	statsResize();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Ajusta las estadsticas al nmero de reglas del modelo o de la imagen (un
+ * modelo cargado de forma perezosa gana reglas al pedirle conjuntos). Sin
+ * estadsticas no reserva nada.
+ */
+void TFuzzyExec::statsResize()
+{
+	if(!m_bStats)
+		return;
+
+	size_t sz_rules = m_evView ? m_evView->ruleCount() : 0;
+
+	if(m_fsStats.size() < sz_rules)
+		m_fsStats.resize(sz_rules);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] dMaxRate Proporcin mxima de disparos (disparos / evaluaciones)
+ *
+ * Busca las reglas que se disparan poco, candidatas a ser eliminadas del
+ * modelo. Con dMaxRate a 0 devuelve las reglas que no se han disparado nunca.
+ * Las reglas que no se han llegado a evaluar tambin se incluyen.
+ *
+ * \return La posicin de las reglas, en orden.
+ */
+fuzzrullist TFuzzyExec::statsRare(double dMaxRate) const
+{
+	fuzzrullist rl_rare;
+
+	for(size_t i = 0; i < m_fsStats.size(); ++i)
 	{
-		if(!iter->second->inputs().empty())
-			iter->second->unset();
+		const SRuleStats& rs_stats = m_fsStats[i];
+		if(double(rs_stats.Fired) <= dMaxRate * double(rs_stats.Evaluated))
+			rl_rare.push_back(i);
+	}
+
+	return rl_rare;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Deja preparado el perfil de cada conjunto y se lo pasa a su TExecData, o lo
+ * quita si no se mide. Tambin le pasa la traza, en la que registra el nombre
+ * de cada conjunto, y el histograma de su latencia si es un conjunto de
+ * salida.
+ */
+void TFuzzyExec::profileAttach()
+{
+	for(size_t i = 0; i < m_elExecData.size(); ++i)
+	{
+		TExecData*   ed_data = m_elExecData[i];
+		SSetProfile* sp_prof = NULL;
+
+		if(m_bProfile)
+		{
+			sp_prof      = &m_mProfile[uint32_t(i)];
+			sp_prof->Set = ed_data->name();
+		}
+		if(m_ftActive)
+			m_ftActive->name(uint32_t(i), ed_data->name());
+		ed_data->profile(sp_prof, m_ftActive);
+		ed_data->latency(m_fhCalculate && !ed_data->inputs().empty()
+						 ? m_flLatency->set(ed_data->name()) : NULL);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] bEnable true para medir el tiempo de la ejecucin
+ *
+ * Activa o desactiva la medida del tiempo de cada fase de la ejecucin
+ * (TProfilePhase) en cada conjunto. Desactivada (y sin traza), cada fase slo
+ * comprueba un puntero; compilando con FL_NO_PROFILE no queda ni eso. Como las
+ * estadsticas de las reglas, el perfil es propio de cada ejecutor.
+ *
+ * \sa profile(), profileReset()
+ */
+void TFuzzyExec::profileEnable(bool bEnable)
+{
+	m_bProfile = bEnable;
+	profileAttach();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Pone a cero el tiempo acumulado de todas las fases.
+ */
+void TFuzzyExec::profileReset()
+{
+	std::map<uint32_t, SSetProfile>::iterator iter = m_mProfile.begin();
+	while(iter != m_mProfile.end())
+	{
+		for(int i = 0; i < ppCount; ++i)
+			iter->second.Phases[i] = SPhaseTimes();
 		++iter;
 	}
+}
+//-----------------------------------------------------------------------------
 
-	iter = m_mExecData.begin();
-	while(iter != m_mExecData.end())
+/**
+ * \return Una copia del tiempo acumulado hasta ahora, con el total de cada fase
+ * y el desglose de los conjuntos que se han ejecutado.
+ */
+SFuzzyProfile TFuzzyExec::profile() const
+{
+	SFuzzyProfile fp_ret;
+
+	std::map<uint32_t, SSetProfile>::const_iterator iter = m_mProfile.begin();
+	while(iter != m_mProfile.end())
 	{
-		iter->second->calculate();
+		if(iter->second.calls())
+			fp_ret.add(iter->second);
 		++iter;
 	}
+
+	return fp_ret;
 }
 //-----------------------------------------------------------------------------
 
-bool TFuzzyExec::logOpen(std::string strLogFile)
+/**
+ * \param [in] bEnable  true para guardar la traza de la ejecucin
+ * \param [in] szEvents Eventos que debe poder guardar la traza
+ *
+ * Activa o desactiva la traza de la ejecucin (TFuzzyTrace): un evento con
+ * su comienzo y su final por cada calculate() y por cada fase de cada
+ * conjunto (ver TProfilePhase), en el hilo que la ejecuta. La traza es
+ * propia del ejecutor y se conserva al desactivarla, para poder exportarla
+ * (trace()). Si no caban szEvents eventos, se crea una nueva.
+ *
+ * Como el perfil, desactivada apenas cuesta nada y compilando con
+ * FL_NO_PROFILE desaparece.
+ *
+ * \sa trace(), profileEnable()
+ */
+void TFuzzyExec::traceEnable(bool bEnable, size_t szEvents)
 {
-	if(!m_osLogFile.is_open())
-		m_osLogFile.open(strLogFile.c_str(), std::ios::trunc | std::ios::out);
+	if(bEnable && (!m_ftTrace || m_ftTrace->capacity() < szEvents))
+	{
+		delete m_ftTrace;
+		m_ftTrace = new TFuzzyTrace(szEvents);
+	}
 
-	return m_osLogFile.is_open();
+	m_ftActive = bEnable ? m_ftTrace : NULL;
+	m_ptCalculate.Trace = m_ftActive;
+	profileAttach();
 }
 //-----------------------------------------------------------------------------
 
-bool TFuzzyExec::logClose()
+/**
+ * \param [in] bEnable true para medir la latencia de la ejecucin
+ *
+ * Activa o desactiva los histogramas de latencia (TFuzzyLatency): uno para
+ * cada calculate() y otro para cada conjunto de salida. Son propios del
+ * ejecutor, no necesitan bloqueos y se conservan al desactivarlos; pueden
+ * leerse y sumarse a los de otros ejecutores (TFuzzyLatency::merge()) desde
+ * cualquier hilo.
+ *
+ * Desactivados slo cuestan comprobar un puntero y compilando con
+ * FL_NO_PROFILE desaparecen.
+ *
+ * \sa latency()
+ */
+void TFuzzyExec::latencyEnable(bool bEnable)
 {
-	if(m_osLogFile.is_open())
-		m_osLogFile.close();
+	if(bEnable && !m_flLatency)
+		m_flLatency = new TFuzzyLatency();
 
-	return !m_osLogFile.is_open();
+	m_fhCalculate = bEnable ? &m_flLatency->calculate() : NULL;
+	profileAttach();
 }
 //-----------------------------------------------------------------------------
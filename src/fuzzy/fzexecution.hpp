@@ -32,7 +32,10 @@
 #ifndef __FZEXECUTION_HPP__
 #define __FZEXECUTION_HPP__
 //-----------------------------------------------------------------------------
-#include "fzmodel.hpp"
+#include "fzview.hpp"
+#include "fzprofile.hpp"
+#include "fzhistogram.hpp"
+#include "fzlog.hpp"
 #include <fstream>
 //-----------------------------------------------------------------------------
 
@@ -44,44 +47,140 @@ namespace nsFuzzy
 	class TExecData;
 	//-------------------------------------------------------------------------
 
-	typedef std::map<fzhndl, TExecData*> fuzzexemap;
-	typedef std::vector<SRuleAtom*>      fuzzrullist;
+	/** Datos de ejecucin de los conjuntos, por posicin en la vista */
+	typedef std::vector<TExecData*> fuzzexelist;
+	/** Posiciones de las reglas de un conjunto */
+	typedef std::vector<size_t>     fuzzrullist;
 	//-------------------------------------------------------------------------
 
+	/**
+	 * Estadsticas de disparo de una regla (ver TFuzzyExec::statsEnable()).
+	 * Una regla se dispara cuando su fuerza (el 'and' de sus antecedentes) es
+	 * mayor que 0, y gana cuando es la que fija el lmite de su valor
+	 * consecuente (la de mayor fuerza; en caso de empate, la primera).
+	 */
+	struct SRuleStats
+	{
+		/** Veces que se ha evaluado la regla */
+		uint64_t Evaluated;
+		/** Veces que se ha disparado */
+		uint64_t Fired;
+		/** Suma de su fuerza en todas las evaluaciones */
+		double   Sum;
+		/** Mayor fuerza alcanzada */
+		fuzzvar  Max;
+		/** Veces que ha ganado */
+		uint64_t Wins;
+
+		SRuleStats() : Evaluated(0), Fired(0), Sum(0.0), Max(0.0), Wins(0) {}
+
+		/** Anota una evaluacin de la regla con fuerza fvStrength */
+		inline void add(fuzzvar fvStrength)
+		{
+			++Evaluated;
+			if(fvStrength > 0.0)
+			{
+				++Fired;
+				Sum += fvStrength;
+				Max  = fvStrength > Max ? fvStrength : Max;
+			}
+		}
+	};
+	//-------------------------------------------------------------------------
+
+	/** Estadsticas de todas las reglas, por posicin en TFuzzyRules */
+	typedef std::vector<SRuleStats> fuzzstats;
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Ejecucin de un conjunto de una vista (TExecView): el grado de verdad
+	 * de sus valores para su entrada o, si alguna regla lo calcula, su
+	 * resultado a partir de sus entradas. El mismo cdigo ejecuta un
+	 * TFuzzyModel y un TFuzzyImage.
+	 */
 	class TExecData
 	{
 	private:
-		static fuzzmap m_fmResults;
+		/** Vista del modelo */
+		TExecView*   m_evView;
+		/** Posicin del conjunto en la vista */
+		uint32_t     m_uiSet;
+		/** Datos de ejecucin de todos los conjuntos del ejecutor, para
+		 * leer el grado de verdad de los valores de las reglas */
+		fuzzexelist* m_elSets;
+		/** Estadsticas de las reglas (NULL si no se recogen) */
+		fuzzstats*   m_fsStats;
+		/** Regla ganadora de cada valor en el ltimo setLimits() */
+		std::vector<size_t> m_vWinners;
+		/** Perfil del conjunto y traza del ejecutor */
+		SProfileTarget        m_ptTarget;
+		/** &m_ptTarget si se mide, NULL si no (ver FL_PROFILE) */
+		const SProfileTarget* m_ptProfile;
+		/** Latencia del conjunto (NULL si no se mide) */
+		TFuzzyHistogram* m_fhLatency;
+		/** Clculo en curso del registro del ejecutor (NULL si no se registra) */
+		SLogCalculate*   m_lcLog;
 
-		TFuzzySet*   m_fsSet;
-		fuzzexemap   m_emInputs;
+		fuzzexelist  m_elInputs;
 		fuzzrullist  m_rlRules;
-		fuzzmap      m_fmLimits;
+		/** Lmite de cada valor fijado por las reglas */
+		fuzzlist     m_flLimits;
 		fuzzvar      m_fvResult;
 		TExeStatus   m_esStatus;
 
-		inline TFuzzySet& fuzzySet() { return *m_fsSet; }
-
-		void initialize();
+		/** Definicin compartida de cada valor del conjunto */
+		std::vector<const SFuzzyDef*> m_vDefs;
+		/** Nmero de serie de cada definicin (SFuzzyDef::Serial) */
+		std::vector<uint64_t>         m_vSerials;
+		/** Primer valor del conjunto con la misma definicin que cada uno */
+		std::vector<int>              m_vFirst;
+		/** Curva muestreada de cada valor (NULL si an no se ha pedido) */
+		std::vector<const fuzzvar*>   m_vCurves;
+		/** Ventana de las curvas muestreadas */
+		fuzzvar                       m_fvCrvMin;
+		fuzzvar                       m_fvCrvMax;
+		/** Grado de verdad de cada valor para la ltima entrada */
+		std::vector<fuzzvar>          m_vResults;
 
-		void clearInputs();
-		void clearRules();
-		void clearResults();
+		void refreshDefs();
 
-		fuzzvar   ruleResult(SRuleAtom* raAtom);
-		void      resetLimits();
+		fuzzvar   evaluate(int iValue, fuzzvar x);
+		fuzzvar   ruleResult(const SViewAtom& vaAtom);
 		void      setLimits();
 		fuzzlist& fuzzyfy(fuzzlist& flOutput);
-		fuzzvar   defuzzyfy(fuzzlist& flData);
 
 	protected:
 	public:
-		TExecData(TFuzzySet* fsSet);
+		TExecData(TExecView* evView, uint32_t uiSet, fuzzexelist* elSets);
 		virtual ~TExecData();
 
-		inline fuzzexemap&  inputs() { return m_emInputs; }
+		static fuzzvar modify(fuzzvar fvValue, TValModifier vmMod);
+		static fuzzvar defuzzyfy(fuzzlist& flData);
+
+		/** Conjuntos de cuyos valores dependen las reglas del conjunto */
+		inline fuzzexelist& inputs() { return m_elInputs; }
 		inline fuzzrullist& rules()  { return m_rlRules;  }
 		inline fuzzvar      result() { return m_fvResult; }
+		/** Posicin del conjunto en la vista */
+		inline uint32_t     index()  { return m_uiSet;    }
+
+		/** Fija dnde anotar las estadsticas de las reglas (NULL para no
+		 * recogerlas) */
+		inline void stats(fuzzstats* fsStats) { m_fsStats = fsStats; }
+		/** Fija dnde acumular el perfil del conjunto y dnde aadir los
+		 * eventos de la traza (NULL para no medir) */
+		inline void profile(SSetProfile* spProfile, TFuzzyTrace* ftTrace)
+		{
+			m_ptTarget.Profile = spProfile;
+			m_ptTarget.Trace   = ftTrace;
+			m_ptTarget.Set     = m_uiSet;
+			m_ptProfile        = m_ptTarget.active() ? &m_ptTarget : NULL;
+		}
+		/** Fija dnde anotar la latencia del conjunto (NULL para no medirla) */
+		inline void latency(TFuzzyHistogram* fhLatency) { m_fhLatency = fhLatency; }
+		/** Fija dnde anotar las entradas, reglas y salidas del clculo (NULL
+		 * para no registrarlas) */
+		inline void log(SLogCalculate* lcLog) { m_lcLog = lcLog; }
 //		inline TExeStatus   status() { return m_esStatus; }
 
 		inline void set()   { m_esStatus = esSet;   }
@@ -89,10 +188,10 @@ namespace nsFuzzy
 
 		std::string name();
 
-		void add(fzhndl fhId, TExecData* edData);
-		void del(fzhndl fhId);
+		void add(TExecData* edData);
 		void clear();
 
+		fuzzvar degree(uint32_t uiValue);
 		fuzzvar execute(fuzzvar x);
 		fuzzvar calculate();
 	};
@@ -102,36 +201,124 @@ namespace nsFuzzy
 	{
 	private:
 		TFuzzyModel*  m_fmModel;
-		fuzzexemap    m_mExecData;
-		std::ofstream m_osLogFile;
+		TFuzzyImage*  m_fiImage;
+		/** Vista del modelo o de la imagen que se ejecuta (NULL si ninguno) */
+		TExecView*    m_evView;
+		/** Datos de ejecucin de cada conjunto, por posicin en la vista */
+		fuzzexelist   m_elExecData;
+		/** Registro de la ejecucin (NULL si est cerrado) */
+		TFuzzyLog*    m_flLog;
+		/** Clculo en curso del registro */
+		SLogCalculate m_lcLog;
+
+		/** Estadsticas de las reglas */
+		fuzzstats     m_fsStats;
+		bool          m_bStats;
+
+		/** Perfil de cada conjunto, por posicin */
+		std::map<uint32_t, SSetProfile> m_mProfile;
+		bool          m_bProfile;
 
+		/** Traza de la ejecucin (NULL si nunca se ha activado) */
+		TFuzzyTrace*  m_ftTrace;
+		/** m_ftTrace si se est trazando, NULL si no */
+		TFuzzyTrace*  m_ftActive;
+		/** Traza de calculate(): m_ftActive, sin perfil ni conjunto */
+		SProfileTarget m_ptCalculate;
+
+		/** Latencias (NULL si nunca se han activado) */
+		TFuzzyLatency*    m_flLatency;
+		/** Latencia de calculate() si se mide, NULL si no */
+		TFuzzyHistogram*  m_fhCalculate;
+
+		/** Conjuntos y reglas ya incluidos en la cadena */
+		size_t        m_szSets;
+		size_t        m_szRules;
+		/** Revisiones de las reglas del modelo al construir la cadena (ver
+		 * TFuzzyRules::revision()) */
+		uint32_t      m_uiRevision;
+		uint32_t      m_uiAtomsRevision;
+		/** Revisin de los conjuntos del modelo al crear los datos (ver
+		 * TFuzzySets::revision()) */
+		uint32_t      m_uiSetsRevision;
+		/** Primer tomo de cada regla de la cadena, que la identifica para
+		 * conservar sus estadsticas si cambia de posicin */
+		std::vector<uint32_t> m_vRuleAtoms;
+
+		void view(TExecView* evView);
 		void createData();
 		void destroyData();
 		void setProcessChain();
+		void resetProcessChain();
+		bool setsMoved();
+		void statsResize();
+		void profileAttach();
+		void logAttach();
+		void logWrite();
 
 	protected:
 		TExecData* operator[](fzhndl fhId);
-		TExecData* operator[](std::string& strName);
+		TExecData* operator[](const std::string& strName);
 
 	public:
 		TFuzzyExec();
 		virtual ~TFuzzyExec();
 
 		inline TFuzzyModel*   model()   { return m_fmModel;             }
-		inline std::ofstream& log()     { return m_osLogFile;           }
-		inline bool           logging() { return m_osLogFile.is_open(); }
+		inline TFuzzyImage*   image()   { return m_fiImage;             }
+		inline TFuzzyLog*     log()     { return m_flLog;               }
+		inline bool           logging() { return m_flLog != NULL;       }
 
 		void model(TFuzzyModel* fmModel);
+		void image(TFuzzyImage* fiImage);
+
+		bool require(const std::string& strSet);
+		std::vector<std::string> inputs();
+
+		uint32_t index(const std::string& strSet);
 
 		void input(fzhndl fhSet, fuzzvar x);
-		void input(std::string strSet, fuzzvar x);
+		void input(const std::string& strSet, fuzzvar x);
+		void inputAt(uint32_t uiSet, fuzzvar x);
 
 		fuzzvar output(fzhndl fhSet);
-		fuzzvar output(std::string strSet);
+		fuzzvar output(const std::string& strSet);
+		fuzzvar outputAt(uint32_t uiSet);
 
-		bool logOpen(std::string strLogFile);
+		bool logOpen(std::string strLogFile, size_t szBytes = FL_LOG_SIZE);
 		bool logClose();
 
+		/** Indica si se recogen estadsticas de las reglas */
+		inline bool             statsEnabled() const { return m_bStats;  }
+		/** Estadsticas de cada regla, por posicin en las reglas del modelo
+		 * (o de la imagen) */
+		inline const fuzzstats& stats()        const { return m_fsStats; }
+
+		void        statsEnable(bool bEnable = true);
+		void        statsReset();
+		fuzzrullist statsRare(double dMaxRate = 0.0) const;
+
+		/** Indica si se mide el tiempo de las fases de la ejecucin */
+		inline bool   profileEnabled() const { return m_bProfile; }
+
+		void          profileEnable(bool bEnable = true);
+		void          profileReset();
+		SFuzzyProfile profile() const;
+
+		/** Indica si se guarda la traza de la ejecucin */
+		inline bool         traceEnabled() const { return m_ftActive != NULL; }
+		/** Traza de la ejecucin (NULL si nunca se ha activado) */
+		inline TFuzzyTrace* trace()              { return m_ftTrace;          }
+
+		void traceEnable(bool bEnable = true, size_t szEvents = FL_TRACE_SIZE);
+
+		/** Indica si se mide la latencia de la ejecucin */
+		inline bool           latencyEnabled() const { return m_fhCalculate != NULL; }
+		/** Latencias de la ejecucin (NULL si nunca se han activado) */
+		inline TFuzzyLatency* latency()              { return m_flLatency;          }
+
+		void latencyEnable(bool bEnable = true);
+
 		void calculate();
 	};
 	//-------------------------------------------------------------------------
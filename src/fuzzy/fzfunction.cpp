@@ -50,6 +50,8 @@ SFuzzyFunction::SFuzzyFunction() : TFuzzyBase(FL_ID_FUN)
 {
 	ParamCount = 0;
 	Function   = NULL;
+	Compile    = NULL;
+	Compiled   = NULL;
 }
 //-----------------------------------------------------------------------------
 
@@ -64,6 +66,8 @@ SFuzzyFunction::~SFuzzyFunction()
 {
 	ParamCount = 0;
 	Function   = NULL;
+	Compile    = NULL;
+	Compiled   = NULL;
 }
 //-----------------------------------------------------------------------------
 
@@ -131,7 +135,24 @@ bool SFuzzyFunction::operator !=(SFuzzyFunction& cmp)
  *
  * \sa m_ffLastId
  */
-std::map<fzhndl, SFuzzyFunction*> TStdFuzzyFunctions::m_mFunctions;
+std::vector<SFuzzyFunction*> TStdFuzzyFunctions::m_vFunctions;
+//-----------------------------------------------------------------------------
+
+/**
+ * ndice de m_vFunctions por el descriptor de cada funcin.
+ *
+ * \sa operator[](fzhndl)
+ */
+std::unordered_map<fzhndl, SFuzzyFunction*> TStdFuzzyFunctions::m_mHandles;
+//-----------------------------------------------------------------------------
+
+/**
+ * ndice de m_vFunctions por el smbolo del nombre de cada funcin. Permite
+ * buscar una funcin por nombre sin recorrer la lista.
+ *
+ * \sa operator[](std::string), TFuzzySymbols
+ */
+std::unordered_map<fzsymbol, SFuzzyFunction*> TStdFuzzyFunctions::m_mNames;
 //-----------------------------------------------------------------------------
 
 /**
@@ -140,6 +161,23 @@ std::map<fzhndl, SFuzzyFunction*> TStdFuzzyFunctions::m_mFunctions;
 unsigned int TStdFuzzyFunctions::m_uiInstances = 0;
 //-----------------------------------------------------------------------------
 
+/**
+ * Protege m_uiInstances y el registro de funciones (constructor, destructor y
+ * add()), de manera que pueden crearse instancias desde varios hilos. Las
+ * bsquedas no usan el cerrojo: las funciones deben registrarse antes de
+ * usarlas desde otros hilos (las estndar se registran al iniciarse el
+ * programa).
+ *
+ * El cerrojo se crea en el primer uso, ya que hay instancias estticas de la
+ * clase en otros archivos (TFuzzyVal).
+ */
+std::recursive_mutex& TStdFuzzyFunctions::functionsLock()
+{
+	static std::recursive_mutex rm_lock;
+	return rm_lock;
+}
+//-----------------------------------------------------------------------------
+
 /**
  * Se inicializa la clase registrando todas las funciones estndar. Para evitar
  * registrarlas ms de una vez se comprueba el nmero de funciones ya
@@ -152,6 +190,8 @@ unsigned int TStdFuzzyFunctions::m_uiInstances = 0;
  */
 TStdFuzzyFunctions::TStdFuzzyFunctions() : TFuzzyBase(FL_ID_FUNS)
 {
+	std::lock_guard<std::recursive_mutex> lock(functionsLock());
+
 	++m_uiInstances;
 	registerFunctions();
 }
@@ -164,6 +204,8 @@ TStdFuzzyFunctions::TStdFuzzyFunctions() : TFuzzyBase(FL_ID_FUNS)
  */
 TStdFuzzyFunctions::~TStdFuzzyFunctions()
 {
+	std::lock_guard<std::recursive_mutex> lock(functionsLock());
+
 	if(0 == --m_uiInstances)
 		clear();
 }
@@ -174,13 +216,14 @@ TStdFuzzyFunctions::~TStdFuzzyFunctions()
  */
 void TStdFuzzyFunctions::clear()
 {
-	while(m_mFunctions.size() > 0)
+	while(!m_vFunctions.empty())
 	{
-		if(m_mFunctions.begin()->second)
-			delete m_mFunctions.begin()->second;
-		m_mFunctions.begin()->second = NULL;
-		m_mFunctions.erase(m_mFunctions.begin());
+		if(m_vFunctions.back())
+			delete m_vFunctions.back();
+		m_vFunctions.pop_back();
 	}
+	m_mHandles.clear();
+	m_mNames.clear();
 }
 //-----------------------------------------------------------------------------
 
@@ -191,7 +234,7 @@ void TStdFuzzyFunctions::clear()
  */
 void TStdFuzzyFunctions::registerFunctions()
 {
-	if(0 == m_mFunctions.size())
+	if(m_vFunctions.empty())
 	{
 		SFuzzyFunction* func = new SFuzzyFunction;
 
@@ -199,6 +242,8 @@ void TStdFuzzyFunctions::registerFunctions()
 		func->name("Gaussian Bell");
 		func->ParamCount = 0;
 		func->Function   = gaussBell;
+		func->Compile    = gaussBellCompile;
+		func->Compiled   = gaussBellCompiled;
 		add(func);
 
 	    // Funcin S
@@ -206,6 +251,8 @@ void TStdFuzzyFunctions::registerFunctions()
 	    func->name("S-Curve");
 	    func->ParamCount = 0;
 	    func->Function   = sCurve;
+	    func->Compile    = sCurveCompile;
+	    func->Compiled   = sCurveCompiled;
 	    add(func);
 
 	    // Funcin S invertida
@@ -213,6 +260,8 @@ void TStdFuzzyFunctions::registerFunctions()
 	    func->name("Inverted S-Curve");
 	    func->ParamCount = 0;
 	    func->Function   = inverseSCurve;
+	    func->Compile    = sCurveCompile;
+	    func->Compiled   = inverseSCurveCompiled;
 	    add(func);
 
 	    // Funcin triangular
@@ -220,6 +269,8 @@ void TStdFuzzyFunctions::registerFunctions()
 	    func->name("Triangle");
 	    func->ParamCount = 1;
 	    func->Function   = triangle;
+	    func->Compile    = triangleCompile;
+	    func->Compiled   = triangleCompiled;
 	    add(func);
 
 	    // Funcin triangular
@@ -227,6 +278,8 @@ void TStdFuzzyFunctions::registerFunctions()
 	    func->name("Inverted Triangle");
 	    func->ParamCount = 1;
 	    func->Function   = inverseTriangle;
+	    func->Compile    = triangleCompile;
+	    func->Compiled   = inverseTriangleCompiled;
 	    add(func);
 
 	    // Funcin de interpolacin de puntos
@@ -239,69 +292,163 @@ void TStdFuzzyFunctions::registerFunctions()
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * Las funciones estndar (salvo Interpolate) se evalan en dos pasos: el
+ * preclculo de los coeficientes que slo dependen de los parmetros
+ * (xxxCompile()) y la evaluacin con ellos (xxxCompiled()). Las definiciones
+ * compartidas (SFuzzyDef) guardan los coeficientes y slo hacen el segundo
+ * paso; estas versiones hacen los dos en cada llamada, con las mismas
+ * operaciones, por lo que el resultado es el mismo bit a bit.
+ */
 fuzzvar TStdFuzzyFunctions::gaussBell(fuzzlist& params, fuzzvar x)
 {
-    if(params.size() < 2)
+	SFuzzyCoefs coefs;
+
+    if(!gaussBellCompile(params, coefs))
         throw TFuzzyError("gausBell", "Nmero de parmetros incorrecto",
         					__LINE__, __FILE__);
 
+    return gaussBellCompiled(coefs, x);
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TStdFuzzyFunctions::sCurve(fuzzlist& params, fuzzvar x)
+{
+	SFuzzyCoefs coefs;
+
+    if(!sCurveCompile(params, coefs))
+        throw TFuzzyError("sCurve", "Nmero de parmetros incorrecto",
+        					__LINE__, __FILE__);
+
+    return sCurveCompiled(coefs, x);
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TStdFuzzyFunctions::inverseSCurve(fuzzlist& params, fuzzvar x)
+{
+    return 1.0 - sCurve(params, x);
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TStdFuzzyFunctions::triangle(fuzzlist& params, fuzzvar x)
+{
+	SFuzzyCoefs coefs;
+
+    if(!triangleCompile(params, coefs))
+        throw TFuzzyError("triangle", "Nmero de parmetros incorrecto",
+        					__LINE__, __FILE__);
+
+    return triangleCompiled(coefs, x);
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TStdFuzzyFunctions::inverseTriangle(fuzzlist& params, fuzzvar x)
+{
+    return fuzzvar(1.0 - triangle(params, x));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * C[0]: centro, C[1]: -atenuacin (-ln(0.001) / ancho^2).
+ */
+bool TStdFuzzyFunctions::gaussBellCompile(const fuzzlist& params, SFuzzyCoefs& coefs)
+{
+    if(params.size() < 2)
+        return false;
+
     fuzzvar width  = (abs(params[0]) + abs(params[1])) / 2.0;
-    fuzzvar center = (params[0] + params[1]) / 2.0;
     fuzzvar attenu = -log(0.001) / width / width;
-    fuzzvar X = (x - center) * (x - center);
 
-    return fuzzvar(exp(-attenu * X));
+    coefs.C[0] = (params[0] + params[1]) / 2.0;
+    coefs.C[1] = -attenu;
+
+    return true;
 }
 //-----------------------------------------------------------------------------
 
-fuzzvar TStdFuzzyFunctions::sCurve(fuzzlist& params, fuzzvar x)
+fuzzvar TStdFuzzyFunctions::gaussBellCompiled(const SFuzzyCoefs& coefs, fuzzvar x)
+{
+    fuzzvar X = (x - coefs.C[0]) * (x - coefs.C[0]);
+
+    return fuzzvar(exp(coefs.C[1] * X));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * C[0]: mnimo, C[1]: mximo, C[2]: A (2 / (mximo - mnimo)^2), C[3]: centro.
+ */
+bool TStdFuzzyFunctions::sCurveCompile(const fuzzlist& params, SFuzzyCoefs& coefs)
 {
     if(params.size() < 2)
-        throw TFuzzyError("sCurve", "Nmero de parmetros incorrecto",
-        					__LINE__, __FILE__);
+        return false;
 
-    if(x < params[0])
+    coefs.C[0] = params[0];
+    coefs.C[1] = params[1];
+    coefs.C[2] = 2.0 / (params[0] - params[1]) / (params[0] - params[1]);
+    coefs.C[3] = (params[0] + params[1]) / 2.0;
+
+    return true;
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TStdFuzzyFunctions::sCurveCompiled(const SFuzzyCoefs& coefs, fuzzvar x)
+{
+    if(x < coefs.C[0])
         return 0.0;
-    if(x > params[1])
+    if(x > coefs.C[1])
         return 1.0;
 
-    fuzzvar rtn, A, center;
-    A = 2.0 / (params[0] - params[1]) / (params[0] - params[1]);
-    center = (params[0] + params[1]) / 2.0;
-
-    rtn = x > center
-        ? 1.0 - A * (x - params[1]) * (x - params[1])
-        : A * (x - params[0]) * (x - params[0]);
+    fuzzvar rtn = x > coefs.C[3]
+        ? 1.0 - coefs.C[2] * (x - coefs.C[1]) * (x - coefs.C[1])
+        : coefs.C[2] * (x - coefs.C[0]) * (x - coefs.C[0]);
 
     return rtn;
 }
 //-----------------------------------------------------------------------------
 
-fuzzvar TStdFuzzyFunctions::inverseSCurve(fuzzlist& params, fuzzvar x)
+fuzzvar TStdFuzzyFunctions::inverseSCurveCompiled(const SFuzzyCoefs& coefs, fuzzvar x)
 {
-    return 1.0 - sCurve(params, x);
+    return 1.0 - sCurveCompiled(coefs, x);
 }
 //-----------------------------------------------------------------------------
 
-fuzzvar TStdFuzzyFunctions::triangle(fuzzlist& params, fuzzvar x)
+/**
+ * C[0]: mnimo, C[1]: mximo, C[2]: vrtice, C[3], C[4]: pendiente y
+ * ordenada del lado izquierdo, C[5], C[6]: las del lado derecho.
+ */
+bool TStdFuzzyFunctions::triangleCompile(const fuzzlist& params, SFuzzyCoefs& coefs)
 {
 	size_t sz_cnt = params.size();
 
     if(sz_cnt < 2)
-        throw TFuzzyError("triangle", "Nmero de parmetros incorrecto",
-        					__LINE__, __FILE__);
+        return false;
 
     fuzzvar mid = sz_cnt >= 3 ? params[2] : (params[0] + params[1]) / 2.0;
-    fuzzvar b   = 1.0 / (mid - (x < mid ? params[0] : params[1]));
-    fuzzvar a   = 1.0 - b * mid;
 
-    return fuzzvar((x > params[0] && x < params[1]) ? a + b * x : 0.0);
+    coefs.C[0] = params[0];
+    coefs.C[1] = params[1];
+    coefs.C[2] = mid;
+    coefs.C[3] = 1.0 / (mid - params[0]);
+    coefs.C[4] = 1.0 - coefs.C[3] * mid;
+    coefs.C[5] = 1.0 / (mid - params[1]);
+    coefs.C[6] = 1.0 - coefs.C[5] * mid;
+
+    return true;
 }
 //-----------------------------------------------------------------------------
 
-fuzzvar TStdFuzzyFunctions::inverseTriangle(fuzzlist& params, fuzzvar x)
+fuzzvar TStdFuzzyFunctions::triangleCompiled(const SFuzzyCoefs& coefs, fuzzvar x)
 {
-    return fuzzvar(1.0 - triangle(params, x));
+    if(!(x > coefs.C[0] && x < coefs.C[1]))
+        return 0.0;
+
+    return x < coefs.C[2] ? coefs.C[4] + coefs.C[3] * x : coefs.C[6] + coefs.C[5] * x;
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TStdFuzzyFunctions::inverseTriangleCompiled(const SFuzzyCoefs& coefs, fuzzvar x)
+{
+    return fuzzvar(1.0 - triangleCompiled(coefs, x));
 }
 //-----------------------------------------------------------------------------
 
@@ -349,87 +496,69 @@ fzhndl TStdFuzzyFunctions::add(SFuzzyFunction* fFunc)
 	if(fFunc->Function == NULL)
         throw TFuzzyError("add", "Puntero a funcin NULL", __LINE__, __FILE__);
 
-	std::map<fzhndl, SFuzzyFunction*>::iterator iter = m_mFunctions.begin();
-
-	while(iter != m_mFunctions.end() && fFunc != iter->second && *fFunc != *(iter->second))
-		++iter;
+	std::lock_guard<std::recursive_mutex> lock(functionsLock());
+	SFuzzyFunction*                       ff_found = bySymbol(fFunc->symbol());
 
-	if(iter == m_mFunctions.end())
+	if(!ff_found)
 	{
-		m_mFunctions[fFunc->handle()] = fFunc;
+		m_vFunctions.push_back(fFunc);
+		m_mHandles[fFunc->handle()] = fFunc;
+		m_mNames[fFunc->symbol()]   = fFunc;
 		return fFunc->handle();
 	}
-	else if(iter->second == fFunc || iter->second->name() == fFunc->name())
-	{
-		return iter->first;
-	}
 
-	return INVALID_FUNC;
+	return ff_found->handle();
 }
 //-----------------------------------------------------------------------------
 
 /**
  * \param [in] ffId Descriptor de la funcin
  *
- * Las funciones de grado de verdad se almacenan en la librera m_mFunctions.
+ * Las funciones de grado de verdad se almacenan en la librera m_vFunctions.
  * A cada funcin se le asigna un descriptor nico que sirve para identifcarla
  * y poder acceder a ella.
  *
  * \return Puntero a la funcin cuyo descriptor es ffId. NULL en caso de no
  * encontrarse dicha funcin
- * \sa add(), operator[], m_mFunctions
+ * \sa add(), operator[], m_vFunctions
  */
 SFuzzyFunction* TStdFuzzyFunctions::operator[](fzhndl ffId)
 {
-	std::map<fzhndl, SFuzzyFunction*>::iterator found = m_mFunctions.find(ffId);
+	std::unordered_map<fzhndl, SFuzzyFunction*>::iterator found = m_mHandles.find(ffId);
 
-	return found == m_mFunctions.end() ? NULL : found->second;
+	return found == m_mHandles.end() ? NULL : found->second;
 }
 //-----------------------------------------------------------------------------
 
 /**
- * \param [in] iIndex Posicin de la funcin a devolver
+ * \param [in] strName Nombre de la funcin
  *
- * Las funciones de grado de verdad se almacenan en la librera m_mFunctions.
- * A cada funcin se le asigna un descriptor nico que sirve para identifcarla
- * y poder acceder a ella.
+ * Las funciones de grado de verdad se almacenan en la librera m_vFunctions.
+ * Cada funcin tiene un nombre que la identifica y puede accederse a ella
+ * mediante ste.
  *
- * \return Puntero a la funcin en la posicin iIndex. NULL en caso de no
+ * \return Puntero a la funcin cuyo nombre es strName. NULL en caso de no
  * encontrarse dicha funcin
- * \sa add(), operator[], m_mFunctions
+ * \sa add(), operator[], m_vFunctions
  */
-SFuzzyFunction* TStdFuzzyFunctions::operator[](int iIndex)
+SFuzzyFunction* TStdFuzzyFunctions::operator[](const std::string& strName)
 {
-	std::map<fzhndl, SFuzzyFunction*>::iterator iter = m_mFunctions.begin();
-	int i_ndx = 0;
-
-	while(iter != m_mFunctions.end() && i_ndx++ < iIndex)
-		++iter;
-
-	return iter == m_mFunctions.end() ? NULL : iter->second;
+	return bySymbol(TFuzzySymbols::find(strName));
 }
 //-----------------------------------------------------------------------------
 
 /**
- * \param [in] strName Nombre de la funcin
- *
- * Las funciones de grado de verdad se almacenan en la librera m_mFunctions.
- * Cada funcin tiene un nombre que la identifica y puede accederse a ella
- * mediante ste.
+ * \param [in] fsName Smbolo del nombre de la funcin
  *
- * \return Puntero a la funcin cuyo nombre es strName. NULL en caso de no
- * encontrarse dicha funcin
- * \sa add(), operator[], m_mFunctions
+ * \return Puntero a la funcin cuyo nombre tiene el smbolo fsName. NULL en
+ * caso de no encontrarse dicha funcin
+ * \sa add(), operator[], m_mNames
  */
-SFuzzyFunction* TStdFuzzyFunctions::operator[](std::string strName)
+SFuzzyFunction* TStdFuzzyFunctions::bySymbol(fzsymbol fsName)
 {
-	toLower(trim(strName));
-	std::map<fzhndl, SFuzzyFunction*>::iterator iter = m_mFunctions.begin();
-
-	while(iter != m_mFunctions.end() && iter->second->name() != strName)
-		++iter;
+	std::unordered_map<fzsymbol, SFuzzyFunction*>::iterator found = m_mNames.find(fsName);
 
-	return iter == m_mFunctions.end() ? NULL : iter->second;
+	return found == m_mNames.end() ? NULL : found->second;
 }
 //-----------------------------------------------------------------------------
 
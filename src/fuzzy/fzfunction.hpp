@@ -35,16 +35,40 @@
 #define __FZFUNCTION_HPP__
 //-----------------------------------------------------------------------------
 #include <string>
-#include <map>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
 #include "fzbase.hpp"
 //-----------------------------------------------------------------------------
 #define INVALID_FUNC	0
+/** Tamao del bloque de coeficientes precalculados de una funcin */
+#define FL_FUNC_COEFS	8
 //-----------------------------------------------------------------------------
 
 namespace nsFuzzy
 {
 	//-------------------------------------------------------------------------
 
+	/**
+	 * Coeficientes de una funcin de grado de verdad que slo dependen de sus
+	 * parmetros (centros, pendientes, constantes...). Se calculan una vez por
+	 * definicin (SFuzzyFunction::Compile) para que cada evaluacin
+	 * (SFuzzyFunction::Compiled) se reduzca a unas pocas multiplicaciones y
+	 * sumas.
+	 */
+	struct SFuzzyCoefs
+	{
+		fuzzvar C[FL_FUNC_COEFS];
+	};
+	//-------------------------------------------------------------------------
+
+	/** Prototipo de la funcin que precalcula los coeficientes. Devuelve
+	 * false si los parmetros no son vlidos */
+	typedef bool    (*FFuzzyCompile)(const fuzzlist&, SFuzzyCoefs&);
+	/** Prototipo de la funcin evaluada con los coeficientes precalculados */
+	typedef fuzzvar (*FFuzzyCompiled)(const SFuzzyCoefs&, fuzzvar);
+	//-------------------------------------------------------------------------
+
 	/** Define una funcin en el contexto de lgica difusa.
 	 *
 	 * Las funciones en lgica difusa corresponden a funciones matemticas.
@@ -76,6 +100,11 @@ namespace nsFuzzy
         int            ParamCount;
         /** Puntero a la funcin */
         FFuzzyFunction Function;
+        /** Preclculo de los coeficientes (NULL si la funcin no lo tiene) */
+        FFuzzyCompile  Compile;
+        /** La funcin con los coeficientes precalculados. Debe dar
+         * exactamente lo mismo que Function */
+        FFuzzyCompiled Compiled;
 
         /** Constructor de la estructura */
         SFuzzyFunction();
@@ -105,11 +134,18 @@ namespace nsFuzzy
 	class TStdFuzzyFunctions : public TFuzzyBase
 	{
     private:
-    	/** Mapa con la lista de funciones registradas */
-    	static std::map<fzhndl, SFuzzyFunction*> m_mFunctions;
+    	/** Lista de funciones registradas, en orden de registro */
+    	static std::vector<SFuzzyFunction*> m_vFunctions;
+    	/** ndice de las funciones registradas por descriptor */
+    	static std::unordered_map<fzhndl, SFuzzyFunction*> m_mHandles;
+    	/** ndice de las funciones registradas por smbolo de su nombre */
+    	static std::unordered_map<fzsymbol, SFuzzyFunction*> m_mNames;
     	/** Numero de instancias de esta clase */
     	static unsigned int                      m_uiInstances;
 
+    	/** Cerrojo para el registro de funciones y el nmero de instancias */
+    	static std::recursive_mutex& functionsLock();
+
     	/** Limpia la lista de funciones registradas */
     	void clear();
     	/** Registra las funciones estndar disponibles */
@@ -135,16 +171,26 @@ namespace nsFuzzy
         static fuzzvar triangle(fuzzlist& params, fuzzvar x);
     	/** An inverse triangle. A 'V'? */
         static fuzzvar inverseTriangle(fuzzlist& params, fuzzvar x);
+
+        //-- Coeficientes precalculados de las funciones estndar
+        static bool    gaussBellCompile(const fuzzlist& params, SFuzzyCoefs& coefs);
+        static fuzzvar gaussBellCompiled(const SFuzzyCoefs& coefs, fuzzvar x);
+        static bool    sCurveCompile(const fuzzlist& params, SFuzzyCoefs& coefs);
+        static fuzzvar sCurveCompiled(const SFuzzyCoefs& coefs, fuzzvar x);
+        static fuzzvar inverseSCurveCompiled(const SFuzzyCoefs& coefs, fuzzvar x);
+        static bool    triangleCompile(const fuzzlist& params, SFuzzyCoefs& coefs);
+        static fuzzvar triangleCompiled(const SFuzzyCoefs& coefs, fuzzvar x);
+        static fuzzvar inverseTriangleCompiled(const SFuzzyCoefs& coefs, fuzzvar x);
         /** An interpolated curve */
         static fuzzvar interpolate(fuzzlist& params, fuzzvar x);
 
     protected:
         /** Hace accesible la lista de funciones a las clases derivadas
          *
-         * \return mapa de las funciones registradas por la librera.
-         * \sa m_mFunctions
+         * \return lista de las funciones registradas por la librera.
+         * \sa m_vFunctions
          */
-        std::map<fzhndl, SFuzzyFunction*>& functions() { return m_mFunctions; }
+        std::vector<SFuzzyFunction*>& functions() { return m_vFunctions; }
 
         /** Devuelve el nmero de instancias existentes de esta clase */
         virtual inline unsigned int instances() { return m_uiInstances; }
@@ -156,16 +202,21 @@ namespace nsFuzzy
     	virtual ~TStdFuzzyFunctions();
 
     	/** Nmero de funciones registradas */
-    	inline size_t size() { return m_mFunctions.size(); }
+    	inline size_t size() { return m_vFunctions.size(); }
 
     	/** Registra una nueva funcin en el sistema */
         fzhndl add(SFuzzyFunction* fFunc);
 		/** Devuelve la funcin con el id especificado */
 		SFuzzyFunction* operator[](fzhndl ffId);
 		/** Devuelve la funcin en la posicin especificada */
-		SFuzzyFunction* operator[](int iIndex);
+		inline SFuzzyFunction* operator[](int iIndex)
+		{
+			return (iIndex >= 0 && size_t(iIndex) < m_vFunctions.size()) ? m_vFunctions[iIndex] : NULL;
+		}
 		/** Devuelve la funcin con el nombre especificado */
-		SFuzzyFunction* operator[](std::string strName);
+		SFuzzyFunction* operator[](const std::string& strName);
+		/** Devuelve la funcin dado el smbolo de su nombre */
+		SFuzzyFunction* bySymbol(fzsymbol fsName);
     };
 	//-------------------------------------------------------------------------
 
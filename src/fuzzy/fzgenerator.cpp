@@ -0,0 +1,315 @@
+/**
+ * \file fzgenerator.cpp
+ *
+ *  Synthetic model generator. Builds large, valid models of a given shape
+ *  (sets, values, functions, rules and chained depth) for benchmarks and
+ *  stress tests, always the same for the same seed.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzgenerator.hpp"
+#include "fzfunction.hpp"
+#include <algorithm>
+#include <set>
+#include <sstream>
+//-----------------------------------------------------------------------------
+/** Intentos de obtener una regla nueva antes de dejar el conjunto con menos */
+#define FL_GEN_RETRIES		1000
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+SGeneratorConfig::SGeneratorConfig()
+{
+	Name          = "generated";
+	Inputs        = 2;
+	Intermediates = 0;
+	Outputs       = 1;
+	Depth         = 1;
+	Values        = 3;
+	Rules         = 10;
+	RuleLength    = 2;
+	ModifierRate  = 0.0;
+	Seed          = 1;
+
+	Functions.push_back("Triangle");
+	Functions.push_back("Gaussian Bell");
+	Functions.push_back("S-Curve");
+	Functions.push_back("Inverted S-Curve");
+}
+//-----------------------------------------------------------------------------
+
+
+
+
+
+
+
+
+/**
+ * \param [in] gcConfig Forma del modelo a generar
+ */
+TFuzzyGenerator::TFuzzyGenerator(const SGeneratorConfig& gcConfig) : m_gcConfig(gcConfig)
+{
+	m_uSeed = gcConfig.Seed;
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyGenerator::~TFuzzyGenerator()
+{
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Generador congruencial lineal. Se usa uno propio, y no rand(), para que el
+ * modelo no dependa de la plataforma ni de otros usuarios de rand().
+ *
+ * \return El siguiente nmero pseudoaleatorio, de 24 bits.
+ */
+unsigned TFuzzyGenerator::random()
+{
+	m_uSeed = m_uSeed * 1103515245u + 12345u;
+	return (m_uSeed >> 8) & 0xFFFFFF;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szCount Nmero de posibilidades
+ *
+ * \return Un nmero pseudoaleatorio entre 0 y szCount - 1.
+ */
+size_t TFuzzyGenerator::random(size_t szCount)
+{
+	uint64_t ui_rand = (uint64_t(random()) << 24) | random();
+
+	return szCount ? size_t(ui_rand % szCount) : 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] cPrefix Prefijo del nombre
+ * \param [in] szIndex Nmero a aadir tras el prefijo
+ *
+ * \return El nombre compuesto (in0, mid12, v3...).
+ */
+static std::string numbered(const char* cPrefix, size_t szIndex)
+{
+	std::stringstream ss;
+
+	ss << cPrefix << szIndex;
+	return ss.str();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [out] vLayers Nombres de los conjuntos de cada capa
+ *
+ * Comprueba la configuracin y reparte los conjuntos en capas (ver
+ * SGeneratorConfig). Lanza TFuzzyError si la forma pedida no es posible.
+ */
+void TFuzzyGenerator::check(std::vector<std::vector<std::string> >& vLayers)
+{
+	TFuzzyFunctions ff_funcs;
+	size_t          sz_mid = 0;
+
+	if(!m_gcConfig.Inputs || !m_gcConfig.Outputs || !m_gcConfig.Values || !m_gcConfig.RuleLength)
+		throw TFuzzyError("generate", "Hace falta al menos una entrada, una salida, un valor y un antecedente",
+				__LINE__, __FILE__);
+	if(!m_gcConfig.Depth || m_gcConfig.Intermediates < m_gcConfig.Depth - 1
+			|| (m_gcConfig.Depth == 1 && m_gcConfig.Intermediates))
+		throw TFuzzyError("generate", "Los intermedios no llenan las capas pedidas",
+				__LINE__, __FILE__);
+	if(m_gcConfig.Rules < m_gcConfig.Intermediates + m_gcConfig.Outputs)
+		throw TFuzzyError("generate", "Hace falta al menos una regla por conjunto calculado",
+				__LINE__, __FILE__);
+	if(m_gcConfig.Functions.empty())
+		throw TFuzzyError("generate", "No hay funciones", __LINE__, __FILE__);
+	for(size_t i = 0; i < m_gcConfig.Functions.size(); ++i)
+	{
+		SFuzzyFunction* ff_func = ff_funcs[m_gcConfig.Functions[i]];
+		if(!ff_func || ff_func == ff_funcs["Interpolate"])
+			throw TFuzzyError("generate", "Funcin desconocida o no admitida", __LINE__, __FILE__);
+	}
+
+	vLayers.assign(m_gcConfig.Depth + 1, std::vector<std::string>());
+	for(size_t i = 0; i < m_gcConfig.Inputs; ++i)
+		vLayers[0].push_back(numbered("in", i));
+	for(size_t l = 1; l < m_gcConfig.Depth; ++l)
+	{
+		size_t sz_count = m_gcConfig.Intermediates / (m_gcConfig.Depth - 1)
+						+ (l - 1 < m_gcConfig.Intermediates % (m_gcConfig.Depth - 1) ? 1 : 0);
+		for(size_t i = 0; i < sz_count; ++i)
+			vLayers[l].push_back(numbered("mid", sz_mid++));
+	}
+	for(size_t i = 0; i < m_gcConfig.Outputs; ++i)
+		vLayers[m_gcConfig.Depth].push_back(numbered("out", i));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] vLayers  Nombres de los conjuntos de cada capa
+ * \param [in] szLayer  Capa del conjunto calculado (1 o ms)
+ * \param [in] strSet   Conjunto calculado
+ *
+ * El primer antecedente sale de la capa anterior y el resto, sin repetir
+ * conjunto, de cualquier capa anterior. Los antecedentes se escriben
+ * ordenados.
+ *
+ * \return El texto de una regla al azar que calcula strSet.
+ */
+std::string TFuzzyGenerator::rule(const std::vector<std::vector<std::string> >& vLayers,
+								  size_t szLayer, const std::string& strSet)
+{
+	static const char* c_mods[3] = { "very.", "slightly.", "not." };
+
+	std::vector<const std::string*> v_sets;
+	std::vector<bool>               v_used;
+	std::vector<std::string>        v_atoms;
+	std::string                     str_rule;
+	size_t                          sz_prev = vLayers[szLayer - 1].size();
+	size_t                          sz_count;
+
+	//-- Los conjuntos de la capa anterior van primero
+	for(size_t l = szLayer; l-- > 0;)
+		for(size_t i = 0; i < vLayers[l].size(); ++i)
+			v_sets.push_back(&vLayers[l][i]);
+	v_used.assign(v_sets.size(), false);
+	sz_count = m_gcConfig.RuleLength < v_sets.size() ? m_gcConfig.RuleLength : v_sets.size();
+
+	for(size_t i = 0; i < sz_count; ++i)
+	{
+		size_t sz_set = i ? random(v_sets.size()) : random(sz_prev);
+
+		while(v_used[sz_set])
+			sz_set = (sz_set + 1) % v_sets.size();
+		v_used[sz_set] = true;
+
+		v_atoms.push_back(*v_sets[sz_set] + ".");
+		if(m_gcConfig.ModifierRate > 0.0 && random(1000000) < m_gcConfig.ModifierRate * 1.0E6)
+			v_atoms.back() += c_mods[random(3)];
+		v_atoms.back() += numbered("v", random(m_gcConfig.Values));
+	}
+
+	//-- En orden, para que dos reglas iguales para el modelo tengan el mismo texto
+	std::sort(v_atoms.begin(), v_atoms.end());
+	for(size_t i = 0; i < v_atoms.size(); ++i)
+		str_rule += (i ? " and " : "if ") + v_atoms[i];
+
+	return str_rule + " then " + strSet + "." + numbered("v", random(m_gcConfig.Values));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [out] fmModel Modelo a construir
+ *
+ * Vaca fmModel y crea en l los conjuntos, sus valores y las reglas. Los
+ * valores de cada conjunto se reparten entre 0 y 100, cada uno el doble de
+ * ancho que la separacin entre ellos, con una funcin elegida al azar de
+ * las configuradas y sus parmetros extra repartidos entre sus lmites. Las
+ * reglas se asignan por turno a los conjuntos calculados, en orden de capa.
+ */
+void TFuzzyGenerator::generate(TFuzzyModel& fmModel)
+{
+	std::vector<std::vector<std::string> > v_layers;
+	std::vector<std::pair<size_t, const std::string*> > v_calc;
+	std::set<std::string>    st_rules;
+	std::vector<std::string> v_rules;
+	std::vector<bool>        v_full;
+	TFuzzyFunctions          ff_funcs;
+	fuzzvar                  fv_step = fuzzvar(100.0 / m_gcConfig.Values);
+
+	check(v_layers);
+	m_uSeed = m_gcConfig.Seed;
+
+	fmModel.clear();
+	fmModel.name(m_gcConfig.Name);
+
+	for(size_t l = 0; l < v_layers.size(); ++l)
+	{
+		for(size_t i = 0; i < v_layers[l].size(); ++i)
+		{
+			TFuzzySet& fs_set = fmModel.sets()[fmModel.sets().add(v_layers[l][i])];
+
+			for(size_t j = 0; j < m_gcConfig.Values; ++j)
+			{
+				TFuzzyVal&      fv_val  = fs_set[fs_set.add(numbered("v", j))];
+				SFuzzyFunction* ff_func = ff_funcs[m_gcConfig.Functions[random(m_gcConfig.Functions.size())]];
+				fuzzvar         fv_min  = fv_step * fuzzvar(j);
+				fuzzvar         fv_max  = fv_step * fuzzvar(j + 2);
+				fuzzlist        v_params;
+
+				v_params.push_back(fv_min);
+				v_params.push_back(fv_max);
+				for(int k = 0; k < ff_func->ParamCount; ++k)
+					v_params.push_back(fv_min + (fv_max - fv_min) * fuzzvar(k + 1) / fuzzvar(ff_func->ParamCount + 1));
+				fv_val.define(ff_func->name(), v_params);
+			}
+
+			if(l)
+				v_calc.push_back(std::make_pair(l, &v_layers[l][i]));
+		}
+	}
+
+	//-- Reglas distintas, por turno entre los conjuntos calculados. Un
+	//   conjunto que no consigue una regla nueva en FL_GEN_RETRIES intentos
+	//   se da por lleno
+	v_full.assign(v_calc.size(), false);
+	for(size_t i = 0; i < m_gcConfig.Rules; ++i)
+	{
+		const std::pair<size_t, const std::string*>& pr_calc = v_calc[i % v_calc.size()];
+		int                                          j       = 0;
+
+		if(v_full[i % v_calc.size()])
+			continue;
+		for(; j < FL_GEN_RETRIES; ++j)
+		{
+			std::string str_rule = rule(v_layers, pr_calc.first, *pr_calc.second);
+			if(st_rules.insert(str_rule).second)
+			{
+				v_rules.push_back(str_rule);
+				break;
+			}
+		}
+		v_full[i % v_calc.size()] = j == FL_GEN_RETRIES;
+	}
+
+	fmModel.rules().addMany(v_rules);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFileName Archivo INI a escribir
+ *
+ * Construye el modelo con generate() y lo guarda con
+ * TFuzzyModel::saveToFile(), sin comentarios.
+ */
+void TFuzzyGenerator::save(const std::string& strFileName)
+{
+	TFuzzyModel fm_model;
+
+	generate(fm_model);
+	fm_model.saveToFile(strFileName, false);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+/**
+ * \file fzgenerator.hpp
+ *
+ *  Synthetic model generator. Builds large, valid models of a given shape
+ *  (sets, values, functions, rules and chained depth) for benchmarks and
+ *  stress tests, always the same for the same seed.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZGENERATOR_HPP__
+#define __FZGENERATOR_HPP__
+//-----------------------------------------------------------------------------
+#include "fzmodel.hpp"
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Forma del modelo que construye TFuzzyGenerator.
+	 *
+	 * Los conjuntos se organizan en capas: la 0 son las entradas (in0,
+	 * in1...), las capas 1 a Depth - 1 se reparten los intermedios (mid0,
+	 * mid1...) y la ltima son las salidas (out0, out1...). Cada regla
+	 * calcula un conjunto a partir de conjuntos de capas anteriores, con al
+	 * menos uno de la capa inmediatamente anterior, por lo que el modelo no
+	 * tiene ciclos y encadena exactamente Depth conjuntos calculados.
+	 */
+	struct SGeneratorConfig
+	{
+		/** Nombre del modelo */
+		std::string Name;
+		/** Conjuntos de entrada, intermedios y de salida */
+		size_t      Inputs;
+		size_t      Intermediates;
+		size_t      Outputs;
+		/** Capas de conjuntos calculados (1: sin intermedios). Hacen falta al
+		 * menos Depth - 1 intermedios */
+		size_t      Depth;
+		/** Valores de cada conjunto */
+		size_t      Values;
+		/** Funciones de los valores, por nombre. Cada valor usa una al azar y
+		 * repetir una funcin aumenta su peso. Interpolate no se admite */
+		std::vector<std::string> Functions;
+		/** Reglas del modelo, repartidas por igual entre los conjuntos
+		 * calculados (al menos una por conjunto) */
+		size_t      Rules;
+		/** Antecedentes de cada regla (menos si no hay tantos conjuntos en
+		 * las capas anteriores) */
+		size_t      RuleLength;
+		/** Proporcin de antecedentes con modificador (very, slightly o not),
+		 * entre 0 y 1 */
+		double      ModifierRate;
+		/** Semilla del generador pseudoaleatorio */
+		unsigned    Seed;
+
+		SGeneratorConfig();
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Generador de modelos sintticos.
+	 *
+	 * Construye un TFuzzyModel con la forma de un SGeneratorConfig usando su
+	 * interfaz pblica, as que el resultado es un modelo vlido que se puede
+	 * ejecutar, guardar o convertir como cualquier otro. Todas las decisiones
+	 * al azar salen de un generador pseudoaleatorio propio iniciado con la
+	 * semilla, por lo que la misma configuracin da siempre el mismo modelo
+	 * (y el mismo archivo) en cualquier mquina.
+	 *
+	 * Los valores de cada conjunto se reparten solapados entre 0 y 100 y las
+	 * reglas son todas distintas (el modelo descarta las repetidas). Si la
+	 * forma pedida no admite tantas reglas distintas, el modelo tiene menos:
+	 * rules().size() dice cuntas tiene en realidad.
+	 */
+	class TFuzzyGenerator
+	{
+	private:
+		SGeneratorConfig m_gcConfig;
+		unsigned         m_uSeed;
+
+		unsigned    random();
+		size_t      random(size_t szCount);
+		void        check(std::vector<std::vector<std::string> >& vLayers);
+		std::string rule(const std::vector<std::vector<std::string> >& vLayers, size_t szLayer,
+						 const std::string& strSet);
+
+	public:
+		TFuzzyGenerator(const SGeneratorConfig& gcConfig);
+		virtual ~TFuzzyGenerator();
+
+		inline const SGeneratorConfig& config() { return m_gcConfig; }
+
+		/** Construye el modelo en fmModel, que se vaca antes */
+		void generate(TFuzzyModel& fmModel);
+		/** Construye el modelo y lo guarda en formato INI */
+		void save(const std::string& strFileName);
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZGENERATOR_HPP__ */
+//-----------------------------------------------------------------------------
@@ -0,0 +1,269 @@
+/**
+ * \file fzhistogram.cpp
+ *
+ *  Latency histograms. Log-bucketed histograms of the time spent by
+ *  TFuzzyExec in each calculate() and in each output set.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzhistogram.hpp"
+#include <cstdio>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+TFuzzyHistogram::TFuzzyHistogram()
+{
+	reset();
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyHistogram::~TFuzzyHistogram()
+{
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uBucket Cubo
+ *
+ * \return El mayor valor que va a parar al cubo uBucket.
+ */
+uint64_t TFuzzyHistogram::highest(unsigned uBucket)
+{
+	if(uBucket < (1u << FL_HST_BITS))
+		return uBucket;
+
+	unsigned u_shift = (uBucket >> (FL_HST_BITS - 1)) - 1;
+	uint64_t ui_base = uBucket - (u_shift << (FL_HST_BITS - 1));
+
+	return ((ui_base + 1) << u_shift) - 1;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fhOther Histograma a sumar a este
+ *
+ * Suma a este histograma los valores de fhOther, que puede estar siendo
+ * escrito por su ejecutor. Este histograma no debe tener otro escritor.
+ */
+void TFuzzyHistogram::merge(const TFuzzyHistogram& fhOther)
+{
+	if(&fhOther == this || !fhOther.count())
+		return;
+
+	for(unsigned i = 0; i < FL_HST_BUCKETS; ++i)
+		bump(m_aCounts[i], fhOther.m_aCounts[i].load(std::memory_order_relaxed));
+	bump(m_uiCount, fhOther.m_uiCount.load(std::memory_order_relaxed));
+	bump(m_uiSum, fhOther.m_uiSum.load(std::memory_order_relaxed));
+	if(fhOther.m_uiMin.load(std::memory_order_relaxed) < m_uiMin.load(std::memory_order_relaxed))
+		m_uiMin.store(fhOther.m_uiMin.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	if(fhOther.m_uiMax.load(std::memory_order_relaxed) > m_uiMax.load(std::memory_order_relaxed))
+		m_uiMax.store(fhOther.m_uiMax.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Vaca el histograma.
+ */
+void TFuzzyHistogram::reset()
+{
+	for(unsigned i = 0; i < FL_HST_BUCKETS; ++i)
+		m_aCounts[i].store(0, std::memory_order_relaxed);
+	m_uiCount.store(0, std::memory_order_relaxed);
+	m_uiSum.store(0, std::memory_order_relaxed);
+	m_uiMin.store(UINT64_MAX, std::memory_order_relaxed);
+	m_uiMax.store(0, std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return La media de los valores anotados (0 si no hay ninguno).
+ */
+double TFuzzyHistogram::mean() const
+{
+	uint64_t ui_count = count();
+
+	return ui_count ? double(m_uiSum.load(std::memory_order_relaxed)) / double(ui_count) : 0.0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] dPercent Percentil, entre 0 y 100 (99.9 para el p999)
+ *
+ * \return El menor valor tal que al menos el dPercent% de los valores
+ * anotados son menores o iguales que l. Se devuelve el mayor valor de su
+ * cubo (sin pasar del mximo anotado), por lo que nunca se queda corto.
+ */
+uint64_t TFuzzyHistogram::percentile(double dPercent) const
+{
+	uint64_t ui_count = 0;
+	uint64_t ui_total = 0;
+	uint64_t ui_max   = max();
+
+	for(unsigned i = 0; i < FL_HST_BUCKETS; ++i)
+		ui_total += m_aCounts[i].load(std::memory_order_relaxed);
+	if(!ui_total)
+		return 0;
+
+	dPercent = dPercent < 0.0 ? 0.0 : (dPercent > 100.0 ? 100.0 : dPercent);
+
+	uint64_t ui_rank = uint64_t(dPercent / 100.0 * double(ui_total) + 0.5);
+	ui_rank = ui_rank ? ui_rank : 1;
+
+	for(unsigned i = 0; i < FL_HST_BUCKETS; ++i)
+	{
+		ui_count += m_aCounts[i].load(std::memory_order_relaxed);
+		if(ui_count >= ui_rank)
+			return highest(i) < ui_max ? highest(i) : ui_max;
+	}
+
+	return ui_max;
+}
+//-----------------------------------------------------------------------------
+
+
+
+
+
+
+
+
+TFuzzyLatency::TFuzzyLatency()
+{
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyLatency::~TFuzzyLatency()
+{
+	while(!m_mSets.empty())
+	{
+		delete m_mSets.begin()->second;
+		m_mSets.erase(m_mSets.begin());
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strSet Nombre del conjunto
+ *
+ * \return El histograma del conjunto strSet, que se crea si no exista.
+ */
+TFuzzyHistogram* TFuzzyLatency::set(const std::string& strSet)
+{
+	TFuzzyHistogram*& fh_hist = m_mSets[strSet];
+
+	if(!fh_hist)
+		fh_hist = new TFuzzyHistogram();
+
+	return fh_hist;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] flOther Latencias a sumar a estas
+ *
+ * Suma a estas latencias las de flOther (las de otro ejecutor), conjunto a
+ * conjunto por nombre.
+ */
+void TFuzzyLatency::merge(const TFuzzyLatency& flOther)
+{
+	if(&flOther == this)
+		return;
+
+	m_fhCalculate.merge(flOther.m_fhCalculate);
+
+	std::map<std::string, TFuzzyHistogram*>::const_iterator iter = flOther.m_mSets.begin();
+	while(iter != flOther.m_mSets.end())
+	{
+		set(iter->first)->merge(*iter->second);
+		++iter;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Vaca todos los histogramas. Los conjuntos se conservan.
+ */
+void TFuzzyLatency::reset()
+{
+	m_fhCalculate.reset();
+
+	std::map<std::string, TFuzzyHistogram*>::iterator iter = m_mSets.begin();
+	while(iter != m_mSets.end())
+	{
+		iter->second->reset();
+		++iter;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] strText Texto al que se aade la lnea
+ * \param [in]     cName   Nombre de la fila
+ * \param [in]     fhHist  Histograma
+ */
+static void latencyLine(std::string& strText, const char* cName, const TFuzzyHistogram& fhHist)
+{
+	char c_line[192];
+
+	if(!fhHist.count())
+		return;
+
+	snprintf(c_line, sizeof(c_line), "%-24s %12llu %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			 cName, (unsigned long long)fhHist.count(), fhHist.mean() / 1.0E3,
+			 double(fhHist.percentile(50.0)) / 1.0E3, double(fhHist.percentile(99.0)) / 1.0E3,
+			 double(fhHist.percentile(99.9)) / 1.0E3, double(fhHist.max()) / 1.0E3);
+	strText += c_line;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Una tabla con una fila para calculate() ("*") y otra por conjunto con
+ * valores anotados: nmero de valores y media, p50, p99, p999 y mximo en
+ * microsegundos.
+ *
+ * \return Las latencias como texto.
+ */
+std::string TFuzzyLatency::text() const
+{
+	char c_head[192];
+
+	snprintf(c_head, sizeof(c_head), "%-24s %12s %10s %10s %10s %10s %10s\n",
+			 "set", "count", "mean (us)", "p50 (us)", "p99 (us)", "p999 (us)", "max (us)");
+
+	std::string str_ret = c_head;
+
+	latencyLine(str_ret, "*", m_fhCalculate);
+
+	std::map<std::string, TFuzzyHistogram*>::const_iterator iter = m_mSets.begin();
+	while(iter != m_mSets.end())
+	{
+		latencyLine(str_ret, iter->first.c_str(), *iter->second);
+		++iter;
+	}
+
+	return str_ret;
+}
+//-----------------------------------------------------------------------------
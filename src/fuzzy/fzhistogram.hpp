@@ -0,0 +1,219 @@
+/**
+ * \file fzhistogram.hpp
+ *
+ *  Latency histograms. Log-bucketed histograms of the time spent by
+ *  TFuzzyExec in each calculate() and in each output set.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZHISTOGRAM_HPP__
+#define __FZHISTOGRAM_HPP__
+//-----------------------------------------------------------------------------
+#include "fztrace.hpp"
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <string>
+//-----------------------------------------------------------------------------
+/** Bits de precisin de los cubos: el error relativo es menor que
+ * 1 / 2^(FL_HST_BITS - 1) (1,6%) */
+#define FL_HST_BITS			7
+/** Bit ms alto de los valores que se distinguen (2^48 ns son unas 78 horas);
+ * los mayores van al ltimo cubo */
+#define FL_HST_TOPBIT		47
+/** Nmero de cubos */
+#define FL_HST_BUCKETS		((FL_HST_TOPBIT - FL_HST_BITS + 3) << (FL_HST_BITS - 1))
+//-----------------------------------------------------------------------------
+
+/**
+ * Anota en el histograma fhHist (TFuzzyHistogram*) el tiempo hasta el final
+ * del bloque. Si fhHist es NULL no mide nada. Compilando con FL_NO_PROFILE
+ * desaparece por completo.
+ */
+#ifndef FL_NO_PROFILE
+	#define FL_LATENCY(fhHist) nsFuzzy::THistogramTimer ht_timer(fhHist)
+#else
+	#define FL_LATENCY(fhHist)
+#endif
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Histograma de latencias, en nanosegundos.
+	 *
+	 * Como en HdrHistogram, los cubos son lineales hasta 2^FL_HST_BITS y, a
+	 * partir de ah, cada potencia de 2 se divide en 2^(FL_HST_BITS - 1)
+	 * cubos iguales. As el error relativo de cualquier percentil es el mismo
+	 * en todo el rango, el tamao es fijo (FL_HST_BUCKETS contadores) y anotar
+	 * un valor es calcular un ndice e incrementar un contador.
+	 *
+	 * Cada histograma tiene un nico escritor (el ejecutor al que pertenece),
+	 * que actualiza los contadores con lecturas y escrituras atmicas
+	 * relajadas, sin instrucciones con bloqueo. Cualquier otro hilo puede
+	 * leerlo o sumarlo a otro (merge()) mientras tanto; reset() s debe
+	 * hacerlo su escritor o hacerse con el ejecutor parado.
+	 */
+	class TFuzzyHistogram
+	{
+	private:
+		std::atomic<uint64_t> m_aCounts[FL_HST_BUCKETS];
+		std::atomic<uint64_t> m_uiCount;
+		std::atomic<uint64_t> m_uiSum;
+		std::atomic<uint64_t> m_uiMin;
+		std::atomic<uint64_t> m_uiMax;
+
+		/** Suma uiDelta a aValue. Slo para el escritor del histograma */
+		static inline void bump(std::atomic<uint64_t>& aValue, uint64_t uiDelta)
+		{
+			aValue.store(aValue.load(std::memory_order_relaxed) + uiDelta,
+						 std::memory_order_relaxed);
+		}
+
+		/** Posicin del bit ms alto de uiValue (distinto de 0) */
+		static inline unsigned topBit(uint64_t uiValue)
+		{
+#if defined(__GNUC__)
+			return 63 - __builtin_clzll(uiValue);
+#else
+			unsigned u_bit = 0;
+			while(uiValue >>= 1)
+				++u_bit;
+			return u_bit;
+#endif
+		}
+
+		TFuzzyHistogram(const TFuzzyHistogram&);
+		TFuzzyHistogram& operator=(const TFuzzyHistogram&);
+
+	public:
+		TFuzzyHistogram();
+		virtual ~TFuzzyHistogram();
+
+		/** Cubo del valor uiValue */
+		static inline unsigned bucket(uint64_t uiValue)
+		{
+			if(uiValue >> FL_HST_TOPBIT >> 1)
+				uiValue = (uint64_t(1) << (FL_HST_TOPBIT + 1)) - 1;
+			if(uiValue < (uint64_t(1) << FL_HST_BITS))
+				return unsigned(uiValue);
+
+			unsigned u_shift = topBit(uiValue) - (FL_HST_BITS - 1);
+			return (u_shift << (FL_HST_BITS - 1)) + unsigned(uiValue >> u_shift);
+		}
+		static uint64_t highest(unsigned uBucket);
+
+		/** Anota un valor */
+		inline void add(uint64_t uiValue)
+		{
+			bump(m_aCounts[bucket(uiValue)], 1);
+			bump(m_uiCount, 1);
+			bump(m_uiSum, uiValue);
+			if(uiValue < m_uiMin.load(std::memory_order_relaxed))
+				m_uiMin.store(uiValue, std::memory_order_relaxed);
+			if(uiValue > m_uiMax.load(std::memory_order_relaxed))
+				m_uiMax.store(uiValue, std::memory_order_relaxed);
+		}
+
+		void merge(const TFuzzyHistogram& fhOther);
+		void reset();
+
+		/** Valores anotados */
+		inline uint64_t count() const { return m_uiCount.load(std::memory_order_relaxed); }
+		/** Menor valor anotado (0 si no hay ninguno) */
+		inline uint64_t min()   const { return count() ? m_uiMin.load(std::memory_order_relaxed) : 0; }
+		/** Mayor valor anotado */
+		inline uint64_t max()   const { return m_uiMax.load(std::memory_order_relaxed); }
+		double          mean()  const;
+
+		uint64_t percentile(double dPercent) const;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Latencias de un ejecutor (TFuzzyExec::latencyEnable()): la de cada
+	 * calculate() completo y la de cada conjunto de salida (el clculo del
+	 * propio conjunto, sin el de sus entradas). Los conjuntos se identifican
+	 * por su nombre, de manera que pueden sumarse las latencias de varios
+	 * ejecutores (merge()), usen un modelo o una imagen.
+	 */
+	class TFuzzyLatency
+	{
+	private:
+		TFuzzyHistogram                          m_fhCalculate;
+		std::map<std::string, TFuzzyHistogram*>  m_mSets;
+
+		TFuzzyLatency(const TFuzzyLatency&);
+		TFuzzyLatency& operator=(const TFuzzyLatency&);
+
+	public:
+		TFuzzyLatency();
+		virtual ~TFuzzyLatency();
+
+		/** Latencia de calculate() */
+		inline TFuzzyHistogram& calculate() { return m_fhCalculate; }
+		/** Latencia de cada conjunto de salida */
+		inline const std::map<std::string, TFuzzyHistogram*>& sets() const { return m_mSets; }
+
+		TFuzzyHistogram* set(const std::string& strSet);
+
+		void        merge(const TFuzzyLatency& flOther);
+		void        reset();
+		std::string text() const;
+	};
+	//-------------------------------------------------------------------------
+
+#ifndef FL_NO_PROFILE
+	/**
+	 * Cronmetro de un histograma: anota en fhHist el tiempo transcurrido
+	 * entre su construccin y su destruccin. Con fhHist a NULL no lee el
+	 * reloj. Se usa a travs de FL_LATENCY.
+	 */
+	class THistogramTimer
+	{
+	private:
+		TFuzzyHistogram* m_fhHist;
+		uint64_t         m_uiStart;
+
+	public:
+		explicit inline THistogramTimer(TFuzzyHistogram* fhHist) : m_fhHist(fhHist)
+		{
+			if(m_fhHist)
+				m_uiStart = TFuzzyTrace::now();
+		}
+		inline ~THistogramTimer()
+		{
+			if(m_fhHist)
+				m_fhHist->add(TFuzzyTrace::now() - m_uiStart);
+		}
+	};
+	//-------------------------------------------------------------------------
+#endif
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZHISTOGRAM_HPP__ */
+//-----------------------------------------------------------------------------
@@ -0,0 +1,479 @@
+/**
+ * \file fzimage.cpp
+ *
+ *  Read-only, memory mapped model images.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzimage.hpp"
+#include "fzsymbols.hpp"
+#include "fzval.hpp"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  cData    Comienzo de la imagen
+ * \param [in]  szSize   Tamao de la imagen
+ * \param [in]  btTable  Entrada de la cabecera que describe la tabla
+ * \param [in]  szRecord Tamao de cada registro
+ * \param [out] uiCount  Nmero de registros de la tabla
+ *
+ * \return Puntero al primer registro de la tabla, comprobando que est
+ * alineada y completamente dentro de la imagen.
+ */
+static const char* imgTable(const char* cData, size_t szSize, const SBinTable& btTable,
+		size_t szRecord, uint32_t& uiCount)
+{
+	uint32_t ui_off = TBinOrder::swap32(btTable.Offset);
+
+	uiCount = TBinOrder::swap32(btTable.Count);
+	if(ui_off % FL_BIN_ALIGN || ui_off < sizeof(SBinHeader)
+			|| uint64_t(ui_off) + uint64_t(uiCount) * szRecord > uint64_t(szSize))
+		throw TFuzzyError("map", "Tabla fuera de la imagen", __LINE__, __FILE__);
+
+	return cData + ui_off;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiFirst Primer registro del rango
+ * \param [in] uiCount Nmero de registros del rango
+ * \param [in] uiSize  Nmero de registros de la tabla
+ *
+ * \return true si el rango est dentro de la tabla.
+ */
+static inline bool imgRange(uint32_t uiFirst, uint32_t uiCount, uint32_t uiSize)
+{
+	return uint64_t(uiFirst) + uint64_t(uiCount) <= uint64_t(uiSize);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+TFuzzyImage::TFuzzyImage()
+{
+#if defined(_WIN32)
+	m_hFile    = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#endif
+	m_cData  = NULL;
+	m_szSize = 0;
+	reset();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo binario a proyectar
+ * \param [in] bVerify Comprobar todos los ndices de la imagen
+ *
+ * \sa map()
+ */
+TFuzzyImage::TFuzzyImage(const std::string& strFile, bool bVerify)
+{
+#if defined(_WIN32)
+	m_hFile    = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#endif
+	m_cData  = NULL;
+	m_szSize = 0;
+	reset();
+	map(strFile, bVerify);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+TFuzzyImage::~TFuzzyImage()
+{
+	unmap();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Deja todas las tablas vacas y libera las definiciones de los valores.
+ */
+void TFuzzyImage::reset()
+{
+	for(size_t i = 0; i < m_vDefs.size(); ++i)
+		TFuzzyVal::definitions().release(m_vDefs[i]);
+	m_vDefs.clear();
+
+	m_bsSets      = NULL;
+	m_bvValues    = NULL;
+	m_bfFunctions = NULL;
+	m_uiParams    = NULL;
+	m_brRules     = NULL;
+	m_baAtoms     = NULL;
+	m_cStrings    = NULL;
+	m_uiRuleRefs  = NULL;
+	m_uiOrder     = NULL;
+	m_uiSetNames  = NULL;
+
+	m_uiSets = m_uiValues = m_uiFunctions = m_uiParamCount = 0;
+	m_uiRules = m_uiAtoms = m_uiStrings = 0;
+	m_uiRuleRefCount = m_uiOrderCount = m_uiSetNameCount = 0;
+
+	m_vFunctions.clear();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo binario a proyectar
+ * \param [in] bVerify Comprobar todos los ndices de la imagen
+ *
+ * Proyecta el archivo en memoria de slo lectura y compartida, de manera que
+ * no se copia ni se analiza su contenido. Siempre se comprueban la cabecera y
+ * que todas las tablas estn dentro del archivo, y se resuelven las funciones
+ * por su nombre.
+ *
+ * Si bVerify es true se comprueba adems que todos los ndices de los
+ * registros estn dentro de sus tablas, lo que supone recorrer la imagen
+ * completa. Slo debe omitirse con archivos de confianza (por ejemplo, los
+ * recin generados por saveToBinary()): TFuzzyExec usa los ndices, los
+ * conjuntos y las posiciones de los tomos tal cual, sin volver a
+ * comprobarlos.
+ *
+ * Si ya haba un archivo proyectado, se libera antes.
+ *
+ * \sa unmap(), TFuzzyModel::saveToBinary()
+ */
+void TFuzzyImage::map(const std::string& strFile, bool bVerify)
+{
+	unmap();
+
+#if defined(_WIN32)
+	HANDLE h_file = CreateFileA(strFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(h_file == INVALID_HANDLE_VALUE)
+		throw TFuzzyError("map", "No se puede abrir el archivo", __LINE__, __FILE__);
+
+	LARGE_INTEGER li_size;
+	if(!GetFileSizeEx(h_file, &li_size) || li_size.QuadPart < LONGLONG(sizeof(SBinHeader)))
+	{
+		CloseHandle(h_file);
+		throw TFuzzyError("map", "El archivo no es un modelo binario", __LINE__, __FILE__);
+	}
+
+	HANDLE h_map = CreateFileMappingA(h_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	void*  p_data = h_map ? MapViewOfFile(h_map, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if(!p_data)
+	{
+		if(h_map)
+			CloseHandle(h_map);
+		CloseHandle(h_file);
+		throw TFuzzyError("map", "No se puede proyectar el archivo", __LINE__, __FILE__);
+	}
+
+	m_hFile    = h_file;
+	m_hMapping = h_map;
+	m_szSize   = size_t(li_size.QuadPart);
+#else
+	int i_file = open(strFile.c_str(), O_RDONLY);
+	if(i_file < 0)
+		throw TFuzzyError("map", "No se puede abrir el archivo", __LINE__, __FILE__);
+
+	struct stat st_file;
+	if(fstat(i_file, &st_file) != 0 || st_file.st_size < off_t(sizeof(SBinHeader)))
+	{
+		close(i_file);
+		throw TFuzzyError("map", "El archivo no es un modelo binario", __LINE__, __FILE__);
+	}
+
+	void* p_data = mmap(NULL, size_t(st_file.st_size), PROT_READ, MAP_SHARED, i_file, 0);
+	//-- La proyeccin se mantiene aunque se cierre el archivo
+	close(i_file);
+	if(p_data == MAP_FAILED)
+		throw TFuzzyError("map", "No se puede proyectar el archivo", __LINE__, __FILE__);
+
+	m_szSize = size_t(st_file.st_size);
+#endif
+	m_cData   = (const char*)p_data;
+	m_strFile = strFile;
+
+	try
+	{
+		check();
+		if(bVerify)
+			verify();
+	}
+	catch(TFuzzyError& e)
+	{
+		unmap();
+		throw e;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Libera la proyeccin y las definiciones de los valores. Los TFuzzyExec que
+ * usan la imagen dejan de poder ejecutarla.
+ */
+void TFuzzyImage::unmap()
+{
+	if(m_cData)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(m_cData);
+		CloseHandle(m_hMapping);
+		CloseHandle(m_hFile);
+		m_hFile    = INVALID_HANDLE_VALUE;
+		m_hMapping = NULL;
+#else
+		munmap((void*)m_cData, m_szSize);
+#endif
+	}
+
+	m_cData  = NULL;
+	m_szSize = 0;
+	m_strFile.clear();
+	reset();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Comprueba la cabecera, localiza las tablas y resuelve las funciones.
+ */
+void TFuzzyImage::check()
+{
+	const SBinHeader* bh_head = (const SBinHeader*)m_cData;
+
+	if(memcmp(bh_head->Magic, FL_BIN_MAGIC, 4) != 0)
+		throw TFuzzyError("map", "El archivo no es un modelo binario", __LINE__, __FILE__);
+	if(TBinOrder::swap16(bh_head->Version) != FL_BIN_VERSION)
+		throw TFuzzyError("map", "Versin del formato binario no soportada", __LINE__, __FILE__);
+	if(TBinOrder::swap32(bh_head->Size) != uint64_t(m_szSize))
+		throw TFuzzyError("map", "Tamao de archivo incorrecto", __LINE__, __FILE__);
+
+	m_bsSets      = (const SBinSet*)     imgTable(m_cData, m_szSize, bh_head->Sets,      sizeof(SBinSet),      m_uiSets);
+	m_bvValues    = (const SBinValue*)   imgTable(m_cData, m_szSize, bh_head->Values,    sizeof(SBinValue),    m_uiValues);
+	m_bfFunctions = (const SBinFunction*)imgTable(m_cData, m_szSize, bh_head->Functions, sizeof(SBinFunction), m_uiFunctions);
+	m_uiParams    = (const uint32_t*)    imgTable(m_cData, m_szSize, bh_head->Params,    sizeof(uint32_t),     m_uiParamCount);
+	m_brRules     = (const SBinRule*)    imgTable(m_cData, m_szSize, bh_head->Rules,     sizeof(SBinRule),     m_uiRules);
+	m_baAtoms     = (const SBinAtom*)    imgTable(m_cData, m_szSize, bh_head->Atoms,     sizeof(SBinAtom),     m_uiAtoms);
+	m_cStrings    =                      imgTable(m_cData, m_szSize, bh_head->Strings,   1,                    m_uiStrings);
+	m_uiRuleRefs  = (const uint32_t*)    imgTable(m_cData, m_szSize, bh_head->RuleRefs,  sizeof(uint32_t),     m_uiRuleRefCount);
+	m_uiOrder     = (const uint32_t*)    imgTable(m_cData, m_szSize, bh_head->Order,     sizeof(uint32_t),     m_uiOrderCount);
+	m_uiSetNames  = (const uint32_t*)    imgTable(m_cData, m_szSize, bh_head->SetNames,  sizeof(uint32_t),     m_uiSetNameCount);
+
+	if(m_uiStrings == 0 || m_cStrings[m_uiStrings - 1] != '\0')
+		throw TFuzzyError("map", "Tabla de cadenas incorrecta", __LINE__, __FILE__);
+	if(m_uiSetNameCount != m_uiSets)
+		throw TFuzzyError("map", "ndice de conjuntos incorrecto", __LINE__, __FILE__);
+
+	m_vFunctions.resize(m_uiFunctions);
+	for(uint32_t i = 0; i < m_uiFunctions; ++i)
+	{
+		m_vFunctions[i] = m_ffFunctions[std::string(string(TBinOrder::swap32(m_bfFunctions[i].Name)))];
+		if(!m_vFunctions[i])
+			throw TFuzzyError("map", "No existe la funcin del valor", __LINE__, __FILE__);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Comprueba que todos los ndices de todos los registros estn dentro de sus
+ * tablas.
+ */
+void TFuzzyImage::verify()
+{
+	for(uint32_t i = 0; i < m_uiSets; ++i)
+	{
+		const SBinSet& bs_set = m_bsSets[i];
+
+		if(!imgRange(TBinOrder::swap32(bs_set.FirstValue), TBinOrder::swap32(bs_set.ValueCount), m_uiValues)
+				|| !imgRange(TBinOrder::swap32(bs_set.FirstRule), TBinOrder::swap32(bs_set.RuleCount), m_uiRuleRefCount)
+				|| TBinOrder::swap32(m_uiSetNames[i]) >= m_uiSets)
+			throw TFuzzyError("verify", "Conjunto incorrecto", __LINE__, __FILE__);
+	}
+
+	for(uint32_t i = 0; i < m_uiValues; ++i)
+	{
+		const SBinValue& bv_val = m_bvValues[i];
+		uint32_t         ui_fun = TBinOrder::swap32(bv_val.Function);
+		uint32_t         ui_cnt = TBinOrder::swap32(bv_val.ParamCount);
+
+		if(ui_cnt < 2 || !imgRange(TBinOrder::swap32(bv_val.FirstParam), ui_cnt, m_uiParamCount)
+				|| (ui_fun != FL_BIN_NONE && ui_fun >= m_uiFunctions))
+			throw TFuzzyError("verify", "Valor incorrecto", __LINE__, __FILE__);
+	}
+
+	for(uint32_t i = 0; i < m_uiRules; ++i)
+	{
+		uint32_t ui_first = TBinOrder::swap32(m_brRules[i].FirstAtom);
+		uint32_t ui_count = TBinOrder::swap32(m_brRules[i].AtomCount);
+
+		if(ui_count < 2 || !imgRange(ui_first, ui_count, m_uiAtoms))
+			throw TFuzzyError("verify", "Regla incorrecta", __LINE__, __FILE__);
+	}
+
+	//-- El conjunto y la posicin de cada tomo deben ser los de su valor
+	for(uint32_t i = 0; i < m_uiAtoms; ++i)
+	{
+		uint32_t ui_val = TBinOrder::swap32(m_baAtoms[i].Value);
+		uint32_t ui_set = TBinOrder::swap32(m_baAtoms[i].Set);
+		uint32_t ui_pos = TBinOrder::swap32(m_baAtoms[i].Position);
+
+		if(ui_val >= m_uiValues || ui_set >= m_uiSets
+				|| ui_pos >= TBinOrder::swap32(m_bsSets[ui_set].ValueCount)
+				|| uint64_t(TBinOrder::swap32(m_bsSets[ui_set].FirstValue)) + ui_pos != ui_val)
+			throw TFuzzyError("verify", "tomo incorrecto", __LINE__, __FILE__);
+	}
+
+	for(uint32_t i = 0; i < m_uiRuleRefCount; ++i)
+		if(TBinOrder::swap32(m_uiRuleRefs[i]) >= m_uiRules)
+			throw TFuzzyError("verify", "Referencia a regla incorrecta", __LINE__, __FILE__);
+
+	for(uint32_t i = 0; i < m_uiOrderCount; ++i)
+		if(TBinOrder::swap32(m_uiOrder[i]) >= m_uiSets)
+			throw TFuzzyError("verify", "Orden de clculo incorrecto", __LINE__, __FILE__);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Registra la definicin de cada valor en TFuzzyVal::definitions(), de
+ * manera que la imagen se evala con los mismos coeficientes precalculados y
+ * curvas muestreadas que un modelo. Slo se hace la primera vez: todos los
+ * TFuzzyExec que usan la imagen comparten las definiciones, que se liberan al
+ * liberar la proyeccin.
+ */
+void TFuzzyImage::share()
+{
+	std::lock_guard<std::mutex>   lock(m_mtDefs);
+	std::vector<const SFuzzyDef*> v_defs;
+	std::vector<fuzzvar>          v_params;
+
+	if(!m_cData || m_vDefs.size() == m_uiValues)
+		return;
+
+	try
+	{
+		v_defs.reserve(m_uiValues);
+		for(uint32_t i = 0; i < m_uiValues; ++i)
+		{
+			valueParams(i, v_params);
+			v_defs.push_back(TFuzzyVal::definitions().acquire(valueFunction(i), v_params));
+		}
+	}
+	catch(...)
+	{
+		for(size_t i = 0; i < v_defs.size(); ++i)
+			TFuzzyVal::definitions().release(v_defs[i]);
+		throw;
+	}
+
+	m_vDefs.swap(v_defs);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiOffset Desplazamiento de la cadena en la tabla de cadenas
+ *
+ * \return La cadena. Cadena vaca si el desplazamiento est fuera de la tabla.
+ */
+const char* TFuzzyImage::string(uint32_t uiOffset) const
+{
+	return uiOffset < m_uiStrings ? m_cStrings + uiOffset : "";
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  uiIndex ndice del valor en la tabla de valores
+ * \param [out] vParams Mnimo, mximo y parmetros de la funcin del valor,
+ *                      como los espera SFuzzyFunction
+ */
+void TFuzzyImage::valueParams(uint32_t uiIndex, std::vector<fuzzvar>& vParams) const
+{
+	uint32_t ui_first = TBinOrder::swap32(m_bvValues[uiIndex].FirstParam);
+	uint32_t ui_count = TBinOrder::swap32(m_bvValues[uiIndex].ParamCount);
+
+	vParams.resize(ui_count);
+	for(uint32_t i = 0; i < ui_count; ++i)
+		vParams[i] = param(ui_first + i);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Nombre del modelo de la imagen.
+ */
+std::string TFuzzyImage::name() const
+{
+	return mapped() ? std::string(string(TBinOrder::swap32(((const SBinHeader*)m_cData)->Name)))
+					: std::string("");
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strName Nombre del conjunto
+ *
+ * Busca el conjunto en el ndice de conjuntos por nombre (bsqueda binaria).
+ * El nombre se normaliza como en TFuzzySymbols (sin espacios en los extremos
+ * y en minsculas), que es como se guardan en la imagen.
+ *
+ * \return ndice del conjunto en la tabla de conjuntos, FL_BIN_NONE si no
+ * existe.
+ */
+uint32_t TFuzzyImage::set(const std::string& strName) const
+{
+	size_t sz_beg = strName.find_first_not_of(' ');
+	size_t sz_end = strName.find_last_not_of(' ');
+
+	std::string str_name = sz_beg == std::string::npos
+			? std::string("") : strName.substr(sz_beg, sz_end - sz_beg + 1);
+	for(size_t i = 0; i < str_name.size(); ++i)
+		str_name[i] = TFuzzySymbols::lower(str_name[i]);
+
+	uint32_t ui_lo = 0;
+	uint32_t ui_hi = m_uiSetNameCount;
+	while(ui_lo < ui_hi)
+	{
+		uint32_t ui_mid = ui_lo + (ui_hi - ui_lo) / 2;
+		uint32_t ui_set = TBinOrder::swap32(m_uiSetNames[ui_mid]);
+		if(ui_set >= m_uiSets)
+			return FL_BIN_NONE;
+
+		int      i_cmp  = strcmp(string(TBinOrder::swap32(m_bsSets[ui_set].Name)), str_name.c_str());
+
+		if(i_cmp == 0)
+			return ui_set;
+		if(i_cmp < 0)
+			ui_lo = ui_mid + 1;
+		else
+			ui_hi = ui_mid;
+	}
+
+	return FL_BIN_NONE;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,184 @@
+/**
+ * \file fzimage.hpp
+ *
+ *  Read-only, memory mapped model images. A binary model file mapped in
+ *  memory and executed in place by TFuzzyExec.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZIMAGE_HPP__
+#define __FZIMAGE_HPP__
+//-----------------------------------------------------------------------------
+#include "fzbinary.hpp"
+#include "fzfunction.hpp"
+#include "fzrules.hpp"
+#include <mutex>
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	struct SFuzzyDef;
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Imagen de un modelo binario (TFuzzyModel::saveToBinary()) proyectada en
+	 * memoria de slo lectura.
+	 *
+	 * Todas las referencias del archivo son ndices y desplazamientos, de
+	 * manera que la imagen se usa directamente desde la proyeccin, sin crear
+	 * conjuntos, valores ni reglas. Varios procesos que proyectan el mismo
+	 * archivo comparten una nica copia fsica en la cach de pginas del
+	 * sistema operativo. Lo nico que se construye al proyectar es la tabla
+	 * de funciones (los descriptores slo son vlidos en el proceso) y, la
+	 * primera vez que se ejecuta, la definicin compartida de cada valor
+	 * (ver share()).
+	 *
+	 * La imagen no guarda ningn estado de ejecucin, por lo que puede ser
+	 * usada a la vez por varios TFuzzyExec (ver TFuzzyExec::image()).
+	 *
+	 * Los registros se devuelven tal cual estn en el archivo (little-endian);
+	 * sus campos deben leerse con TBinOrder.
+	 *
+	 * \sa SBinHeader, TFuzzyExec::image()
+	 */
+	class TFuzzyImage
+	{
+	private:
+		/** Archivo proyectado */
+		std::string                  m_strFile;
+		/** Comienzo de la proyeccin */
+		const char*                  m_cData;
+		/** Tamao de la proyeccin */
+		size_t                       m_szSize;
+#if defined(_WIN32)
+		/** Descriptores del archivo y de la proyeccin */
+		void*                        m_hFile;
+		void*                        m_hMapping;
+#endif
+
+		const SBinSet*               m_bsSets;
+		const SBinValue*             m_bvValues;
+		const SBinFunction*          m_bfFunctions;
+		const uint32_t*              m_uiParams;
+		const SBinRule*              m_brRules;
+		const SBinAtom*              m_baAtoms;
+		const char*                  m_cStrings;
+		const uint32_t*              m_uiRuleRefs;
+		const uint32_t*              m_uiOrder;
+		const uint32_t*              m_uiSetNames;
+
+		uint32_t                     m_uiSets;
+		uint32_t                     m_uiValues;
+		uint32_t                     m_uiFunctions;
+		uint32_t                     m_uiParamCount;
+		uint32_t                     m_uiRules;
+		uint32_t                     m_uiAtoms;
+		uint32_t                     m_uiStrings;
+		uint32_t                     m_uiRuleRefCount;
+		uint32_t                     m_uiOrderCount;
+		uint32_t                     m_uiSetNameCount;
+
+		/** Librera de funciones, para resolver las funciones de la imagen */
+		TFuzzyFunctions              m_ffFunctions;
+		/** Funcin de cada registro de la tabla de funciones */
+		std::vector<SFuzzyFunction*> m_vFunctions;
+		/** Definicin compartida de cada valor, vaca hasta share() */
+		std::vector<const SFuzzyDef*> m_vDefs;
+		/** Cerrojo de m_vDefs */
+		std::mutex                   m_mtDefs;
+
+		void reset();
+		void check();
+		void verify();
+
+	public:
+		TFuzzyImage();
+		TFuzzyImage(const std::string& strFile, bool bVerify = true);
+		virtual ~TFuzzyImage();
+
+		void map(const std::string& strFile, bool bVerify = true);
+		void unmap();
+		void share();
+
+		/** Indica si hay un archivo proyectado */
+		inline bool               mapped() const { return m_cData != NULL; }
+		/** Archivo proyectado */
+		inline const std::string& file()   const { return m_strFile;         }
+		/** Tamao de la proyeccin en bytes */
+		inline size_t             size()   const { return m_szSize;          }
+
+		inline const SBinSet*      sets()      const { return m_bsSets;      }
+		inline const SBinValue*    values()    const { return m_bvValues;    }
+		inline const uint32_t*     params()    const { return m_uiParams;    }
+		inline const SBinRule*     rules()     const { return m_brRules;     }
+		inline const SBinAtom*     atoms()     const { return m_baAtoms;     }
+		inline const uint32_t*     ruleRefs()  const { return m_uiRuleRefs;  }
+		inline const uint32_t*     order()     const { return m_uiOrder;     }
+
+		inline uint32_t setCount()   const { return m_uiSets;         }
+		inline uint32_t valueCount() const { return m_uiValues;       }
+		inline uint32_t ruleCount()  const { return m_uiRules;        }
+		inline uint32_t atomCount()  const { return m_uiAtoms;        }
+		inline uint32_t orderCount() const { return m_uiOrderCount;   }
+
+		/** Parmetro uiIndex de la tabla de parmetros */
+		inline fuzzvar param(uint32_t uiIndex) const { return TBinOrder::fromFile(m_uiParams[uiIndex]); }
+		/** Funcin del registro uiIndex de la tabla de funciones (NULL si
+		 * uiIndex es FL_BIN_NONE) */
+		inline SFuzzyFunction* function(uint32_t uiIndex) const
+		{
+			return uiIndex < m_vFunctions.size() ? m_vFunctions[uiIndex] : NULL;
+		}
+
+		/** Funcin del valor uiIndex (NULL si no tiene) */
+		inline SFuzzyFunction* valueFunction(uint32_t uiIndex) const
+		{
+			return function(TBinOrder::swap32(m_bvValues[uiIndex].Function));
+		}
+		/** Valor mnimo sobre el que se aplica la funcin del valor uiIndex */
+		inline fuzzvar valueMin(uint32_t uiIndex) const
+		{
+			return param(TBinOrder::swap32(m_bvValues[uiIndex].FirstParam));
+		}
+		/** Valor mximo sobre el que se aplica la funcin del valor uiIndex */
+		inline fuzzvar valueMax(uint32_t uiIndex) const
+		{
+			return param(TBinOrder::swap32(m_bvValues[uiIndex].FirstParam) + 1);
+		}
+		void valueParams(uint32_t uiIndex, std::vector<fuzzvar>& vParams) const;
+		/** Definicin compartida del valor uiIndex (ver share()) */
+		inline const SFuzzyDef* definition(uint32_t uiIndex) const { return m_vDefs[uiIndex]; }
+
+		const char* string(uint32_t uiOffset) const;
+		std::string name() const;
+		uint32_t    set(const std::string& strName) const;
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZIMAGE_HPP__ */
+//-----------------------------------------------------------------------------
@@ -0,0 +1,500 @@
+/**
+ * \file fzlog.cpp
+ *
+ *  Execution log. Binary records of the inputs, rule strengths and outputs of
+ *  each TFuzzyExec::calculate(), written to disk by a background thread.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzlog.hpp"
+#include "fztrace.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] osOut   Destino
+ * \param [in] uiValue Valor
+ * \param [in] iBytes  Bytes a escribir (4 u 8)
+ *
+ * Escribe uiValue en little-endian.
+ */
+static void fileWrite(std::ostream& osOut, uint64_t uiValue, int iBytes)
+{
+	char c_data[8];
+
+	for(int i = 0; i < iBytes; ++i, uiValue >>= 8)
+		c_data[i] = char(uiValue & 0xFF);
+	osOut.write(c_data, iBytes);
+}
+//-----------------------------------------------------------------------------
+
+/** Lee un uint32_t en little-endian */
+static uint32_t get32(const uint8_t* uiData)
+{
+	return uint32_t(uiData[0]) | (uint32_t(uiData[1]) << 8)
+		 | (uint32_t(uiData[2]) << 16) | (uint32_t(uiData[3]) << 24);
+}
+//-----------------------------------------------------------------------------
+
+/** Lee un uint64_t en little-endian */
+static uint64_t get64(const uint8_t* uiData)
+{
+	return uint64_t(get32(uiData)) | (uint64_t(get32(uiData + 4)) << 32);
+}
+//-----------------------------------------------------------------------------
+
+/** Representacin de un fuzzvar en el archivo (los bits del float) */
+static uint32_t valueBits(fuzzvar fvValue)
+{
+	float    f_value = float(fvValue);
+	uint32_t ui_bits;
+
+	memcpy(&ui_bits, &f_value, sizeof(ui_bits));
+	return ui_bits;
+}
+//-----------------------------------------------------------------------------
+
+/** fuzzvar a partir de su representacin en el archivo */
+static fuzzvar bitsValue(uint32_t uiBits)
+{
+	float f_value;
+
+	memcpy(&f_value, &uiBits, sizeof(f_value));
+	return fuzzvar(f_value);
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyLog::TFuzzyLog() : m_uiMask(0), m_uiHead(0), m_uiTail(0), m_uiDropped(0), m_uiNoted(0),
+						 m_uiRecords(0), m_uiSequence(0), m_bStop(false)
+{
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyLog::~TFuzzyLog()
+{
+	close();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de destino (se sobrescribe)
+ * \param [in] szBytes Tamao del buffer. Se redondea a la siguiente potencia
+ *                     de 2.
+ *
+ * Abre el archivo, escribe su cabecera y arranca el hilo que vaca el
+ * buffer. Si el registro ya estaba abierto no hace nada.
+ *
+ * \return true si el registro est abierto.
+ */
+bool TFuzzyLog::open(const std::string& strFile, size_t szBytes)
+{
+	if(isOpen())
+		return true;
+
+	m_osFile.open(strFile.c_str(), std::ios::trunc | std::ios::out | std::ios::binary);
+	if(!m_osFile.is_open())
+		return false;
+
+	size_t sz_size = 64;
+	while(sz_size < szBytes)
+		sz_size <<= 1;
+
+	m_vBuffer.assign(sz_size, 0);
+	m_uiMask = sz_size - 1;
+	m_uiHead.store(0, std::memory_order_relaxed);
+	m_uiTail.store(0, std::memory_order_relaxed);
+	m_uiDropped.store(0, std::memory_order_relaxed);
+	m_uiRecords.store(0, std::memory_order_relaxed);
+	m_uiNoted    = 0;
+	m_uiSequence = 0;
+	m_bStop      = false;
+	m_mNames.clear();
+
+	m_osFile.write(FL_LOG_MAGIC, 4);
+	fileWrite(m_osFile, FL_LOG_VERSION, 4);
+	m_osFile.flush();
+
+	m_thWriter = std::thread(&TFuzzyLog::run, this);
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Para el hilo de fondo despus de vaciar el buffer y cierra el archivo.
+ *
+ * \return true si todo lo anotado se ha escrito correctamente.
+ */
+bool TFuzzyLog::close()
+{
+	if(!isOpen())
+		return true;
+
+	{
+		std::lock_guard<std::mutex> lg_lock(m_mtWait);
+		m_bStop = true;
+	}
+	m_cvWait.notify_one();
+	m_thWriter.join();
+
+	m_osFile.close();
+
+	return !m_osFile.fail();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  uiBytes Tamao del registro
+ * \param [out] uiPos   Posicin del registro en el buffer
+ *
+ * \return false si el registro no cabe en el espacio libre del buffer.
+ */
+bool TFuzzyLog::reserve(uint64_t uiBytes, uint64_t& uiPos)
+{
+	uint64_t ui_head = m_uiHead.load(std::memory_order_relaxed);
+	uint64_t ui_tail = m_uiTail.load(std::memory_order_acquire);
+
+	if(uiBytes > m_vBuffer.size() - (ui_head - ui_tail))
+		return false;
+
+	uiPos = ui_head;
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiPos Nueva cabeza del buffer (el final del ltimo registro)
+ *
+ * Hace visible el registro al hilo de fondo y lo despierta si el buffer ha
+ * pasado de la mitad.
+ */
+void TFuzzyLog::publish(uint64_t uiPos)
+{
+	uint64_t ui_half = m_vBuffer.size() / 2;
+	uint64_t ui_tail = m_uiTail.load(std::memory_order_relaxed);
+	uint64_t ui_head = m_uiHead.load(std::memory_order_relaxed);
+
+	m_uiHead.store(uiPos, std::memory_order_release);
+	if(ui_head - ui_tail < ui_half && uiPos - ui_tail >= ui_half)
+		m_cvWait.notify_one();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Escribe en el archivo lo que haya en el buffer y, si se han perdido
+ * clculos desde la ltima vez, un registro lrDropped. Slo lo llama el hilo
+ * de fondo.
+ */
+void TFuzzyLog::drain()
+{
+	uint64_t ui_drop = m_uiDropped.load(std::memory_order_relaxed);
+	uint64_t ui_head = m_uiHead.load(std::memory_order_acquire);
+	uint64_t ui_tail = m_uiTail.load(std::memory_order_relaxed);
+
+	if(ui_head == ui_tail && ui_drop == m_uiNoted)
+		return;
+
+	if(ui_head != ui_tail)
+	{
+		size_t sz_pos   = size_t(ui_tail & m_uiMask);
+		size_t sz_bytes = size_t(ui_head - ui_tail);
+		size_t sz_first = sz_bytes < m_vBuffer.size() - sz_pos ? sz_bytes : m_vBuffer.size() - sz_pos;
+
+		m_osFile.write((const char*)&m_vBuffer[sz_pos], sz_first);
+		if(sz_bytes > sz_first)
+			m_osFile.write((const char*)&m_vBuffer[0], sz_bytes - sz_first);
+		m_uiTail.store(ui_head, std::memory_order_release);
+	}
+
+	if(ui_drop != m_uiNoted)
+	{
+		fileWrite(m_osFile, 16, 4);
+		fileWrite(m_osFile, lrDropped, 4);
+		fileWrite(m_osFile, ui_drop - m_uiNoted, 8);
+		m_uiNoted = ui_drop;
+	}
+
+	m_osFile.flush();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Cuerpo del hilo de fondo: vaca el buffer cada FL_LOG_PERIOD ms (o cuando
+ * el ejecutor lo despierta) hasta que se cierra el registro.
+ */
+void TFuzzyLog::run()
+{
+	std::unique_lock<std::mutex> ul_lock(m_mtWait);
+
+	while(!m_bStop)
+	{
+		ul_lock.unlock();
+		drain();
+		ul_lock.lock();
+		if(!m_bStop)
+			m_cvWait.wait_for(ul_lock, std::chrono::milliseconds(FL_LOG_PERIOD));
+	}
+	ul_lock.unlock();
+
+	drain();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiSet   Conjunto
+ * \param [in] strName Nombre del conjunto
+ *
+ * Anota el nombre de un conjunto si no se haba anotado ya con ese nombre.
+ * Los nombres no se descartan: si el buffer est lleno se espera a que el
+ * hilo de fondo lo vace, por lo que no debe llamarse durante la inferencia
+ * (el ejecutor lo hace al preparar la cadena de ejecucin).
+ */
+void TFuzzyLog::name(uint32_t uiSet, const std::string& strName)
+{
+	std::map<uint32_t, std::string>::iterator found = m_mNames.find(uiSet);
+	uint64_t                                  ui_size = 12 + strName.size();
+	uint64_t                                  ui_pos;
+
+	if(!isOpen() || (found != m_mNames.end() && found->second == strName)
+			|| ui_size > m_vBuffer.size())
+		return;
+
+	while(!reserve(ui_size, ui_pos))
+	{
+		m_cvWait.notify_one();
+		std::this_thread::yield();
+	}
+
+	put32(ui_pos, uint32_t(ui_size));
+	put32(ui_pos, lrName);
+	put32(ui_pos, uiSet);
+	for(size_t i = 0; i < strName.size(); ++i)
+		m_vBuffer[(ui_pos++) & m_uiMask] = uint8_t(strName[i]);
+	publish(ui_pos);
+
+	m_mNames[uiSet] = strName;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] lcCalc Clculo a anotar. Se le asignan su nmero de
+ *                        secuencia y el instante actual.
+ *
+ * \return false si no cabe en el buffer y se ha descartado.
+ */
+bool TFuzzyLog::write(SLogCalculate& lcCalc)
+{
+	size_t   sz_vals = lcCalc.Inputs.size() + lcCalc.Rules.size() + lcCalc.Outputs.size();
+	uint64_t ui_size = 36 + 8 * uint64_t(sz_vals);
+	uint64_t ui_pos;
+
+	lcCalc.Sequence = m_uiSequence++;
+	lcCalc.Time     = TFuzzyTrace::now();
+
+	if(!isOpen())
+		return false;
+	if(!reserve(ui_size, ui_pos))
+	{
+		m_uiDropped.store(m_uiDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	put32(ui_pos, uint32_t(ui_size));
+	put32(ui_pos, lrCalculate);
+	put64(ui_pos, lcCalc.Sequence);
+	put64(ui_pos, lcCalc.Time);
+	put32(ui_pos, uint32_t(lcCalc.Inputs.size()));
+	put32(ui_pos, uint32_t(lcCalc.Rules.size()));
+	put32(ui_pos, uint32_t(lcCalc.Outputs.size()));
+
+	const std::vector<SLogValue>* v_lists[3] = { &lcCalc.Inputs, &lcCalc.Rules, &lcCalc.Outputs };
+	for(int k = 0; k < 3; ++k)
+	{
+		for(size_t i = 0; i < v_lists[k]->size(); ++i)
+		{
+			put32(ui_pos, (*v_lists[k])[i].Id);
+			put32(ui_pos, valueBits((*v_lists[k])[i].Value));
+		}
+	}
+	publish(ui_pos);
+
+	m_uiRecords.store(m_uiRecords.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+
+
+
+
+
+
+
+TFuzzyLogReader::TFuzzyLogReader() : m_uiDropped(0)
+{
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyLogReader::~TFuzzyLogReader()
+{
+	close();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo escrito por TFuzzyLog
+ *
+ * Abre el archivo y comprueba su cabecera.
+ */
+void TFuzzyLogReader::open(const std::string& strFile)
+{
+	uint8_t ui_head[8];
+
+	close();
+	m_mNames.clear();
+	m_uiDropped = 0;
+
+	m_isFile.open(strFile.c_str(), std::ios::in | std::ios::binary);
+	if(!m_isFile.is_open())
+		throw TFuzzyError("open", "No se puede abrir el archivo", __LINE__, __FILE__);
+
+	m_isFile.read((char*)ui_head, sizeof(ui_head));
+	if(!m_isFile.good() || memcmp(ui_head, FL_LOG_MAGIC, 4) != 0)
+		throw TFuzzyError("open", "El archivo no es un registro de ejecucin", __LINE__, __FILE__);
+	if(get32(ui_head + 4) != FL_LOG_VERSION)
+		throw TFuzzyError("open", "Versin del registro no soportada", __LINE__, __FILE__);
+}
+//-----------------------------------------------------------------------------
+
+void TFuzzyLogReader::close()
+{
+	if(m_isFile.is_open())
+		m_isFile.close();
+	m_isFile.clear();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [out] lcCalc Siguiente clculo del archivo
+ *
+ * Lee registros hasta encontrar un clculo. Un registro incompleto al final
+ * del archivo (un programa que no lleg a cerrar el registro) se trata como
+ * el final.
+ *
+ * \return false si no quedan clculos.
+ */
+bool TFuzzyLogReader::next(SLogCalculate& lcCalc)
+{
+	uint8_t ui_head[8];
+
+	while(m_isFile.is_open())
+	{
+		m_isFile.read((char*)ui_head, sizeof(ui_head));
+		if(m_isFile.gcount() != std::streamsize(sizeof(ui_head)))
+			return false;
+
+		uint32_t ui_size = get32(ui_head);
+		uint32_t ui_type = get32(ui_head + 4);
+
+		if(ui_size < sizeof(ui_head) || ui_size > FL_LOG_MAXRECORD)
+			throw TFuzzyError("next", "Registro no vlido", __LINE__, __FILE__);
+
+		size_t sz_body = ui_size - sizeof(ui_head);
+		m_vRecord.resize(sz_body + 1);
+		m_isFile.read((char*)&m_vRecord[0], sz_body);
+		if(m_isFile.gcount() != std::streamsize(sz_body))
+			return false;
+
+		const uint8_t* ui_data = &m_vRecord[0];
+
+		switch(ui_type)
+		{
+		case lrName:
+			if(sz_body < 4)
+				throw TFuzzyError("next", "Registro de nombre no vlido", __LINE__, __FILE__);
+			m_mNames[get32(ui_data)] = std::string((const char*)ui_data + 4, sz_body - 4);
+			break;
+
+		case lrDropped:
+			if(sz_body < 8)
+				throw TFuzzyError("next", "Registro de prdidas no vlido", __LINE__, __FILE__);
+			m_uiDropped += get64(ui_data);
+			break;
+
+		case lrCalculate:
+		{
+			if(sz_body < 28)
+				throw TFuzzyError("next", "Registro de clculo no vlido", __LINE__, __FILE__);
+
+			uint64_t ui_vals[3] = { get32(ui_data + 16), get32(ui_data + 20), get32(ui_data + 24) };
+			if(28 + 8 * (ui_vals[0] + ui_vals[1] + ui_vals[2]) != sz_body)
+				throw TFuzzyError("next", "Registro de clculo no vlido", __LINE__, __FILE__);
+
+			std::vector<SLogValue>* v_lists[3] = { &lcCalc.Inputs, &lcCalc.Rules, &lcCalc.Outputs };
+
+			lcCalc.Sequence = get64(ui_data);
+			lcCalc.Time     = get64(ui_data + 8);
+			ui_data += 28;
+			for(int k = 0; k < 3; ++k)
+			{
+				v_lists[k]->resize(size_t(ui_vals[k]));
+				for(size_t i = 0; i < v_lists[k]->size(); ++i, ui_data += 8)
+					(*v_lists[k])[i] = SLogValue(get32(ui_data), bitsValue(get32(ui_data + 4)));
+			}
+			return true;
+		}
+
+		default:
+			//-- Tipos de registro desconocidos (versiones posteriores): se saltan
+			break;
+		}
+	}
+
+	return false;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiSet Conjunto
+ *
+ * \return El nombre del conjunto o su nmero si no lo tiene.
+ */
+std::string TFuzzyLogReader::name(uint32_t uiSet) const
+{
+	std::map<uint32_t, std::string>::const_iterator found = m_mNames.find(uiSet);
+
+	if(found != m_mNames.end())
+		return found->second;
+
+	char c_num[16];
+	snprintf(c_num, sizeof(c_num), "#%u", uiSet);
+	return c_num;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,230 @@
+/**
+ * \file fzlog.hpp
+ *
+ *  Execution log. Binary records of the inputs, rule strengths and outputs of
+ *  each TFuzzyExec::calculate(), written to disk by a background thread.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZLOG_HPP__
+#define __FZLOG_HPP__
+//-----------------------------------------------------------------------------
+#include "fzbase.hpp"
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+//-----------------------------------------------------------------------------
+/** Identificador de los archivos de registro */
+#define FL_LOG_MAGIC		"YFLG"
+/** Versin del formato de los archivos de registro */
+#define FL_LOG_VERSION		1
+/** Tamao por defecto del buffer de cada ejecutor, en bytes */
+#define FL_LOG_SIZE			(1 << 20)
+/** Milisegundos entre dos vaciados del buffer */
+#define FL_LOG_PERIOD		10
+/** Tamao mximo de un registro al leerlo (protege de archivos daados) */
+#define FL_LOG_MAXRECORD	(1 << 28)
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Tipos de registro del archivo. Cada registro empieza por su tamao en
+	 * bytes (incluida la cabecera) y su tipo, ambos uint32_t:
+	 *
+	 * - lrName: uint32_t conjunto y su nombre (el resto del registro, sin
+	 *   '\0'). Aparece antes del primer registro que usa el conjunto y de
+	 *   nuevo si el nombre cambia (otro modelo u otra imagen).
+	 * - lrCalculate: uint64_t secuencia, uint64_t instante (ns), uint32_t
+	 *   nmero de entradas, reglas y salidas y, a continuacin, las entradas,
+	 *   las reglas y las salidas como pares uint32_t identificador, float
+	 *   valor (ver SLogCalculate).
+	 * - lrDropped: uint64_t nmero de clculos perdidos por tener el buffer
+	 *   lleno desde el anterior registro de este tipo.
+	 *
+	 * Todos los nmeros se guardan en little-endian (ver TBinOrder). El
+	 * archivo empieza por FL_LOG_MAGIC y la versin (uint32_t).
+	 */
+	enum TLogRecord { lrName = 1, lrCalculate, lrDropped };
+	//-------------------------------------------------------------------------
+
+	/** Valor anotado: el de un conjunto o la fuerza de una regla */
+	struct SLogValue
+	{
+		/** Posicin del conjunto (ver TFuzzyExec::index()) o de la regla */
+		uint32_t Id;
+		fuzzvar  Value;
+
+		SLogValue() : Id(0), Value(0.0) {}
+		SLogValue(uint32_t uiId, fuzzvar fvValue) : Id(uiId), Value(fvValue) {}
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Un clculo anotado: el valor de todas las entradas, y la fuerza de cada
+	 * regla evaluada y el resultado de cada conjunto calculado en el orden en
+	 * que se han producido.
+	 */
+	struct SLogCalculate
+	{
+		/** Nmero de clculo del ejecutor (los perdidos dejan huecos) */
+		uint64_t               Sequence;
+		/** Instante del final del clculo, en ns (ver TFuzzyTrace::now()) */
+		uint64_t               Time;
+		std::vector<SLogValue> Inputs;
+		std::vector<SLogValue> Rules;
+		std::vector<SLogValue> Outputs;
+
+		SLogCalculate() : Sequence(0), Time(0) {}
+
+		/** Vaca el clculo sin liberar la memoria de las listas */
+		inline void clear()
+		{
+			Inputs.clear();
+			Rules.clear();
+			Outputs.clear();
+		}
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Registro binario de la ejecucin (TFuzzyExec::logOpen()).
+	 *
+	 * El ejecutor escribe cada clculo en un buffer circular propio, sin
+	 * bloqueos: slo copia bytes y publica la nueva cabeza con una escritura
+	 * atmica. Un hilo de fondo vaca el buffer al archivo cada
+	 * FL_LOG_PERIOD ms (o antes, si se llena hasta la mitad), de manera que
+	 * el hilo de inferencia nunca espera al disco. Si el buffer est lleno el
+	 * clculo se descarta y se cuenta (dropped()).
+	 *
+	 * write() y name() deben llamarse siempre desde el mismo hilo (el del
+	 * ejecutor).
+	 */
+	class TFuzzyLog
+	{
+	private:
+		std::ofstream           m_osFile;
+		std::vector<uint8_t>    m_vBuffer;
+		uint64_t                m_uiMask;
+		/** Bytes escritos en el buffer (slo los modifica el ejecutor) */
+		std::atomic<uint64_t>   m_uiHead;
+		/** Bytes vaciados al archivo (slo los modifica el hilo de fondo) */
+		std::atomic<uint64_t>   m_uiTail;
+		/** Clculos descartados y cuntos de ellos se han anotado ya */
+		std::atomic<uint64_t>   m_uiDropped;
+		uint64_t                m_uiNoted;
+		/** Clculos escritos en el buffer */
+		std::atomic<uint64_t>   m_uiRecords;
+		uint64_t                m_uiSequence;
+		/** Nombres ya anotados */
+		std::map<uint32_t, std::string> m_mNames;
+
+		std::thread             m_thWriter;
+		std::mutex              m_mtWait;
+		std::condition_variable m_cvWait;
+		bool                    m_bStop;
+
+		/** Copia uiValue en little-endian en la posicin uiPos del buffer */
+		inline void put32(uint64_t& uiPos, uint32_t uiValue)
+		{
+			for(int i = 0; i < 4; ++i, uiValue >>= 8)
+				m_vBuffer[(uiPos++) & m_uiMask] = uint8_t(uiValue);
+		}
+		inline void put64(uint64_t& uiPos, uint64_t uiValue)
+		{
+			put32(uiPos, uint32_t(uiValue));
+			put32(uiPos, uint32_t(uiValue >> 32));
+		}
+
+		bool reserve(uint64_t uiBytes, uint64_t& uiPos);
+		void publish(uint64_t uiPos);
+		void drain();
+		void run();
+
+		TFuzzyLog(const TFuzzyLog&);
+		TFuzzyLog& operator=(const TFuzzyLog&);
+
+	public:
+		TFuzzyLog();
+		virtual ~TFuzzyLog();
+
+		/** Indica si el registro est abierto */
+		inline bool     isOpen()  const { return m_osFile.is_open(); }
+		/** Clculos escritos en el buffer */
+		inline uint64_t records() const { return m_uiRecords.load(std::memory_order_relaxed); }
+		/** Clculos descartados por tener el buffer lleno */
+		inline uint64_t dropped() const { return m_uiDropped.load(std::memory_order_relaxed); }
+
+		bool open(const std::string& strFile, size_t szBytes = FL_LOG_SIZE);
+		bool close();
+
+		void name(uint32_t uiSet, const std::string& strName);
+		bool write(SLogCalculate& lcCalc);
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Lectura de los archivos de TFuzzyLog. Los registros de nombres y de
+	 * clculos perdidos se procesan al leer, por lo que next() slo devuelve
+	 * clculos.
+	 */
+	class TFuzzyLogReader
+	{
+	private:
+		std::ifstream                   m_isFile;
+		std::map<uint32_t, std::string> m_mNames;
+		uint64_t                        m_uiDropped;
+		std::vector<uint8_t>            m_vRecord;
+
+		TFuzzyLogReader(const TFuzzyLogReader&);
+		TFuzzyLogReader& operator=(const TFuzzyLogReader&);
+
+	public:
+		TFuzzyLogReader();
+		virtual ~TFuzzyLogReader();
+
+		/** Nombres de los conjuntos ledos hasta ahora */
+		inline const std::map<uint32_t, std::string>& names() const { return m_mNames; }
+		/** Clculos perdidos anotados hasta ahora */
+		inline uint64_t dropped() const { return m_uiDropped; }
+
+		void        open(const std::string& strFile);
+		void        close();
+		bool        next(SLogCalculate& lcCalc);
+		std::string name(uint32_t uiSet) const;
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZLOG_HPP__ */
+//-----------------------------------------------------------------------------
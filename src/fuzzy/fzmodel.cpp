@@ -30,15 +30,18 @@
  */
 //-----------------------------------------------------------------------------
 #include "fzmodel.hpp"
+#include "fzbinary.hpp"
 #include "ini_file.hpp"
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
-#ifdef __BORLANDC__
-#include <stdio.h>
-#else
-#include <cstdio>
-#endif
+#include <thread>
+#include <atomic>
+#include <cctype>
 //-----------------------------------------------------------------------------
 using namespace nsFuzzy;
 //-----------------------------------------------------------------------------
@@ -47,11 +50,44 @@ using namespace nsFuzzy;
 #define FL_SCRIPT_RULES     "rules"
 //-----------------------------------------------------------------------------
 
+/**
+ * Estado de la carga perezosa de un modelo (TFuzzyModel::loadFromFile()).
+ * Guarda el archivo ya ledo, que contiene el texto de las partes del modelo
+ * an no creadas, y las indexa por el smbolo del conjunto que las necesita.
+ */
+typedef std::pair<unsigned int, nsIniFile::TParam*> lazyrule;
+//-----------------------------------------------------------------------------
+
+struct nsFuzzy::SLazyLoad
+{
+	/** Archivo del modelo */
+	nsIniFile::TIniFile File;
+	/** Conjuntos an no creados (parmetro de la seccin [sets]) */
+	std::unordered_map<fzsymbol, nsIniFile::TParam*> Sets;
+	/** Reglas an no creadas (su posicin en la seccin [rules] y su
+	 * parmetro), por el conjunto de su consecuente y en el orden del archivo */
+	std::unordered_map<fzsymbol, std::vector<lazyrule> > Rules;
+	/** Posicin en la seccin [rules] de cada regla ya creada, en el orden
+	 * de TFuzzyModel::rules() */
+	std::vector<unsigned int> Source;
+};
+//-----------------------------------------------------------------------------
+
+/** Ordena posiciones de TFuzzyRules por la posicin de la regla en el archivo */
+struct SSourceLess
+{
+	const std::vector<unsigned int>* Source;
+
+	inline bool operator()(size_t szA, size_t szB) const { return (*Source)[szA] < (*Source)[szB]; }
+};
+//-----------------------------------------------------------------------------
+
 /**
  *
  */
 TFuzzyModel::TFuzzyModel() : TFuzzyBase(FL_ID_MODS), m_frRules(m_fsSets)
 {
+	m_llLazy           = NULL;
 	m_fsSets.parent()  = this;
 	m_frRules.parent() = this;
 }
@@ -198,105 +234,422 @@ std::string& TFuzzyModel::configurationHint(std::string& strHint)
  */
 void TFuzzyModel::clear()
 {
+	delete m_llLazy;
+	m_llLazy = NULL;
 	m_frRules.clear();
 	m_fsSets.clear();
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] cPrefix Prefijo del nombre
+ * \param [in] szIndex ndice a aadir tras el prefijo
+ * \param [in] iWidth  Nmero mnimo de dgitos del ndice (se rellena con 0)
+ *
+ * Construye los nombres de los parmetros numerados del archivo de modelo
+ * (param_0000, rule_001...), sin lmite en el nmero de dgitos.
  *
+ * \return El nombre compuesto.
  */
-void TFuzzyModel::loadFromFile(std::string strFileName)
+std::string TFuzzyModel::indexedName(const char* cPrefix, size_t szIndex, int iWidth)
 {
-	clear();
+	std::string str_num;
 
-	nsIniFile::TIniFile  file;
-	nsIniFile::TSection* section = NULL;
+	do
+	{
+		str_num.insert(str_num.begin(), char('0' + szIndex % 10));
+		szIndex /= 10;
+	} while(szIndex > 0);
+	if(int(str_num.size()) < iWidth)
+		str_num.insert(0, iWidth - str_num.size(), '0');
+
+	return std::string(cPrefix) + str_num;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fvValue Nmero a convertir
+ *
+ * Escribe el nmero con el menor nmero de cifras significativas que permite
+ * recuperarlo exactamente al leerlo, de manera que guardar y volver a cargar
+ * un modelo no altera sus valores y el archivo sigue siendo legible.
+ *
+ * \return El nmero en formato texto.
+ */
+std::string TFuzzyModel::numberText(fuzzvar fvValue)
+{
+	std::stringstream ss_aux;
+	fuzzvar           fv_read;
+
+	for(int i = 6; i < 9; ++i)
+	{
+		ss_aux.str("");
+		ss_aux.clear();
+		ss_aux << std::setprecision(i) << fvValue;
+		ss_aux >> fv_read;
+		if(fv_read == fvValue)
+			return ss_aux.str();
+	}
+
+	ss_aux.str("");
+	ss_aux.clear();
+	ss_aux << std::setprecision(9) << fvValue;
+
+	return ss_aux.str();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  strRule Texto de la regla
+ * \param [out] vSets   Smbolos de los conjuntos de cada tomo de la regla.
+ *                      El ltimo es el del consecuente
+ *
+ * Obtiene los conjuntos que usa una regla sin analizarla por completo: los
+ * tomos estn separados por " and " y " then " tras el "if " inicial, y el
+ * conjunto es lo que precede al primer punto de cada tomo. Los errores de
+ * sintaxis se dejan para TFuzzyRules::add(), que es quien analiza la regla.
+ */
+static void ruleSets(std::string strRule, std::vector<fzsymbol>& vSets)
+{
+	size_t pos = 0;
+	size_t end;
+
+	vSets.clear();
+	for(size_t i = 0; i < strRule.size(); ++i)
+		strRule[i] = char(tolower((unsigned char)strRule[i]));
+	if((pos = strRule.find("if ")) == std::string::npos)
+		return;
+
+	for(pos += 3; pos < strRule.size(); pos = end + 1)
+	{
+		end = std::min(strRule.find(" and ", pos), strRule.find(" then ", pos));
+		if(end == std::string::npos)
+			end = strRule.size();
+
+		size_t dot = strRule.find('.', pos);
+		if(dot != std::string::npos && dot < end)
+			vSets.push_back(TFuzzySymbols::intern(strRule.data() + pos, dot - pos));
+
+		//-- Salta el separador (" and " o " then ")
+		if(end < strRule.size())
+			end = strRule.find(' ', end + 1);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] file  Archivo del modelo
+ * \param [in] prSet Parmetro del conjunto en la seccin [sets]
+ *
+ * Crea un conjunto y sus valores. Los lmites y parmetros de cada valor se
+ * leen de la seccin [<set>_<valor>] a medida que se crea, y el valor se
+ * define de una vez con su funcin (TFuzzyVal::define()) cuando ya se
+ * conocen los lmites sobre los que se calcula su mximo.
+ */
+void TFuzzyModel::loadSet(nsIniFile::TIniFile& file, nsIniFile::TParam* prSet)
+{
+	nsIniFile::TSection* sc_set  = NULL;
+	nsIniFile::TSection* sc_val  = NULL;
 	nsIniFile::TParam*   param   = NULL;
-	fzhndl               fh_val  = FL_INVALID_HANDLE;
-	std::stringstream    ss_aux;
+	nsIniFile::TParam*   pr_val  = NULL;
+	TFuzzySet*           fs_set  = NULL;
+	TFuzzyVal*           fv_val  = NULL;
 	std::string          str_aux;
-	char                 c_aux[512];
 	fuzzvar              fv_aux;
+	std::vector<fuzzvar> v_params;
 
-	file.loadFile(strFileName);
+	fs_set = &m_fsSets[m_fsSets.add(prSet->name())];
 
-	//-- Recuperamos el nombre del modelo
-	section = file[FL_SCRIPT_MODEL];
-	param   = (*section)["name"];
-	name(param->value().str());
-	//-- Se crean los sets
-	section = file[FL_SCRIPT_SETS];
-	for(int i = 0; i < int(section->size()); ++i)
+	sc_set = file[prSet->name()];
+	if(!sc_set)
+		throw TFuzzyError("loadFile", "No existe la seccin",
+				__LINE__, __FILE__);
+	for(unsigned int j = 0; j < sc_set->size(); ++j)
 	{
-		param = (*section)[i];
-		m_fsSets.add(param->name());
-	}
+		pr_val = (*sc_set)[j];
+		fv_val = &(*fs_set)[fs_set->add(pr_val->name())];
+		if(*fv_val == invalidObject())
+			throw TFuzzyError("loadFile",
+					"No se ha creado el valor para el set",
+					__LINE__, __FILE__);
 
-	//-- Para cada set, creamos los valores
-	for(int i = 0; i < int(m_fsSets.size()); ++i)
-	{
-		section = file[m_fsSets[i].name()];
-		if(!section)
-			throw TFuzzyError("loadFile", "No existe la seccin",
+		//-- Particularidades del valor
+		str_aux = prSet->name() + "_" + pr_val->name();
+		sc_val  = file[str_aux];
+		if(!sc_val)
+			throw TFuzzyError("loadFile", "No se encuentra la seccin",
+					__LINE__, __FILE__);
+
+		param = (*sc_val)["min"];
+		if(!param)
+			throw TFuzzyError("loadFile", "No se encuentra el parametro 'min'",
+					__LINE__, __FILE__);
+		param->number(fv_aux);
+		v_params.assign(1, fv_aux);
+
+		param = (*sc_val)["max"];
+		if(!param)
+			throw TFuzzyError("loadFile", "No se encuentra el parametro 'max'",
 					__LINE__, __FILE__);
-		for(int j = 0; j < int(section->size()); ++j)
+		param->number(fv_aux);
+		v_params.push_back(fv_aux);
+
+		param = (*sc_val)["count"];
+		if(!param)
+			throw TFuzzyError("loadFile", "No se encuentra el parametro 'count'",
+					__LINE__, __FILE__);
+		param->number(fv_aux);
+		v_params.resize(size_t(fv_aux) + 2, 0.0);
+
+		for(size_t k = 2; k < v_params.size(); ++k)
 		{
-			param = (*section)[j];
-			fh_val = m_fsSets[i].add(param->name());
-			if(FL_INVALID_HANDLE == fh_val)
-				throw TFuzzyError("loadFile",
-						"No se ha creado el valor para el set",
+			param = (*sc_val)[indexedName("param_", k - 2, 4)];
+			if(!param)
+				throw TFuzzyError("loadFile", "No se encuentra un parametro de la funcin",
 						__LINE__, __FILE__);
-			m_fsSets[i][fh_val].setFunction(param->value().str());
+			param->number(v_params[k]);
 		}
+
+		//-- Los valores definidos igual comparten una nica definicin
+		if(FL_INVALID_HANDLE == fv_val->define(pr_val->text(), v_params))
+			throw TFuzzyError("loadFile", "No existe la funcin del valor",
+					__LINE__, __FILE__);
 	}
+}
+//-----------------------------------------------------------------------------
 
-	//-- Ahora asignamos las particularidades de cada valor en cada set
-	for(int i = 0; i < int(m_fsSets.size()); ++i)
+/**
+ * \param [in] fsSet Smbolo del conjunto
+ *
+ * En la carga perezosa, crea el conjunto fsSet si an no se ha creado. No
+ * crea sus reglas.
+ */
+void TFuzzyModel::lazySet(fzsymbol fsSet)
+{
+	std::unordered_map<fzsymbol, nsIniFile::TParam*>::iterator found = m_llLazy->Sets.find(fsSet);
+
+	if(found != m_llLazy->Sets.end())
 	{
-		for(int j = 0; j < int(m_fsSets[i].size()); ++j)
+		nsIniFile::TParam* pr_set = found->second;
+
+		m_llLazy->Sets.erase(found);
+		loadSet(m_llLazy->File, pr_set);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] vRules Reglas a crear: su posicin en la seccin [rules] y
+ * su parmetro (se ordenan por la posicin)
+ *
+ * En la carga perezosa, crea las reglas indicadas, cuyos conjuntos ya deben
+ * existir, y las coloca entre las ya creadas segn su posicin en el archivo
+ * (lazyOrder()).
+ */
+void TFuzzyModel::lazyRules(std::vector<lazyrule>& vRules)
+{
+	std::sort(vRules.begin(), vRules.end());
+	try
+	{
+		for(size_t i = 0; i < vRules.size(); ++i)
 		{
-			sprintf(c_aux, "%s_%s", m_fsSets[i].name().c_str(), m_fsSets[i][j].name().c_str());
-			str_aux = c_aux;
+			if(m_frRules.add(vRules[i].second->text()))
+				m_llLazy->Source.push_back(vRules[i].first);
+		}
+	}
+	catch(TFuzzyError&)
+	{
+		lazyOrder();
+		throw;
+	}
+	lazyOrder();
+}
+//-----------------------------------------------------------------------------
 
-			section = file[str_aux];
-			if(!section)
-				throw TFuzzyError("loadFile", "No se encuentra la seccin",
-						__LINE__, __FILE__);
+/**
+ * Las reglas se crean en el orden en que se piden los conjuntos, pero deben
+ * quedar en el mismo orden que en la carga completa, que es el del archivo:
+ * de l dependen las posiciones que usan las estadsticas, el registro de
+ * ejecucin y saveToFile(). Las reglas iguales tienen el mismo consecuente,
+ * por lo que se crean a la vez y se descartan las mismas que en la carga
+ * completa.
+ *
+ * Si se han modificado las reglas fuera de la carga perezosa, su orden ya no
+ * se corresponde con el del archivo y no se toca.
+ */
+void TFuzzyModel::lazyOrder()
+{
+	std::vector<unsigned int>& v_source = m_llLazy->Source;
 
-			param = (*section)["min"];
-			if(!param)
-				throw TFuzzyError("loadFile", "No se encuentra el parametro 'min'",
-						__LINE__, __FILE__);
-			param->value() >> fv_aux;
-			m_fsSets[i][j].min(fv_aux);
+	if(v_source.size() != m_frRules.size() || std::is_sorted(v_source.begin(), v_source.end()))
+		return;
 
-			param = (*section)["max"];
-			if(!param)
-				throw TFuzzyError("loadFile", "No se encuentra el parametro 'max'",
-						__LINE__, __FILE__);
-			param->value() >> fv_aux;
-			m_fsSets[i][j].max(fv_aux);
+	std::vector<size_t> v_order(v_source.size());
+	SSourceLess         sl_less = { &v_source };
 
-			param = (*section)["count"];
-			if(!param)
-				throw TFuzzyError("loadFile", "No se encuentra el parametro 'count'",
-						__LINE__, __FILE__);
-			param->value() >> fv_aux;
-			m_fsSets[i][j].size(size_t(fv_aux));
+	for(size_t i = 0; i < v_order.size(); ++i)
+		v_order[i] = i;
+	std::sort(v_order.begin(), v_order.end(), sl_less);
+
+	m_frRules.reorder(v_order);
+	std::sort(v_source.begin(), v_source.end());
+}
+//-----------------------------------------------------------------------------
 
-			if(m_fsSets[i][j].size() > 0)
+/**
+ * \param [in] strSet Nombre del conjunto
+ *
+ * En un modelo cargado de forma perezosa, crea el conjunto strSet y todo lo
+ * necesario para calcularlo: las reglas cuyo consecuente es uno de sus
+ * valores y, de forma transitiva, los conjuntos y reglas de los que stas
+ * dependen. Cuando ya no queda nada por crear se libera el archivo.
+ *
+ * En un modelo completo no hace nada.
+ *
+ * \return true si el conjunto existe en el modelo.
+ * \sa loadFromFile(), lazy(), TFuzzyExec::require()
+ */
+bool TFuzzyModel::require(const std::string& strSet)
+{
+	std::vector<fzsymbol> v_pending(1, TFuzzySymbols::find(strSet));
+	std::vector<fzsymbol> v_sets;
+	std::vector<lazyrule> v_create;
+
+	if(!m_llLazy)
+		return m_fsSets.bySymbol(v_pending[0]) != NULL;
+
+	lazySet(v_pending[0]);
+	if(!m_fsSets.bySymbol(v_pending[0]))
+		return false;
+
+	//-- Cada conjunto pendiente trae sus reglas, y stas los conjuntos que
+	//   usan. Las reglas de un conjunto se retiran todas a la vez del ndice,
+	//   por lo que los ciclos entre conjuntos no son un problema. Las reglas
+	//   se crean al final, con todos sus conjuntos ya creados
+	while(!v_pending.empty())
+	{
+		std::unordered_map<fzsymbol, std::vector<lazyrule> >::iterator found
+				= m_llLazy->Rules.find(v_pending.back());
+		std::vector<lazyrule> v_rules;
+
+		v_pending.pop_back();
+		if(found == m_llLazy->Rules.end())
+			continue;
+		v_rules.swap(found->second);
+		m_llLazy->Rules.erase(found);
+
+		for(size_t i = 0; i < v_rules.size(); ++i)
+		{
+			ruleSets(v_rules[i].second->text(), v_sets);
+			for(size_t j = 0; j < v_sets.size(); ++j)
 			{
-				char c_par[10];
-				for(size_t k = 0; k < m_fsSets[i][j].size(); ++k)
-				{
-					sprintf(c_par, "param_%04u", k);
-					param = (*section)[c_par];
-					param->value() >> m_fsSets[i][j][k];
-				}
+				lazySet(v_sets[j]);
+				if(m_llLazy->Rules.find(v_sets[j]) != m_llLazy->Rules.end())
+					v_pending.push_back(v_sets[j]);
 			}
 		}
+		v_create.insert(v_create.end(), v_rules.begin(), v_rules.end());
+	}
+	lazyRules(v_create);
+
+	if(m_llLazy->Sets.empty() && m_llLazy->Rules.empty())
+	{
+		delete m_llLazy;
+		m_llLazy = NULL;
+	}
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Crea todo lo que queda pendiente de un modelo cargado de forma perezosa:
+ * primero los conjuntos y despus las reglas, en el orden del archivo.
+ *
+ * \sa require(const std::string&)
+ */
+void TFuzzyModel::require()
+{
+	nsIniFile::TSection*  section = NULL;
+	std::vector<lazyrule> v_create;
+
+	if(!m_llLazy)
+		return;
+
+	section = m_llLazy->File[FL_SCRIPT_SETS];
+	for(unsigned int i = 0; i < section->size(); ++i)
+		lazySet(TFuzzySymbols::find((*section)[i]->name()));
+
+	std::unordered_map<fzsymbol, std::vector<lazyrule> >::iterator iter = m_llLazy->Rules.begin();
+	while(iter != m_llLazy->Rules.end())
+	{
+		v_create.insert(v_create.end(), iter->second.begin(), iter->second.end());
+		++iter;
+	}
+	m_llLazy->Rules.clear();
+	lazyRules(v_create);
+
+	delete m_llLazy;
+	m_llLazy = NULL;
+}
+//-----------------------------------------------------------------------------
+/**
+ * \param [in] strFileName Archivo del modelo
+ * \param [in] bLazy       Carga perezosa
+ * \param [in] uiThreads   Nmero de hilos para analizar las reglas (0: uno
+ *                         por ncleo)
+ *
+ * Carga el modelo en una sola pasada: para cada conjunto de la seccin [sets]
+ * se crean sus valores (loadSet()) y despus se analizan las reglas, en
+ * paralelo (TFuzzyRules::addMany()). Cada
+ * seccin y cada parmetro se busca una nica vez, por lo que el tiempo de
+ * carga crece de forma lineal con el tamao del modelo.
+ *
+ * En la carga perezosa slo se lee el archivo y se indexan los conjuntos por
+ * nombre y las reglas por el conjunto de su consecuente. Los conjuntos, sus
+ * valores y las reglas se crean cuando se piden con require() (lo que hace
+ * TFuzzyExec con los conjuntos que se le piden), de manera que el tiempo de
+ * carga y la memoria dependen slo de la parte del modelo que se usa. El
+ * archivo se mantiene en memoria mientras quede algo por crear.
+ *
+ * \sa require(), lazy()
+ */
+void TFuzzyModel::loadFromFile(std::string strFileName, bool bLazy, unsigned int uiThreads)
+{
+	clear();
+
+	nsIniFile::TIniFile       fl_file;
+	nsIniFile::TSection*      section = NULL;
+	nsIniFile::TParam*        param   = NULL;
+	std::vector<fzsymbol>     v_sets;
+	std::vector<std::string>  v_rules;
+	std::vector<lazyrule>     v_now;
+
+	if(bLazy)
+		m_llLazy = new SLazyLoad;
+	nsIniFile::TIniFile& file = m_llLazy ? m_llLazy->File : fl_file;
+
+	file.loadFile(strFileName);
+
+	//-- Recuperamos el nombre del modelo
+	section = file[FL_SCRIPT_MODEL];
+	if(!section || !(param = (*section)["name"]))
+		throw TFuzzyError("loadFile", "No se encuentra el nombre del modelo",
+				__LINE__, __FILE__);
+	name(param->text());
+	m_strDescription = section->comment();
+
+	//-- Se crean los sets y, para cada uno, sus valores
+	section = file[FL_SCRIPT_SETS];
+	if(!section)
+		throw TFuzzyError("loadFile", "No se encuentra la seccin de sets",
+				__LINE__, __FILE__);
+	for(unsigned int i = 0; i < section->size(); ++i)
+	{
+		if(m_llLazy)
+			m_llLazy->Sets[TFuzzySymbols::intern((*section)[i]->name())] = (*section)[i];
+		else
+			loadSet(file, (*section)[i]);
 	}
 
 	//-- Finalmente se cargan las reglas
@@ -305,12 +658,29 @@ void TFuzzyModel::loadFromFile(std::string strFileName)
 		throw TFuzzyError("loadFile", "No se encuentran reglas para este modelo",
 				__LINE__, __FILE__);
 
-	for(size_t i = 0; i < section->size(); ++i)
+	for(unsigned int i = 0; i < section->size(); ++i)
 	{
-		m_frRules.add((*section)[i]->value().str());
+		param = (*section)[i];
+		if(m_llLazy)
+		{
+			//-- Una regla sin consecuente se analiza ya, para que d el mismo
+			//   error que en la carga completa
+			ruleSets(param->text(), v_sets);
+			if(!v_sets.empty())
+				m_llLazy->Rules[v_sets.back()].push_back(lazyrule(i, param));
+			else
+				v_now.push_back(lazyrule(i, param));
+			continue;
+		}
+		v_rules.push_back(param->text());
 	}
+	if(m_llLazy)
+		lazyRules(v_now);
+	else
+		m_frRules.addMany(v_rules, uiThreads);
 
-	file.close();
+	if(!m_llLazy)
+		file.close();
 }
 //-----------------------------------------------------------------------------
 
@@ -319,9 +689,9 @@ void TFuzzyModel::loadFromFile(std::string strFileName)
  */
 void TFuzzyModel::saveToFile(std::string strFileName, bool bAddComments)
 {
-	char                 c_aux[32];
+	require();
+
 	std::string          str_aux;
-	std::stringstream    ss_aux;
 	nsIniFile::TIniFile  file;
 	nsIniFile::TSection* section = NULL;
 	nsIniFile::TParam*   param   = NULL;
@@ -334,7 +704,7 @@ void TFuzzyModel::saveToFile(std::string strFileName, bool bAddComments)
 	if(bAddComments)
 		section->comment() = m_strDescription;
 	param   = section->add("name");
-	param->value() << m_strName;
+	param->value() << name();
 
 	//-- Se guarda la lista de sets
 	section = file.add(FL_SCRIPT_SETS);
@@ -369,11 +739,11 @@ void TFuzzyModel::saveToFile(std::string strFileName, bool bAddComments)
 			if(bAddComments)
 				section->comment() = "Definicin del valor " + m_fsSets[i].name() + "." + m_fsSets[i][j].name();
 			param   = section->add("min");
-			param->value() << m_fsSets[i][j].min();
+			param->value() << numberText(m_fsSets[i][j].min());
 			if(bAddComments)
 				param->comment() = "Valor mnimo que toma";
 			param   = section->add("max");
-			param->value() << m_fsSets[i][j].max();
+			param->value() << numberText(m_fsSets[i][j].max());
 			if(bAddComments)
 				param->comment() = "Valor mximo que toma";
 			param   = section->add("count");
@@ -381,15 +751,10 @@ void TFuzzyModel::saveToFile(std::string strFileName, bool bAddComments)
 			if(bAddComments)
 				param->comment() = "Nmero de parmetros que necesita la funcin";
 
-			if(m_fsSets[i][j].size() > 0)
+			for(size_t k = 0; k < m_fsSets[i][j].size(); ++k)
 			{
-				char c_par[11];
-				for(size_t k = 0; k < m_fsSets[i][j].size(); ++k)
-				{
-					sprintf(c_par, "param_%04u", k);
-					param = section->add(c_par);
-					param->value() << m_fsSets[i][j][k];
-				}
+				param = section->add(indexedName("param_", k, 4));
+				param->value() << numberText(m_fsSets[i][j].param(int(k)));
 			}
 		}
 	}
@@ -400,10 +765,8 @@ void TFuzzyModel::saveToFile(std::string strFileName, bool bAddComments)
 		section->comment() = "Establece la relacin que hay entre los diferentes conjuntos del modelo";
 	for(size_t i = 0; i < m_frRules.size(); ++i)
 	{
-		sprintf(c_aux, "rule_%03u", i + 1);
-
-		param = section->add(c_aux);
-		param->value() << m_frRules[i].String;
+		param = section->add(indexedName("rule_", i + 1, 3));
+		param->value() << m_frRules.text(i);
 	}
 
 	file.saveFile(strFileName);
@@ -411,9 +774,717 @@ void TFuzzyModel::saveToFile(std::string strFileName, bool bAddComments)
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in,out] strTable Tabla de cadenas
+ * \param [in,out] mNames   Posicin de los nombres ya aadidos a la tabla
+ * \param [in]     fsName   Smbolo del nombre a aadir
+ *
+ * Aade un nombre a la tabla de cadenas del formato binario, una nica vez.
+ *
+ * \return Desplazamiento del nombre dentro de la tabla.
+ */
+static uint32_t binName(std::string& strTable, std::unordered_map<fzsymbol, uint32_t>& mNames,
+		fzsymbol fsName)
+{
+	std::unordered_map<fzsymbol, uint32_t>::iterator found = mNames.find(fsName);
+	if(found != mNames.end())
+		return found->second;
+
+	const std::string& str_name = TFuzzySymbols::name(fsName);
+	uint32_t           ui_off   = 0;
 
+	if(!str_name.empty())
+	{
+		ui_off = uint32_t(strTable.size());
+		strTable.append(str_name.c_str(), str_name.size() + 1);
+	}
+	mNames[fsName] = ui_off;
+
+	return ui_off;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] strFile  Contenido del archivo binario
+ * \param [out]    btTable  Entrada de la cabecera que describe la tabla
+ * \param [in]     pData    Registros de la tabla
+ * \param [in]     szCount  Nmero de registros
+ * \param [in]     szRecord Tamao de cada registro
+ *
+ * Aade una tabla al final del archivo, alineada a FL_BIN_ALIGN bytes.
+ */
+static void binPut(std::string& strFile, SBinTable& btTable, const void* pData,
+		size_t szCount, size_t szRecord)
+{
+	while(strFile.size() % FL_BIN_ALIGN)
+		strFile.push_back('\0');
+	btTable.Offset = TBinOrder::swap32(uint32_t(strFile.size()));
+	btTable.Count  = TBinOrder::swap32(uint32_t(szCount));
+	if(szCount)
+		strFile.append((const char*)pData, szCount * szRecord);
+}
+//-----------------------------------------------------------------------------
 
+/**
+ * \param [in]  cData    Contenido del archivo binario
+ * \param [in]  uiSize   Tamao del archivo
+ * \param [in]  btTable  Entrada de la cabecera que describe la tabla
+ * \param [in]  szRecord Tamao de cada registro
+ * \param [out] uiCount  Nmero de registros de la tabla
+ *
+ * Comprueba que la tabla est alineada y completamente dentro del archivo.
+ *
+ * \return Puntero al primer registro de la tabla.
+ */
+static const char* binTable(const char* cData, uint64_t uiSize, const SBinTable& btTable,
+		size_t szRecord, uint32_t& uiCount)
+{
+	uint32_t ui_off = TBinOrder::swap32(btTable.Offset);
 
+	uiCount = TBinOrder::swap32(btTable.Count);
+	if(ui_off % FL_BIN_ALIGN || ui_off < sizeof(SBinHeader)
+			|| uint64_t(ui_off) + uint64_t(uiCount) * szRecord > uiSize)
+		throw TFuzzyError("loadFromBinary", "Tabla fuera del archivo", __LINE__, __FILE__);
+
+	return cData + ui_off;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] cStrings Tabla de cadenas (terminada en '\0')
+ * \param [in] uiSize   Tamao de la tabla
+ * \param [in] uiOffset Desplazamiento de la cadena
+ *
+ * \return La cadena, comprobando que empieza dentro de la tabla.
+ */
+static const char* binString(const char* cStrings, uint32_t uiSize, uint32_t uiOffset)
+{
+	if(uiOffset >= uiSize)
+		throw TFuzzyError("loadFromBinary", "Cadena fuera de la tabla", __LINE__, __FILE__);
+
+	return cStrings + uiOffset;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFileName Archivo binario donde guardar el modelo
+ *
+ * Guarda el modelo en el formato binario descrito en SBinHeader. Los valores
+ * se guardan consecutivos por conjunto y los tomos consecutivos por regla, en
+ * el mismo orden que en memoria, por lo que cargar el archivo reproduce el
+ * modelo exactamente (incluido el texto de las reglas).
+ *
+ * Tambin se guardan las tablas de ejecucin: las reglas de cada conjunto,
+ * el orden de clculo de los conjuntos (cada uno tras sus entradas; si las
+ * reglas forman un ciclo, ste se rompe por el primer conjunto que lo cierra)
+ * y el ndice de conjuntos por nombre.
+ *
+ * \sa loadFromBinary(), saveToFile(), TFuzzyImage
+ */
+void TFuzzyModel::saveToBinary(std::string strFileName)
+{
+	//-- Un modelo cargado de forma perezosa se guarda completo
+	require();
+
+	SBinHeader                 bh_head;
+	std::vector<SBinSet>       v_sets;
+	std::vector<SBinValue>     v_vals;
+	std::vector<SBinFunction>  v_funs;
+	std::vector<uint32_t>      v_pars;
+	std::vector<SBinRule>      v_ruls;
+	std::vector<SBinAtom>      v_atms;
+	std::vector<uint32_t>      v_refs;
+	std::vector<uint32_t>      v_ordr;
+	std::vector<uint32_t>      v_snam;
+	std::string                str_strs(1, '\0');
+
+	//-- Conjunto al que pertenece cada valor, reglas y entradas de cada conjunto
+	std::vector<uint32_t>               v_vset;
+	std::vector<std::vector<uint32_t> > v_srul(m_fsSets.size());
+	std::vector<std::vector<uint32_t> > v_deps(m_fsSets.size());
+
+	std::unordered_map<fzsymbol, uint32_t>    m_names;
+	std::unordered_map<fzhndl, uint32_t>      m_funcs;
+	std::unordered_map<TFuzzyVal*, uint32_t>  m_vals;
+
+	//-- Conjuntos, valores, funciones y parmetros
+	for(size_t i = 0; i < m_fsSets.size(); ++i)
+	{
+		TFuzzySet& fs_set = m_fsSets[int(i)];
+		SBinSet    bs_set;
+
+		bs_set.Name       = TBinOrder::swap32(binName(str_strs, m_names, fs_set.symbol()));
+		bs_set.FirstValue = TBinOrder::swap32(uint32_t(v_vals.size()));
+		bs_set.ValueCount = TBinOrder::swap32(uint32_t(fs_set.size()));
+		bs_set.FirstRule  = 0;
+		bs_set.RuleCount  = 0;
+		bs_set.Min        = TBinOrder::toFile(fs_set.min());
+		bs_set.Max        = TBinOrder::toFile(fs_set.max());
+		bs_set.Reserved   = 0;
+		v_sets.push_back(bs_set);
+		v_snam.push_back(uint32_t(i));
+
+		for(size_t j = 0; j < fs_set.size(); ++j)
+		{
+			TFuzzyVal&      fv_val  = fs_set[int(j)];
+			SFuzzyFunction* ff_func = fv_val.function();
+			SBinValue       bv_val;
+			uint32_t        ui_fun  = FL_BIN_NONE;
+
+			if(ff_func)
+			{
+				std::unordered_map<fzhndl, uint32_t>::iterator found = m_funcs.find(ff_func->handle());
+				if(found == m_funcs.end())
+				{
+					SBinFunction bf_fun;
+
+					bf_fun.Name = TBinOrder::swap32(binName(str_strs, m_names, ff_func->symbol()));
+					ui_fun = uint32_t(v_funs.size());
+					v_funs.push_back(bf_fun);
+					m_funcs[ff_func->handle()] = ui_fun;
+				}
+				else
+					ui_fun = found->second;
+			}
+
+			m_vals[&fv_val] = uint32_t(v_vals.size());
+			v_vset.push_back(uint32_t(i));
+
+			bv_val.Name       = TBinOrder::swap32(binName(str_strs, m_names, fv_val.symbol()));
+			bv_val.Function   = TBinOrder::swap32(ui_fun);
+			bv_val.FirstParam = TBinOrder::swap32(uint32_t(v_pars.size()));
+			bv_val.ParamCount = TBinOrder::swap32(uint32_t(fv_val.size() + 2));
+			v_vals.push_back(bv_val);
+
+			v_pars.push_back(TBinOrder::toFile(fv_val.min()));
+			v_pars.push_back(TBinOrder::toFile(fv_val.max()));
+			for(size_t k = 0; k < fv_val.size(); ++k)
+				v_pars.push_back(TBinOrder::toFile(fv_val.param(int(k))));
+		}
+	}
+
+	//-- Reglas, ya resueltas
+	for(size_t i = 0; i < m_frRules.size(); ++i)
+	{
+		SFuzzyRule&      fr_rule = m_frRules[i];
+		const SRuleAtom* ra_atms = m_frRules.atoms(fr_rule);
+		std::string      str_txt = m_frRules.text(i);
+		SBinRule         br_rule;
+
+		br_rule.FirstAtom = TBinOrder::swap32(uint32_t(v_atms.size()));
+		br_rule.Text      = TBinOrder::swap32(uint32_t(str_strs.size()));
+		br_rule.Reserved  = 0;
+		str_strs.append(str_txt.c_str(), str_txt.size() + 1);
+
+		uint32_t ui_atoms = 0;
+		uint32_t ui_first = uint32_t(v_atms.size());
+		for(; ui_atoms < fr_rule.AtomCount; ++ui_atoms)
+		{
+			const SRuleAtom& ra_atom = ra_atms[ui_atoms];
+			std::unordered_map<TFuzzyVal*, uint32_t>::iterator found = m_vals.find(m_frRules.value(ra_atom));
+			SBinAtom ba_atom;
+
+			if(found == m_vals.end())
+				throw TFuzzyError("saveToBinary", "La regla usa un valor que no pertenece al modelo",
+						__LINE__, __FILE__);
+
+			uint32_t ui_set = v_vset[found->second];
+
+			ba_atom.Value     = TBinOrder::swap32(found->second);
+			ba_atom.Set       = TBinOrder::swap32(ui_set);
+			ba_atom.Position  = TBinOrder::swap32(found->second - TBinOrder::swap32(v_sets[ui_set].FirstValue));
+			ba_atom.Modifiers = TBinOrder::swap32(ra_atom.Modifiers);
+			v_atms.push_back(ba_atom);
+		}
+		br_rule.AtomCount = TBinOrder::swap32(ui_atoms);
+		v_ruls.push_back(br_rule);
+
+		//-- El ltimo tomo es el consecuente; el resto son sus entradas
+		if(ui_atoms > 0)
+		{
+			uint32_t ui_out = v_vset[TBinOrder::swap32(v_atms.back().Value)];
+
+			v_srul[ui_out].push_back(uint32_t(i));
+			for(uint32_t j = ui_first; j + 1 < v_atms.size(); ++j)
+				v_deps[ui_out].push_back(v_vset[TBinOrder::swap32(v_atms[j].Value)]);
+		}
+	}
+
+	//-- Reglas agrupadas por conjunto consecuente
+	for(size_t i = 0; i < v_sets.size(); ++i)
+	{
+		v_sets[i].FirstRule = TBinOrder::swap32(uint32_t(v_refs.size()));
+		v_sets[i].RuleCount = TBinOrder::swap32(uint32_t(v_srul[i].size()));
+		v_refs.insert(v_refs.end(), v_srul[i].begin(), v_srul[i].end());
+	}
+
+	//-- Orden de clculo: recorrido en profundidad de las entradas de cada
+	//   conjunto calculado, aadindolo cuando todas ellas ya lo estn
+	std::vector<uint8_t>                          v_state(v_sets.size(), 0);
+	std::vector<std::pair<uint32_t, uint32_t> >   v_stack;
+	for(uint32_t i = 0; i < v_sets.size(); ++i)
+	{
+		if(v_state[i] || v_srul[i].empty())
+			continue;
+
+		v_state[i] = 1;
+		v_stack.push_back(std::make_pair(i, 0u));
+		while(!v_stack.empty())
+		{
+			uint32_t  ui_set = v_stack.back().first;
+			uint32_t& ui_dep = v_stack.back().second;
+
+			if(ui_dep < v_deps[ui_set].size())
+			{
+				uint32_t ui_in = v_deps[ui_set][ui_dep++];
+				if(!v_state[ui_in] && !v_srul[ui_in].empty())
+				{
+					v_state[ui_in] = 1;
+					v_stack.push_back(std::make_pair(ui_in, 0u));
+				}
+			}
+			else
+			{
+				v_state[ui_set] = 2;
+				v_ordr.push_back(ui_set);
+				v_stack.pop_back();
+			}
+		}
+	}
+
+	//-- ndice de conjuntos por nombre
+	struct SByName
+	{
+		TFuzzySets* Sets;
+		bool operator()(uint32_t uiA, uint32_t uiB)
+		{
+			return (*Sets)[int(uiA)].name() < (*Sets)[int(uiB)].name();
+		}
+	} sn_cmp;
+	sn_cmp.Sets = &m_fsSets;
+	std::sort(v_snam.begin(), v_snam.end(), sn_cmp);
+
+	for(size_t i = 0; i < v_refs.size(); ++i)
+		v_refs[i] = TBinOrder::swap32(v_refs[i]);
+	for(size_t i = 0; i < v_ordr.size(); ++i)
+		v_ordr[i] = TBinOrder::swap32(v_ordr[i]);
+	for(size_t i = 0; i < v_snam.size(); ++i)
+		v_snam[i] = TBinOrder::swap32(v_snam[i]);
+
+	//-- Cabecera: nombre, descripcin y posicin de cada tabla
+	memset(&bh_head, 0, sizeof(bh_head));
+	memcpy(bh_head.Magic, FL_BIN_MAGIC, 4);
+	bh_head.Version     = TBinOrder::swap16(FL_BIN_VERSION);
+	bh_head.Name        = TBinOrder::swap32(binName(str_strs, m_names, symbol()));
+	bh_head.Description = TBinOrder::swap32(uint32_t(str_strs.size()));
+	str_strs.append(m_strDescription.c_str(), m_strDescription.size() + 1);
+
+	std::string str_file(sizeof(bh_head), '\0');
+
+	binPut(str_file, bh_head.Sets,      v_sets.empty() ? NULL : &v_sets[0], v_sets.size(), sizeof(SBinSet));
+	binPut(str_file, bh_head.Values,    v_vals.empty() ? NULL : &v_vals[0], v_vals.size(), sizeof(SBinValue));
+	binPut(str_file, bh_head.Functions, v_funs.empty() ? NULL : &v_funs[0], v_funs.size(), sizeof(SBinFunction));
+	binPut(str_file, bh_head.Params,    v_pars.empty() ? NULL : &v_pars[0], v_pars.size(), sizeof(uint32_t));
+	binPut(str_file, bh_head.Rules,     v_ruls.empty() ? NULL : &v_ruls[0], v_ruls.size(), sizeof(SBinRule));
+	binPut(str_file, bh_head.Atoms,     v_atms.empty() ? NULL : &v_atms[0], v_atms.size(), sizeof(SBinAtom));
+	binPut(str_file, bh_head.Strings,   str_strs.data(), str_strs.size(), 1);
+	binPut(str_file, bh_head.RuleRefs,  v_refs.empty() ? NULL : &v_refs[0], v_refs.size(), sizeof(uint32_t));
+	binPut(str_file, bh_head.Order,     v_ordr.empty() ? NULL : &v_ordr[0], v_ordr.size(), sizeof(uint32_t));
+	binPut(str_file, bh_head.SetNames,  v_snam.empty() ? NULL : &v_snam[0], v_snam.size(), sizeof(uint32_t));
+	while(str_file.size() % FL_BIN_ALIGN)
+		str_file.push_back('\0');
+
+	bh_head.Size = TBinOrder::swap32(uint32_t(str_file.size()));
+	memcpy(&str_file[0], &bh_head, sizeof(bh_head));
+
+	std::ofstream file(strFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+		throw TFuzzyError("saveToBinary", "No se puede crear el archivo", __LINE__, __FILE__);
+	file.write(str_file.data(), str_file.size());
+	if(!file.good())
+		throw TFuzzyError("saveToBinary", "Error al escribir el archivo", __LINE__, __FILE__);
+	file.close();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFileName Archivo binario con el modelo
+ *
+ * Lee el archivo completo de una sola vez y construye el modelo directamente a
+ * partir de sus tablas: los valores de las reglas ya estn resueltos, por lo
+ * que no se analiza ningn texto. Antes de usar el contenido se comprueba que
+ * todas las tablas, ndices y cadenas estn dentro del archivo.
+ *
+ * \sa saveToBinary(), loadFromFile()
+ */
+void TFuzzyModel::loadFromBinary(std::string strFileName)
+{
+	clear();
+
+	std::ifstream file(strFileName.c_str(), std::ios::in | std::ios::binary);
+	if(!file.is_open())
+		throw TFuzzyError("loadFromBinary", "No se puede abrir el archivo", __LINE__, __FILE__);
+
+	file.seekg(0, std::ios::end);
+	std::streamoff so_size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if(so_size < std::streamoff(sizeof(SBinHeader)))
+		throw TFuzzyError("loadFromBinary", "El archivo no es un modelo binario", __LINE__, __FILE__);
+
+	std::vector<uint32_t> v_data((size_t(so_size) + 3) / 4);
+	const char*           c_data = (const char*)&v_data[0];
+	file.read((char*)&v_data[0], so_size);
+	if(!file.good())
+		throw TFuzzyError("loadFromBinary", "Error al leer el archivo", __LINE__, __FILE__);
+	file.close();
+
+	SBinHeader bh_head;
+	memcpy(&bh_head, c_data, sizeof(bh_head));
+	if(memcmp(bh_head.Magic, FL_BIN_MAGIC, 4) != 0)
+		throw TFuzzyError("loadFromBinary", "El archivo no es un modelo binario", __LINE__, __FILE__);
+	if(TBinOrder::swap16(bh_head.Version) != FL_BIN_VERSION)
+		throw TFuzzyError("loadFromBinary", "Versin del formato binario no soportada", __LINE__, __FILE__);
+	if(TBinOrder::swap32(bh_head.Size) != uint64_t(so_size))
+		throw TFuzzyError("loadFromBinary", "Tamao de archivo incorrecto", __LINE__, __FILE__);
+
+	uint64_t ui_size = uint64_t(so_size);
+	uint32_t ui_sets, ui_vals, ui_funs, ui_pars, ui_ruls, ui_atms, ui_strs;
+
+	const SBinSet*      bs_sets = (const SBinSet*)     binTable(c_data, ui_size, bh_head.Sets,      sizeof(SBinSet),      ui_sets);
+	const SBinValue*    bv_vals = (const SBinValue*)   binTable(c_data, ui_size, bh_head.Values,    sizeof(SBinValue),    ui_vals);
+	const SBinFunction* bf_funs = (const SBinFunction*)binTable(c_data, ui_size, bh_head.Functions, sizeof(SBinFunction), ui_funs);
+	const uint32_t*     ui_prms = (const uint32_t*)    binTable(c_data, ui_size, bh_head.Params,    sizeof(uint32_t),     ui_pars);
+	const SBinRule*     br_ruls = (const SBinRule*)    binTable(c_data, ui_size, bh_head.Rules,     sizeof(SBinRule),     ui_ruls);
+	const SBinAtom*     ba_atms = (const SBinAtom*)    binTable(c_data, ui_size, bh_head.Atoms,     sizeof(SBinAtom),     ui_atms);
+	const char*         c_strs  =                      binTable(c_data, ui_size, bh_head.Strings,   1,                    ui_strs);
+
+	if(ui_strs == 0 || c_strs[ui_strs - 1] != '\0')
+		throw TFuzzyError("loadFromBinary", "Tabla de cadenas incorrecta", __LINE__, __FILE__);
+
+	name(binString(c_strs, ui_strs, TBinOrder::swap32(bh_head.Name)));
+	m_strDescription = binString(c_strs, ui_strs, TBinOrder::swap32(bh_head.Description));
+
+	//-- Las funciones se resuelven una nica vez
+	std::vector<std::string> v_funs(ui_funs);
+	for(uint32_t i = 0; i < ui_funs; ++i)
+		v_funs[i] = binString(c_strs, ui_strs, TBinOrder::swap32(bf_funs[i].Name));
+
+	//-- Conjuntos y valores
+	std::vector<TFuzzyVal*> v_vals(ui_vals, (TFuzzyVal*)NULL);
+	std::vector<fuzzvar>    v_params;
+	fzhndl                  fh_fun;
+	for(uint32_t i = 0; i < ui_sets; ++i)
+	{
+		uint32_t   ui_first = TBinOrder::swap32(bs_sets[i].FirstValue);
+		uint32_t   ui_count = TBinOrder::swap32(bs_sets[i].ValueCount);
+		TFuzzySet& fs_set   = m_fsSets[m_fsSets.add(binString(c_strs, ui_strs, TBinOrder::swap32(bs_sets[i].Name)))];
+
+		if(m_fsSets.size() != i + 1 || uint64_t(ui_first) + ui_count > ui_vals)
+			throw TFuzzyError("loadFromBinary", "Conjunto incorrecto", __LINE__, __FILE__);
+
+		for(uint32_t j = ui_first; j < ui_first + ui_count; ++j)
+		{
+			const SBinValue& bv_val = bv_vals[j];
+			uint32_t         ui_fun = TBinOrder::swap32(bv_val.Function);
+			uint32_t         ui_par = TBinOrder::swap32(bv_val.FirstParam);
+			uint32_t         ui_cnt = TBinOrder::swap32(bv_val.ParamCount);
+			TFuzzyVal*       fv_val;
+
+			if(v_vals[j] || ui_cnt < 2 || uint64_t(ui_par) + ui_cnt > ui_pars
+					|| (ui_fun != FL_BIN_NONE && ui_fun >= ui_funs))
+				throw TFuzzyError("loadFromBinary", "Valor incorrecto", __LINE__, __FILE__);
+
+			fv_val = &fs_set[fs_set.add(binString(c_strs, ui_strs, TBinOrder::swap32(bv_val.Name)))];
+			if(fs_set.size() != j - ui_first + 1)
+				throw TFuzzyError("loadFromBinary", "Valor repetido", __LINE__, __FILE__);
+			v_params.resize(ui_cnt);
+			for(uint32_t k = 0; k < ui_cnt; ++k)
+				v_params[k] = TBinOrder::fromFile(ui_prms[ui_par + k]);
+			fh_fun = fv_val->define(ui_fun != FL_BIN_NONE ? v_funs[ui_fun] : std::string(), v_params);
+			if(ui_fun != FL_BIN_NONE && FL_INVALID_HANDLE == fh_fun)
+				throw TFuzzyError("loadFromBinary", "No existe la funcin del valor", __LINE__, __FILE__);
+
+			v_vals[j] = fv_val;
+		}
+	}
+
+	//-- Reglas, sin analizar su texto
+	std::vector<fuzzatom>     v_atoms;
+	std::vector<TValModifier> v_mods;
+	for(uint32_t i = 0; i < ui_ruls; ++i)
+	{
+		uint32_t ui_first = TBinOrder::swap32(br_ruls[i].FirstAtom);
+		uint32_t ui_count = TBinOrder::swap32(br_ruls[i].AtomCount);
+
+		if(ui_count < 2 || uint64_t(ui_first) + ui_count > ui_atms)
+			throw TFuzzyError("loadFromBinary", "Regla incorrecta", __LINE__, __FILE__);
+
+		v_atoms.clear();
+		for(uint32_t j = ui_first; j < ui_first + ui_count; ++j)
+		{
+			uint32_t ui_val = TBinOrder::swap32(ba_atms[j].Value);
+
+			if(ui_val >= ui_vals || !v_vals[ui_val])
+				throw TFuzzyError("loadFromBinary", "tomo incorrecto", __LINE__, __FILE__);
+
+			//-- Se descartan los grupos vacos, como al analizar el texto
+			TFuzzyRules::unpack(TBinOrder::swap32(ba_atms[j].Modifiers), v_mods);
+			v_atoms.push_back(fuzzatom(v_vals[ui_val], TFuzzyRules::pack(v_mods)));
+		}
+
+		m_frRules.add(v_atoms, m_frRules.keepText()
+				? binString(c_strs, ui_strs, TBinOrder::swap32(br_ruls[i].Text)) : std::string());
+	}
+}
+//-----------------------------------------------------------------------------
+
+
+
+
+
+/**
+ * \param [in] vOutputs Conjuntos cuyo resultado se usa. Si est vaco, los
+ *                      conjuntos calculados por alguna regla que no son
+ *                      antecedentes de ninguna otra.
+ *
+ * Simplifica el modelo sin cambiar el resultado de ninguna salida:
+ *
+ * \li Elimina los conjuntos que no influyen en ninguna salida y las reglas
+ * que los calculan.
+ * \li Fusiona los valores de un mismo conjunto con la misma definicin
+ * (TFuzzyVal::share()). Como antecedentes dan el mismo grado de verdad y,
+ * como consecuentes, el mximo de sus curvas limitadas es la curva limitada
+ * por el mximo de sus lmites, que es lo que calcula el valor fusionado.
+ * \li Elimina las reglas que, tras la fusin, son iguales a otra o
+ * redundantes (TFuzzyRules::subsumed()).
+ * \li Elimina los valores que no usa ninguna regla, salvo los que fijan los
+ * lmites (TFuzzySet::min(), max()) de un conjunto calculado por las reglas,
+ * pues de ellos depende el muestreo al defuzzificar.
+ *
+ * El modelo resultante puede guardarse (saveToFile(), saveToBinary()). Los
+ * TFuzzyExec que lo usen reconstruyen su cadena de ejecucin en el siguiente
+ * clculo; si se ha eliminado algn conjunto, las entradas que ya tuvieran
+ * se pierden y deben darse de nuevo.
+ *
+ * \return Lo que se ha eliminado. Si alguna salida no existe lanza
+ * TFuzzyError sin cambiar el modelo.
+ */
+SModelOptimization TFuzzyModel::optimize(const std::vector<std::string>& vOutputs)
+{
+	typedef std::unordered_map<TFuzzySet*, std::vector<size_t> > setrules;
+
+	SModelOptimization                   mo_report;
+	setrules                             m_rules;
+	std::unordered_set<TFuzzySet*>       s_inputs, s_live;
+	std::unordered_map<TFuzzyVal*, TFuzzyVal*> m_merge;
+	std::unordered_set<TFuzzyVal*>       s_used;
+	std::vector<TFuzzySet*>              v_work;
+	std::vector<std::vector<fuzzatom> >  v_rules;
+	std::vector<std::string>             v_texts, v_orig;
+
+	require();
+
+	//-- Reglas de cada conjunto calculado y conjuntos usados como antecedentes
+	for(size_t i = 0; i < m_frRules.size(); ++i)
+	{
+		SFuzzyRule&      fr_rule = m_frRules[i];
+		const SRuleAtom* ra_atom = m_frRules.atoms(fr_rule);
+
+		m_rules[static_cast<TFuzzySet*>(m_frRules.value(ra_atom[fr_rule.AtomCount - 1])->parent())].push_back(i);
+		for(uint32_t k = 0; k + 1 < fr_rule.AtomCount; ++k)
+			s_inputs.insert(static_cast<TFuzzySet*>(m_frRules.value(ra_atom[k])->parent()));
+	}
+
+	//-- Salidas y, hacia atrs, los conjuntos de los que dependen
+	if(vOutputs.empty())
+	{
+		for(size_t i = 0; i < m_fsSets.size(); ++i)
+		{
+			TFuzzySet* fs_set = &m_fsSets[int(i)];
+			if(m_rules.count(fs_set) && !s_inputs.count(fs_set))
+				v_work.push_back(fs_set);
+		}
+	}
+	for(size_t i = 0; i < vOutputs.size(); ++i)
+	{
+		TFuzzySet* fs_set = m_fsSets.bySymbol(TFuzzySymbols::find(vOutputs[i]));
+		if(!fs_set)
+			throw TFuzzyError("optimize", ("No existe el conjunto de salida " + vOutputs[i]).c_str(),
+					__LINE__, __FILE__);
+		v_work.push_back(fs_set);
+	}
+	s_live.insert(v_work.begin(), v_work.end());
+	while(!v_work.empty())
+	{
+		setrules::iterator found = m_rules.find(v_work.back());
+
+		v_work.pop_back();
+		if(found == m_rules.end())
+			continue;
+		for(size_t i = 0; i < found->second.size(); ++i)
+		{
+			SFuzzyRule&      fr_rule = m_frRules[found->second[i]];
+			const SRuleAtom* ra_atom = m_frRules.atoms(fr_rule);
+
+			for(uint32_t k = 0; k + 1 < fr_rule.AtomCount; ++k)
+			{
+				TFuzzySet* fs_set = static_cast<TFuzzySet*>(m_frRules.value(ra_atom[k])->parent());
+				if(s_live.insert(fs_set).second)
+					v_work.push_back(fs_set);
+			}
+		}
+	}
+
+	//-- Valores con la misma definicin que otro anterior del conjunto
+	for(size_t i = 0; i < m_fsSets.size(); ++i)
+	{
+		TFuzzySet& fs_set = m_fsSets[int(i)];
+		std::unordered_map<const SFuzzyDef*, TFuzzyVal*> m_first;
+
+		if(!s_live.count(&fs_set) || (!s_inputs.count(&fs_set) && !m_rules.count(&fs_set)))
+			continue;
+		for(size_t j = 0; j < fs_set.size(); ++j)
+		{
+			TFuzzyVal* fv_val = &fs_set[int(j)];
+
+			fv_val->share();
+			TFuzzyVal* fv_first = m_first.insert(std::make_pair(fv_val->definition(), fv_val)).first->second;
+			if(fv_first != fv_val)
+			{
+				m_merge[fv_val] = fv_first;
+				mo_report.Merged.push_back(std::make_pair(fs_set.name() + "." + fv_val->name(),
+														  fs_set.name() + "." + fv_first->name()));
+			}
+		}
+	}
+
+	//-- Reglas de los conjuntos que se mantienen, con los valores fusionados
+	for(size_t i = 0; i < m_frRules.size(); ++i)
+	{
+		SFuzzyRule&           fr_rule  = m_frRules[i];
+		const SRuleAtom*      ra_atom  = m_frRules.atoms(fr_rule);
+		std::vector<fuzzatom> v_atoms;
+		bool                  b_merged = false;
+
+		if(!s_live.count(static_cast<TFuzzySet*>(m_frRules.value(ra_atom[fr_rule.AtomCount - 1])->parent())))
+		{
+			mo_report.DeadRules.push_back(m_frRules.text(i));
+			continue;
+		}
+
+		for(uint32_t k = 0; k < fr_rule.AtomCount; ++k)
+		{
+			TFuzzyVal* fv_val = m_frRules.value(ra_atom[k]);
+			std::unordered_map<TFuzzyVal*, TFuzzyVal*>::iterator found = m_merge.find(fv_val);
+
+			if(found != m_merge.end())
+			{
+				fv_val   = found->second;
+				b_merged = true;
+			}
+			v_atoms.push_back(fuzzatom(fv_val, ra_atom[k].Modifiers));
+		}
+		v_rules.push_back(v_atoms);
+		v_orig.push_back(m_frRules.text(i));
+		v_texts.push_back(b_merged ? std::string() : v_orig.back());
+	}
+
+	m_frRules.clear();
+	for(size_t i = 0; i < v_rules.size(); ++i)
+	{
+		if(!m_frRules.add(v_rules[i], v_texts[i]))
+			mo_report.Redundant.push_back(v_orig[i]);
+	}
+
+	std::vector<std::pair<size_t, size_t> > v_subsumed = m_frRules.subsumed();
+	for(size_t i = 0; i < v_subsumed.size(); ++i)
+		mo_report.Redundant.push_back(m_frRules.text(v_subsumed[i].first));
+	m_frRules.pruneSubsumed();
+
+	//-- Valores que usan las reglas que quedan y conjuntos que calculan
+	std::unordered_set<TFuzzySet*> s_computed;
+	for(size_t i = 0; i < m_frRules.size(); ++i)
+	{
+		SFuzzyRule&      fr_rule = m_frRules[i];
+		const SRuleAtom* ra_atom = m_frRules.atoms(fr_rule);
+
+		for(uint32_t k = 0; k < fr_rule.AtomCount; ++k)
+			s_used.insert(m_frRules.value(ra_atom[k]));
+		s_computed.insert(static_cast<TFuzzySet*>(m_frRules.value(ra_atom[fr_rule.AtomCount - 1])->parent()));
+	}
+
+	//-- Valores sin usar y conjuntos que no influyen en ninguna salida
+	for(size_t i = 0; i < m_fsSets.size(); )
+	{
+		TFuzzySet&          fs_set = m_fsSets[int(i)];
+		std::vector<fzhndl> v_del;
+
+		if(!s_live.count(&fs_set))
+		{
+			mo_report.Sets.push_back(fs_set.name());
+			m_fsSets.del(fs_set.handle());
+			continue;
+		}
+
+		//-- Los lmites de un conjunto calculado fijan su muestreo: se
+		//   mantiene algn valor que llegue a cada uno
+		bool    b_bounds = s_computed.count(&fs_set) != 0;
+		fuzzvar fv_min   = fs_set.min();
+		fuzzvar fv_max   = fs_set.max();
+		bool    b_min    = !b_bounds;
+		bool    b_max    = !b_bounds;
+
+		for(size_t j = 0; j < fs_set.size(); ++j)
+		{
+			TFuzzyVal& fv_val = fs_set[int(j)];
+			if(s_used.count(&fv_val))
+			{
+				b_min = b_min || fv_val.min() == fv_min;
+				b_max = b_max || fv_val.max() == fv_max;
+			}
+		}
+
+		for(size_t j = 0; j < fs_set.size(); ++j)
+		{
+			TFuzzyVal& fv_val = fs_set[int(j)];
+
+			if(s_used.count(&fv_val))
+				continue;
+			if(!m_merge.count(&fv_val))
+			{
+				if(!b_min && fv_val.min() == fv_min)
+				{
+					b_min = true;
+					b_max = b_max || fv_val.max() == fv_max;
+					continue;
+				}
+				if(!b_max && fv_val.max() == fv_max)
+				{
+					b_max = true;
+					continue;
+				}
+			}
+			v_del.push_back(fv_val.handle());
+		}
+
+		//-- Un conjunto sin valores usados (una salida que es slo entrada)
+		//   se deja como est
+		if(v_del.size() < fs_set.size())
+		{
+			for(size_t j = 0; j < v_del.size(); ++j)
+			{
+				TFuzzyVal& fv_val = fs_set[v_del[j]];
+				if(!m_merge.count(&fv_val))
+					mo_report.Values.push_back(fs_set.name() + "." + fv_val.name());
+				fs_set.del(v_del[j]);
+			}
+		}
+		++i;
+	}
+
+	return mo_report;
+}
+//-----------------------------------------------------------------------------
 
 
 
@@ -435,30 +1506,243 @@ TFuzzyModels::~TFuzzyModels()
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in] fmModel Modelo a aadir
+ *
+ * Aade a la lista un modelo ya creado. Debe llamarse con el cerrojo tomado.
+ */
+void TFuzzyModels::publish(TFuzzyModel* fmModel)
+{
+	fmModel->parent() = this;
+	m_vModels.push_back(fmModel);
+	m_mHandles[fmModel->handle()] = fmModel;
+	if(!bySymbol(fmModel->symbol()))
+		m_mNames[fmModel->symbol()] = fmModel;
+}
+//-----------------------------------------------------------------------------
+
 /**
  *
  */
 fzhndl TFuzzyModels::add()
 {
-	TFuzzyModel* fm_model = new TFuzzyModel;
-	fm_model->parent() = this;
-	m_mModels[fm_model->handle()] = fm_model;
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	TFuzzyModel*                          fm_model = new TFuzzyModel;
+
+	publish(fm_model);
 	return fm_model->handle();
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * Trabajo compartido por los hilos de TFuzzyModels::load()
+ */
+struct SModelsLoad
+{
+	/** Archivos a cargar */
+	const std::vector<std::string>* Files;
+	/** Modelo cargado de cada archivo (NULL si ha fallado) */
+	std::vector<TFuzzyModel*>       Models;
+	/** Error de cada archivo que ha fallado */
+	std::vector<std::string>        Errors;
+	/** Siguiente archivo a cargar */
+	std::atomic<size_t>             Next;
+	/** Hilos con los que cada modelo analiza sus reglas */
+	unsigned int                    Threads;
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de modelo
+ *
+ * \return true si el archivo empieza por FL_BIN_MAGIC (formato binario).
+ */
+static bool isBinaryModel(const std::string& strFile)
+{
+	char          c_magic[4] = { 0, 0, 0, 0 };
+	std::ifstream file(strFile.c_str(), std::ios::in | std::ios::binary);
+
+	file.read(c_magic, sizeof(c_magic));
+
+	return file.good() && memcmp(c_magic, FL_BIN_MAGIC, sizeof(c_magic)) == 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] smLoad Trabajo compartido
+ *
+ * Cuerpo de cada hilo de TFuzzyModels::load(): toma archivos de la lista
+ * hasta que no queda ninguno, de manera que los hilos se reparten la carga
+ * aunque los modelos sean de tamaos muy diferentes.
+ */
+static void loadModels(SModelsLoad* smLoad)
+{
+	for(size_t i = smLoad->Next++; i < smLoad->Files->size(); i = smLoad->Next++)
+	{
+		const std::string& str_file = (*smLoad->Files)[i];
+		TFuzzyModel*       fm_model = NULL;
+
+		try
+		{
+			fm_model = new TFuzzyModel;
+			if(isBinaryModel(str_file))
+				fm_model->loadFromBinary(str_file);
+			else
+				fm_model->loadFromFile(str_file, false, smLoad->Threads);
+			smLoad->Models[i] = fm_model;
+		}
+		catch(TFuzzyError& e)
+		{
+			delete fm_model;
+			smLoad->Errors[i] = str_file + ": " + e.what() + ": " + e.why();
+		}
+		catch(std::exception& e)
+		{
+			delete fm_model;
+			smLoad->Errors[i] = str_file + ": " + e.what();
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] vFiles    Archivos de los modelos (de texto o binarios)
+ * \param [in] uiThreads Nmero de hilos a usar (0: uno por ncleo)
+ *
+ * Carga varios modelos en paralelo. Cada archivo se carga en un modelo nuevo
+ * (con loadFromFile() o loadFromBinary() segn su formato) y los archivos se
+ * reparten entre uiThreads hilos, incluido el que llama. Si hay menos
+ * archivos que hilos, los que sobran se reparten entre los modelos para
+ * analizar sus reglas (TFuzzyRules::addMany()), sin pasar de uiThreads en
+ * total.
+ *
+ * Los modelos se aaden a la lista cuando todos se han cargado, de una vez y
+ * bajo el cerrojo de la lista, de manera que otros hilos ven todos los modelos
+ * nuevos o ninguno. Si algn archivo falla no se aade ninguno y se lanza un
+ * error con el del primer archivo que ha fallado (en el orden de vFiles).
+ *
+ * \return Descriptores de los modelos cargados, en el orden de vFiles.
+ * \sa add(), TFuzzyModel::loadFromFile()
+ */
+std::vector<fzhndl> TFuzzyModels::load(const std::vector<std::string>& vFiles, unsigned int uiThreads)
+{
+	std::vector<fzhndl>      v_handles;
+	std::vector<std::thread> v_threads;
+	SModelsLoad              sm_load;
+
+	sm_load.Files = &vFiles;
+	sm_load.Models.assign(vFiles.size(), (TFuzzyModel*)NULL);
+	sm_load.Errors.assign(vFiles.size(), std::string(""));
+	sm_load.Next  = 0;
+
+	if(uiThreads == 0)
+		uiThreads = std::thread::hardware_concurrency();
+	sm_load.Threads = 1;
+	if(uiThreads > vFiles.size())
+	{
+		sm_load.Threads = vFiles.empty() ? 1 : uiThreads / (unsigned int)vFiles.size();
+		uiThreads       = (unsigned int)vFiles.size();
+	}
+
+	//-- Si no se puede crear algn hilo, el trabajo se reparte entre los dems
+	try
+	{
+		for(unsigned int i = 1; i < uiThreads; ++i)
+			v_threads.push_back(std::thread(loadModels, &sm_load));
+	}
+	catch(std::exception&)
+	{
+	}
+	loadModels(&sm_load);
+	for(size_t i = 0; i < v_threads.size(); ++i)
+		v_threads[i].join();
+
+	for(size_t i = 0; i < vFiles.size(); ++i)
+	{
+		if(!sm_load.Models[i])
+		{
+			for(size_t j = 0; j < vFiles.size(); ++j)
+				delete sm_load.Models[j];
+			throw TFuzzyError("load", sm_load.Errors[i].c_str(), __LINE__, __FILE__);
+		}
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	v_handles.reserve(vFiles.size());
+	m_vModels.reserve(m_vModels.size() + vFiles.size());
+	for(size_t i = 0; i < vFiles.size(); ++i)
+	{
+		publish(sm_load.Models[i]);
+		v_handles.push_back(sm_load.Models[i]->handle());
+	}
+
+	return v_handles;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Puede haber varios modelos con el mismo nombre. El ndice de nombres apunta
+ * siempre al primero de ellos (el de menor descriptor), que es el que
+ * devuelve operator[](std::string). Este mtodo vuelve a buscar dicho modelo
+ * cuando el que estaba indexado desaparece o cambia de nombre.
+ */
+void TFuzzyModels::index(fzsymbol fsName)
+{
+	size_t i = 0;
+
+	while(i < m_vModels.size() && m_vModels[i]->symbol() != fsName)
+		++i;
+
+	if(i == m_vModels.size())
+		m_mNames.erase(fsName);
+	else
+		m_mNames[fsName] = m_vModels[i];
+}
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+void TFuzzyModels::renamed(TFuzzyBase* fbChild, fzsymbol fsOld)
+{
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	TFuzzyModel* fm_model = bySymbol(fsOld);
+
+	if(fm_model == fbChild)
+		index(fsOld);
+
+	fm_model = bySymbol(fbChild->symbol());
+	if(!fm_model || fm_model->handle() > fbChild->handle())
+		m_mNames[fbChild->symbol()] = (TFuzzyModel*)fbChild;
+}
+//-----------------------------------------------------------------------------
+
 /**
  *
  */
 void TFuzzyModels::del(fzhndl fzId)
 {
-	std::map<fzhndl, TFuzzyModel*>::iterator found = m_mModels.find(fzId);
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	std::unordered_map<fzhndl, TFuzzyModel*>::iterator found = m_mHandles.find(fzId);
 
-	if(found != m_mModels.end())
+	if(found != m_mHandles.end())
 	{
-		delete found->second;
-		found->second = NULL;
-		m_mModels.erase(found);
+		TFuzzyModel* fm_model  = found->second;
+		fzsymbol     fs_name   = fm_model->symbol();
+		bool         b_indexed = bySymbol(fs_name) == fm_model;
+
+		m_mHandles.erase(found);
+		for(size_t i = 0; i < m_vModels.size(); ++i)
+		{
+			if(m_vModels[i] == fm_model)
+			{
+				m_vModels.erase(m_vModels.begin() + i);
+				break;
+			}
+		}
+		delete fm_model;
+		if(b_indexed)
+			index(fs_name);
 	}
 }
 //-----------------------------------------------------------------------------
@@ -468,11 +1752,14 @@ void TFuzzyModels::del(fzhndl fzId)
  */
 void TFuzzyModels::clear()
 {
-	while(m_mModels.size() > 0)
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	while(!m_vModels.empty())
 	{
-		delete m_mModels.begin()->second;
-		m_mModels.erase(m_mModels.begin());
+		delete m_vModels.back();
+		m_vModels.pop_back();
 	}
+	m_mHandles.clear();
+	m_mNames.clear();
 }
 //-----------------------------------------------------------------------------
 
@@ -481,38 +1768,33 @@ void TFuzzyModels::clear()
  */
 TFuzzyModel& TFuzzyModels::operator[](fzhndl fzId)
 {
-	std::map<fzhndl, TFuzzyModel*>::iterator found = m_mModels.find(fzId);
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	std::unordered_map<fzhndl, TFuzzyModel*>::iterator found = m_mHandles.find(fzId);
 
-	return found == m_mModels.end() ? *((TFuzzyModel*)&invalidObject()) : *found->second;
+	return found == m_mHandles.end() ? *((TFuzzyModel*)&invalidObject()) : *found->second;
 }
 //-----------------------------------------------------------------------------
 
 /**
  *
  */
-TFuzzyModel& TFuzzyModels::operator[](int iIndex)
+TFuzzyModel& TFuzzyModels::operator[](const std::string& strName)
 {
-	std::map<fzhndl, TFuzzyModel*>::iterator iter = m_mModels.begin();
-	int i_ndx = 0;
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	TFuzzyModel* fm_model = bySymbol(TFuzzySymbols::find(strName));
 
-	while(iter != m_mModels.end() && i_ndx++ < iIndex)
-		++iter;
-
-	return iter == m_mModels.end() ? *((TFuzzyModel*)&invalidObject()) : *iter->second;
+	return fm_model ? *fm_model : *((TFuzzyModel*)&invalidObject());
 }
 //-----------------------------------------------------------------------------
 
 /**
  *
  */
-TFuzzyModel& TFuzzyModels::operator[](std::string strName)
+TFuzzyModel* TFuzzyModels::bySymbol(fzsymbol fsName)
 {
-	std::map<fzhndl, TFuzzyModel*>::iterator iter = m_mModels.begin();
-	strName = toLower(trim(strName));
-
-	while(iter != m_mModels.end() && iter->second->name() != strName)
-		++iter;
+	std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+	std::unordered_map<fzsymbol, TFuzzyModel*>::iterator found = m_mNames.find(fsName);
 
-	return iter == m_mModels.end() ? *((TFuzzyModel*)&invalidObject()) : *iter->second;
+	return found == m_mNames.end() ? NULL : found->second;
 }
 //-----------------------------------------------------------------------------
@@ -33,21 +33,66 @@
 #define __FZMODEL_HPP__
 //-----------------------------------------------------------------------------
 #include "fzrules.hpp"
+#include <mutex>
 //-----------------------------------------------------------------------------
-/** Nmero de puntos en cada funcin para propsitos de pintado */
-#define FL_CRV_COUNT		1000
+namespace nsIniFile
+{
+	class TIniFile;
+	class TParam;
+}
+//-----------------------------------------------------------------------------
+/** Nmero de puntos en cada funcin para propsitos de pintado. Es tambin
+ * el nmero de tramos de la curva de salida de cada conjunto calculado, por
+ * lo que puede fijarse al compilar (-DFL_CRV_COUNT=...) para cambiar precisin
+ * por velocidad */
+#ifndef FL_CRV_COUNT
+	#define FL_CRV_COUNT	1000
+#endif
 //-----------------------------------------------------------------------------
 
 namespace nsFuzzy
 {
 	//-------------------------------------------------------------------------
 
+	struct SLazyLoad;
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Lo que ha eliminado TFuzzyModel::optimize().
+	 */
+	struct SModelOptimization
+	{
+		/** Conjuntos que no influyen en ninguna salida */
+		std::vector<std::string> Sets;
+		/** Valores ("set.valor") que no usa ninguna regla */
+		std::vector<std::string> Values;
+		/** Valores fusionados con otro del mismo conjunto con la misma
+		 * definicin ("set.valor", "set.otro") */
+		std::vector<std::pair<std::string, std::string> > Merged;
+		/** Reglas que calculan conjuntos eliminados */
+		std::vector<std::string> DeadRules;
+		/** Reglas iguales a otra o redundantes (TFuzzyRules::subsumed()) */
+		std::vector<std::string> Redundant;
+	};
+	//-------------------------------------------------------------------------
+
 	class TFuzzyModel : public TFuzzyBase
 	{
 	private:
 		TFuzzySets  m_fsSets;
 		TFuzzyRules m_frRules;
 		std::string m_strDescription;
+		/** Archivo indexado y partes an no creadas en la carga perezosa
+		 * (NULL si el modelo est completo). \sa loadFromFile(), require() */
+		SLazyLoad*  m_llLazy;
+
+		static std::string indexedName(const char* cPrefix, size_t szIndex, int iWidth);
+		static std::string numberText(fuzzvar fvValue);
+
+		void loadSet(nsIniFile::TIniFile& file, nsIniFile::TParam* prSet);
+		void lazySet(fzsymbol fsSet);
+		void lazyRules(std::vector<std::pair<unsigned int, nsIniFile::TParam*> >& vRules);
+		void lazyOrder();
 
 	protected:
         std::string& configurationHint(std::string& strHint);
@@ -60,32 +105,67 @@ namespace nsFuzzy
 		inline TFuzzyRules& rules()       { return m_frRules;        }
 		inline TFuzzySets&  sets()        { return m_fsSets;         }
 
+		/** Indica si quedan partes del modelo por crear. \sa require() */
+		inline bool lazy() { return m_llLazy != NULL; }
+
 		void clear();
 
-		void loadFromFile(std::string strFileName);
+		bool require(const std::string& strSet);
+		void require();
+
+		void loadFromFile(std::string strFileName, bool bLazy = false, unsigned int uiThreads = 0);
 		void saveToFile(std::string strFileName, bool bAddComments = true);
+
+		void loadFromBinary(std::string strFileName);
+		void saveToBinary(std::string strFileName);
+
+		SModelOptimization optimize(const std::vector<std::string>& vOutputs = std::vector<std::string>());
 	};
 	//-------------------------------------------------------------------------
 
 	class TFuzzyModels : public TFuzzyBase
 	{
 	private:
-		std::map<fzhndl, TFuzzyModel*> m_mModels;
+		/** Lista de modelos, en orden de creacin */
+		std::vector<TFuzzyModel*> m_vModels;
+		/** ndice de los modelos por descriptor */
+		std::unordered_map<fzhndl, TFuzzyModel*> m_mHandles;
+		/** ndice de los modelos por smbolo de su nombre */
+		std::unordered_map<fzsymbol, TFuzzyModel*> m_mNames;
+		/** Cerrojo de la lista y sus ndices */
+		std::recursive_mutex m_mtModels;
+
+		void index(fzsymbol fsName);
+		void publish(TFuzzyModel* fmModel);
 
 	protected:
+		virtual void renamed(TFuzzyBase* fbChild, fzsymbol fsOld);
+
 	public:
 		TFuzzyModels();
 		virtual ~TFuzzyModels();
 
-		inline size_t size() { return m_mModels.size(); }
+		inline size_t size()
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+			return m_vModels.size();
+		}
 
 		fzhndl add();
 		void   del(fzhndl fzId);
 		void   clear();
 
+		std::vector<fzhndl> load(const std::vector<std::string>& vFiles, unsigned int uiThreads = 0);
+
 		TFuzzyModel& operator[](fzhndl fzId);
-		TFuzzyModel& operator[](int iIndex);
-		TFuzzyModel& operator[](std::string strName);
+		inline TFuzzyModel& operator[](int iIndex)
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_mtModels);
+			return (iIndex >= 0 && size_t(iIndex) < m_vModels.size())
+					? *m_vModels[iIndex] : *((TFuzzyModel*)&invalidObject());
+		}
+		TFuzzyModel& operator[](const std::string& strName);
+		TFuzzyModel* bySymbol(fzsymbol fsName);
 	};
 }
 //-----------------------------------------------------------------------------
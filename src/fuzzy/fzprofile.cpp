@@ -0,0 +1,134 @@
+/**
+ * \file fzprofile.cpp
+ *
+ *  Execution profile. Cumulative timings and call counts of the phases of
+ *  TFuzzyExec, per set.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzprofile.hpp"
+#include <cstdio>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+uint64_t SSetProfile::calls() const
+{
+	uint64_t ui_calls = 0;
+
+	for(int i = 0; i < ppCount; ++i)
+		ui_calls += Phases[i].Calls;
+
+	return ui_calls;
+}
+//-----------------------------------------------------------------------------
+
+uint64_t SSetProfile::nanos() const
+{
+	uint64_t ui_nanos = 0;
+
+	for(int i = 0; i < ppCount; ++i)
+		ui_nanos += Phases[i].Nanos;
+
+	return ui_nanos;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] ppPhase Fase
+ *
+ * \return El nombre de la fase, tal como aparece en text().
+ */
+const char* SFuzzyProfile::phaseName(TProfilePhase ppPhase)
+{
+	switch(ppPhase)
+	{
+	case ppExecute: return "execute";
+	case ppRules:   return "rules";
+	case ppSample:  return "fuzzyfy";
+	case ppDefuzzy: return "defuzzyfy";
+	default:        break;
+	}
+
+	return "";
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] spSet Perfil de un conjunto
+ *
+ * Aade el conjunto al desglose, mantenindolo ordenado de ms a menos
+ * tiempo, y suma sus fases a las del total.
+ */
+void SFuzzyProfile::add(const SSetProfile& spSet)
+{
+	std::vector<SSetProfile>::iterator iter = Sets.begin();
+
+	while(iter != Sets.end() && iter->nanos() >= spSet.nanos())
+		++iter;
+	Sets.insert(iter, spSet);
+
+	for(int i = 0; i < ppCount; ++i)
+		Phases[i] += spSet.Phases[i];
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Una tabla con una fila por fase (total de todos los conjuntos) y, debajo,
+ * una fila por conjunto y fase con llamadas, tiempo total en milisegundos y
+ * tiempo medio por llamada en microsegundos.
+ *
+ * \return El perfil como texto.
+ */
+std::string SFuzzyProfile::text() const
+{
+	std::string str_ret;
+	char        c_line[160];
+
+	snprintf(c_line, sizeof(c_line), "%-24s %-10s %12s %12s %10s\n",
+			 "set", "phase", "calls", "total (ms)", "avg (us)");
+	str_ret += c_line;
+
+	for(size_t k = 0; k <= Sets.size(); ++k)
+	{
+		const SPhaseTimes* pt_times = k ? Sets[k - 1].Phases : Phases;
+		const char*        c_set    = k ? Sets[k - 1].Set.c_str() : "*";
+
+		for(int i = 0; i < ppCount; ++i)
+		{
+			if(!pt_times[i].Calls)
+				continue;
+			snprintf(c_line, sizeof(c_line), "%-24s %-10s %12llu %12.3f %10.3f\n",
+					 c_set, phaseName(TProfilePhase(i)),
+					 (unsigned long long)pt_times[i].Calls,
+					 double(pt_times[i].Nanos) / 1.0E6,
+					 double(pt_times[i].Nanos) / 1.0E3 / double(pt_times[i].Calls));
+			str_ret += c_line;
+		}
+	}
+
+	return str_ret;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,186 @@
+/**
+ * \file fzprofile.hpp
+ *
+ *  Execution profile. Cumulative timings and call counts of the phases of
+ *  TFuzzyExec, per set.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZPROFILE_HPP__
+#define __FZPROFILE_HPP__
+//-----------------------------------------------------------------------------
+#include "fztrace.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+
+/**
+ * Mide la fase ppPhase hasta el final del bloque y la anota en el perfil y en
+ * la traza de ptTarget (SProfileTarget*). Si ptTarget es NULL no mide nada.
+ * Compilando con FL_NO_PROFILE desaparece por completo.
+ */
+#ifndef FL_NO_PROFILE
+	#define FL_PROFILE(ptTarget, ppPhase) \
+			nsFuzzy::TProfileTimer pt_timer(ptTarget, ppPhase)
+#else
+	#define FL_PROFILE(ptTarget, ppPhase)
+#endif
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/** Fases de la ejecucin de un conjunto */
+	enum TProfilePhase
+	{
+		/** Grado de verdad de los valores para una entrada (TExecData::execute) */
+		ppExecute = 0,
+		/** Evaluacin de las reglas (TExecData::setLimits) */
+		ppRules,
+		/** Muestreo de la curva de salida (TExecData::fuzzyfy) */
+		ppSample,
+		/** Obtencin del resultado (TExecData::defuzzyfy) */
+		ppDefuzzy,
+		/** Nmero de fases */
+		ppCount
+	};
+	//-------------------------------------------------------------------------
+
+	/** Tiempo acumulado de una fase */
+	struct SPhaseTimes
+	{
+		/** Veces que se ha ejecutado */
+		uint64_t Calls;
+		/** Tiempo total, en nanosegundos */
+		uint64_t Nanos;
+
+		SPhaseTimes() : Calls(0), Nanos(0) {}
+
+		inline SPhaseTimes& operator+=(const SPhaseTimes& ptOther)
+		{
+			Calls += ptOther.Calls;
+			Nanos += ptOther.Nanos;
+			return *this;
+		}
+	};
+	//-------------------------------------------------------------------------
+
+	/** Perfil de un conjunto */
+	struct SSetProfile
+	{
+		/** Nombre del conjunto */
+		std::string Set;
+		/** Tiempo de cada fase (TProfilePhase) */
+		SPhaseTimes Phases[ppCount];
+
+		/** Llamadas de todas las fases */
+		uint64_t calls() const;
+		/** Tiempo total de todas las fases, en nanosegundos */
+		uint64_t nanos() const;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Perfil de un ejecutor (TFuzzyExec::profile()): el tiempo de cada fase
+	 * sumando todos los conjuntos y el desglose por conjunto.
+	 */
+	struct SFuzzyProfile
+	{
+		/** Tiempo de cada fase (TProfilePhase) en todos los conjuntos */
+		SPhaseTimes              Phases[ppCount];
+		/** Perfil de cada conjunto ejecutado, de ms a menos tiempo */
+		std::vector<SSetProfile> Sets;
+
+		static const char* phaseName(TProfilePhase ppPhase);
+
+		void        add(const SSetProfile& spSet);
+		std::string text() const;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Dnde anota FL_PROFILE las fases de un conjunto. Quien mide pasa NULL en
+	 * lugar de un destino sin perfil ni traza, de manera que sin medir slo
+	 * se comprueba un puntero.
+	 */
+	struct SProfileTarget
+	{
+		/** Perfil del conjunto (NULL si no se mide) */
+		SSetProfile* Profile;
+		/** Traza del ejecutor (NULL si no se traza) */
+		TFuzzyTrace* Trace;
+		/** Conjunto en la traza (FL_TRACE_NOSET si no es de uno) */
+		uint32_t     Set;
+
+		SProfileTarget() : Profile(NULL), Trace(NULL), Set(FL_TRACE_NOSET) {}
+
+		inline bool active() const { return Profile || Trace; }
+	};
+	//-------------------------------------------------------------------------
+
+#ifndef FL_NO_PROFILE
+	/**
+	 * Cronmetro de una fase: mide desde su construccin hasta su destruccin,
+	 * lo acumula en el perfil de ptTarget y lo aade como evento a su traza.
+	 * Si ptTarget es NULL no lee el reloj. Se usa a travs de FL_PROFILE.
+	 */
+	class TProfileTimer
+	{
+	private:
+		const SProfileTarget* m_ptTarget;
+		uint16_t              m_uiPhase;
+		uint64_t              m_uiStart;
+
+	public:
+		inline TProfileTimer(const SProfileTarget* ptTarget, int iPhase)
+				: m_ptTarget(ptTarget), m_uiPhase(uint16_t(iPhase))
+		{
+			if(m_ptTarget)
+				m_uiStart = TFuzzyTrace::now();
+		}
+		inline ~TProfileTimer()
+		{
+			if(m_ptTarget)
+			{
+				uint64_t ui_end = TFuzzyTrace::now();
+
+				if(m_ptTarget->Profile)
+				{
+					++m_ptTarget->Profile->Phases[m_uiPhase].Calls;
+					m_ptTarget->Profile->Phases[m_uiPhase].Nanos += ui_end - m_uiStart;
+				}
+				if(m_ptTarget->Trace)
+					m_ptTarget->Trace->add(m_uiStart, ui_end, m_ptTarget->Set, m_uiPhase);
+			}
+		}
+	};
+	//-------------------------------------------------------------------------
+#endif
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZPROFILE_HPP__ */
+//-----------------------------------------------------------------------------
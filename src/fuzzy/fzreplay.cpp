@@ -0,0 +1,346 @@
+/**
+ * \file fzreplay.cpp
+ *
+ *  Replay of execution logs. Feeds the inputs recorded by TFuzzyExec::logOpen()
+ *  back through an executor and measures throughput, latency and how far the
+ *  outputs move from the recorded ones.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzreplay.hpp"
+#include <cmath>
+#include <cstdio>
+#include <map>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] vNames  Nombres conocidos
+ * \param [in,out] mIndex  Posicin de cada nombre en vNames
+ * \param [in]     strName Nombre
+ *
+ * \return La posicin de strName en vNames, donde se aade si no estaba.
+ */
+static uint32_t nameIndex(std::vector<std::string>& vNames, std::map<std::string, uint32_t>& mIndex,
+						  const std::string& strName)
+{
+	std::map<std::string, uint32_t>::iterator found = mIndex.find(strName);
+
+	if(found != mIndex.end())
+		return found->second;
+
+	vNames.push_back(strName);
+	mIndex[strName] = uint32_t(vNames.size() - 1);
+
+	return uint32_t(vNames.size() - 1);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fvOut Salida comparada
+ * \param [in] fvRef Salida de referencia
+ *
+ * \return La diferencia absoluta entre las dos salidas. Un resultado no
+ * numrico slo coincide con otro igual: si no, la diferencia es infinita.
+ */
+double nsFuzzy::outputError(fuzzvar fvOut, fuzzvar fvRef)
+{
+	if(fvOut != fvOut || fvRef != fvRef)
+		return (fvOut != fvOut && fvRef != fvRef) ? 0.0 : HUGE_VAL;
+
+	return fabs(double(fvOut) - double(fvRef));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fvOut Salida comparada
+ * \param [in] fvRef Salida de referencia
+ *
+ * Acumula la diferencia entre las dos salidas (outputError()).
+ *
+ * \return La diferencia.
+ */
+double SOutputDeviation::add(fuzzvar fvOut, fuzzvar fvRef)
+{
+	double d_diff = outputError(fvOut, fvRef);
+
+	++Count;
+	Sum += d_diff;
+	Max  = d_diff > Max ? d_diff : Max;
+
+	return d_diff;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return La fila del conjunto en los informes: comparadas, desviacin
+ * mxima y media, o "missing" si el ejecutor no lo tiene.
+ */
+std::string SOutputDeviation::text() const
+{
+	char c_line[192];
+
+	if(Missing)
+		snprintf(c_line, sizeof(c_line), "%-24s %12s\n", Set.c_str(), "missing");
+	else
+		snprintf(c_line, sizeof(c_line), "%-24s %12llu %16.9g %16.9g\n", Set.c_str(),
+				 (unsigned long long)Count, Max, mean());
+
+	return c_line;
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyReplay::TFuzzyReplay() : m_uiDropped(0), m_uiIncomplete(0), m_uiRuns(0), m_dSeconds(0.0)
+{
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyReplay::~TFuzzyReplay()
+{
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strLog Registro escrito por TFuzzyExec::logOpen()
+ *
+ * Lee todos los clculos del registro. Las reglas no se guardan: dependen de
+ * la versin del modelo y no se comparan.
+ */
+void TFuzzyReplay::load(const std::string& strLog)
+{
+	TFuzzyLogReader                 lr_log;
+	SLogCalculate                   lc_calc;
+	std::map<std::string, uint32_t> m_index;
+
+	m_vNames.clear();
+	m_vValues.clear();
+	m_vSteps.clear();
+	m_vDeviations.clear();
+	m_fhLatency.reset();
+	m_uiDropped    = 0;
+	m_uiIncomplete = 0;
+	m_uiRuns       = 0;
+	m_dSeconds     = 0.0;
+
+	lr_log.open(strLog);
+	while(lr_log.next(lc_calc))
+	{
+		SReplayStep rs_step;
+
+		rs_step.FirstInput = uint32_t(m_vValues.size());
+		rs_step.InputCount = uint32_t(lc_calc.Inputs.size());
+		for(size_t i = 0; i < lc_calc.Inputs.size(); ++i)
+			m_vValues.push_back(SLogValue(nameIndex(m_vNames, m_index, lr_log.name(lc_calc.Inputs[i].Id)),
+										  lc_calc.Inputs[i].Value));
+
+		rs_step.FirstOutput = uint32_t(m_vValues.size());
+		rs_step.OutputCount = uint32_t(lc_calc.Outputs.size());
+		for(size_t i = 0; i < lc_calc.Outputs.size(); ++i)
+			m_vValues.push_back(SLogValue(nameIndex(m_vNames, m_index, lr_log.name(lc_calc.Outputs[i].Id)),
+										  lc_calc.Outputs[i].Value));
+
+		m_vSteps.push_back(rs_step);
+	}
+	m_uiDropped = lr_log.dropped();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] feExec   Ejecutor del modelo (o la imagen) a probar
+ * \param [in]     uiRepeat Veces que se reproduce el registro completo
+ *
+ * Reproduce los clculos grabados. La latencia de cada uno (el paso de sus
+ * entradas y calculate()) se anota en latency() y la suma de todas da
+ * seconds() y throughput(); la comparacin de las salidas queda fuera de la
+ * medida. Los conjuntos que el ejecutor no tiene se marcan como Missing y
+ * los clculos a los que les falta alguna entrada del ejecutor no se
+ * comparan (incomplete()).
+ */
+void TFuzzyReplay::run(TFuzzyExec& feExec, unsigned uiRepeat)
+{
+	std::vector<bool> v_known(m_vNames.size(), false);
+	std::vector<bool> v_complete(m_vSteps.size(), false);
+	uint64_t          ui_total = 0;
+
+	m_fhLatency.reset();
+	m_vDeviations.assign(m_vNames.size(), SOutputDeviation());
+	for(size_t i = 0; i < m_vNames.size(); ++i)
+	{
+		m_vDeviations[i].Set = m_vNames[i];
+		v_known[i]           = feExec.require(m_vNames[i]);
+	}
+	for(size_t k = 0; k < m_vSteps.size(); ++k)
+	{
+		for(uint32_t i = 0; i < m_vSteps[k].OutputCount; ++i)
+		{
+			uint32_t ui_set = m_vValues[m_vSteps[k].FirstOutput + i].Id;
+			m_vDeviations[ui_set].Missing = !v_known[ui_set];
+		}
+	}
+
+	//-- Entradas que necesita el ejecutor, por posicin en m_vNames (las que
+	//   no aparecen en el registro no las lleva ningn clculo)
+	std::vector<std::string> v_inputs = feExec.inputs();
+	std::vector<uint32_t>    v_needed;
+	std::vector<uint32_t>    v_seen(m_vNames.size(), 0);
+	bool                     b_absent = false;
+
+	for(size_t i = 0; i < v_inputs.size(); ++i)
+	{
+		size_t j = 0;
+
+		while(j < m_vNames.size() && m_vNames[j] != v_inputs[i])
+			++j;
+		if(j < m_vNames.size())
+			v_needed.push_back(uint32_t(j));
+		else
+			b_absent = true;
+	}
+	m_uiIncomplete = 0;
+	for(size_t k = 0; k < m_vSteps.size(); ++k)
+	{
+		const SReplayStep& rs_step = m_vSteps[k];
+
+		for(uint32_t i = 0; i < rs_step.InputCount; ++i)
+			v_seen[m_vValues[rs_step.FirstInput + i].Id] = uint32_t(k + 1);
+
+		v_complete[k] = !b_absent;
+		for(size_t i = 0; i < v_needed.size() && v_complete[k]; ++i)
+			v_complete[k] = v_seen[v_needed[i]] == k + 1;
+		if(!v_complete[k])
+			++m_uiIncomplete;
+	}
+
+	for(unsigned r = 0; r < uiRepeat; ++r)
+	{
+		for(size_t k = 0; k < m_vSteps.size(); ++k)
+		{
+			const SReplayStep& rs_step  = m_vSteps[k];
+			const SLogValue*   lv_value = &m_vValues[rs_step.FirstInput];
+			uint64_t           ui_begin = TFuzzyTrace::now();
+
+			for(uint32_t i = 0; i < rs_step.InputCount; ++i, ++lv_value)
+				feExec.input(m_vNames[lv_value->Id], lv_value->Value);
+			feExec.calculate();
+
+			uint64_t ui_time = TFuzzyTrace::now() - ui_begin;
+			m_fhLatency.add(ui_time);
+			ui_total += ui_time;
+
+			lv_value = &m_vValues[rs_step.FirstOutput];
+			for(uint32_t i = 0; i < rs_step.OutputCount && v_complete[k]; ++i, ++lv_value)
+			{
+				if(!v_known[lv_value->Id])
+					continue;
+
+				m_vDeviations[lv_value->Id].add(feExec.output(m_vNames[lv_value->Id]), lv_value->Value);
+			}
+		}
+	}
+
+	m_uiRuns   = uint64_t(uiRepeat) * m_vSteps.size();
+	m_dSeconds = double(ui_total) / 1.0E9;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Clculos por segundo en la ltima run() (0 si no se ha hecho).
+ */
+double TFuzzyReplay::throughput() const
+{
+	return m_dSeconds > 0.0 ? double(m_uiRuns) / m_dSeconds : 0.0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return La mayor desviacin de cualquier salida.
+ */
+double TFuzzyReplay::maxDeviation() const
+{
+	double d_max = 0.0;
+
+	for(size_t i = 0; i < m_vDeviations.size(); ++i)
+		d_max = m_vDeviations[i].Max > d_max ? m_vDeviations[i].Max : d_max;
+
+	return d_max;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return La desviacin media de todas las salidas comparadas.
+ */
+double TFuzzyReplay::meanDeviation() const
+{
+	double   d_sum    = 0.0;
+	uint64_t ui_count = 0;
+
+	for(size_t i = 0; i < m_vDeviations.size(); ++i)
+	{
+		d_sum    += m_vDeviations[i].Sum;
+		ui_count += m_vDeviations[i].Count;
+	}
+
+	return ui_count ? d_sum / double(ui_count) : 0.0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return El resultado de la ltima run() como texto: rendimiento,
+ * latencia, desviacin total y una fila por conjunto calculado.
+ */
+std::string TFuzzyReplay::text() const
+{
+	std::string str_ret;
+	char        c_line[192];
+
+	snprintf(c_line, sizeof(c_line), "replayed %llu calculations (%zu recorded, %llu dropped, %llu incomplete)\n",
+			 (unsigned long long)m_uiRuns, m_vSteps.size(), (unsigned long long)m_uiDropped,
+			 (unsigned long long)m_uiIncomplete);
+	str_ret += c_line;
+	if(!valid())
+		str_ret += "comparison not valid: the log lost calculations or lacks inputs\n";
+	snprintf(c_line, sizeof(c_line), "throughput %.0f calculations/s\n", throughput());
+	str_ret += c_line;
+	snprintf(c_line, sizeof(c_line),
+			 "latency (us): mean %.3f p50 %.3f p99 %.3f p999 %.3f max %.3f\n",
+			 m_fhLatency.mean() / 1.0E3, double(m_fhLatency.percentile(50.0)) / 1.0E3,
+			 double(m_fhLatency.percentile(99.0)) / 1.0E3, double(m_fhLatency.percentile(99.9)) / 1.0E3,
+			 double(m_fhLatency.max()) / 1.0E3);
+	str_ret += c_line;
+	snprintf(c_line, sizeof(c_line), "deviation: max %.9g mean %.9g\n", maxDeviation(), meanDeviation());
+	str_ret += c_line;
+
+	snprintf(c_line, sizeof(c_line), "%-24s %12s %16s %16s\n", "set", "compared", "max", "mean");
+	str_ret += c_line;
+	for(size_t i = 0; i < m_vDeviations.size(); ++i)
+	{
+		if(m_vDeviations[i].Missing || m_vDeviations[i].Count)
+			str_ret += m_vDeviations[i].text();
+	}
+
+	return str_ret;
+}
+//-----------------------------------------------------------------------------
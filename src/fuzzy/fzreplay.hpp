@@ -0,0 +1,152 @@
+/**
+ * \file fzreplay.hpp
+ *
+ *  Replay of execution logs. Feeds the inputs recorded by TFuzzyExec::logOpen()
+ *  back through an executor and measures throughput, latency and how far the
+ *  outputs move from the recorded ones.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZREPLAY_HPP__
+#define __FZREPLAY_HPP__
+//-----------------------------------------------------------------------------
+#include "fzexecution.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	double outputError(fuzzvar fvOut, fuzzvar fvRef);
+	//-------------------------------------------------------------------------
+
+	/** Desviacin de las salidas de un conjunto respecto a otras de referencia
+	 * (las grabadas o las de otro ejecutor) */
+	struct SOutputDeviation
+	{
+		/** Nombre del conjunto */
+		std::string Set;
+		/** Salidas comparadas */
+		uint64_t    Count;
+		/** Mayor diferencia absoluta y suma de todas ellas */
+		double      Max;
+		double      Sum;
+		/** true si el ejecutor no tiene el conjunto (no se compara) */
+		bool        Missing;
+
+		SOutputDeviation() : Count(0), Max(0.0), Sum(0.0), Missing(false) {}
+
+		inline double mean() const { return Count ? Sum / double(Count) : 0.0; }
+
+		double      add(fuzzvar fvOut, fuzzvar fvRef);
+		std::string text() const;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Reproduccin de un registro de ejecucin (TFuzzyLog).
+	 *
+	 * load() lee el registro a memoria, con los conjuntos ya traducidos a su
+	 * nombre, de manera que el mismo registro puede reproducirse con otra
+	 * versin del modelo o de la librera, ejecutando un modelo o una imagen.
+	 * run() pasa cada clculo grabado por el ejecutor (sus entradas y
+	 * calculate()), mide el tiempo de cada uno y compara el resultado de cada
+	 * conjunto calculado con el grabado.
+	 *
+	 * Cada clculo grabado lleva el valor de todas las entradas
+	 * (TFuzzyExec::logWrite()), por lo que no depende de los anteriores y el
+	 * ejecutor puede reutilizarse entre clculos y repeticiones. Un clculo
+	 * al que le falta alguna de las entradas que necesita el ejecutor
+	 * (TFuzzyExec::inputs()) se reproduce, pero sus salidas no se comparan:
+	 * se cuenta en incomplete(). Si hay alguno, o el registro perdi
+	 * clculos (dropped()), la comparacin no es vlida (valid()).
+	 */
+	class TFuzzyReplay
+	{
+	private:
+		/** Un clculo grabado: sus entradas y salidas en m_vValues */
+		struct SReplayStep
+		{
+			uint32_t FirstInput;
+			uint32_t InputCount;
+			uint32_t FirstOutput;
+			uint32_t OutputCount;
+		};
+
+		/** Nombres de los conjuntos del registro */
+		std::vector<std::string>      m_vNames;
+		/** Entradas y salidas de todos los clculos (Id: posicin en
+		 * m_vNames) */
+		std::vector<SLogValue>        m_vValues;
+		std::vector<SReplayStep>      m_vSteps;
+		uint64_t                      m_uiDropped;
+
+		TFuzzyHistogram               m_fhLatency;
+		std::vector<SOutputDeviation> m_vDeviations;
+		/** Clculos grabados sin todas las entradas del ejecutor */
+		uint64_t                      m_uiIncomplete;
+		uint64_t                      m_uiRuns;
+		double                        m_dSeconds;
+
+		TFuzzyReplay(const TFuzzyReplay&);
+		TFuzzyReplay& operator=(const TFuzzyReplay&);
+
+	public:
+		TFuzzyReplay();
+		virtual ~TFuzzyReplay();
+
+		/** Clculos grabados */
+		inline size_t   size()    const { return m_vSteps.size(); }
+		/** Clculos que el registro perdi al grabarse */
+		inline uint64_t dropped() const { return m_uiDropped;     }
+		/** Latencia de cada clculo reproducido (entradas y calculate()), en ns */
+		inline const TFuzzyHistogram& latency() const { return m_fhLatency; }
+		/** Desviacin de cada conjunto calculado */
+		inline const std::vector<SOutputDeviation>& deviations() const { return m_vDeviations; }
+		/** Clculos grabados a los que les faltan entradas en la ltima run() */
+		inline uint64_t incomplete() const { return m_uiIncomplete; }
+		/** Indica si la comparacin de la ltima run() es vlida: el registro
+		 * no perdi clculos y todos llevan las entradas del ejecutor */
+		inline bool     valid()      const { return !m_uiDropped && !m_uiIncomplete; }
+		/** Clculos reproducidos y segundos empleados en la ltima run() */
+		inline uint64_t runs()    const { return m_uiRuns;    }
+		inline double   seconds() const { return m_dSeconds;  }
+
+		void load(const std::string& strLog);
+		void run(TFuzzyExec& feExec, unsigned uiRepeat = 1);
+
+		double      throughput() const;
+		double      maxDeviation() const;
+		double      meanDeviation() const;
+		std::string text() const;
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZREPLAY_HPP__ */
+//-----------------------------------------------------------------------------
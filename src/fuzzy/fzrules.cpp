@@ -29,289 +29,874 @@
  */
 //-----------------------------------------------------------------------------
 #include "fzrules.hpp"
+#include <sstream>
+#include <thread>
+#include <algorithm>
 //-----------------------------------------------------------------------------
 using namespace nsFuzzy;
 //-----------------------------------------------------------------------------
+/** Reglas que analiza de una vez cada hilo de TFuzzyRules::addMany() */
+#define FL_RULES_BLOCK		256
+/** Mximo de antecedentes de una regla para buscar las reglas que la hacen
+ * redundante por sus subconjuntos (2^n bsquedas). Con ms antecedentes se
+ * compara con las reglas del mismo consecuente */
+#define FL_RULES_SUBSETS	10
+//-----------------------------------------------------------------------------
+
+/**
+ * Combina un valor con un hash.
+ */
+static inline void hashCombine(size_t& szHash, size_t szValue)
+{
+	szHash ^= szValue + 0x9e3779b9 + (szHash << 6) + (szHash >> 2);
+}
+//-----------------------------------------------------------------------------
 
 /**
+ * \param [in] uiConsequent Valor consecuente de la regla
+ * \param [in] vKeys        Antecedentes de la regla (ver TFuzzyRules::key())
  *
+ * \return Hash de la forma cannica de una regla.
  */
-SRuleAtom::SRuleAtom(TFuzzyVal* fVal)
+static size_t ruleHash(uint32_t uiConsequent, const std::vector<uint64_t>& vKeys)
 {
-	Next  = NULL;
-	Value = fVal;
-	Modifiers.clear();
+	size_t sz_hash = 0;
+
+	hashCombine(sz_hash, size_t(uiConsequent));
+	for(size_t i = 0; i < vKeys.size(); ++i)
+	{
+		hashCombine(sz_hash, size_t(vKeys[i]));
+		hashCombine(sz_hash, size_t(vKeys[i] >> 32));
+	}
+
+	return sz_hash;
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \return Texto con la posicin de un error de sintaxis.
+ */
+static std::string location(size_t szRule, size_t szColumn)
+{
+	std::stringstream ss;
+	ss << " (regla " << szRule << ", columna " << szColumn << ")";
+
+	return ss.str();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] What     Qu ha producido el error
+ * \param [in] strWhy   Por qu se ha producido
+ * \param [in] szRule   Posicin de la regla en la lista de reglas
+ * \param [in] szColumn Columna (desde 1) del texto de la regla
+ * \param [in] uiLine   Lnea del cdigo donde se ha producido
+ * \param [in] cFile    Archivo del cdigo donde se ha producido
  *
+ * La posicin se aade tambin al 'por qu', para que aparezca en message().
  */
-SRuleAtom::~SRuleAtom()
+TFuzzyRuleError::TFuzzyRuleError(const char* What, const std::string& strWhy, size_t szRule,
+		size_t szColumn, unsigned int uiLine, const char* cFile)
+	: TFuzzyError(What, (strWhy + location(szRule, szColumn)).c_str(), uiLine, cFile)
 {
-	Modifiers.clear();
-	Value = NULL;
-	if(Next)
-		delete Next;
-	Next  = NULL;
+	m_szRule   = szRule;
+	m_szColumn = szColumn;
 }
 //-----------------------------------------------------------------------------
 
+/**
+ *
+ */
+SFuzzyRule TFuzzyRules::invalid = { 0, 0, FL_RULE_NOTEXT };
+//-----------------------------------------------------------------------------
 
+/**
+ *
+ */
+TFuzzyRules::TFuzzyRules(TFuzzySets& fsSets) : TFuzzyBase(FL_ID_RUL), m_fsSets(fsSets)
+{
+	m_bKeepText       = false;
+	m_uiRevision      = 0;
+	m_uiAtomsRevision = 0;
+	name("rules");
+}
+//-----------------------------------------------------------------------------
 
+/**
+ *
+ */
+TFuzzyRules::~TFuzzyRules()
+{
+	clear();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] vMods Modificadores, en el orden en que se aplican
+ *
+ * \return Modificadores empaquetados (ver SRuleAtom). Se ignoran los vmNone
+ * y los que superan FL_MOD_MAX.
+ */
+uint32_t TFuzzyRules::pack(const std::vector<TValModifier>& vMods)
+{
+	uint32_t ui_mods = 0;
+	int      i_bits  = 0;
 
+	for(size_t i = 0; i < vMods.size() && i_bits < FL_MOD_BITS * FL_MOD_MAX; ++i)
+	{
+		if(vMods[i] != vmNone)
+		{
+			ui_mods |= uint32_t(vMods[i]) << i_bits;
+			i_bits  += FL_MOD_BITS;
+		}
+	}
 
+	return ui_mods;
+}
+//-----------------------------------------------------------------------------
 
+/**
+ * \param [in]  uiMods Modificadores empaquetados
+ * \param [out] vMods  Modificadores, en el orden en que se aplican
+ */
+void TFuzzyRules::unpack(uint32_t uiMods, std::vector<TValModifier>& vMods)
+{
+	vMods.clear();
+	for(; uiMods; uiMods >>= FL_MOD_BITS)
+		vMods.push_back(TValModifier(uiMods & FL_MOD_MASK));
+}
+//-----------------------------------------------------------------------------
 
 /**
+ * \param [in] cText Texto del modificador
+ * \param [in] szLen Longitud del texto
  *
+ * \return Modificador correspondiente al texto (ya en minsculas y sin tener
+ * en cuenta los espacios de los extremos), vmNone si no es ninguno.
  */
-bool SFuzzyRule::operator==(SFuzzyRule& cmp)
+TValModifier TFuzzyRules::modifier(const char* cText, size_t szLen)
 {
-	return this == &cmp ? true : String == cmp.String;
+	while(szLen > 0 && *cText == ' ')
+	{
+		++cText;
+		--szLen;
+	}
+	while(szLen > 0 && cText[szLen - 1] == ' ')
+		--szLen;
+
+	std::string str_mod(cText, szLen);
+
+	if(str_mod == "very" || str_mod == "muy")
+		return vmVery;
+	if(str_mod == "slightly" || str_mod == "little" || str_mod == "few"
+			|| str_mod == "ligeramente" || str_mod == "algo")
+		return vmSlightly;
+	if(str_mod == "not" || str_mod == "no")
+		return vmNot;
+
+	return vmNone;
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in]  strRule Texto de la regla, en minsculas
+ * \param [in]  szBegin Comienzo del tomo en strRule
+ * \param [in]  szEnd   Fin del tomo en strRule
+ * \param [in]  szRule  Posicin de la regla (para los errores)
+ * \param [out] faAtom  Valor y modificadores del tomo
+ *
+ * Analiza un tomo con el formato set.[mod.[mod...]]valor. Lo que precede al
+ * primer punto es el conjunto y lo que sigue al ltimo el valor; los nombres
+ * se buscan por smbolo sin copiar el texto. Los modificadores desconocidos
+ * se ignoran.
+ */
+void TFuzzyRules::parseAtom(const std::string& strRule, size_t szBegin, size_t szEnd,
+		size_t szRule, fuzzatom& faAtom)
+{
+	const char* c_rule  = strRule.data();
+	size_t      sz_dot  = strRule.find('.', szBegin);
+	size_t      sz_last = strRule.rfind('.', szEnd - 1);
+	TFuzzySet*  fs_set  = NULL;
+	int         i_bits  = 0;
+
+	if(sz_dot == std::string::npos || sz_dot >= szEnd)
+		throw TFuzzyRuleError("parseRule", "No se ha encontrado el operador '.'",
+				szRule, szBegin + 1, __LINE__, __FILE__);
+
+	fs_set = m_fsSets.bySymbol(TFuzzySymbols::find(c_rule + szBegin, sz_dot - szBegin));
+	if(!fs_set)
+		throw TFuzzyRuleError("parseRule",
+				"No existe el set " + strRule.substr(szBegin, sz_dot - szBegin),
+				szRule, szBegin + 1, __LINE__, __FILE__);
+
+	faAtom.first = fs_set->bySymbol(TFuzzySymbols::find(c_rule + sz_last + 1, szEnd - sz_last - 1));
+	if(!faAtom.first)
+		throw TFuzzyRuleError("parseRule",
+				"No existe el valor " + strRule.substr(sz_last + 1, szEnd - sz_last - 1)
+				+ " en el set " + strRule.substr(szBegin, sz_dot - szBegin),
+				szRule, sz_last + 2, __LINE__, __FILE__);
+
+	faAtom.second = 0;
+	for(size_t pos = sz_dot + 1, end; pos < sz_last; pos = end + 1)
+	{
+		end = strRule.find('.', pos);
+		TValModifier vm_mod = modifier(c_rule + pos, end - pos);
+		if(vm_mod == vmNone)
+			continue;
+		if(i_bits == FL_MOD_BITS * FL_MOD_MAX)
+			throw TFuzzyRuleError("parseRule", "Demasiados modificadores",
+					szRule, pos + 1, __LINE__, __FILE__);
+		faAtom.second |= uint32_t(vm_mod) << i_bits;
+		i_bits        += FL_MOD_BITS;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  strRule Texto de la regla
+ * \param [in]  szRule  Posicin que ocupar la regla (para los errores)
+ * \param [out] vAtoms  tomos de la regla, el ltimo el consecuente
+ * \param [out] strText Texto de la regla en minsculas y sin los espacios de
+ *                      los extremos
+ *
+ * Analiza una regla con el formato
  *
+ * 		if <tomo> [and <tomo> [...]] then <tomo>
+ *
+ * en una sola pasada. El texto se divide en palabras separadas por espacios;
+ * las palabras "and" y "then" cierran el tomo en curso, que se resuelve en
+ * ese momento (parseAtom()).
+ *
+ * En caso de error lanza TFuzzyRuleError con la columna de strRule donde se
+ * ha detectado.
  */
-bool SFuzzyRule::operator!=(SFuzzyRule& cmp)
+void TFuzzyRules::parseRule(const std::string& strRule, size_t szRule,
+		std::vector<fuzzatom>& vAtoms, std::string& strText)
 {
-	return this != &cmp ? true : String != cmp.String;
+	std::string str_rule = strRule;
+	fuzzatom    fa_atom;
+	size_t      sz_len   = str_rule.size();
+	size_t      sz_first = std::string::npos;
+	size_t      sz_atom  = std::string::npos;
+	size_t      sz_end   = 0;
+	size_t      sz_word, pos = 0;
+	bool        b_if     = false;
+	bool        b_then   = false;
+	bool        b_last   = false;
+
+	toLower(str_rule);
+	vAtoms.clear();
+
+	while(!b_last)
+	{
+		//-- Siguiente palabra [sz_word, pos)
+		while(pos < sz_len && str_rule[pos] == ' ')
+			++pos;
+		sz_word = pos;
+		while(pos < sz_len && str_rule[pos] != ' ')
+			++pos;
+
+		if(sz_first == std::string::npos)
+			sz_first = sz_word;
+		b_last = sz_word == sz_len;
+
+		if(!b_if)
+		{
+			if(pos - sz_word != 2 || str_rule.compare(sz_word, 2, "if") != 0)
+				throw TFuzzyRuleError("parseRule", "No se encuentra la clausula 'if'",
+						szRule, sz_word + 1, __LINE__, __FILE__);
+			b_if = true;
+			continue;
+		}
+
+		bool b_and  = pos - sz_word == 3 && str_rule.compare(sz_word, 3, "and") == 0;
+		bool b_thn  = pos - sz_word == 4 && str_rule.compare(sz_word, 4, "then") == 0;
+
+		if(!b_and && !b_thn && !b_last)
+		{
+			//-- Una palabra ms del tomo en curso
+			if(sz_atom == std::string::npos)
+				sz_atom = sz_word;
+			sz_end = pos;
+			continue;
+		}
+
+		if(b_last && !b_then)
+			throw TFuzzyRuleError("parseRule", "No se encuentra la clausula 'then'",
+					szRule, sz_len + 1, __LINE__, __FILE__);
+		if(sz_atom == std::string::npos)
+			throw TFuzzyRuleError("parseRule", "Falta un tomo",
+					szRule, sz_word + 1, __LINE__, __FILE__);
+		if(b_then && !b_last)
+			throw TFuzzyRuleError("parseRule", "Slo puede haber un consecuente",
+					szRule, sz_word + 1, __LINE__, __FILE__);
+
+		//-- Fin del tomo en curso
+		parseAtom(str_rule, sz_atom, sz_end, szRule, fa_atom);
+		vAtoms.push_back(fa_atom);
+
+		sz_atom = std::string::npos;
+		b_then  = b_thn;
+	}
+
+	strText = str_rule.substr(sz_first, sz_end - sz_first);
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in] fvVal Valor
+ *
+ * \return ndice del valor en la tabla de valores de las reglas. Si no
+ * estaba, se aade.
+ */
+uint32_t TFuzzyRules::valueIndex(TFuzzyVal* fvVal)
+{
+	std::unordered_map<TFuzzyVal*, uint32_t>::iterator found = m_mValues.find(fvVal);
+
+	if(found != m_mValues.end())
+		return found->second;
 
+	m_vValues.push_back(fvVal);
+	m_mValues[fvVal] = uint32_t(m_vValues.size() - 1);
+
+	return uint32_t(m_vValues.size() - 1);
+}
+//-----------------------------------------------------------------------------
 
+/**
+ * \param [in]  szRule Posicin de la regla
+ * \param [out] vKeys  Antecedentes de la regla, ordenados y sin repetir. Cada
+ *                     uno es su valor (32 bits altos) y sus modificadores
+ *
+ * \return Hash de la forma cannica de la regla (ver SFuzzyRule).
+ */
+size_t TFuzzyRules::key(size_t szRule, std::vector<uint64_t>& vKeys)
+{
+	const SFuzzyRule& fr_rule = m_vRules[szRule];
+	const SRuleAtom*  ra_atom = &m_vAtoms[fr_rule.FirstAtom];
 
+	vKeys.clear();
+	for(uint32_t i = 0; i + 1 < fr_rule.AtomCount; ++i)
+		vKeys.push_back((uint64_t(ra_atom[i].Value) << 32) | ra_atom[i].Modifiers);
+	std::sort(vKeys.begin(), vKeys.end());
+	vKeys.erase(std::unique(vKeys.begin(), vKeys.end()), vKeys.end());
 
+	return ruleHash(ra_atom[fr_rule.AtomCount - 1].Value, vKeys);
+}
+//-----------------------------------------------------------------------------
 
 /**
+ * \param [in] szRule  Posicin de una regla
+ * \param [in] szOther Posicin de la otra regla
+ *
+ * Compara las formas cannicas de las reglas (ver SFuzzyRule), de manera
+ * que dos reglas que slo difieren en espacios, maysculas o el orden de sus
+ * antecedentes son iguales.
  *
+ * \return true si las dos reglas son iguales.
  */
-SFuzzyRule TFuzzyRules::invalid(NULL);
+bool TFuzzyRules::equals(size_t szRule, size_t szOther)
+{
+	std::vector<uint64_t> v_rule, v_other;
+
+	if(szRule >= m_vRules.size() || szOther >= m_vRules.size())
+		return false;
+	if(szRule == szOther)
+		return true;
+
+	key(szRule, v_rule);
+	key(szOther, v_other);
+
+	return v_rule == v_other
+		&& m_vAtoms[m_vRules[szRule].FirstAtom + m_vRules[szRule].AtomCount - 1].Value
+		== m_vAtoms[m_vRules[szOther].FirstAtom + m_vRules[szOther].AtomCount - 1].Value;
+}
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] szRule Posicin de la regla
+ * \param [in] szHash Hash de su forma cannica
  *
+ * \return Posicin de otra regla igual a la de szRule, std::string::npos si
+ * no hay ninguna.
  */
-TFuzzyRules::TFuzzyRules(TFuzzySets& fsSets) : TFuzzyBase(FL_ID_RUL), m_fsSets(fsSets)
+size_t TFuzzyRules::find(size_t szRule, size_t szHash)
 {
-	m_strName = "rules";
+	typedef std::unordered_multimap<size_t, size_t>::iterator keyiter;
+
+	std::pair<keyiter, keyiter> range = m_mKeys.equal_range(szHash);
+
+	for(keyiter iter = range.first; iter != range.second; ++iter)
+	{
+		if(iter->second != szRule && equals(iter->second, szRule))
+			return iter->second;
+	}
+
+	return std::string::npos;
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] strRule Texto de la regla
  *
+ * \return Posicin de la regla igual a strRule, std::string::npos si no hay
+ * ninguna. Si strRule no es correcta lanza TFuzzyRuleError.
  */
-TFuzzyRules::~TFuzzyRules()
+size_t TFuzzyRules::find(const std::string& strRule)
 {
-	clear();
+	std::vector<fuzzatom> v_atoms;
+	std::vector<uint64_t> v_keys;
+	std::string           str_text;
+	size_t                sz_found;
+
+	parseRule(strRule, m_vRules.size(), v_atoms, str_text);
+
+	//-- La regla se coloca provisionalmente al final para compararla
+	SFuzzyRule fr_rule = { uint32_t(m_vAtoms.size()), uint32_t(v_atoms.size()), FL_RULE_NOTEXT };
+	for(size_t i = 0; i < v_atoms.size(); ++i)
+	{
+		SRuleAtom ra_atom = { valueIndex(v_atoms[i].first), v_atoms[i].second };
+		m_vAtoms.push_back(ra_atom);
+	}
+	m_vRules.push_back(fr_rule);
+
+	sz_found = find(m_vRules.size() - 1, key(m_vRules.size() - 1, v_keys));
+
+	m_vRules.pop_back();
+	m_vAtoms.resize(fr_rule.FirstAtom);
+
+	return sz_found;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strRule Texto de la regla
+ *
+ * Analiza la regla y la aade al final de la lista, si no hay ya una igual
+ * (ver add(const std::vector<fuzzatom>&, const std::string&)). Si la regla
+ * no es correcta lanza TFuzzyRuleError.
+ *
+ * \return false si ya exista una regla igual.
+ */
+bool TFuzzyRules::add(std::string strRule)
+{
+	std::vector<fuzzatom> v_atoms;
+	std::string           str_text;
+
+	parseRule(strRule, m_vRules.size(), v_atoms, str_text);
+
+	return add(v_atoms, str_text);
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] vAtoms  tomos de la regla (valor y modificadores
+ *                     empaquetados), el ltimo el consecuente
+ * \param [in] strText Texto de la regla (slo se guarda con keepText(); si
+ *                     est vaco, se reconstruye a partir de los tomos)
  *
+ * Aade una regla cuyos tomos ya estn resueltos (por ejemplo, al cargar un
+ * modelo binario), sin analizar su texto.
+ *
+ * Si ya existe una regla igual (ver SFuzzyRule) la nueva no aportara nada a
+ * la ejecucin, as que se descarta. La bsqueda usa el ndice de formas
+ * cannicas, por lo que su coste no depende del nmero de reglas.
+ *
+ * \return false si ya exista una regla igual o la regla no tiene al menos un
+ * antecedente y el consecuente.
  */
-std::string TFuzzyRules::splitModsValue(std::string& strValue)
+bool TFuzzyRules::add(const std::vector<fuzzatom>& vAtoms, const std::string& strText)
 {
-	std::string str_mods = "";
+	std::vector<uint64_t> v_keys;
+	SFuzzyRule            fr_rule = { uint32_t(m_vAtoms.size()), uint32_t(vAtoms.size()), FL_RULE_NOTEXT };
+	size_t                sz_hash;
+
+	if(vAtoms.size() < 2)
+		return false;
 
-	size_t pos = strValue.rfind(".");
-	if(pos != std::string::npos)
+	for(size_t i = 0; i < vAtoms.size(); ++i)
 	{
-		str_mods = strValue.substr(0, pos);
-		str_mods = trim(toLower(str_mods));
-		strValue = strValue.substr(pos + 1);
+		SRuleAtom ra_atom = { valueIndex(vAtoms[i].first), vAtoms[i].second };
+		m_vAtoms.push_back(ra_atom);
 	}
+	m_vRules.push_back(fr_rule);
 
-	return str_mods;
+	sz_hash = key(m_vRules.size() - 1, v_keys);
+	if(find(m_vRules.size() - 1, sz_hash) != std::string::npos)
+	{
+		m_vRules.pop_back();
+		m_vAtoms.resize(fr_rule.FirstAtom);
+		return false;
+	}
+
+	if(m_bKeepText && !strText.empty())
+	{
+		m_vRules.back().Text = uint32_t(m_strTexts.size());
+		m_strTexts.append(strText.c_str(), strText.size() + 1);
+	}
+	m_mKeys.insert(std::make_pair(sz_hash, m_vRules.size() - 1));
+
+	return true;
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * Trabajo compartido por los hilos de TFuzzyRules::addMany()
+ */
+struct nsFuzzy::SRulesParse
+{
+	/** Reglas a analizar */
+	const std::vector<std::string>*     Rules;
+	/** Posicin en la lista de la primera regla */
+	size_t                              First;
+	/** tomos de cada regla */
+	std::vector<std::vector<fuzzatom> > Atoms;
+	/** Texto normalizado de cada regla */
+	std::vector<std::string>            Texts;
+	/** Error de cada regla que ha fallado (NULL si no ha fallado) */
+	std::vector<TFuzzyRuleError*>       Errors;
+	/** Siguiente bloque de reglas a analizar */
+	std::atomic<size_t>                 Next;
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] srParse Trabajo compartido
  *
+ * Cuerpo de cada hilo de addMany(): toma bloques de FL_RULES_BLOCK reglas
+ * hasta que no queda ninguno. Analizar una regla slo consulta los conjuntos
+ * y la tabla de smbolos, por lo que varios hilos pueden hacerlo a la vez
+ * mientras nadie modifique el modelo.
  */
-void TFuzzyRules::setModifiers(SRuleAtom* flLink, std::string& strMods)
+void TFuzzyRules::parseRules(SRulesParse* srParse)
 {
-	std::string str_aux;
-	size_t      pos;
+	size_t sz_size = srParse->Rules->size();
 
-	while(!strMods.empty())
+	for(size_t i = srParse->Next.fetch_add(FL_RULES_BLOCK); i < sz_size;
+			i = srParse->Next.fetch_add(FL_RULES_BLOCK))
 	{
-		pos = strMods.find(".");
-		if(pos == std::string::npos)
-			pos = strMods.size();
-		str_aux = strMods.substr(0, pos);
-		str_aux = trim(toLower(str_aux));
-		if(pos == strMods.size())
-			strMods = "";
-		else
-			strMods = strMods.substr(pos + 1);
-
-		if(str_aux == "very" || str_aux == "muy")
-			flLink->Modifiers.push_back(vmVery);
-		else if(str_aux == "slightly" || str_aux == "little" || str_aux == "few"
-				|| str_aux == "ligeramente" || str_aux == "algo")
-			flLink->Modifiers.push_back(vmSlightly);
-		else if(str_aux == "not" || str_aux == "no")
-			flLink->Modifiers.push_back(vmNot);
+		for(size_t j = i; j < i + FL_RULES_BLOCK && j < sz_size; ++j)
+		{
+			try
+			{
+				parseRule((*srParse->Rules)[j], srParse->First + j,
+						  srParse->Atoms[j], srParse->Texts[j]);
+			}
+			catch(TFuzzyRuleError& e)
+			{
+				srParse->Errors[j] = new TFuzzyRuleError(e);
+			}
+			catch(std::exception& e)
+			{
+				srParse->Errors[j] = new TFuzzyRuleError("parseRule", e.what(),
+						srParse->First + j, 0, __LINE__, __FILE__);
+			}
+		}
 	}
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] vRules    Textos de las reglas
+ * \param [in] uiThreads Nmero de hilos a usar (0: uno por ncleo)
  *
+ * Analiza las reglas repartindolas entre varios hilos (incluido el que
+ * llama) y las aade al final de la lista en el orden de vRules. No se crean
+ * ms hilos que bloques de FL_RULES_BLOCK reglas, por lo que con pocas reglas
+ * todo se hace en el hilo que llama.
+ *
+ * Las reglas se aaden todas o ninguna: si alguna falla se lanza el
+ * TFuzzyRuleError de la primera que ha fallado (en el orden de vRules). Las
+ * reglas iguales a otras ya existentes se descartan, como en add().
+ *
+ * \return Nmero de reglas aadidas.
  */
-SFuzzyRule* TFuzzyRules::parseRule(std::string strRule)
+size_t TFuzzyRules::addMany(const std::vector<std::string>& vRules, unsigned int uiThreads)
 {
-	toLower(strRule);
+	std::vector<std::thread> v_threads;
+	SRulesParse              sr_parse;
+	size_t                   sz_blocks = (vRules.size() + FL_RULES_BLOCK - 1) / FL_RULES_BLOCK;
+	size_t                   sz_added  = 0;
+
+	sr_parse.Rules = &vRules;
+	sr_parse.First = m_vRules.size();
+	sr_parse.Atoms.resize(vRules.size());
+	sr_parse.Texts.resize(vRules.size());
+	sr_parse.Errors.assign(vRules.size(), (TFuzzyRuleError*)NULL);
+	sr_parse.Next  = 0;
+
+	if(uiThreads == 0)
+		uiThreads = std::thread::hardware_concurrency();
+	if(uiThreads > sz_blocks)
+		uiThreads = (unsigned int)sz_blocks;
+
+	//-- Si no se puede crear algn hilo, el trabajo se reparte entre los dems
+	try
+	{
+		for(unsigned int i = 1; i < uiThreads; ++i)
+			v_threads.push_back(std::thread(&TFuzzyRules::parseRules, this, &sr_parse));
+	}
+	catch(std::exception&)
+	{
+	}
+	parseRules(&sr_parse);
+	for(size_t i = 0; i < v_threads.size(); ++i)
+		v_threads[i].join();
 
-	if(strRule.find("if ") == std::string::npos)
+	for(size_t i = 0; i < vRules.size(); ++i)
 	{
-		throw TFuzzyError("parseRule", "No se encuentra la clausula 'if'",
-							__LINE__, __FILE__);
+		if(sr_parse.Errors[i])
+		{
+			TFuzzyRuleError fr_error(*sr_parse.Errors[i]);
+
+			for(size_t j = 0; j < vRules.size(); ++j)
+				delete sr_parse.Errors[j];
+			throw fr_error;
+		}
 	}
-	if(strRule.find(" then ") == std::string::npos)
+
+	m_vRules.reserve(m_vRules.size() + vRules.size());
+	for(size_t i = 0; i < vRules.size(); ++i)
 	{
-		throw TFuzzyError("parseRule", "No se encuentra la clausula 'then'",
-							__LINE__, __FILE__);
+		if(add(sr_parse.Atoms[i], sr_parse.Texts[i]))
+			++sz_added;
 	}
 
-	std::string  str_rule = strRule;
-	SFuzzyRule*  fr_rule  = NULL;
-	size_t       pos      = strRule.find("if ");
-    SRuleAtom  *f_link   = NULL, *f_first = NULL;
-    std::string  str_cmd, str_val, str_set;
-    std::string  str_mods;
-
-    strRule = strRule.substr(pos + 3);
-    trim(strRule);
-
-    pos     = strRule.find(" and ") != std::string::npos
-    		? strRule.find(" and ") : strRule.find(" then ");
-
-    try
-    {
-    	while(!strRule.empty())
-    	{
-    		//-- Obtiene el 'comando' (set.[mod.]value) y prepara strRule para
-    		//   la siguiente pasada a este while
-    		str_cmd = strRule.substr(0, pos);
-    		trim(str_cmd);
-			if(pos == strRule.size())
-				pos -= 5;
-            strRule = strRule.substr(pos + 5);
-            trim(strRule);
-
-            //-- Al menos debe haber un punto (set.value)... si no hay ninguno,
-            //   error en la regla
-            pos = str_cmd.find(".");
-            if(pos == std::string::npos)
-            	throw TFuzzyError("parseRule", "No se ha encontrado el operador '.'",
-            					__LINE__, __FILE__);
-
-            //-- Obtiene el set
-            str_set = str_cmd.substr(0, pos);
-           	if(m_fsSets[str_set] == invalidObject())
-   			{
-   				std::string str_why = "No existe el set " + str_set;
-           		throw TFuzzyError("parseRule", str_why.c_str(), __LINE__, __FILE__);
-   			}
-
-           	//-- Obtiene el valor y busca un modificador ([mod.]value)
-           	str_val  = str_cmd.substr(pos + 1);
-           	str_mods = splitModsValue(str_val);
-   			if(m_fsSets[str_set][str_val] == invalidObject())
-   			{
-   				std::string str_why = "No existe el valor " + str_val + "en el set " + str_set;
-   				throw TFuzzyError("parseRule", str_why.c_str(), __LINE__, __FILE__);
-   			}
-
-   			if(f_first)
-   			{
-   				f_link->Next = new SRuleAtom(&m_fsSets[str_set][str_val]);
-   				f_link           = f_link->Next;
-   			}
-   			else
-   			{
-   				fr_rule = new SFuzzyRule(&m_fsSets[str_set][str_val]);
-   				fr_rule->String    = str_rule;
-   				f_first          = fr_rule->Links;
-   				f_link           = f_first;
-   			}
-   			//-- Asigna los modificadores al valor
-			setModifiers(f_link, str_mods);
-
-   		    pos = strRule.find(" and ") != std::string::npos
-   		    	? strRule.find(" and ") : strRule.find(" then ");
-
-   		    if(pos == std::string::npos)
-   		    	pos = strRule.size();
-    	}
-    }
-    catch(TFuzzyError& e)
-    {
-    	if(fr_rule)
-    		delete fr_rule;
-    	fr_rule = NULL;
-
-    	throw e;
-    }
-    catch(...)
-    {
-    	if(fr_rule)
-    		delete fr_rule;
-    	fr_rule = NULL;
-
-    	throw TFuzzyError("parseRule", "Error sin especificar", __LINE__, __FILE__);
-    }
-
-    return fr_rule;
+	return sz_added;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Reconstruye el ndice de formas cannicas.
+ */
+void TFuzzyRules::index()
+{
+	std::vector<uint64_t> v_keys;
+
+	m_mKeys.clear();
+	for(size_t i = 0; i < m_vRules.size(); ++i)
+		m_mKeys.insert(std::make_pair(key(i, v_keys), i));
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] vDelete Reglas a eliminar
  *
+ * Elimina varias reglas de una vez, dejando los almacenes contiguos. La
+ * tabla de valores se reconstruye con los que usan las reglas que quedan,
+ * de manera que no guarda valores que despus puedan eliminarse.
  */
-void TFuzzyRules::add(std::string strRule)
+void TFuzzyRules::compact(const std::vector<bool>& vDelete)
 {
-	trim(strRule);
+	std::vector<SFuzzyRule> v_rules;
+	std::vector<SRuleAtom>  v_atoms;
+	std::vector<TFuzzyVal*> v_values;
+	std::string             str_texts;
+
+	v_rules.reserve(m_vRules.size());
+	v_atoms.reserve(m_vAtoms.size());
+	for(size_t i = 0; i < m_vRules.size(); ++i)
+	{
+		SFuzzyRule fr_rule = m_vRules[i];
+
+		if(vDelete[i])
+			continue;
+
+		v_atoms.insert(v_atoms.end(), m_vAtoms.begin() + fr_rule.FirstAtom,
+					   m_vAtoms.begin() + fr_rule.FirstAtom + fr_rule.AtomCount);
+		fr_rule.FirstAtom = uint32_t(v_atoms.size() - fr_rule.AtomCount);
+		if(fr_rule.Text != FL_RULE_NOTEXT)
+		{
+			std::string str_text(m_strTexts.c_str() + fr_rule.Text);
+			fr_rule.Text = uint32_t(str_texts.size());
+			str_texts.append(str_text.c_str(), str_text.size() + 1);
+		}
+		v_rules.push_back(fr_rule);
+	}
+
+	m_vRules.swap(v_rules);
+	m_vAtoms.swap(v_atoms);
+	m_strTexts.swap(str_texts);
+	++m_uiRevision;
+	++m_uiAtomsRevision;
 
-	SFuzzyRule* fr_rule = parseRule(strRule);
-	if(fr_rule)
-		m_vRules.push_back(fr_rule);
+	v_values.swap(m_vValues);
+	m_mValues.clear();
+	for(size_t i = 0; i < m_vAtoms.size(); ++i)
+		m_vAtoms[i].Value = valueIndex(v_values[m_vAtoms[i].Value]);
+
+	index();
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * Busca las reglas redundantes: una regla es redundante si hay otra con el
+ * mismo consecuente cuyos antecedentes son un subconjunto de los suyos. El
+ * mnimo de sus antecedentes nunca supera al de la otra, as que no cambia
+ * el mximo que se aplica al consecuente.
+ *
+ * Para cada regla se buscan en el ndice de formas cannicas todos los
+ * subconjuntos de sus antecedentes (hasta FL_RULES_SUBSETS antecedentes; con
+ * ms se compara con las reglas del mismo consecuente).
  *
+ * \return Pares (regla redundante, regla que la hace redundante), en el
+ * orden de las reglas.
  */
-void TFuzzyRules::del(size_t szIndex)
+std::vector<std::pair<size_t, size_t> > TFuzzyRules::subsumed()
 {
-    if(szIndex >= 0 && szIndex < m_vRules.size())
-    {
-    	std::vector<SFuzzyRule*>::iterator itfl = m_vRules.begin();
-    	size_t sz_ndx = 0;
+	typedef std::unordered_multimap<size_t, size_t>::iterator keyiter;
 
-    	for(; sz_ndx < szIndex; ++itfl, ++sz_ndx);
+	std::vector<std::pair<size_t, size_t> >            v_subsumed;
+	std::vector<std::vector<uint64_t> >                v_canon(m_vRules.size());
+	std::vector<uint32_t>                              v_cons(m_vRules.size());
+	std::unordered_map<uint32_t, std::vector<size_t> > m_groups;
+	std::vector<uint64_t>                              v_subset;
 
-    	delete m_vRules[sz_ndx];
-    	m_vRules.erase(itfl);
-    }
+	for(size_t i = 0; i < m_vRules.size(); ++i)
+	{
+		key(i, v_canon[i]);
+		v_cons[i] = m_vAtoms[m_vRules[i].FirstAtom + m_vRules[i].AtomCount - 1].Value;
+		m_groups[v_cons[i]].push_back(i);
+	}
+
+	for(size_t i = 0; i < m_vRules.size(); ++i)
+	{
+		std::vector<uint64_t>& v_keys = v_canon[i];
+		size_t                 sz_by  = std::string::npos;
+
+		if(v_keys.size() <= FL_RULES_SUBSETS)
+		{
+			//-- Subconjuntos propios y no vacos de los antecedentes
+			for(size_t mask = 1; mask + 1 < (size_t(1) << v_keys.size())
+					&& sz_by == std::string::npos; ++mask)
+			{
+				v_subset.clear();
+				for(size_t b = 0; b < v_keys.size(); ++b)
+				{
+					if(mask & (size_t(1) << b))
+						v_subset.push_back(v_keys[b]);
+				}
+
+				std::pair<keyiter, keyiter> range = m_mKeys.equal_range(ruleHash(v_cons[i], v_subset));
+				for(keyiter iter = range.first; iter != range.second; ++iter)
+				{
+					size_t j = iter->second;
+					if(j != i && v_cons[j] == v_cons[i] && v_canon[j] == v_subset)
+					{
+						sz_by = j;
+						break;
+					}
+				}
+			}
+		}
+		else
+		{
+			std::vector<size_t>& v_group = m_groups[v_cons[i]];
+			for(size_t k = 0; k < v_group.size() && sz_by == std::string::npos; ++k)
+			{
+				size_t j = v_group[k];
+				if(j != i && v_canon[j].size() < v_keys.size()
+						&& std::includes(v_keys.begin(), v_keys.end(),
+										 v_canon[j].begin(), v_canon[j].end()))
+					sz_by = j;
+			}
+		}
+
+		if(sz_by != std::string::npos)
+			v_subsumed.push_back(std::make_pair(i, sz_by));
+	}
+
+	return v_subsumed;
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * Elimina las reglas redundantes (ver subsumed()), de manera que la
+ * ejecucin evala el menor nmero de reglas con el mismo resultado. Cada
+ * regla eliminada lo es por otra ms general que se conserva (o que, a su
+ * vez, ha sido eliminada por otra an ms general).
+ *
+ * Las reglas cambian de posicin, por lo que los TFuzzyExec que usen el
+ * modelo deben volver a asignarlo (TFuzzyExec::model()).
  *
+ * \return Nmero de reglas eliminadas.
  */
-void TFuzzyRules::clear()
+size_t TFuzzyRules::pruneSubsumed()
+{
+	std::vector<std::pair<size_t, size_t> > v_subsumed = subsumed();
+	std::vector<bool>                       v_del(m_vRules.size(), false);
+
+	if(v_subsumed.empty())
+		return 0;
+
+	for(size_t i = 0; i < v_subsumed.size(); ++i)
+		v_del[v_subsumed[i].first] = true;
+	compact(v_del);
+
+	return v_subsumed.size();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+void TFuzzyRules::del(size_t szIndex)
 {
-	while(!m_vRules.empty())
+	if(szIndex < m_vRules.size())
 	{
-		delete m_vRules.back();
-		m_vRules.pop_back();
+		std::vector<bool> v_del(m_vRules.size(), false);
+
+		v_del[szIndex] = true;
+		compact(v_del);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] vOrder Posicin actual de cada regla, en el nuevo orden
+ *
+ * Coloca en la posicin i la regla que estaba en la posicin vOrder[i].
+ * vOrder debe ser una permutacin de las posiciones. Los tomos no se
+ * mueven.
+ */
+void TFuzzyRules::reorder(const std::vector<size_t>& vOrder)
+{
+	std::vector<SFuzzyRule> v_rules(m_vRules.size());
+	std::vector<size_t>     v_pos(m_vRules.size());
+
+	if(vOrder.size() != m_vRules.size())
+		throw TFuzzyError("reorder", "Nmero de reglas incorrecto", __LINE__, __FILE__);
+
+	for(size_t i = 0; i < vOrder.size(); ++i)
+	{
+		v_rules[i]       = m_vRules[vOrder[i]];
+		v_pos[vOrder[i]] = i;
+	}
+	m_vRules.swap(v_rules);
+
+	std::unordered_multimap<size_t, size_t>::iterator iter = m_mKeys.begin();
+	while(iter != m_mKeys.end())
+	{
+		iter->second = v_pos[iter->second];
+		++iter;
 	}
+	++m_uiRevision;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+void TFuzzyRules::clear()
+{
+	++m_uiRevision;
+	++m_uiAtomsRevision;
+	m_vRules.clear();
+	m_vAtoms.clear();
+	m_vValues.clear();
+	m_mValues.clear();
+	m_strTexts.clear();
+	m_mKeys.clear();
 }
 //-----------------------------------------------------------------------------
 
@@ -320,7 +905,44 @@ void TFuzzyRules::clear()
  */
 SFuzzyRule& TFuzzyRules::operator[](size_t szIndex)
 {
-	return szIndex >= 0 && szIndex < m_vRules.size()
-			? *m_vRules[szIndex] : TFuzzyRules::invalid;
+	return szIndex < m_vRules.size() ? m_vRules[szIndex] : TFuzzyRules::invalid;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szIndex Posicin de la regla
+ *
+ * \return Texto original de la regla si se ha guardado (keepText()). Si no,
+ * el texto se reconstruye a partir de sus tomos, con los nombres de los
+ * conjuntos, modificadores y valores.
+ */
+std::string TFuzzyRules::text(size_t szIndex)
+{
+	static const char* c_mods[] = { "", "very", "slightly", "not" };
+
+	std::string str_text;
+
+	if(szIndex >= m_vRules.size())
+		return str_text;
+
+	const SFuzzyRule& fr_rule = m_vRules[szIndex];
+	if(fr_rule.Text != FL_RULE_NOTEXT)
+		return std::string(m_strTexts.c_str() + fr_rule.Text);
+
+	str_text = "if ";
+	for(uint32_t i = 0; i < fr_rule.AtomCount; ++i)
+	{
+		const SRuleAtom& ra_atom = m_vAtoms[fr_rule.FirstAtom + i];
+		TFuzzyVal*       fv_val  = m_vValues[ra_atom.Value];
+
+		if(i > 0)
+			str_text += i + 1 == fr_rule.AtomCount ? " then " : " and ";
+		str_text += fv_val->parent()->name() + ".";
+		for(uint32_t ui_mods = ra_atom.Modifiers; ui_mods; ui_mods >>= FL_MOD_BITS)
+			str_text += std::string(c_mods[ui_mods & FL_MOD_MASK]) + ".";
+		str_text += fv_val->name();
+	}
+
+	return str_text;
 }
 //-----------------------------------------------------------------------------
@@ -32,6 +32,16 @@
 #define __FZRULES_HPP__
 //-----------------------------------------------------------------------------
 #include "fzset.hpp"
+#include <stdint.h>
+//-----------------------------------------------------------------------------
+/** Bits de cada modificador en SRuleAtom::Modifiers */
+#define FL_MOD_BITS			2
+/** Mscara de un modificador en SRuleAtom::Modifiers */
+#define FL_MOD_MASK			3
+/** Mximo de modificadores de un tomo */
+#define FL_MOD_MAX			16
+/** SFuzzyRule::Text de las reglas de las que no se guarda el texto */
+#define FL_RULE_NOTEXT		0xFFFFFFFF
 //-----------------------------------------------------------------------------
 
 namespace nsFuzzy
@@ -41,46 +51,129 @@ namespace nsFuzzy
 	enum TValModifier { vmNone = 0, vmVery, vmSlightly, vmNot };
 	//-------------------------------------------------------------------------
 
+	/**
+	 * tomo de una regla, empaquetado en 8 bytes.
+	 *
+	 * Los modificadores se aplican en orden y se guardan en grupos de
+	 * FL_MOD_BITS bits, el primero en los bits bajos. Como vmNone es 0, el
+	 * cdigo termina en el primer grupo a 0 y admite hasta FL_MOD_MAX
+	 * modificadores:
+	 *
+	 * \code
+	 * for(uint32_t ui_mods = atom.Modifiers; ui_mods; ui_mods >>= FL_MOD_BITS)
+	 *     fv = modify(fv, TValModifier(ui_mods & FL_MOD_MASK));
+	 * \endcode
+	 */
 	struct SRuleAtom
 	{
-		SRuleAtom*                Next;
-		TFuzzyVal*                Value;
-		std::vector<TValModifier> Modifiers;
-
-		SRuleAtom(TFuzzyVal* fVal);
-		virtual ~SRuleAtom();
+		/** ndice del valor en TFuzzyRules::value() */
+		uint32_t Value;
+		/** Modificadores empaquetados */
+		uint32_t Modifiers;
 	};
 	//-------------------------------------------------------------------------
 
 	/**
+	 * Regla: sus tomos (antecedentes unidos por 'and' y, el ltimo, el
+	 * consecuente) estn consecutivos en el almacn de tomos de TFuzzyRules.
 	 *
+	 * Dos reglas son iguales (TFuzzyRules::equals()) si tienen la misma forma
+	 * cannica: el mismo conjunto de antecedentes (valor y modificadores), sin
+	 * importar su orden ni sus repeticiones, y el mismo valor consecuente. Los
+	 * modificadores del consecuente no cuentan, pues la ejecucin no los usa.
+	 * Dos reglas iguales producen siempre el mismo resultado.
 	 */
 	struct SFuzzyRule
 	{
-		std::string String;
-		SRuleAtom*  Links;
+		/** Posicin del primer tomo en el almacn de tomos */
+		uint32_t FirstAtom;
+		/** Nmero de tomos */
+		uint32_t AtomCount;
+		/** Posicin del texto original en el almacn de textos, FL_RULE_NOTEXT
+		 * si no se guarda */
+		uint32_t Text;
+	};
+	//-------------------------------------------------------------------------
+
+	/** tomo de una regla an no aadida: valor y modificadores empaquetados */
+	typedef std::pair<TFuzzyVal*, uint32_t> fuzzatom;
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Error de sintaxis en una regla. Adems de lo que guarda TFuzzyError,
+	 * indica la posicin que ocupara la regla en TFuzzyRules y la columna
+	 * (desde 1) del texto de la regla donde se ha detectado el error.
+	 */
+	class TFuzzyRuleError : public TFuzzyError
+	{
+	private:
+		/** Posicin de la regla en la lista de reglas */
+		size_t m_szRule;
+		/** Columna del texto de la regla donde est el error */
+		size_t m_szColumn;
 
-		SFuzzyRule(TFuzzyVal* fVal) { Links = new SRuleAtom(fVal); String = "";          }
-		virtual ~SFuzzyRule()       { if(Links) delete Links; Links = NULL; String = ""; }
+	public:
+		TFuzzyRuleError(const char* What, const std::string& strWhy, size_t szRule,
+						size_t szColumn, unsigned int uiLine, const char* cFile);
 
-		bool operator==(SFuzzyRule& cmp);
-		bool operator!=(SFuzzyRule& cmp);
+		/** Posicin de la regla en la lista de reglas */
+		inline size_t rule()   { return m_szRule;   }
+		/** Columna (desde 1) del texto de la regla donde est el error */
+		inline size_t column() { return m_szColumn; }
 	};
 	//-------------------------------------------------------------------------
 
+	struct SRulesParse;
+	//-------------------------------------------------------------------------
+
 	/**
+	 * Reglas de un modelo.
+	 *
+	 * Las reglas se guardan en tres almacenes contiguos: los registros de las
+	 * reglas, sus tomos y los valores a los que se refieren los tomos (cada
+	 * valor una sola vez). As una regla ocupa 12 bytes ms 8 por tomo y
+	 * recorrerlas es recorrer memoria consecutiva.
 	 *
+	 * El texto original de las reglas slo se guarda si se pide con
+	 * keepText(). Si no, text() lo reconstruye a partir de los tomos.
 	 */
 	class TFuzzyRules : public TFuzzyBase
 	{
 	private:
-		std::vector<SFuzzyRule*> m_vRules;
+		/** Reglas, en orden */
+		std::vector<SFuzzyRule> m_vRules;
+		/** tomos de todas las reglas, consecutivos por regla */
+		std::vector<SRuleAtom>  m_vAtoms;
+		/** Valores a los que se refieren los tomos */
+		std::vector<TFuzzyVal*> m_vValues;
+		/** ndice de m_vValues por valor */
+		std::unordered_map<TFuzzyVal*, uint32_t> m_mValues;
+		/** Textos originales de las reglas, terminados en '\0' */
+		std::string             m_strTexts;
+		/** Indica si se guarda el texto original de las reglas */
+		bool                    m_bKeepText;
 
 		TFuzzySets& m_fsSets;
 
-		std::string splitModsValue(std::string& strValue);
-		void        setModifiers(SRuleAtom* flLink, std::string& strMods);
-		SFuzzyRule* parseRule(std::string strRule);
+		/** ndice de las reglas por el hash de su forma cannica */
+		std::unordered_multimap<size_t, size_t> m_mKeys;
+
+		/** Ver revision() y atomsRevision() */
+		uint32_t    m_uiRevision;
+		uint32_t    m_uiAtomsRevision;
+
+		size_t      key(size_t szRule, std::vector<uint64_t>& vKeys);
+		size_t      find(size_t szRule, size_t szHash);
+		void        index();
+		void        compact(const std::vector<bool>& vDelete);
+		uint32_t    valueIndex(TFuzzyVal* fvVal);
+
+		static TValModifier modifier(const char* cText, size_t szLen);
+		void        parseAtom(const std::string& strRule, size_t szBegin, size_t szEnd,
+							  size_t szRule, fuzzatom& faAtom);
+		void        parseRule(const std::string& strRule, size_t szRule,
+							  std::vector<fuzzatom>& vAtoms, std::string& strText);
+		void        parseRules(SRulesParse* srParse);
 
 	protected:
 	public:
@@ -92,8 +185,35 @@ namespace nsFuzzy
 		/** Nmero de reglas existentes */
 		inline size_t size() { return m_vRules.size(); }
 
-		/** Aade una nueva regla al conjunto */
-		void add(std::string strRule);
+		/** Cambia cada vez que alguna regla existente cambia de posicin o se
+		 * elimina. Mientras no cambia, las reglas slo se aaden al final */
+		inline uint32_t revision()      { return m_uiRevision;      }
+		/** Cambia cada vez que se reconstruye el almacn de tomos. Mientras
+		 * no cambia, SFuzzyRule::FirstAtom identifica a cada regla aunque
+		 * cambie de posicin */
+		inline uint32_t atomsRevision() { return m_uiAtomsRevision; }
+
+		/** Indica si se guarda el texto original de las reglas que se aadan */
+		inline bool keepText()             { return m_bKeepText;  }
+		/** Guarda (o no) el texto original de las reglas que se aadan */
+		inline void keepText(bool bKeep)   { m_bKeepText = bKeep; }
+
+		/** Aade una nueva regla al conjunto, si no existe ya */
+		bool   add(std::string strRule);
+		/** Aade una regla ya resuelta al conjunto, si no existe ya */
+		bool   add(const std::vector<fuzzatom>& vAtoms, const std::string& strText = "");
+		/** Aade varias reglas, analizndolas en paralelo */
+		size_t addMany(const std::vector<std::string>& vRules, unsigned int uiThreads = 0);
+		/** Posicin de la regla igual a strRule */
+		size_t find(const std::string& strRule);
+		/** Indica si dos reglas son iguales */
+		bool   equals(size_t szRule, size_t szOther);
+		/** Reglas que son redundantes por existir otra ms general */
+		std::vector<std::pair<size_t, size_t> > subsumed();
+		/** Elimina las reglas redundantes */
+		size_t pruneSubsumed();
+		/** Cambia el orden de las reglas */
+		void reorder(const std::vector<size_t>& vOrder);
 		/** Elimina una regla del conjunto */
 		void del(size_t szIndex);
 		/** Limpia la lista de reglas*/
@@ -101,6 +221,17 @@ namespace nsFuzzy
 
 		/** Devuelve la regla en la posicin indicada */
 		SFuzzyRule& operator[](size_t szIndex);
+		/** tomos de la regla en la posicin indicada */
+		inline const SRuleAtom* atoms(const SFuzzyRule& frRule) { return &m_vAtoms[frRule.FirstAtom]; }
+		/** Valor de un tomo */
+		inline TFuzzyVal* value(const SRuleAtom& raAtom) { return m_vValues[raAtom.Value]; }
+		/** Texto de la regla en la posicin indicada */
+		std::string text(size_t szIndex);
+
+		/** Empaqueta una lista de modificadores (ver SRuleAtom) */
+		static uint32_t pack(const std::vector<TValModifier>& vMods);
+		/** Desempaqueta los modificadores de un tomo */
+		static void     unpack(uint32_t uiMods, std::vector<TValModifier>& vMods);
 
 		static SFuzzyRule invalid;
 	};
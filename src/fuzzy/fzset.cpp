@@ -51,8 +51,7 @@ using namespace nsFuzzy;
  */
 TFuzzySet::TFuzzySet(std::string strName) : TFuzzyBase(FL_ID_SET)
 {
-	m_strName  = strName;
-    toLower(trim(m_strName));
+	name(strName);
 }
 //-----------------------------------------------------------------------------
 
@@ -83,14 +82,30 @@ TFuzzySet::~TFuzzySet()
  * de no existir.
  * \sa fzhndl, operator[]()
  */
-fzhndl TFuzzySet::id(std::string strName)
+fzhndl TFuzzySet::id(const std::string& strName)
 {
-	std::map<fzhndl, TFuzzyVal*>::iterator iter = m_fvValues.begin();
+	TFuzzyVal* fv_val = bySymbol(TFuzzySymbols::find(strName));
 
-	while(iter != m_fvValues.end() && iter->second->name() != strName)
-		++iter;
+	return fv_val ? fv_val->handle() : FL_INVALID_HANDLE;
+}
+//-----------------------------------------------------------------------------
 
-	return iter == m_fvValues.end() ? FL_INVALID_HANDLE : iter->first;
+/**
+ * \param [in] fbChild Valor que ha cambiado de nombre
+ * \param [in] fsOld   Smbolo del nombre anterior
+ *
+ * Mantiene actualizado el ndice de nombres de los valores del conjunto.
+ *
+ * \sa TFuzzyBase::name()
+ */
+void TFuzzySet::renamed(TFuzzyBase* fbChild, fzsymbol fsOld)
+{
+	if(bySymbol(fsOld) == fbChild)
+		index(fsOld);
+	if(bySymbol(fbChild->symbol()))
+		index(fbChild->symbol());
+	else
+		m_mNames[fbChild->symbol()] = (TFuzzyVal*)fbChild;
 }
 //-----------------------------------------------------------------------------
 
@@ -109,11 +124,10 @@ fzhndl TFuzzySet::id(std::string strName)
  */
 fuzzvar TFuzzySet::min()
 {
-    fuzzvar                                rtn  = 1E+64;
-    std::map<fzhndl, TFuzzyVal*>::iterator iter = m_fvValues.begin();
+    fuzzvar rtn = 1E+64;
 
-    for(iter = m_fvValues.begin(); iter != m_fvValues.end(); ++iter)
-    	rtn = iter->second->min() < rtn ? iter->second->min() : rtn;
+    for(size_t i = 0; i < m_vValues.size(); ++i)
+    	rtn = m_vValues[i]->min() < rtn ? m_vValues[i]->min() : rtn;
 
     return rtn;
 }
@@ -134,11 +148,10 @@ fuzzvar TFuzzySet::min()
  */
 fuzzvar TFuzzySet::max()
 {
-    fuzzvar                                rtn  = -1E+64;
-    std::map<fzhndl, TFuzzyVal*>::iterator iter = m_fvValues.begin();
+    fuzzvar rtn = -1E+64;
 
-    for(iter = m_fvValues.begin(); iter != m_fvValues.end(); ++iter)
-    	rtn = iter->second->max() > rtn ? iter->second->max() : rtn;
+    for(size_t i = 0; i < m_vValues.size(); ++i)
+    	rtn = m_vValues[i]->max() > rtn ? m_vValues[i]->max() : rtn;
 
     return rtn;
 }
@@ -156,23 +169,20 @@ fuzzvar TFuzzySet::max()
  * en caso de no encontrarse.
  * \sa del(), operator[]()
  */
-fzhndl TFuzzySet::add(std::string strName)
+fzhndl TFuzzySet::add(const std::string& strName)
 {
-	fzhndl fv_id = INVALID_FUNC;
+	TFuzzyVal* fv_aux = bySymbol(TFuzzySymbols::find(strName));
 
-	if((*this)[strName] != invalidObject())
-	{
-		fv_id = id(strName);
-	}
-	else
+	if(!fv_aux)
 	{
-		TFuzzyVal* fv_aux = new TFuzzyVal(strName);
+		fv_aux = new TFuzzyVal(strName);
 		fv_aux->parent()  = this;
-		fv_id = fv_aux->handle();
-		m_fvValues[fv_id] = fv_aux;
+		m_vValues.push_back(fv_aux);
+		m_mHandles[fv_aux->handle()] = fv_aux;
+		m_mNames[fv_aux->symbol()]   = fv_aux;
 	}
 
-	return fv_id;
+	return fv_aux->handle();
 }
 //-----------------------------------------------------------------------------
 
@@ -183,17 +193,31 @@ fzhndl TFuzzySet::add(std::string strName)
  * sea fzValue y lo elimina de la lista, liberando los recursos empleados por
  * ste. En caso de no encontrarse dicho valor la funcin no hace nada.
  *
+ * Los valores posteriores al eliminado avanzan una posicin.
+ *
  * \return Nada.
  * \sa clear(), add(), id()
  */
 void TFuzzySet::del(fzhndl fzValue)
 {
-	std::map<fzhndl, TFuzzyVal*>::iterator found = m_fvValues.find(fzValue);
+	std::unordered_map<fzhndl, TFuzzyVal*>::iterator found = m_mHandles.find(fzValue);
 
-	if(found != m_fvValues.end())
+	if(found != m_mHandles.end())
 	{
-		delete found->second;
-		m_fvValues.erase(found);
+		TFuzzyVal* fv_val = found->second;
+
+		m_mHandles.erase(found);
+		for(size_t i = 0; i < m_vValues.size(); ++i)
+		{
+			if(m_vValues[i] == fv_val)
+			{
+				m_vValues.erase(m_vValues.begin() + i);
+				break;
+			}
+		}
+		if(bySymbol(fv_val->symbol()) == fv_val)
+			index(fv_val->symbol());
+		delete fv_val;
 	}
 }
 //-----------------------------------------------------------------------------
@@ -207,13 +231,14 @@ void TFuzzySet::del(fzhndl fzValue)
  */
 void TFuzzySet::clear()
 {
-	while(m_fvValues.size())
+	while(!m_vValues.empty())
 	{
-		if(m_fvValues.begin()->second)
-			delete m_fvValues.begin()->second;
-		m_fvValues.begin()->second = NULL;
-		m_fvValues.erase(m_fvValues.begin());
+		if(m_vValues.back())
+			delete m_vValues.back();
+		m_vValues.pop_back();
 	}
+	m_mHandles.clear();
+	m_mNames.clear();
 }
 //-----------------------------------------------------------------------------
 
@@ -228,12 +253,8 @@ void TFuzzySet::clear()
  */
 fuzzvar TFuzzySet::execute(fuzzvar x)
 {
-    if(m_fvValues.size() > 0)
-    {
-		std::map<fzhndl, TFuzzyVal*>::iterator iter = m_fvValues.begin();
-        for(; iter != m_fvValues.end(); ++iter)
-        	iter->second->execute(x);
-    }
+    for(size_t i = 0; i < m_vValues.size(); ++i)
+    	m_vValues[i]->execute(x);
     return x;
 }
 //-----------------------------------------------------------------------------
@@ -247,46 +268,65 @@ fuzzvar TFuzzySet::execute(fuzzvar x)
  */
 TFuzzyVal& TFuzzySet::operator[](fzhndl fzId)
 {
-	std::map<fzhndl, TFuzzyVal*>::iterator found = m_fvValues.find(fzId);
-	return found == m_fvValues.end() ? *((TFuzzyVal*)&invalidObject()) : *found->second;
+	std::unordered_map<fzhndl, TFuzzyVal*>::iterator found = m_mHandles.find(fzId);
+	return found == m_mHandles.end() ? *((TFuzzyVal*)&invalidObject()) : *found->second;
 }
 //-----------------------------------------------------------------------------
 
 /**
- * \param [in] iIndex Posicin en la lista del valor.
+ * \param [in] strName Nombre del valor.
  *
- * \return Valor del conjunto en la posicin i Index. En caso de no encontrarse
- * dicho valor (out of bounds), retorna TFuzzyBase::invalid.
+ * \return Valor del conjunto con nombre strName. En caso de no encontrarse
+ * dicho valor, retorna TFuzzyBase::invalid.
  * \sa operator[](fzhndl), operator[](std::string), size()
  */
-TFuzzyVal& TFuzzySet::operator[](int iIndex)
+TFuzzyVal& TFuzzySet::operator[](const std::string& strName)
 {
-	std::map<fzhndl, TFuzzyVal*>::iterator iter = m_fvValues.begin();
-	int i_ndx = 0;
+	TFuzzyVal* fv_val = bySymbol(TFuzzySymbols::find(strName));
+
+	return fv_val ? *fv_val : *((TFuzzyVal*)&invalidObject());
+}
+//-----------------------------------------------------------------------------
 
-	while(iter != m_fvValues.end() && i_ndx++ < iIndex)
-		++iter;
+/**
+ * \param [in] fsName Smbolo del nombre del valor.
+ *
+ * Bsqueda directa en el ndice de nombres. No normaliza ni copia ningn
+ * texto.
+ *
+ * \return Valor del conjunto cuyo nombre tiene el smbolo fsName. NULL en
+ * caso de no encontrarse.
+ * \sa operator[](std::string), TFuzzySymbols
+ */
+TFuzzyVal* TFuzzySet::bySymbol(fzsymbol fsName)
+{
+	std::unordered_map<fzsymbol, TFuzzyVal*>::iterator found = m_mNames.find(fsName);
 
-	return iter == m_fvValues.end() ? *((TFuzzyVal*)&invalidObject()) : *iter->second;
+	return found == m_mNames.end() ? NULL : found->second;
 }
 //-----------------------------------------------------------------------------
 
 /**
- * \param [in] strName Nombre del valor.
+ * \param [in] fsName Smbolo del nombre
  *
- * \return Valor del conjunto con nombre strName. En caso de no encontrarse
- * dicho valor, retorna TFuzzyBase::invalid.
- * \sa operator[](fzhndl), operator[](std::string), size()
+ * Puede haber varios valores con el mismo nombre. El ndice de nombres apunta
+ * siempre al primero de ellos en la lista, que es el que encontraba la
+ * bsqueda lineal. Este mtodo vuelve a buscarlo cuando el que estaba
+ * indexado desaparece o cambia de nombre.
+ *
+ * \sa TFuzzyModels::index()
  */
-TFuzzyVal& TFuzzySet::operator[](std::string strName)
+void TFuzzySet::index(fzsymbol fsName)
 {
-	std::map<fzhndl, TFuzzyVal*>::iterator iter = m_fvValues.begin();
-	strName = toLower(trim(strName));
+	size_t i = 0;
 
-	while(iter != m_fvValues.end() && iter->second->name() != strName)
-		++iter;
+	while(i < m_vValues.size() && m_vValues[i]->symbol() != fsName)
+		++i;
 
-	return iter == m_fvValues.end() ? *((TFuzzyVal*)&invalidObject()) : *iter->second;
+	if(i == m_vValues.size())
+		m_mNames.erase(fsName);
+	else
+		m_mNames[fsName] = m_vValues[i];
 }
 //-----------------------------------------------------------------------------
 
@@ -305,6 +345,7 @@ TFuzzyVal& TFuzzySet::operator[](std::string strName)
  */
 TFuzzySets::TFuzzySets() : TFuzzyBase(FL_ID_SETS)
 {
+	m_uiRevision = 0;
 }
 //-----------------------------------------------------------------------------
 
@@ -320,28 +361,40 @@ TFuzzySets::~TFuzzySets()
 /**
  *
  */
-fzhndl TFuzzySets::add(std::string strName)
+fzhndl TFuzzySets::add(const std::string& strName)
 {
-	TFuzzySet* fs_new = NULL;
-	std::map<fzhndl, TFuzzySet*>::iterator iter = m_mSets.begin();
+	TFuzzySet* fs_set = bySymbol(TFuzzySymbols::find(strName));
 
-	while(iter != m_mSets.end())
+	if(!fs_set)
 	{
-		if(iter->second->name() == strName)
-			break;
-		++iter;
+		fs_set = new TFuzzySet(strName);
+		fs_set->parent() = this;
+		m_vSets.push_back(fs_set);
+		m_mHandles[fs_set->handle()] = fs_set;
+		m_mNames[fs_set->symbol()]   = fs_set;
+		++m_uiRevision;
 	}
 
-	if(iter == m_mSets.end())
-	{
-		fs_new = new TFuzzySet(strName);
-		fs_new->parent() = this;
-		m_mSets[fs_new->handle()] = fs_new;
-	}
+	return fs_set->handle();
+}
+//-----------------------------------------------------------------------------
 
-	return iter == m_mSets.end() ?
-			(fs_new ? fs_new->handle() : FL_INVALID_HANDLE) :
-			iter->first;
+/**
+ * \param [in] fbChild Conjunto que ha cambiado de nombre
+ * \param [in] fsOld   Smbolo del nombre anterior
+ *
+ * Mantiene actualizado el ndice de nombres de los conjuntos.
+ *
+ * \sa TFuzzyBase::name()
+ */
+void TFuzzySets::renamed(TFuzzyBase* fbChild, fzsymbol fsOld)
+{
+	if(bySymbol(fsOld) == fbChild)
+		index(fsOld);
+	if(bySymbol(fbChild->symbol()))
+		index(fbChild->symbol());
+	else
+		m_mNames[fbChild->symbol()] = (TFuzzySet*)fbChild;
 }
 //-----------------------------------------------------------------------------
 
@@ -350,9 +403,25 @@ fzhndl TFuzzySets::add(std::string strName)
  */
 void TFuzzySets::del(fzhndl fhId)
 {
-	std::map<fzhndl, TFuzzySet*>::iterator found = m_mSets.find(fhId);
-	if(found != m_mSets.end())
-		m_mSets.erase(found);
+	std::unordered_map<fzhndl, TFuzzySet*>::iterator found = m_mHandles.find(fhId);
+	if(found != m_mHandles.end())
+	{
+		TFuzzySet* fs_set = found->second;
+
+		m_mHandles.erase(found);
+		for(size_t i = 0; i < m_vSets.size(); ++i)
+		{
+			if(m_vSets[i] == fs_set)
+			{
+				m_vSets.erase(m_vSets.begin() + i);
+				break;
+			}
+		}
+		if(bySymbol(fs_set->symbol()) == fs_set)
+			index(fs_set->symbol());
+		delete fs_set;
+		++m_uiRevision;
+	}
 }
 //-----------------------------------------------------------------------------
 
@@ -361,13 +430,15 @@ void TFuzzySets::del(fzhndl fhId)
  */
 void TFuzzySets::clear()
 {
-	while(m_mSets.size() > 0)
+	while(!m_vSets.empty())
 	{
-		if(m_mSets.begin()->second)
-			delete m_mSets.begin()->second;
-		m_mSets.begin()->second = NULL;
-		m_mSets.erase(m_mSets.begin());
+		if(m_vSets.back())
+			delete m_vSets.back();
+		m_vSets.pop_back();
+		++m_uiRevision;
 	}
+	m_mHandles.clear();
+	m_mNames.clear();
 }
 //-----------------------------------------------------------------------------
 
@@ -376,36 +447,57 @@ void TFuzzySets::clear()
  */
 TFuzzySet& TFuzzySets::operator[](fzhndl fhId)
 {
-	std::map<fzhndl, TFuzzySet*>::iterator found = m_mSets.find(fhId);
-	return found == m_mSets.end() ? *((TFuzzySet*)&invalidObject()) : *found->second;
+	std::unordered_map<fzhndl, TFuzzySet*>::iterator found = m_mHandles.find(fhId);
+	return found == m_mHandles.end() ? *((TFuzzySet*)&invalidObject()) : *found->second;
 }
 //-----------------------------------------------------------------------------
 
 /**
  *
  */
-TFuzzySet& TFuzzySets::operator[](int iIndex)
+TFuzzySet& TFuzzySets::operator[](const std::string& strName)
 {
-	std::map<fzhndl, TFuzzySet*>::iterator iter = m_mSets.begin();
-	int i_ndx = 0;
+	TFuzzySet* fs_set = bySymbol(TFuzzySymbols::find(strName));
+
+	return fs_set ? *fs_set : *((TFuzzySet*)&invalidObject());
+}
+//-----------------------------------------------------------------------------
 
-	while(iter != m_mSets.end() && i_ndx++ < iIndex)
-		++iter;
+/**
+ * \param [in] fsName Smbolo del nombre del conjunto.
+ *
+ * \return Conjunto cuyo nombre tiene el smbolo fsName. NULL en caso de no
+ * encontrarse.
+ * \sa TFuzzySymbols
+ */
+TFuzzySet* TFuzzySets::bySymbol(fzsymbol fsName)
+{
+	std::unordered_map<fzsymbol, TFuzzySet*>::iterator found = m_mNames.find(fsName);
 
-	return iter == m_mSets.end() ? *((TFuzzySet*)&invalidObject()) : *iter->second;
+	return found == m_mNames.end() ? NULL : found->second;
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] fsName Smbolo del nombre
+ *
+ * Puede haber varios conjuntos con el mismo nombre. El ndice de nombres apunta
+ * siempre al primero de ellos en la lista, que es el que encontraba la
+ * bsqueda lineal. Este mtodo vuelve a buscarlo cuando el que estaba
+ * indexado desaparece o cambia de nombre.
  *
+ * \sa TFuzzyModels::index()
  */
-TFuzzySet& TFuzzySets::operator[](std::string strName)
+void TFuzzySets::index(fzsymbol fsName)
 {
-	std::map<fzhndl, TFuzzySet*>::iterator iter = m_mSets.begin();
+	size_t i = 0;
 
-	while(iter != m_mSets.end() && iter->second->name() != strName)
-		++iter;
+	while(i < m_vSets.size() && m_vSets[i]->symbol() != fsName)
+		++i;
 
-	return iter == m_mSets.end() ? *((TFuzzySet*)&invalidObject()) : *iter->second;
+	if(i == m_vSets.size())
+		m_mNames.erase(fsName);
+	else
+		m_mNames[fsName] = m_vSets[i];
 }
 //-----------------------------------------------------------------------------
@@ -34,6 +34,7 @@
 #define __FZSET_HPP__
 //-----------------------------------------------------------------------------
 #include "fzval.hpp"
+#include <unordered_map>
 //-----------------------------------------------------------------------------
 
 namespace nsFuzzy
@@ -54,16 +55,25 @@ namespace nsFuzzy
 		/** Lista de valores del conjunto
 		 *
 		 *  Los valores (TFuzzyVal) que forman parte del conjunto (TFuzzySet)
-		 *  se almacenan en un mapa, cuya llave es el descriptor (fzhndl) del
-		 *  mismo. Esto permite bsquedas rpidas en la lista.
+		 *  se almacenan de forma contigua, en orden de creacin. El acceso
+		 *  por posicin es directo y recorrer los valores no salta por los
+		 *  nodos de un rbol.
 		 *
-		 *  \sa id(), operator[]()
+		 *  \sa m_mHandles, id(), operator[]()
 		 */
-		std::map<fzhndl, TFuzzyVal*> m_fvValues;
+		std::vector<TFuzzyVal*> m_vValues;
+		/** ndice de los valores por descriptor (fzhndl) */
+		std::unordered_map<fzhndl, TFuzzyVal*> m_mHandles;
+		/** ndice de los valores por smbolo de su nombre */
+		std::unordered_map<fzsymbol, TFuzzyVal*> m_mNames;
+
+		void index(fzsymbol fsName);
 
 	protected:
 		/** Devuelve el descriptor de un valor (TFuzzyVal) dado su nombre */
-		fzhndl id(std::string strName);
+		fzhndl id(const std::string& strName);
+		/** Actualiza el ndice de nombres cuando un valor cambia de nombre */
+		virtual void renamed(TFuzzyBase* fbChild, fzsymbol fsOld);
 
 	public:
 		/** Constructor principal de un conjunto */
@@ -76,9 +86,9 @@ namespace nsFuzzy
 		 *  Devuelve el nmero de valores (TFuzzyVal) del conjunto.
 		 *
 		 *  \return Nmero de valores que contiene el grupo
-		 *  \sa m_fvValues, operator[]()
+		 *  \sa m_vValues, operator[]()
 		 */
-		inline size_t   size()   { return m_fvValues.size(); }
+		inline size_t   size()   { return m_vValues.size(); }
 
 		/** Devuelve el lmite inferior de influencia del conjunto */
 		fuzzvar min();
@@ -86,7 +96,7 @@ namespace nsFuzzy
 		fuzzvar max();
 
 		/** Aade un nuevo valor al conjunto */
-		fzhndl add(std::string strName);
+		fzhndl add(const std::string& strName);
 		/** ELimina en valor del conjunto */
 		void   del(fzhndl fzValue);
 		/** Limpia el conjunto, eliminando todos los valores definidos */
@@ -98,10 +108,23 @@ namespace nsFuzzy
 
 		/** Devuelve un valor (TFuzyVal) dado su descriptor */
 		TFuzzyVal& operator[](fzhndl fzId);
-		/** Devuelve el valor (TFuzyVal) que ocupa la posicin dada */
-		TFuzzyVal& operator[](int iIndex);
+		/** Devuelve el valor (TFuzyVal) que ocupa la posicin dada
+		 *
+		 * \param [in] iIndex Posicin en la lista del valor.
+		 *
+		 * \return Valor del conjunto en la posicin iIndex. En caso de no
+		 * existir dicha posicin, retorna TFuzzyBase::invalid.
+		 * \sa operator[](fzhndl), operator[](std::string), size()
+		 */
+		inline TFuzzyVal& operator[](int iIndex)
+		{
+			return (iIndex >= 0 && size_t(iIndex) < m_vValues.size())
+					? *m_vValues[iIndex] : *((TFuzzyVal*)&invalidObject());
+		}
 		/** Devuelve un valor (TFuzyVal) dado su nombre */
-		TFuzzyVal& operator[](std::string strName);
+		TFuzzyVal& operator[](const std::string& strName);
+		/** Devuelve un valor (TFuzyVal) dado el smbolo de su nombre */
+		TFuzzyVal* bySymbol(fzsymbol fsName);
 	};
 	//-------------------------------------------------------------------------
 
@@ -119,10 +142,22 @@ namespace nsFuzzy
 	class TFuzzySets : public TFuzzyBase
 	{
 	private:
-		/** Lista de los conjuntos (TFuzzySet). */
-		std::map<fzhndl, TFuzzySet*> m_mSets;
+		/** Lista de los conjuntos (TFuzzySet), contigua y en orden de
+		 * creacin. */
+		std::vector<TFuzzySet*> m_vSets;
+		/** ndice de los conjuntos por descriptor (fzhndl) */
+		std::unordered_map<fzhndl, TFuzzySet*> m_mHandles;
+		/** ndice de los conjuntos por smbolo de su nombre */
+		std::unordered_map<fzsymbol, TFuzzySet*> m_mNames;
+		/** Ver revision() */
+		uint32_t m_uiRevision;
+
+		void index(fzsymbol fsName);
 
 	protected:
+		/** Actualiza el ndice de nombres cuando un conjunto cambia de nombre */
+		virtual void renamed(TFuzzyBase* fbChild, fzsymbol fsOld);
+
 	public:
 		/** Constructor principal de la clase. */
 		TFuzzySets();
@@ -134,12 +169,17 @@ namespace nsFuzzy
 		 *  Devuelve el nmero de conjuntos (TFuzzySet) que contiene el grupo.
 		 *
 		 * \return Nmero de conjuntos (TFuzzySet) que forman el grupo.
-		 * \sa m_mSets, operator[]()
+		 * \sa m_vSets, operator[]()
 		 */
-		inline size_t size() { return m_mSets.size(); }
+		inline size_t size() { return m_vSets.size(); }
+
+		/** Aumenta en uno con cada conjunto que se aade o se elimina. Si ha
+		 * aumentado lo mismo que size(), slo se han aadido conjuntos (al
+		 * final) y los dems conservan su posicin */
+		inline uint32_t revision() { return m_uiRevision; }
 
 		/** Aade un nuevo conjunto (TFuzzySet) al grupo. */
-		fzhndl add(std::string strName);
+		fzhndl add(const std::string& strName);
 		/** Elimina un conjunto (TFuzzySet) del grupo. */
 		void   del(fzhndl fhId);
 		/** Vaca el grupo de los conjuntos (TFuzzySet) que contenga. */
@@ -147,10 +187,20 @@ namespace nsFuzzy
 
 		/** Devuelve el conjunto (TFuzzySet) con el descriptor especificado. */
 		TFuzzySet& operator[](fzhndl fhId);
-		/** Devuelve el conjunto (TFuzzySet) en la posicin especificada. */
-		TFuzzySet& operator[](int iIndex);
+		/** Devuelve el conjunto (TFuzzySet) en la posicin especificada.
+		 *
+		 * \return Conjunto en la posicin iIndex. En caso de no existir
+		 * dicha posicin, retorna TFuzzyBase::invalid.
+		 */
+		inline TFuzzySet& operator[](int iIndex)
+		{
+			return (iIndex >= 0 && size_t(iIndex) < m_vSets.size())
+					? *m_vSets[iIndex] : *((TFuzzySet*)&invalidObject());
+		}
 		/** Devuelve el conjunto (TFuzzySet) con el nombre especificado. */
-		TFuzzySet& operator[](std::string strName);
+		TFuzzySet& operator[](const std::string& strName);
+		/** Devuelve el conjunto (TFuzzySet) dado el smbolo de su nombre. */
+		TFuzzySet* bySymbol(fzsymbol fsName);
 	};
 	//-------------------------------------------------------------------------
 }
@@ -0,0 +1,347 @@
+/**
+ * \file fzsymbols.cpp
+ *
+ *  Symbol table definition.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzsymbols.hpp"
+#include "fzbase.hpp"
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+/** Tamao inicial de la tabla hash (potencia de 2) */
+#define FZ_SYM_BUCKETS		256
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szSize Tamao de la tabla (potencia de 2)
+ */
+TFuzzySymbols::SBuckets::SBuckets(size_t szSize)
+{
+	Mask  = szSize - 1;
+	Slots = new std::atomic<fzsymbol>[szSize];
+	for(size_t i = 0; i < szSize; ++i)
+		Slots[i].store(FL_INVALID_SYMBOL, std::memory_order_relaxed);
+}
+//-----------------------------------------------------------------------------
+
+TFuzzySymbols::SBuckets::~SBuckets()
+{
+	delete[] Slots;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Crea la tabla y registra la cadena vaca como FL_EMPTY_SYMBOL.
+ */
+TFuzzySymbols::STable::STable()
+{
+	for(size_t i = 0; i < FZ_SYM_CHUNKS; ++i)
+		Chunks[i].store(NULL, std::memory_order_relaxed);
+	Chunks[0].store(new std::string[FZ_SYM_CHUNK], std::memory_order_relaxed);
+	Count.store(1, std::memory_order_relaxed);
+
+	SBuckets* sb_buckets = new SBuckets(FZ_SYM_BUCKETS);
+	sb_buckets->Slots[TFuzzySymbols::hash("", 0) & sb_buckets->Mask].store(FL_EMPTY_SYMBOL,
+																		  std::memory_order_relaxed);
+	Buckets.store(sb_buckets, std::memory_order_release);
+}
+//-----------------------------------------------------------------------------
+
+TFuzzySymbols::STable::~STable()
+{
+	for(size_t i = 0; i < FZ_SYM_CHUNKS; ++i)
+		delete[] Chunks[i].load(std::memory_order_relaxed);
+	delete Buckets.load(std::memory_order_relaxed);
+	for(size_t i = 0; i < Retired.size(); ++i)
+		delete Retired[i];
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * La tabla se crea en el primer uso para que est disponible durante la
+ * inicializacin de los objetos estticos de la librera (por ejemplo las
+ * funciones estndar registradas por TFuzzyVal).
+ *
+ * \return La tabla de smbolos.
+ */
+TFuzzySymbols::STable& TFuzzySymbols::table()
+{
+	static STable st_table;
+	return st_table;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] cText Texto a ajustar
+ * \param [in,out] szLen Longitud del texto
+ *
+ * Elimina, sin copiar el texto, los espacios al principio y final del mismo.
+ */
+void TFuzzySymbols::bounds(const char*& cText, size_t& szLen)
+{
+	while(szLen > 0 && *cText == ' ')
+	{
+		++cText;
+		--szLen;
+	}
+	while(szLen > 0 && cText[szLen - 1] == ' ')
+		--szLen;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] cText Texto (ya sin espacios en los extremos)
+ * \param [in] szLen Longitud del texto
+ *
+ * Calcula el hash FNV-1a del texto convertido a minsculas. La conversin se
+ * hace carcter a carcter, de manera que no es necesario crear una copia
+ * normalizada del texto para buscarlo.
+ *
+ * \return Hash del texto normalizado.
+ */
+size_t TFuzzySymbols::hash(const char* cText, size_t szLen)
+{
+	unsigned int ui_hash = 2166136261u;
+
+	for(size_t i = 0; i < szLen; ++i)
+	{
+		ui_hash ^= (unsigned char)lower(cText[i]);
+		ui_hash *= 16777619u;
+	}
+
+	return size_t(ui_hash);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strName Nombre normalizado
+ * \param [in] cText   Texto sin normalizar (ya sin espacios en los extremos)
+ * \param [in] szLen   Longitud del texto
+ *
+ * \return true si el texto normalizado coincide con strName.
+ */
+bool TFuzzySymbols::equals(const std::string& strName, const char* cText, size_t szLen)
+{
+	if(strName.size() != szLen)
+		return false;
+
+	for(size_t i = 0; i < szLen; ++i)
+		if(strName[i] != lower(cText[i]))
+			return false;
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] stTable   Tabla de smbolos
+ * \param [in] sbBuckets Tabla hash donde buscar
+ * \param [in] cText     Texto sin normalizar (ya sin espacios en los extremos)
+ * \param [in] szLen     Longitud del texto
+ *
+ * Recorre la tabla hash (sondeo lineal) hasta encontrar el nombre o una
+ * posicin libre. Un smbolo se escribe en la tabla hash despus de su
+ * nombre, por lo que todo smbolo que se lee en ella tiene ya su nombre.
+ *
+ * \return Posicin en sbBuckets del nombre, o de la posicin libre donde
+ * debera insertarse.
+ */
+size_t TFuzzySymbols::slot(STable& stTable, SBuckets* sbBuckets, const char* cText, size_t szLen)
+{
+	size_t   sz_pos = hash(cText, szLen) & sbBuckets->Mask;
+	fzsymbol fs_sym = sbBuckets->Slots[sz_pos].load(std::memory_order_acquire);
+
+	while(fs_sym != FL_INVALID_SYMBOL && !equals(at(stTable, fs_sym), cText, szLen))
+	{
+		sz_pos = (sz_pos + 1) & sbBuckets->Mask;
+		fs_sym = sbBuckets->Slots[sz_pos].load(std::memory_order_acquire);
+	}
+
+	return sz_pos;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] stTable Tabla a redimensionar
+ *
+ * Crea una tabla hash del doble de tamao con todos los smbolos y la
+ * publica. La anterior no se libera, porque puede haber lectores
+ * recorrindola; sigue siendo vlida para todos los smbolos que contiene.
+ * Se llama con el cerrojo tomado.
+ */
+void TFuzzySymbols::grow(STable& stTable)
+{
+	SBuckets* sb_old   = stTable.Buckets.load(std::memory_order_relaxed);
+	SBuckets* sb_new   = new SBuckets(2 * (sb_old->Mask + 1));
+	size_t    sz_count = stTable.Count.load(std::memory_order_relaxed);
+
+	for(size_t i = 0; i < sz_count; ++i)
+	{
+		const std::string& str_name = at(stTable, fzsymbol(i));
+		sb_new->Slots[slot(stTable, sb_new, str_name.data(), str_name.size())].store(fzsymbol(i),
+																				   std::memory_order_relaxed);
+	}
+
+	stTable.Retired.push_back(sb_old);
+	stTable.Buckets.store(sb_new, std::memory_order_release);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strName Nombre a registrar
+ *
+ * \return Smbolo del nombre normalizado.
+ * \sa find()
+ */
+fzsymbol TFuzzySymbols::intern(const std::string& strName)
+{
+	return intern(strName.data(), strName.size());
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] cText Nombre a registrar
+ * \param [in] szLen Longitud del nombre
+ *
+ * Normaliza el nombre (elimina los espacios de los extremos y lo convierte a
+ * minsculas) y lo busca en la tabla. Si no existe lo registra con un nuevo
+ * smbolo.
+ *
+ * \return Smbolo del nombre normalizado.
+ * \sa find()
+ */
+fzsymbol TFuzzySymbols::intern(const char* cText, size_t szLen)
+{
+	STable& st_table = table();
+
+	bounds(cText, szLen);
+
+	//-- La mayora de los nombres ya estn registrados: se buscan sin cerrojo
+	fzsymbol fs_sym = find(cText, szLen);
+	if(fs_sym != FL_INVALID_SYMBOL)
+		return fs_sym;
+
+	std::lock_guard<std::mutex> lock(st_table.Lock);
+	SBuckets* sb_buckets = st_table.Buckets.load(std::memory_order_relaxed);
+	size_t    sz_pos     = slot(st_table, sb_buckets, cText, szLen);
+
+	fs_sym = sb_buckets->Slots[sz_pos].load(std::memory_order_relaxed);
+	if(fs_sym != FL_INVALID_SYMBOL)
+		return fs_sym;
+
+	size_t sz_count = st_table.Count.load(std::memory_order_relaxed);
+	if(sz_count >= size_t(FZ_SYM_CHUNK) * FZ_SYM_CHUNKS)
+		throw TFuzzyError("intern", "Tabla de smbolos llena", __LINE__, __FILE__);
+
+	std::string* s_chunk = st_table.Chunks[sz_count / FZ_SYM_CHUNK].load(std::memory_order_relaxed);
+	if(!s_chunk)
+	{
+		s_chunk = new std::string[FZ_SYM_CHUNK];
+		st_table.Chunks[sz_count / FZ_SYM_CHUNK].store(s_chunk, std::memory_order_release);
+	}
+
+	std::string& str_name = s_chunk[sz_count % FZ_SYM_CHUNK];
+
+	str_name.assign(cText, szLen);
+	for(size_t i = 0; i < str_name.size(); ++i)
+		str_name[i] = lower(str_name[i]);
+
+	//-- Primero el nombre y luego el smbolo, para los lectores sin cerrojo
+	fs_sym = fzsymbol(sz_count);
+	st_table.Count.store(sz_count + 1, std::memory_order_release);
+	sb_buckets->Slots[sz_pos].store(fs_sym, std::memory_order_release);
+
+	//-- Mantiene el factor de carga por debajo de 1/2
+	if(2 * (sz_count + 1) > sb_buckets->Mask + 1)
+		grow(st_table);
+
+	return fs_sym;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strName Nombre a buscar
+ *
+ * \return Smbolo del nombre, FL_INVALID_SYMBOL si no se ha registrado nunca.
+ * \sa intern()
+ */
+fzsymbol TFuzzySymbols::find(const std::string& strName)
+{
+	return find(strName.data(), strName.size());
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] cText Nombre a buscar
+ * \param [in] szLen Longitud del nombre
+ *
+ * Busca el smbolo de un nombre sin registrarlo ni reservar memoria. Si el
+ * nombre no est registrado es que ningn objeto de la librera lo tiene, por
+ * lo que cualquier bsqueda por este nombre fallar.
+ *
+ * \return Smbolo del nombre, FL_INVALID_SYMBOL si no se ha registrado nunca.
+ * \sa intern()
+ */
+fzsymbol TFuzzySymbols::find(const char* cText, size_t szLen)
+{
+	STable& st_table = table();
+
+	bounds(cText, szLen);
+
+	SBuckets* sb_buckets = st_table.Buckets.load(std::memory_order_acquire);
+
+	return sb_buckets->Slots[slot(st_table, sb_buckets, cText, szLen)].load(std::memory_order_acquire);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fsSymbol Smbolo
+ *
+ * Los nombres se guardan en bloques que no se mueven al crecer la tabla,
+ * por lo que la referencia devuelta sigue siendo vlida aunque otros hilos
+ * registren nuevos nombres.
+ *
+ * \return Nombre normalizado del smbolo. Cadena vaca si el smbolo no
+ * existe.
+ */
+const std::string& TFuzzySymbols::name(fzsymbol fsSymbol)
+{
+	STable& st_table = table();
+
+	return fsSymbol < st_table.Count.load(std::memory_order_acquire)
+			? at(st_table, fsSymbol) : at(st_table, FL_EMPTY_SYMBOL);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Nmero de smbolos registrados (incluido FL_EMPTY_SYMBOL)
+ */
+size_t TFuzzySymbols::size()
+{
+	return table().Count.load(std::memory_order_acquire);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,150 @@
+/**
+ * \file fzsymbols.hpp
+ *
+ *  Symbol table. Every name used by the library is interned once, already
+ *  trimmed and lowercased, and identified afterwards by a fzsymbol.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZSYMBOLS_HPP__
+#define __FZSYMBOLS_HPP__
+//-----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include "fuzzy.hpp"
+//-----------------------------------------------------------------------------
+
+/** Nombres por bloque de la tabla de smbolos */
+#define FZ_SYM_CHUNK		4096
+/** Nmero mximo de bloques (FZ_SYM_CHUNK * FZ_SYM_CHUNKS smbolos) */
+#define FZ_SYM_CHUNKS		8192
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Tabla de smbolos de la librera.
+	 *
+	 * Los nombres de conjuntos, valores, funciones y modelos se comparan sin
+	 * tener en cuenta maysculas ni espacios al principio y final. En lugar de
+	 * normalizar y comparar cadenas de texto en cada bsqueda, cada nombre se
+	 * normaliza una nica vez y se registra en esta tabla, que le asigna un
+	 * smbolo (fzsymbol). Dos nombres equivalentes tienen siempre el mismo
+	 * smbolo, por lo que las bsquedas por nombre se reducen a buscar un
+	 * entero en un ndice hash.
+	 *
+	 * La tabla es global y slo crece: un smbolo es vlido durante toda la
+	 * vida del programa. El smbolo FL_EMPTY_SYMBOL corresponde a la cadena
+	 * vaca.
+	 *
+	 * Puede usarse desde varios hilos (por ejemplo, al cargar varios modelos
+	 * en paralelo con TFuzzyModels::load()). Slo los registros (intern())
+	 * se hacen bajo un cerrojo; las bsquedas (find(), name()), que son la
+	 * inmensa mayora de los accesos, no lo toman: los nombres nunca se
+	 * mueven una vez registrados y la tabla hash se publica entera, con un
+	 * puntero atmico, cada vez que crece.
+	 *
+	 * \sa TFuzzyBase::symbol()
+	 */
+	class TFuzzySymbols
+	{
+	private:
+		/** Tabla hash de direccionamiento abierto (smbolos) */
+		struct SBuckets
+		{
+			/** Tamao de la tabla menos uno (es potencia de 2) */
+			size_t                 Mask;
+			/** Smbolo de cada posicin, FL_INVALID_SYMBOL si est libre */
+			std::atomic<fzsymbol>* Slots;
+
+			SBuckets(size_t szSize);
+			~SBuckets();
+		};
+
+		/** Datos de la tabla */
+		struct STable
+		{
+			/** Nombres normalizados, indexados por smbolo, en bloques de
+			 * FZ_SYM_CHUNK que no se mueven una vez reservados */
+			std::atomic<std::string*> Chunks[FZ_SYM_CHUNKS];
+			/** Nmero de nombres registrados */
+			std::atomic<size_t>       Count;
+			/** Tabla hash en uso */
+			std::atomic<SBuckets*>    Buckets;
+			/** Tablas hash anteriores, que algn lector puede estar
+			 * recorriendo todava. Se liberan al final del programa */
+			std::vector<SBuckets*>    Retired;
+			/** Cerrojo de los registros */
+			std::mutex                Lock;
+
+			STable();
+			~STable();
+		};
+
+		/** Devuelve la tabla de smbolos (se crea en el primer uso) */
+		static STable& table();
+		/** Nombre normalizado de un smbolo ya registrado */
+		static inline const std::string& at(STable& stTable, fzsymbol fsSymbol)
+		{
+			return stTable.Chunks[fsSymbol / FZ_SYM_CHUNK].load(std::memory_order_acquire)[fsSymbol % FZ_SYM_CHUNK];
+		}
+
+		/** Ajusta los lmites de un texto eliminando los espacios */
+		static void   bounds(const char*& cText, size_t& szLen);
+		/** Calcula el hash de un texto normalizado */
+		static size_t hash(const char* cText, size_t szLen);
+		/** Compara un texto sin normalizar con un nombre ya normalizado */
+		static bool   equals(const std::string& strName, const char* cText, size_t szLen);
+		/** Busca la posicin de un texto en la tabla hash */
+		static size_t slot(STable& stTable, SBuckets* sbBuckets, const char* cText, size_t szLen);
+		/** Duplica el tamao de la tabla hash */
+		static void   grow(STable& stTable);
+
+	public:
+		/** Convierte un carcter a minsculas */
+		static inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; }
+
+		/** Registra un nombre y devuelve su smbolo */
+		static fzsymbol intern(const std::string& strName);
+		/** Registra un nombre y devuelve su smbolo */
+		static fzsymbol intern(const char* cText, size_t szLen);
+		/** Devuelve el smbolo de un nombre sin registrarlo */
+		static fzsymbol find(const std::string& strName);
+		/** Devuelve el smbolo de un nombre sin registrarlo */
+		static fzsymbol find(const char* cText, size_t szLen);
+		/** Devuelve el nombre normalizado de un smbolo */
+		static const std::string& name(fzsymbol fsSymbol);
+		/** Nmero de smbolos registrados */
+		static size_t size();
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZSYMBOLS_HPP__ */
+//-----------------------------------------------------------------------------
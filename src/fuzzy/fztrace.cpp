@@ -0,0 +1,266 @@
+/**
+ * \file fztrace.cpp
+ *
+ *  Execution trace. Timestamped events of the phases of TFuzzyExec kept in a
+ *  ring buffer and exported in Chrome trace format.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fztrace.hpp"
+#include "fzprofile.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szEvents Eventos que caben en el buffer. Se redondea a la
+ *                      siguiente potencia de 2.
+ */
+TFuzzyTrace::TFuzzyTrace(size_t szEvents) : m_uiHead(0)
+{
+	size_t sz_size = 1;
+
+	while(sz_size < szEvents)
+		sz_size <<= 1;
+
+	m_vEvents.resize(sz_size);
+	m_uiMask = sz_size - 1;
+}
+//-----------------------------------------------------------------------------
+
+TFuzzyTrace::~TFuzzyTrace()
+{
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return El instante actual en nanosegundos, en un reloj montono comn a
+ * todos los hilos.
+ */
+uint64_t TFuzzyTrace::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Un nmero pequeo que identifica al hilo actual, asignado la
+ * primera vez que lo pide (el principal no es necesariamente el 1).
+ */
+uint16_t TFuzzyTrace::thread()
+{
+	static std::atomic<uint16_t> ui_next(1);
+	static thread_local uint16_t ui_thread = ui_next.fetch_add(1);
+
+	return ui_thread;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return El nmero de eventos que hay en el buffer.
+ */
+size_t TFuzzyTrace::size() const
+{
+	uint64_t ui_total = total();
+
+	return ui_total < m_vEvents.size() ? size_t(ui_total) : m_vEvents.size();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiSet   Conjunto
+ * \param [in] strName Nombre con el que aparecer en la traza
+ */
+void TFuzzyTrace::name(uint32_t uiSet, const std::string& strName)
+{
+	m_mNames[uiSet] = strName;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] uiSet Conjunto
+ *
+ * \return El nombre del conjunto o su nmero si no lo tiene.
+ */
+std::string TFuzzyTrace::name(uint32_t uiSet) const
+{
+	std::map<uint32_t, std::string>::const_iterator found = m_mNames.find(uiSet);
+
+	if(found != m_mNames.end())
+		return found->second;
+
+	char c_num[16];
+	snprintf(c_num, sizeof(c_num), "#%u", uiSet);
+	return c_num;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \return Los eventos del buffer, del ms antiguo al ms reciente.
+ */
+std::vector<STraceEvent> TFuzzyTrace::events() const
+{
+	std::vector<STraceEvent> v_ret;
+	uint64_t                 ui_head  = total();
+	uint64_t                 ui_first = ui_head > m_vEvents.size() ? ui_head - m_vEvents.size() : 0;
+
+	v_ret.reserve(size_t(ui_head - ui_first));
+	for(uint64_t i = ui_first; i < ui_head; ++i)
+		v_ret.push_back(m_vEvents[i & m_uiMask]);
+
+	return v_ret;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Vaca el buffer. Los nombres de los conjuntos se conservan.
+ */
+void TFuzzyTrace::clear()
+{
+	m_uiHead.store(0, std::memory_order_release);
+}
+//-----------------------------------------------------------------------------
+
+void TFuzzyTrace::writeString(std::ostream& osOut, const std::string& strText)
+{
+	osOut << '"';
+	for(size_t i = 0; i < strText.size(); ++i)
+	{
+		unsigned char c_chr = (unsigned char)strText[i];
+
+		if(c_chr == '"' || c_chr == '\\')
+			osOut << '\\' << char(c_chr);
+		else if(c_chr < 0x20)
+		{
+			char c_esc[8];
+			snprintf(c_esc, sizeof(c_esc), "\\u%04x", c_chr);
+			osOut << c_esc;
+		}
+		else
+			osOut << char(c_chr);
+	}
+	osOut << '"';
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     osOut  Destino
+ * \param [in,out] bFirst Indica si todava no se ha escrito ningn evento (para
+ *                        separarlos con comas)
+ *
+ * Escribe los eventos como eventos completos ("ph":"X") de Chrome, con el
+ * comienzo y la duracin en microsegundos.
+ */
+void TFuzzyTrace::writeEvents(std::ostream& osOut, bool& bFirst) const
+{
+	std::vector<STraceEvent> v_events = events();
+	char                     c_time[64];
+
+	for(size_t i = 0; i < v_events.size(); ++i)
+	{
+		const STraceEvent& te_evt = v_events[i];
+		bool               b_calc = te_evt.Phase == FL_TRACE_CALCULATE;
+
+		osOut << (bFirst ? "\n" : ",\n") << "{\"name\":";
+		writeString(osOut, b_calc ? std::string("calculate")
+								  : std::string(SFuzzyProfile::phaseName(TProfilePhase(te_evt.Phase))));
+		osOut << ",\"cat\":";
+		writeString(osOut, te_evt.Set == FL_TRACE_NOSET ? std::string("exec") : name(te_evt.Set));
+
+		snprintf(c_time, sizeof(c_time), "%.3f,\"dur\":%.3f",
+				 double(te_evt.Begin) / 1.0E3, double(te_evt.End - te_evt.Begin) / 1.0E3);
+		osOut << ",\"ph\":\"X\",\"ts\":" << c_time
+			  << ",\"pid\":1,\"tid\":" << te_evt.Thread << "}";
+		bFirst = false;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] osOut Destino
+ *
+ * Escribe la traza en formato JSON de Chrome.
+ */
+void TFuzzyTrace::write(std::ostream& osOut) const
+{
+	write(osOut, std::vector<const TFuzzyTrace*>(1, this));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de destino
+ *
+ * \return true si se ha podido escribir.
+ */
+bool TFuzzyTrace::save(const std::string& strFile) const
+{
+	return save(strFile, std::vector<const TFuzzyTrace*>(1, this));
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] osOut   Destino
+ * \param [in] vTraces Trazas a escribir (las de varios ejecutores)
+ *
+ * Escribe varias trazas en un nico documento JSON de Chrome. Como todas
+ * usan el mismo reloj, los eventos de los distintos hilos quedan alineados.
+ */
+void TFuzzyTrace::write(std::ostream& osOut, const std::vector<const TFuzzyTrace*>& vTraces)
+{
+	bool b_first = true;
+
+	osOut << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	for(size_t i = 0; i < vTraces.size(); ++i)
+	{
+		if(vTraces[i])
+			vTraces[i]->writeEvents(osOut, b_first);
+	}
+	osOut << "\n]}\n";
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de destino
+ * \param [in] vTraces Trazas a escribir
+ *
+ * \return true si se ha podido escribir.
+ */
+bool TFuzzyTrace::save(const std::string& strFile, const std::vector<const TFuzzyTrace*>& vTraces)
+{
+	std::ofstream os_file(strFile.c_str(), std::ios::trunc | std::ios::out);
+
+	if(!os_file.is_open())
+		return false;
+
+	write(os_file, vTraces);
+	os_file.close();
+
+	return !os_file.fail();
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+/**
+ * \file fztrace.hpp
+ *
+ *  Execution trace. Timestamped events of the phases of TFuzzyExec kept in a
+ *  ring buffer and exported in Chrome trace format.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZTRACE_HPP__
+#define __FZTRACE_HPP__
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+//-----------------------------------------------------------------------------
+/** Eventos que guarda por omisin el buffer de una traza */
+#define FL_TRACE_SIZE		65536
+/** Conjunto de los eventos que no son de un conjunto (calculate()) */
+#define FL_TRACE_NOSET		0xFFFFFFFF
+/** Fase del evento de un TFuzzyExec::calculate() completo */
+#define FL_TRACE_CALCULATE	0xFFFF
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/** Evento de la traza: una fase de la ejecucin de un conjunto */
+	struct STraceEvent
+	{
+		/** Comienzo, en nanosegundos (TFuzzyTrace::now()) */
+		uint64_t Begin;
+		/** Final, en nanosegundos */
+		uint64_t End;
+		/** Conjunto (ver TFuzzyTrace::name()), FL_TRACE_NOSET si no es de uno */
+		uint32_t Set;
+		/** Fase (TProfilePhase) o FL_TRACE_CALCULATE */
+		uint16_t Phase;
+		/** Hilo que lo ha generado (TFuzzyTrace::thread()) */
+		uint16_t Thread;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Traza de la ejecucin de un TFuzzyExec (ver TFuzzyExec::traceEnable()).
+	 *
+	 * Los eventos se guardan en un buffer circular de tamao fijo: cuando se
+	 * llena, cada evento nuevo sustituye al ms antiguo, de manera que siempre
+	 * estn los ltimos. Cada ejecutor tiene el suyo y slo l escribe en l,
+	 * por lo que aadir un evento no necesita bloqueos: se escribe el evento y
+	 * despus se publica avanzando la cabeza del buffer.
+	 *
+	 * La traza puede exportarse en formato JSON de Chrome (chrome://tracing,
+	 * Perfetto), sola o junto a las de otros ejecutores, cada uno con los
+	 * eventos en el hilo en que se generaron. Debe exportarse cuando el
+	 * ejecutor no est calculando (desde su hilo o tras esperar a que termine).
+	 */
+	class TFuzzyTrace
+	{
+	private:
+		std::vector<STraceEvent>        m_vEvents;
+		/** Mscara del ndice del buffer (su tamao es potencia de 2) */
+		uint64_t                        m_uiMask;
+		/** Eventos aadidos desde el principio */
+		std::atomic<uint64_t>           m_uiHead;
+		/** Nombre de cada conjunto */
+		std::map<uint32_t, std::string> m_mNames;
+
+		void writeEvents(std::ostream& osOut, bool& bFirst) const;
+
+		static void writeString(std::ostream& osOut, const std::string& strText);
+
+	public:
+		TFuzzyTrace(size_t szEvents = FL_TRACE_SIZE);
+		virtual ~TFuzzyTrace();
+
+		static uint64_t now();
+		static uint16_t thread();
+
+		/** Nmero de eventos que caben en el buffer */
+		inline size_t   capacity() const { return m_vEvents.size(); }
+		/** Eventos aadidos desde el principio, incluidos los ya sustituidos */
+		inline uint64_t total()    const { return m_uiHead.load(std::memory_order_acquire); }
+		size_t          size()     const;
+
+		/** Aade un evento */
+		inline void add(uint64_t uiBegin, uint64_t uiEnd, uint32_t uiSet, uint16_t uiPhase)
+		{
+			uint64_t     ui_head = m_uiHead.load(std::memory_order_relaxed);
+			STraceEvent& te_evt  = m_vEvents[ui_head & m_uiMask];
+
+			te_evt.Begin  = uiBegin;
+			te_evt.End    = uiEnd;
+			te_evt.Set    = uiSet;
+			te_evt.Phase  = uiPhase;
+			te_evt.Thread = thread();
+			m_uiHead.store(ui_head + 1, std::memory_order_release);
+		}
+
+		void        name(uint32_t uiSet, const std::string& strName);
+		std::string name(uint32_t uiSet) const;
+
+		std::vector<STraceEvent> events() const;
+		void                     clear();
+
+		void write(std::ostream& osOut) const;
+		bool save(const std::string& strFile) const;
+
+		static void write(std::ostream& osOut, const std::vector<const TFuzzyTrace*>& vTraces);
+		static bool save(const std::string& strFile, const std::vector<const TFuzzyTrace*>& vTraces);
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZTRACE_HPP__ */
+//-----------------------------------------------------------------------------
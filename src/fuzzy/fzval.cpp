@@ -29,10 +29,212 @@
 //-----------------------------------------------------------------------------
 #include "fzval.hpp"
 #include <cmath>
+#include <functional>
 //-----------------------------------------------------------------------------
 using namespace nsFuzzy;
 //-----------------------------------------------------------------------------
 TFuzzyFunctions TFuzzyVal::m_ffFunctions;
+std::mutex      TFuzzyVal::m_mtShare;
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+TFuzzyDefs::TFuzzyDefs()
+{
+	m_uiSerial = 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] ffFunc  Funcin de grado de verdad (NULL si no tiene)
+ * \param [in] vParams Mnimo, mximo y parmetros de la funcin
+ *
+ * Busca una definicin igual a la indicada y, si no existe, la registra. En
+ * ambos casos la definicin queda en uso hasta la llamada correspondiente a
+ * release().
+ *
+ * La definicin nueva (coeficientes y punto mximo) se calcula fuera del
+ * cerrojo, para no bloquear a los dems hilos; si entretanto otro hilo ha
+ * registrado la misma, se descarta y se usa aqulla.
+ *
+ * \return Definicin compartida.
+ */
+const SFuzzyDef* TFuzzyDefs::acquire(SFuzzyFunction* ffFunc, const std::vector<fuzzvar>& vParams)
+{
+	fzhndl     fh_func = ffFunc ? ffFunc->handle() : INVALID_FUNC;
+	size_t     sz_hash = std::hash<fzhndl>()(fh_func);
+	SFuzzyDef* fd_def;
+
+	for(size_t i = 0; i < vParams.size(); ++i)
+		sz_hash ^= std::hash<fuzzvar>()(vParams[i]) + 0x9e3779b9 + (sz_hash << 6) + (sz_hash >> 2);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mtDefs);
+
+		if((fd_def = use(sz_hash, fh_func, vParams)) != NULL)
+			return fd_def;
+	}
+
+	fd_def = new SFuzzyDef;
+
+	fd_def->Function = fh_func;
+	fd_def->Call     = ffFunc ? ffFunc->Function : NULL;
+	fd_def->Compiled = ffFunc && ffFunc->Compile && ffFunc->Compiled
+					&& ffFunc->Compile(vParams, fd_def->Coefs) ? ffFunc->Compiled : NULL;
+	fd_def->Params   = vParams;
+	fd_def->MaxF     = ffFunc ? TFuzzyVal::calcMaxFunc(ffFunc, fd_def->Params)
+							  : TFuzzyBase::invalidNumber();
+	fd_def->Hash     = sz_hash;
+	fd_def->Refs     = 1;
+
+	std::lock_guard<std::mutex> lock(m_mtDefs);
+	SFuzzyDef*                  fd_found = use(sz_hash, fh_func, vParams);
+
+	if(fd_found)
+	{
+		delete fd_def;
+		return fd_found;
+	}
+
+	fd_def->Serial = ++m_uiSerial;
+	m_mDefs.insert(std::make_pair(sz_hash, fd_def));
+
+	return fd_def;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szHash  Hash de la funcin y los parmetros
+ * \param [in] fhFunc  Funcin de grado de verdad
+ * \param [in] vParams Mnimo, mximo y parmetros de la funcin
+ *
+ * Busca una definicin registrada y, si existe, la deja en uso. Debe
+ * llamarse con el cerrojo del registro.
+ *
+ * \return Definicin encontrada, NULL si no existe.
+ */
+SFuzzyDef* TFuzzyDefs::use(size_t szHash, fzhndl fhFunc, const std::vector<fuzzvar>& vParams)
+{
+	typedef std::unordered_multimap<size_t, SFuzzyDef*>::iterator defiter;
+
+	std::pair<defiter, defiter> range = m_mDefs.equal_range(szHash);
+	for(defiter iter = range.first; iter != range.second; ++iter)
+	{
+		if(iter->second->Function == fhFunc && iter->second->Params == vParams)
+		{
+			++iter->second->Refs;
+			return iter->second;
+		}
+	}
+
+	return NULL;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fdDef Definicin obtenida con acquire()
+ *
+ * Deja de usar una definicin. Cuando ningn valor la usa, se eliminan la
+ * definicin y sus curvas muestreadas.
+ */
+void TFuzzyDefs::release(const SFuzzyDef* fdDef)
+{
+	typedef std::unordered_multimap<size_t, SFuzzyDef*>::iterator defiter;
+
+	if(!fdDef)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_mtDefs);
+
+	std::pair<defiter, defiter> range = m_mDefs.equal_range(fdDef->Hash);
+	for(defiter iter = range.first; iter != range.second; ++iter)
+	{
+		if(iter->second == fdDef)
+		{
+			if(--iter->second->Refs == 0)
+			{
+				m_mCurves.erase(fdDef);
+				delete iter->second;
+				m_mDefs.erase(iter);
+			}
+			break;
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fdDef  Definicin
+ * \param [in] fvMin  Comienzo de la ventana
+ * \param [in] fvMax  Fin de la ventana
+ * \param [in] iCount Nmero de intervalos
+ *
+ * Muestrea la definicin en iCount + 1 puntos equiespaciados de la ventana
+ * [fvMin, fvMax], igual que TExecData al defuzzificar. La curva se calcula
+ * la primera vez que se pide y se comparte entre todos los conjuntos y
+ * ejecuciones que la piden despus.
+ *
+ * \return Grado de verdad en cada punto. Es vlido mientras la definicin
+ * est en uso.
+ */
+const fuzzvar* TFuzzyDefs::curve(const SFuzzyDef* fdDef, fuzzvar fvMin, fuzzvar fvMax, int iCount)
+{
+	std::lock_guard<std::mutex> lock(m_mtDefs);
+
+	std::list<SCurve>& l_curves = m_mCurves[fdDef];
+	for(std::list<SCurve>::iterator iter = l_curves.begin(); iter != l_curves.end(); ++iter)
+	{
+		if(iter->Min == fvMin && iter->Max == fvMax && iter->Count == iCount)
+			return &iter->Values[0];
+	}
+
+	SCurve  sc_curve;
+	fuzzvar fv_rng = fvMax - fvMin;
+	fuzzvar x;
+
+	sc_curve.Min   = fvMin;
+	sc_curve.Max   = fvMax;
+	sc_curve.Count = iCount;
+	sc_curve.Values.resize(iCount + 1);
+	for(int i = 0; i < iCount + 1; ++i)
+	{
+		x = fvMin + i * fv_rng / iCount;
+		if(fdDef->Compiled)
+			sc_curve.Values[i] = fdDef->Compiled(fdDef->Coefs, x);
+		else
+			sc_curve.Values[i] = fdDef->Call
+					? fdDef->Call(const_cast<fuzzlist&>(fdDef->Params), x) : fuzzvar(0.0);
+	}
+	l_curves.push_back(sc_curve);
+
+	return &l_curves.back().Values[0];
+}
+//-----------------------------------------------------------------------------
+
+/**
+ *
+ */
+size_t TFuzzyDefs::size()
+{
+	std::lock_guard<std::mutex> lock(m_mtDefs);
+
+	return m_mDefs.size();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * El registro se crea en el primer uso y no se destruye, ya que puede haber
+ * valores estticos (modelos globales) que se destruyan despus que l.
+ *
+ * \return Registro de definiciones compartidas por todos los valores.
+ */
+TFuzzyDefs& TFuzzyVal::definitions()
+{
+	static TFuzzyDefs* fd_defs = new TFuzzyDefs();
+
+	return *fd_defs;
+}
 //-----------------------------------------------------------------------------
 
 /**
@@ -50,11 +252,11 @@ TFuzzyVal::TFuzzyVal(std::string strName) : TFuzzyBase(FL_ID_VAL)
         throw TFuzzyError("contructor", "Nombre no especificado. El Objeto "
         				  "no puede construirse", __LINE__, __FILE__);
 
-	m_fvMaxF  = TFuzzyBase::invalidNumber();
+	m_fdDef   = NULL;
     m_ffId    = INVALID_FUNC;
-    m_strName = strName;
+    m_bDirty  = false;
 
-	toLower(trim(m_strName));
+	name(strName);
 }
 //-----------------------------------------------------------------------------
 
@@ -66,6 +268,7 @@ TFuzzyVal::TFuzzyVal(std::string strName) : TFuzzyBase(FL_ID_VAL)
  */
 TFuzzyVal::~TFuzzyVal()
 {
+	definitions().release(m_fdDef);
 }
 //-----------------------------------------------------------------------------
 
@@ -81,50 +284,58 @@ TFuzzyVal::~TFuzzyVal()
  */
 fuzzvar TFuzzyVal::exeFunction(fuzzvar x)
 {
-	if(INVALID_FUNC == m_ffId)
+	if(m_bDirty)
+		share();
+	if(m_fdDef && m_fdDef->Compiled)
+		return m_fdDef->Compiled(m_fdDef->Coefs, x);
+	if(m_fdDef)
+		return m_fdDef->Call ? m_fdDef->Call(const_cast<fuzzlist&>(m_fdDef->Params), x) : 0.0;
+
+	SFuzzyFunction* ff_func = m_ffFunctions[m_ffId];
+
+	if(!ff_func || m_vParams.size() < 2)
 		return 0.0;
 
-    if(!m_vParams.size())
-    {
-        size(0);
-        m_vParams[0] = 0.0;
-        m_vParams[1] = 10.0;
-    }
-    return m_ffFunctions[m_ffId]->Function(m_vParams, x);
+    return ff_func->Function(m_vParams, x);
 }
 //-----------------------------------------------------------------------------
 
 /**
+ * \param [in] ffFunc  Funcin de grado de verdad
+ * \param [in] vParams Mnimo, mximo y parmetros de la funcin
+ *
  * Calcula el punto donde la funcin es mxima
  */
-fuzzvar TFuzzyVal::calcMaxFunc()
+fuzzvar TFuzzyVal::calcMaxFunc(SFuzzyFunction* ffFunc, std::vector<fuzzvar>& vParams)
 {
-	fuzzvar x   = min();
-	fuzzvar y   = 0.0;
-	fuzzvar dy  = 2.0;
-	fuzzvar Dx  = (max() - min()) / 2;
-	fuzzvar de2 = 1.0E-6;
+	fuzzvar f_min = vParams.size() > 0 ? vParams[0] : 0.0;
+	fuzzvar f_max = vParams.size() > 1 ? vParams[1] : 0.0;
+	fuzzvar x     = f_min;
+	fuzzvar y     = 0.0;
+	fuzzvar dy    = 2.0;
+	fuzzvar Dx    = (f_max - f_min) / 2;
+	fuzzvar de2   = 1.0E-6;
 
 	while(dy > de2)
 	{
 		x += Dx;
 
 		dy  = y;
-		y   = exeFunction(x);
+		y   = ffFunc->Function(vParams, x);
 
 		if(y < dy)
 			Dx /= -2.0;
 
 		dy = pow(y - dy, 2.0);
 
-		if(x > max())
+		if(x > f_max)
 		{
-			x  = max();
+			x  = f_max;
 			dy = 0.0;
 		}
-		else if(x < min())
+		else if(x < f_min)
 		{
-			x  = min();
+			x  = f_min;
 			dy = 0.0;
 		}
 	}
@@ -133,6 +344,79 @@ fuzzvar TFuzzyVal::calcMaxFunc()
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \return Punto donde la funcin es mxima, TFuzzyBase::invalidNumber() si
+ * el valor no tiene funcin.
+ */
+fuzzvar TFuzzyVal::maxF()
+{
+	return definition() ? definition()->MaxF : TFuzzyBase::invalidNumber();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Registra la definicin del valor (funcin y parmetros) en el registro de
+ * definiciones compartidas (definitions()) y libera la propia. Los valores
+ * definidos de la misma manera comparten as una nica copia y se pueden
+ * evaluar una sola vez para una misma entrada.
+ *
+ * Los mtodos que modifican el valor (min(), max(), size(), set(),
+ * setFunction() y operator[]()) slo lo marcan como modificado: la
+ * definicin (con sus coeficientes precalculados, SFuzzyDef::Compiled) se
+ * actualiza una nica vez, en la siguiente evaluacin (execute(),
+ * definition(), maxF()) o llamada a share(). As, modificar varios
+ * parmetros seguidos no registra definiciones intermedias. La actualizacin
+ * est protegida por un cerrojo, ya que pueden pedirla a la vez varios
+ * TFuzzyExec que ejecutan el mismo modelo.
+ */
+void TFuzzyVal::share()
+{
+	std::lock_guard<std::mutex> lock(m_mtShare);
+
+	if(m_fdDef && !m_bDirty)
+		return;
+
+	if(m_vParams.size() < 2)
+	{
+		m_vParams.resize(2, 0.0);
+		m_vParams[1] = 10.0;
+	}
+
+	//-- La lista propia se conserva: otro hilo puede estar leyndola
+	const SFuzzyDef* fd_old = m_fdDef;
+
+	m_fdDef  = definitions().acquire(m_ffFunctions[m_ffId], m_vParams);
+	m_bDirty = false;
+	definitions().release(fd_old);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Deja en la lista propia los parmetros actuales antes de modificarlos. La
+ * definicin compartida se mantiene hasta que se actualiza (ver share()).
+ */
+void TFuzzyVal::edit()
+{
+	if(!m_bDirty && m_fdDef)
+		m_vParams = m_fdDef->Params;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Completa el mnimo y el mximo si faltan, como share(), y deja la
+ * definicin pendiente de actualizar.
+ */
+void TFuzzyVal::edited()
+{
+	if(m_vParams.size() < 2)
+	{
+		m_vParams.resize(2, 0.0);
+		m_vParams[1] = 10.0;
+	}
+	m_bDirty = true;
+}
+//-----------------------------------------------------------------------------
+
 /**
  * \param [in] szCount Nmero de parmetros a asignar
  *
@@ -152,10 +436,12 @@ void TFuzzyVal::size(size_t szCount)
 {
 	size_t sz_cnt = szCount + 2;
 
+	edit();
 	while(m_vParams.size() > sz_cnt)
 		m_vParams.pop_back();
 	while(m_vParams.size() < sz_cnt)
 		m_vParams.push_back(0.0);
+	edited();
 }
 //-----------------------------------------------------------------------------
 
@@ -174,10 +460,12 @@ void TFuzzyVal::size(size_t szCount)
  */
 void TFuzzyVal::min(fuzzvar fvMin)
 {
+	edit();
 	if(m_vParams.size() > 0)
 		m_vParams[0] = fvMin;
 	else
 		m_vParams.push_back(fvMin);
+	edited();
 }
 //-----------------------------------------------------------------------------
 
@@ -196,6 +484,7 @@ void TFuzzyVal::min(fuzzvar fvMin)
  */
 void TFuzzyVal::max(fuzzvar fvMax)
 {
+	edit();
 	switch(m_vParams.size())
 	{
 	case 0:
@@ -210,6 +499,7 @@ void TFuzzyVal::max(fuzzvar fvMax)
 		m_vParams[1] = fvMax;
 		break;
 	}
+	edited();
 }
 //-----------------------------------------------------------------------------
 
@@ -231,9 +521,10 @@ void TFuzzyVal::max(fuzzvar fvMax)
 fzhndl TFuzzyVal::setFunction(std::string strName)
 {
 	SFuzzyFunction* ff_func = m_ffFunctions[strName];
-    m_ffId = ff_func ? ff_func->handle() : FL_INVALID_HANDLE;
 
-    m_fvMaxF = calcMaxFunc();
+	edit();
+    m_ffId = ff_func ? ff_func->handle() : FL_INVALID_HANDLE;
+    edited();
 
     return m_ffId;
 }
@@ -258,12 +549,41 @@ std::string TFuzzyVal::setFunction(fzhndl ffId)
 {
 	SFuzzyFunction* ff_func = m_ffFunctions[ffId];
 
+	edit();
 	m_ffId = ff_func ? ffId : INVALID_FUNC;
+	edited();
 
     return ff_func ? ff_func->name() : std::string("");
 }
 //-----------------------------------------------------------------------------
 
+/**
+ * \param [in] strName Nombre de la funcin a asignar (vaco si no tiene).
+ * \param [in] vParams Mnimo, mximo y parmetros de la funcin.
+ *
+ * Asigna de una vez la funcin y todos sus parmetros y comparte la
+ * definicin resultante. Equivale a min(), max(), size(), set() y
+ * setFunction() seguidos, pero registra una nica definicin, por lo que es
+ * la forma de definir un valor al cargar o generar un modelo.
+ *
+ * \return Descriptor de la funcin con nombre strName, FL_INVALID_HANDLE en
+ * caso de no existir la funcin.
+ * \sa setFunction(), share()
+ */
+fzhndl TFuzzyVal::define(const std::string& strName, const std::vector<fuzzvar>& vParams)
+{
+	SFuzzyFunction* ff_func = m_ffFunctions[strName];
+
+	m_ffId    = ff_func ? ff_func->handle() : INVALID_FUNC;
+	m_vParams = vParams;
+	edited();
+	share();
+	std::vector<fuzzvar>().swap(m_vParams);
+
+	return ff_func ? m_ffId : FL_INVALID_HANDLE;
+}
+//-----------------------------------------------------------------------------
+
 /**
  * \param [in] iIndex Posicin del parmetro.
  *
@@ -272,13 +592,56 @@ std::string TFuzzyVal::setFunction(fzhndl ffId)
  * parmetro 0. Para determinar cuntos parmetros tiene una funcion se puede
  * usar el mtodo size().
  *
+ * Como el parmetro puede modificarse a travs de la referencia, el valor
+ * queda marcado como modificado y su definicin se actualiza en la siguiente
+ * evaluacin (ver share()); la referencia slo debe usarse hasta entonces.
+ * Para slo leerlo, usar param(); para modificarlo, set().
+ *
  * \return Valor del parmetro en la posicin iIndex, TFuzzyBase::invalid()
  * en caso de no existir dicha posicin.
- * \sa size()
+ * \sa size(), param()
  */
 fuzzvar& TFuzzyVal::operator[](int iIndex)
+{
+	if(iIndex < 0 || size_t(iIndex) >= size())
+		return invalidNumber();
+
+	edit();
+	edited();
+	return m_vParams[iIndex + 2];
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] iIndex Posicin del parmetro.
+ *
+ * \return Valor del parmetro en la posicin iIndex (como operator[]()), sin
+ * marcar el valor como modificado.
+ * \sa operator[]()
+ */
+fuzzvar TFuzzyVal::param(int iIndex)
 {
 	return (iIndex >= 0 && size_t(iIndex) < size())
-			? m_vParams[iIndex + 2] : invalidNumber();
+			? params()[iIndex + 2] : invalidNumber();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] iIndex Posicin del parmetro.
+ * \param [in] Value  Nuevo valor del parmetro.
+ *
+ * Asigna el parmetro en la posicin iIndex. Si no existe, no hace nada.
+ *
+ * \return Nada
+ * \sa operator[](), size()
+ */
+void TFuzzyVal::set(int iIndex, fuzzvar Value)
+{
+	if(iIndex >= 0 && size_t(iIndex) < size())
+	{
+		edit();
+		m_vParams[iIndex + 2] = Value;
+		edited();
+	}
 }
 //-----------------------------------------------------------------------------
@@ -32,6 +32,10 @@
 #define __FZVAL_HPP__
 //-----------------------------------------------------------------------------
 #include <vector>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
 #include "fzfunction.hpp"
 //-----------------------------------------------------------------------------
 
@@ -39,6 +43,91 @@ namespace nsFuzzy
 {
 	//-------------------------------------------------------------------------
 
+	/**
+	 * Definicin de un grado de verdad: la funcin y sus parmetros. Es
+	 * inmutable y la comparten todos los valores (TFuzzyVal) definidos de la
+	 * misma manera (ver TFuzzyDefs).
+	 */
+	struct SFuzzyDef
+	{
+		/** Funcin de grado de verdad */
+		fzhndl               Function;
+		/** Mnimo, mximo y parmetros de la funcin */
+		std::vector<fuzzvar> Params;
+		/** Punto donde la funcin es mxima */
+		fuzzvar              MaxF;
+		/** Puntero a la funcin, NULL si no tiene */
+		FFuzzyFunction       Call;
+		/** Coeficientes precalculados de la funcin (ver
+		 * SFuzzyFunction::Compile) */
+		SFuzzyCoefs          Coefs;
+		/** La funcin con los coeficientes precalculados, NULL si la funcin
+		 * no los tiene o sus parmetros no son vlidos (se usa Call) */
+		FFuzzyCompiled       Compiled;
+		/** Hash de la funcin y los parmetros */
+		size_t               Hash;
+		/** Nmero de serie, distinto en cada definicin registrada. Una
+		 * definicin nueva puede ocupar la direccin de otra ya liberada, por
+		 * lo que quien guarde datos de una definicin debe compararlo */
+		uint64_t             Serial;
+		/** Nmero de valores que la usan */
+		unsigned int         Refs;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Registro de las definiciones de grado de verdad (SFuzzyDef).
+	 *
+	 * Los modelos generados repiten a menudo la misma funcin con los mismos
+	 * parmetros en cientos de valores. Cada definicin distinta se guarda
+	 * una sola vez y los valores la referencian, de manera que tampoco es
+	 * necesario evaluarla ms de una vez para la misma entrada: las curvas
+	 * muestreadas para la defuzzificacin (curve()) se calculan una sola vez
+	 * y se comparten entre conjuntos y ejecuciones.
+	 *
+	 * Las definiciones se liberan cuando ningn valor las usa. El registro
+	 * est protegido por un cerrojo; las definiciones, al ser inmutables, se
+	 * leen sin l.
+	 *
+	 * \sa TFuzzyVal::share()
+	 */
+	class TFuzzyDefs
+	{
+	private:
+		/** Curva muestreada de una definicin */
+		struct SCurve
+		{
+			/** Ventana y nmero de intervalos del muestreo */
+			fuzzvar              Min, Max;
+			int                  Count;
+			/** Grado de verdad en cada punto (Count + 1) */
+			std::vector<fuzzvar> Values;
+		};
+
+		/** Definiciones por su hash */
+		std::unordered_multimap<size_t, SFuzzyDef*>                m_mDefs;
+		/** Curvas muestreadas de cada definicin */
+		std::unordered_map<const SFuzzyDef*, std::list<SCurve> > m_mCurves;
+		/** Cerrojo del registro */
+		std::mutex                                                m_mtDefs;
+		/** ltimo nmero de serie asignado */
+		uint64_t                                                  m_uiSerial;
+
+		SFuzzyDef* use(size_t szHash, fzhndl fhFunc, const std::vector<fuzzvar>& vParams);
+
+	public:
+		TFuzzyDefs();
+
+		const SFuzzyDef* acquire(SFuzzyFunction* ffFunc, const std::vector<fuzzvar>& vParams);
+		void             release(const SFuzzyDef* fdDef);
+
+		const fuzzvar*   curve(const SFuzzyDef* fdDef, fuzzvar fvMin, fuzzvar fvMax, int iCount);
+
+		/** Nmero de definiciones distintas en uso */
+		size_t size();
+	};
+	//-------------------------------------------------------------------------
+
 	/**
 	 * Esta clase personaliza una funcin en lgica difusa para luego usarla
 	 * en un set.
@@ -51,17 +140,32 @@ namespace nsFuzzy
 		/** Lista de todas funciones registradas */
 		static TFuzzyFunctions m_ffFunctions;
 
-		/** Punto donde la funcin es mxima */
-		fuzzvar              m_fvMaxF;
-		/** Lista de parmetros */
+		/** Cerrojo para compartir las definiciones modificadas */
+		static std::mutex      m_mtShare;
+
+		/** Definicin compartida (NULL mientras el valor no se ha definido) */
+		const SFuzzyDef*     m_fdDef;
+		/** Lista de parmetros propia, en uso mientras el valor no tiene
+		 * definicin o la tiene pendiente de actualizar */
 		std::vector<fuzzvar> m_vParams;
         /** Funcin de grado de verdad */
         fzhndl               m_ffId;
+        /** Indica que el valor se ha modificado y su definicin est
+         * pendiente de actualizar (ver share()) */
+        std::atomic<bool>    m_bDirty;
+
+        /** Parmetros en uso: los de la definicin compartida o los propios */
+        inline const std::vector<fuzzvar>& params()
+        {
+        	return !m_bDirty && m_fdDef ? m_fdDef->Params : m_vParams;
+        }
 
         /** Ejecuta la funcin */
         fuzzvar exeFunction(fuzzvar x);
-        /** Calcula el punto donde la funcin es mxima */
-        fuzzvar calcMaxFunc();
+        /** Prepara la lista de parmetros propia para modificarla */
+        void    edit();
+        /** Marca el valor como modificado (ver share()) */
+        void    edited();
 
 	protected:
 	public:
@@ -70,14 +174,32 @@ namespace nsFuzzy
 		/** Destructor de la clase */
 		virtual ~TFuzzyVal();
 
+		/** Registro de definiciones compartidas */
+		static TFuzzyDefs& definitions();
+		/** Calcula el punto donde una funcin es mxima */
+		static fuzzvar calcMaxFunc(SFuzzyFunction* ffFunc, std::vector<fuzzvar>& vParams);
+
 		/** Nmero de parmetros */
-		inline size_t        size() { return m_vParams.size() > 1 ? m_vParams.size() - 2 : 0; }
+		inline size_t        size() { return params().size() > 1 ? params().size() - 2 : 0; }
 		/** Valor mnimo sobre el que aplicar la funcin */
-		inline fuzzvar       min()  { return m_vParams.size() > 0 ? m_vParams[0] : 0.0; }
+		inline fuzzvar       min()  { return params().size() > 0 ? params()[0] : 0.0; }
 		/** Valor mximo sobre el que aplicar la funcin */
-		inline fuzzvar       max()  { return m_vParams.size() > 1 ? m_vParams[1] : 0.0; }
+		inline fuzzvar       max()  { return params().size() > 1 ? params()[1] : 0.0; }
 		/** Devuelve el valor x donde la funcin es mxima */
-		inline fuzzvar       maxF() { return m_fvMaxF; }
+		fuzzvar              maxF();
+		/** Devuelve el parmetro en la posicin especificada, sin modificarlo */
+		fuzzvar              param(int iIndex);
+
+		/** Definicin compartida, NULL si el valor no se ha definido (ver
+		 * share()) */
+		inline const SFuzzyDef* definition()
+		{
+			if(m_bDirty)
+				share();
+			return m_fdDef;
+		}
+		/** Comparte la definicin con los valores definidos igual */
+		void share();
 
 		/** Asigna el nmero de parmetros */
 		void size(size_t szCount);
@@ -96,9 +218,18 @@ namespace nsFuzzy
 		fzhndl setFunction(std::string strName);
 		/** Asigna una funcin para el grado de verdad a este valor */
 		std::string setFunction(fzhndl ffId);
+		/** Asigna la funcin y todos sus parmetros a la vez */
+		fzhndl define(const std::string& strName, const std::vector<fuzzvar>& vParams);
 
-		/** Calcula el resultado de la funcin de grado de verdad */
-		inline fuzzvar execute(fuzzvar fvX) { return exeFunction(fvX); }
+		/** Calcula el resultado de la funcin de grado de verdad. Con la
+		 * definicin compartida se usan sus coeficientes precalculados */
+		inline fuzzvar execute(fuzzvar fvX)
+		{
+			if(m_bDirty)
+				share();
+			return m_fdDef && m_fdDef->Compiled ? m_fdDef->Compiled(m_fdDef->Coefs, fvX)
+												: exeFunction(fvX);
+		}
 		/** Devuelve el parmetro en la posicin especificada */
 		fuzzvar& operator[](int iIndex);
 	};
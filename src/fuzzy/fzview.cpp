@@ -0,0 +1,314 @@
+/**
+ * \file fzview.cpp
+ *
+ *  Execution views of a TFuzzyModel and of a TFuzzyImage.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzview.hpp"
+#include "fzsymbols.hpp"
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+TModelView::TModelView(TFuzzyModel* fmModel)
+{
+	m_fmModel = fmModel;
+}
+//-----------------------------------------------------------------------------
+
+TModelView::~TModelView()
+{
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fsSet Conjunto del modelo
+ *
+ * El ndice de posiciones se vuelve a construir cuando el modelo ha ganado
+ * conjuntos o una posicin ya no corresponde a su conjunto.
+ *
+ * \return Posicin del conjunto, FL_VIEW_NONE si no es del modelo.
+ */
+uint32_t TModelView::position(TFuzzySet* fsSet)
+{
+	std::unordered_map<TFuzzyBase*, uint32_t>::iterator found = m_mSets.find(fsSet);
+
+	if(found != m_mSets.end() && found->second < setCount() && &fuzzySet(found->second) == fsSet)
+		return found->second;
+	if(found == m_mSets.end() && m_mSets.size() == setCount())
+		return FL_VIEW_NONE;
+
+	m_mSets.clear();
+	for(uint32_t i = 0; i < setCount(); ++i)
+		m_mSets[&fuzzySet(i)] = i;
+	found = m_mSets.find(fsSet);
+
+	return found == m_mSets.end() ? FL_VIEW_NONE : found->second;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  fvVal Valor de una regla
+ * \param [out] vpPos Conjunto y posicin del valor
+ */
+void TModelView::locate(TFuzzyVal* fvVal, SValuePos& vpPos)
+{
+	TFuzzySet* fs_set = fvVal ? (TFuzzySet*)fvVal->parent() : NULL;
+
+	vpPos.Value    = fvVal;
+	vpPos.Set      = fs_set ? position(fs_set) : FL_VIEW_NONE;
+	vpPos.Position = FL_VIEW_NONE;
+	for(uint32_t i = 0; vpPos.Set != FL_VIEW_NONE && i < fs_set->size(); ++i)
+	{
+		if(&(*fs_set)[int(i)] == fvVal)
+		{
+			vpPos.Position = i;
+			return;
+		}
+	}
+
+	std::string str_why = fvVal ? std::string("The value '") + fvVal->name()
+								+ std::string("' does not belong to any set of the model.")
+								: std::string("No value to apply the rule to found.");
+	throw TFuzzyError("locate", str_why.c_str(), __LINE__, __FILE__);
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TModelView::setCount()
+{
+	return uint32_t(m_fmModel->sets().size());
+}
+//-----------------------------------------------------------------------------
+
+std::string TModelView::setName(uint32_t uiSet)
+{
+	return fuzzySet(uiSet).name();
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TModelView::set(const std::string& strName)
+{
+	TFuzzySet* fs_set = m_fmModel->sets().bySymbol(TFuzzySymbols::find(strName));
+
+	return fs_set ? position(fs_set) : FL_VIEW_NONE;
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TModelView::set(fzhndl fhSet)
+{
+	TFuzzySet& fs_set = m_fmModel->sets()[fhSet];
+
+	return fs_set.handle() == fhSet ? position(&fs_set) : FL_VIEW_NONE;
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TModelView::valueCount(uint32_t uiSet)
+{
+	return uint32_t(fuzzySet(uiSet).size());
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TModelView::min(uint32_t uiSet)
+{
+	return fuzzySet(uiSet).min();
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TModelView::max(uint32_t uiSet)
+{
+	return fuzzySet(uiSet).max();
+}
+//-----------------------------------------------------------------------------
+
+const SFuzzyDef* TModelView::definition(uint32_t uiSet, uint32_t uiValue)
+{
+	return fuzzySet(uiSet)[int(uiValue)].definition();
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TModelView::execute(uint32_t uiSet, uint32_t uiValue, fuzzvar x)
+{
+	return fuzzySet(uiSet)[int(uiValue)].execute(x);
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TModelView::ruleCount()
+{
+	return uint32_t(m_fmModel->rules().size());
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TModelView::atomCount(uint32_t uiRule)
+{
+	return m_fmModel->rules()[uiRule].AtomCount;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  uiRule Posicin de la regla
+ * \param [in]  uiAtom Posicin del tomo en la regla
+ * \param [out] vaAtom tomo por posicin
+ *
+ * La posicin de cada valor de las reglas se guarda la primera vez que se
+ * busca y se comprueba en cada uso: si el valor ya no est en ella (se han
+ * eliminado valores de su conjunto o las reglas han reconstruido su tabla de
+ * valores), se vuelve a buscar.
+ */
+void TModelView::atom(uint32_t uiRule, uint32_t uiAtom, SViewAtom& vaAtom)
+{
+	TFuzzyRules&     fr_rules = m_fmModel->rules();
+	const SRuleAtom& ra_atom  = fr_rules.atoms(fr_rules[uiRule])[uiAtom];
+	TFuzzyVal*       fv_val   = fr_rules.value(ra_atom);
+
+	if(ra_atom.Value >= m_vValues.size())
+	{
+		SValuePos vp_none = { NULL, FL_VIEW_NONE, FL_VIEW_NONE };
+		m_vValues.resize(ra_atom.Value + 1, vp_none);
+	}
+
+	SValuePos& vp_pos = m_vValues[ra_atom.Value];
+	if(vp_pos.Value != fv_val || vp_pos.Set >= setCount()
+			|| &fuzzySet(vp_pos.Set)[int(vp_pos.Position)] != fv_val)
+		locate(fv_val, vp_pos);
+
+	vaAtom.Set       = vp_pos.Set;
+	vaAtom.Value     = vp_pos.Position;
+	vaAtom.Modifiers = ra_atom.Modifiers;
+}
+//-----------------------------------------------------------------------------
+
+
+
+
+
+
+
+
+/**
+ * \param [in] fiImage Imagen proyectada
+ *
+ * Registra, si an no lo estn, las definiciones de los valores de la imagen
+ * (ver TFuzzyImage::share()).
+ */
+TImageView::TImageView(TFuzzyImage* fiImage)
+{
+	m_fiImage = fiImage;
+	m_fiImage->share();
+}
+//-----------------------------------------------------------------------------
+
+TImageView::~TImageView()
+{
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TImageView::setCount()
+{
+	return m_fiImage->setCount();
+}
+//-----------------------------------------------------------------------------
+
+std::string TImageView::setName(uint32_t uiSet)
+{
+	return m_fiImage->string(TBinOrder::swap32(m_fiImage->sets()[uiSet].Name));
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TImageView::set(const std::string& strName)
+{
+	uint32_t ui_set = m_fiImage->set(strName);
+
+	return ui_set == FL_BIN_NONE ? FL_VIEW_NONE : ui_set;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * La imagen no tiene descriptores: sus conjuntos slo se buscan por nombre
+ * o se usan por posicin.
+ */
+uint32_t TImageView::set(fzhndl /*fhSet*/)
+{
+	return FL_VIEW_NONE;
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TImageView::valueCount(uint32_t uiSet)
+{
+	return TBinOrder::swap32(m_fiImage->sets()[uiSet].ValueCount);
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TImageView::min(uint32_t uiSet)
+{
+	return TBinOrder::fromFile(m_fiImage->sets()[uiSet].Min);
+}
+//-----------------------------------------------------------------------------
+
+fuzzvar TImageView::max(uint32_t uiSet)
+{
+	return TBinOrder::fromFile(m_fiImage->sets()[uiSet].Max);
+}
+//-----------------------------------------------------------------------------
+
+const SFuzzyDef* TImageView::definition(uint32_t uiSet, uint32_t uiValue)
+{
+	return m_fiImage->definition(TBinOrder::swap32(m_fiImage->sets()[uiSet].FirstValue) + uiValue);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Todos los valores de la imagen tienen definicin compartida, por lo que
+ * TExecData no llega a pedir este resultado; se calcula igual con ella.
+ */
+fuzzvar TImageView::execute(uint32_t uiSet, uint32_t uiValue, fuzzvar x)
+{
+	const SFuzzyDef* fd_def = definition(uiSet, uiValue);
+
+	return fd_def->Call ? fd_def->Call(const_cast<fuzzlist&>(fd_def->Params), x) : 0.0;
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TImageView::ruleCount()
+{
+	return m_fiImage->ruleCount();
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TImageView::atomCount(uint32_t uiRule)
+{
+	return TBinOrder::swap32(m_fiImage->rules()[uiRule].AtomCount);
+}
+//-----------------------------------------------------------------------------
+
+void TImageView::atom(uint32_t uiRule, uint32_t uiAtom, SViewAtom& vaAtom)
+{
+	const SBinAtom& ba_atom = m_fiImage->atoms()[TBinOrder::swap32(m_fiImage->rules()[uiRule].FirstAtom) + uiAtom];
+
+	vaAtom.Set       = TBinOrder::swap32(ba_atom.Set);
+	vaAtom.Value     = TBinOrder::swap32(ba_atom.Position);
+	vaAtom.Modifiers = TBinOrder::swap32(ba_atom.Modifiers);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,190 @@
+/**
+ * \file fzview.hpp
+ *
+ *  Execution views. The sets, values and rules of a TFuzzyModel or of a
+ *  TFuzzyImage seen by position, so that TFuzzyExec runs both the same way.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#ifndef __FZVIEW_HPP__
+#define __FZVIEW_HPP__
+//-----------------------------------------------------------------------------
+#include "fzmodel.hpp"
+#include "fzimage.hpp"
+//-----------------------------------------------------------------------------
+/** Posicin que no corresponde a ningn conjunto de la vista */
+#define FL_VIEW_NONE		0xFFFFFFFF
+//-----------------------------------------------------------------------------
+
+namespace nsFuzzy
+{
+	//-------------------------------------------------------------------------
+
+	/**
+	 * tomo de una regla visto por posicin: el conjunto, la posicin del
+	 * valor dentro del conjunto y los modificadores, empaquetados como en
+	 * SRuleAtom.
+	 */
+	struct SViewAtom
+	{
+		uint32_t Set;
+		uint32_t Value;
+		uint32_t Modifiers;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Lo que TExecData necesita de un modelo para ejecutarlo: sus conjuntos,
+	 * los valores de cada conjunto y las reglas, todo por posicin.
+	 *
+	 * Los conjuntos se numeran desde 0, sin huecos, y un conjunto no cambia
+	 * de posicin mientras exista; los valores, desde 0 dentro de su
+	 * conjunto. Las reglas tienen la posicin que tienen en el modelo, por lo
+	 * que las estadsticas (SRuleStats) y el registro (TFuzzyLog) se refieren a
+	 * ellas igual en cualquier vista.
+	 *
+	 * \sa TModelView, TImageView, TFuzzyExec
+	 */
+	class TExecView
+	{
+	public:
+		virtual ~TExecView() {}
+
+		/** Nmero de conjuntos */
+		virtual uint32_t    setCount() = 0;
+		/** Nombre del conjunto uiSet */
+		virtual std::string setName(uint32_t uiSet) = 0;
+		/** Posicin del conjunto strName, FL_VIEW_NONE si no existe */
+		virtual uint32_t    set(const std::string& strName) = 0;
+		/** Posicin del conjunto con el descriptor fhSet, FL_VIEW_NONE si no
+		 * existe o la vista no tiene descriptores */
+		virtual uint32_t    set(fzhndl fhSet) = 0;
+
+		/** Nmero de valores del conjunto uiSet */
+		virtual uint32_t    valueCount(uint32_t uiSet) = 0;
+		/** Lmites de influencia del conjunto (ver TFuzzySet::min()) */
+		virtual fuzzvar     min(uint32_t uiSet) = 0;
+		virtual fuzzvar     max(uint32_t uiSet) = 0;
+		/** Definicin compartida de un valor, NULL si no tiene */
+		virtual const SFuzzyDef* definition(uint32_t uiSet, uint32_t uiValue) = 0;
+		/** Grado de verdad de un valor sin definicin compartida */
+		virtual fuzzvar     execute(uint32_t uiSet, uint32_t uiValue, fuzzvar x) = 0;
+
+		/** Nmero de reglas */
+		virtual uint32_t    ruleCount() = 0;
+		/** Nmero de tomos de la regla uiRule (el ltimo es el consecuente) */
+		virtual uint32_t    atomCount(uint32_t uiRule) = 0;
+		/** tomo uiAtom de la regla uiRule */
+		virtual void        atom(uint32_t uiRule, uint32_t uiAtom, SViewAtom& vaAtom) = 0;
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Vista de un TFuzzyModel. Los conjuntos tienen su posicin en
+	 * TFuzzySets; un modelo cargado de forma perezosa gana conjuntos al
+	 * final. El valor de cada tomo se sita la primera vez que se usa y se
+	 * comprueba en cada uso, por si el conjunto ha cambiado.
+	 */
+	class TModelView : public TExecView
+	{
+	private:
+		/** Posicin de un valor de las reglas (ver TFuzzyRules::value()) */
+		struct SValuePos
+		{
+			TFuzzyVal* Value;
+			uint32_t   Set;
+			uint32_t   Position;
+		};
+
+		TFuzzyModel*                               m_fmModel;
+		/** Posicin de cada conjunto */
+		std::unordered_map<TFuzzyBase*, uint32_t>  m_mSets;
+		/** Posicin de cada valor de las reglas, por SRuleAtom::Value */
+		std::vector<SValuePos>                     m_vValues;
+
+		uint32_t position(TFuzzySet* fsSet);
+		void     locate(TFuzzyVal* fvVal, SValuePos& vpPos);
+
+	public:
+		TModelView(TFuzzyModel* fmModel);
+		virtual ~TModelView();
+
+		/** Conjunto uiSet */
+		inline TFuzzySet& fuzzySet(uint32_t uiSet) { return m_fmModel->sets()[int(uiSet)]; }
+
+		virtual uint32_t    setCount();
+		virtual std::string setName(uint32_t uiSet);
+		virtual uint32_t    set(const std::string& strName);
+		virtual uint32_t    set(fzhndl fhSet);
+
+		virtual uint32_t    valueCount(uint32_t uiSet);
+		virtual fuzzvar     min(uint32_t uiSet);
+		virtual fuzzvar     max(uint32_t uiSet);
+		virtual const SFuzzyDef* definition(uint32_t uiSet, uint32_t uiValue);
+		virtual fuzzvar     execute(uint32_t uiSet, uint32_t uiValue, fuzzvar x);
+
+		virtual uint32_t    ruleCount();
+		virtual uint32_t    atomCount(uint32_t uiRule);
+		virtual void        atom(uint32_t uiRule, uint32_t uiAtom, SViewAtom& vaAtom);
+	};
+	//-------------------------------------------------------------------------
+
+	/**
+	 * Vista de un TFuzzyImage. Los conjuntos y los valores tienen su ndice
+	 * en las tablas de la imagen, y todo se lee de la proyeccin: los lmites
+	 * de los conjuntos, los tomos ya resueltos y las definiciones que la
+	 * imagen comparte entre todas sus vistas (ver TFuzzyImage::share()), con
+	 * sus coeficientes precalculados y curvas muestreadas. La imagen debe
+	 * seguir proyectada mientras se use la vista.
+	 */
+	class TImageView : public TExecView
+	{
+	private:
+		TFuzzyImage* m_fiImage;
+
+	public:
+		TImageView(TFuzzyImage* fiImage);
+		virtual ~TImageView();
+
+		virtual uint32_t    setCount();
+		virtual std::string setName(uint32_t uiSet);
+		virtual uint32_t    set(const std::string& strName);
+		virtual uint32_t    set(fzhndl fhSet);
+
+		virtual uint32_t    valueCount(uint32_t uiSet);
+		virtual fuzzvar     min(uint32_t uiSet);
+		virtual fuzzvar     max(uint32_t uiSet);
+		virtual const SFuzzyDef* definition(uint32_t uiSet, uint32_t uiValue);
+		virtual fuzzvar     execute(uint32_t uiSet, uint32_t uiValue, fuzzvar x);
+
+		virtual uint32_t    ruleCount();
+		virtual uint32_t    atomCount(uint32_t uiRule);
+		virtual void        atom(uint32_t uiRule, uint32_t uiAtom, SViewAtom& vaAtom);
+	};
+	//-------------------------------------------------------------------------
+}
+//-----------------------------------------------------------------------------
+#endif /* __FZVIEW_HPP__ */
+//-----------------------------------------------------------------------------
@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lini_file
+LIBS := -lini_file -lpthread
 
@@ -4,31 +4,64 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../fzaccuracy.cpp \
+../fzanalysis.cpp \
 ../fzbase.cpp \
 ../fzexecution.cpp \
 ../fzfunction.cpp \
+../fzgenerator.cpp \
+../fzhistogram.cpp \
+../fzimage.cpp \
+../fzlog.cpp \
 ../fzmodel.cpp \
+../fzprofile.cpp \
+../fzreplay.cpp \
 ../fzrules.cpp \
 ../fzset.cpp \
-../fzval.cpp 
+../fzsymbols.cpp \
+../fztrace.cpp \
+../fzval.cpp \
+../fzview.cpp 
 
 OBJS += \
+./fzaccuracy.o \
+./fzanalysis.o \
 ./fzbase.o \
 ./fzexecution.o \
 ./fzfunction.o \
+./fzgenerator.o \
+./fzhistogram.o \
+./fzimage.o \
+./fzlog.o \
 ./fzmodel.o \
+./fzprofile.o \
+./fzreplay.o \
 ./fzrules.o \
 ./fzset.o \
-./fzval.o 
+./fzsymbols.o \
+./fztrace.o \
+./fzval.o \
+./fzview.o 
 
 CPP_DEPS += \
+./fzaccuracy.d \
+./fzanalysis.d \
 ./fzbase.d \
 ./fzexecution.d \
 ./fzfunction.d \
+./fzgenerator.d \
+./fzhistogram.d \
+./fzimage.d \
+./fzlog.d \
 ./fzmodel.d \
+./fzprofile.d \
+./fzreplay.d \
 ./fzrules.d \
 ./fzset.d \
-./fzval.d 
+./fzsymbols.d \
+./fztrace.d \
+./fzval.d \
+./fzview.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
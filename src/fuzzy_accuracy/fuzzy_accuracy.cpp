@@ -0,0 +1,279 @@
+/**
+ * \file fuzzy_accuracy.cpp
+ *
+ *  Differential accuracy gate. Compares an alternative engine with the
+ *  reference one over random, grid and edge-case inputs and fails if the
+ *  error exceeds the given tolerances.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzaccuracy.hpp"
+#include "fzbinary.hpp"
+#include "fzimage.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de modelo
+ *
+ * \return true si el archivo empieza por FL_BIN_MAGIC (formato binario).
+ */
+static bool isBinaryModel(const std::string& strFile)
+{
+	char          c_magic[4] = { 0, 0, 0, 0 };
+	std::ifstream file(strFile.c_str(), std::ios::in | std::ios::binary);
+
+	file.read(c_magic, sizeof(c_magic));
+
+	return file.good() && memcmp(c_magic, FL_BIN_MAGIC, sizeof(c_magic)) == 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  strFile  Archivo de modelo
+ * \param [out] fmModel  Modelo cargado
+ */
+static void loadModel(const std::string& strFile, TFuzzyModel& fmModel)
+{
+	if(isBinaryModel(strFile))
+		fmModel.loadFromBinary(strFile);
+	else
+		fmModel.loadFromFile(strFile);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] fmModel Modelo a redefinir
+ * \param [in]     fmRef   Mismo modelo, cargado sin modificar
+ *
+ * Vuelve a definir cada valor de fmModel a travs de la interfaz (min(),
+ * max(), size(), set() y setFunction()), pasando por otra definicin antes
+ * de dejar la original. Comprueba que cada valor queda compartido y con los
+ * coeficientes precalculados que tiene el mismo valor en fmRef.
+ *
+ * \return Nmero de valores que no quedan precalculados.
+ */
+static size_t editModel(TFuzzyModel& fmModel, TFuzzyModel& fmRef)
+{
+	size_t sz_bad = 0;
+
+	for(size_t i = 0; i < fmModel.sets().size(); ++i)
+	{
+		TFuzzySet& fs_set = fmModel.sets()[int(i)];
+		TFuzzySet& fs_ref = fmRef.sets()[int(i)];
+
+		for(size_t j = 0; j < fs_set.size(); ++j)
+		{
+			TFuzzyVal&      fv_val  = fs_set[int(j)];
+			TFuzzyVal&      fv_ref  = fs_ref[int(j)];
+			SFuzzyFunction* ff_func = fv_ref.function();
+
+			fv_val.setFunction(fzhndl(INVALID_FUNC));
+			fv_val.min(fv_ref.min() - 1);
+			fv_val.max(fv_ref.max() + 1);
+			fv_val.size(0);
+			fv_val.size(fv_ref.size());
+			for(size_t k = 0; k < fv_ref.size(); ++k)
+				fv_val.set(int(k), fv_ref.param(int(k)));
+			fv_val.min(fv_ref.min());
+			fv_val.max(fv_ref.max());
+			if(ff_func)
+				fv_val.setFunction(ff_func->handle());
+
+			if(!fv_val.definition() || !fv_ref.definition()
+					|| (fv_val.definition()->Compiled == NULL) != (fv_ref.definition()->Compiled == NULL))
+				++sz_bad;
+		}
+	}
+
+	return sz_bad;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * fuzzy_accuracy reference candidate [clave=valor ...]
+ *
+ * Compara el modelo reference, ejecutado como modelo, con candidate, que
+ * puede ser:
+ *
+ * \li image: el mismo modelo ejecutado como imagen (TFuzzyImage).
+ * \li binary: el mismo modelo guardado y cargado en formato binario.
+ * \li optimized: el mismo modelo tras TFuzzyModel::optimize().
+ * \li edited: el mismo modelo con cada valor redefinido a travs de la
+ * interfaz (ver editModel()). Termina con error si alguno no queda con sus
+ * coeficientes precalculados.
+ * \li Un archivo de modelo: de texto se ejecuta como modelo y binario como
+ * imagen.
+ *
+ * Las claves son random (casos al azar, 10000 por defecto), grid (puntos por
+ * entrada de la rejilla, 11 por defecto; 0 para no usarla), edges (0 para
+ * no probar los casos lmite), seed, max_error y mean_error. Termina con
+ * error si el error mximo o el medio pasan de su tolerancia.
+ */
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		std::cerr << "usage: fuzzy_accuracy reference image|binary|optimized|edited|candidate"
+				  << " [random=N] [grid=N] [edges=0|1] [seed=N] [max_error=E] [mean_error=E]" << std::endl;
+		return 1;
+	}
+
+	std::string str_ref   = argv[1];
+	std::string str_cand  = argv[2];
+	std::string str_bin;
+	size_t      sz_random = 10000;
+	size_t      sz_grid   = 11;
+	bool        b_edges   = true;
+	unsigned    u_seed    = 1;
+	double      d_maxerr  = -1.0;
+	double      d_meanerr = -1.0;
+
+	for(int i = 3; i < argc; ++i)
+	{
+		std::string str_arg = argv[i];
+		size_t      sz_eq   = str_arg.find('=');
+		std::string str_key = str_arg.substr(0, sz_eq);
+		const char* c_val   = sz_eq == std::string::npos ? "" : argv[i] + sz_eq + 1;
+		bool        b_ok    = sz_eq != std::string::npos;
+
+		if(str_key == "random")
+			sz_random = size_t(strtoull(c_val, NULL, 10));
+		else if(str_key == "grid")
+			sz_grid = size_t(strtoull(c_val, NULL, 10));
+		else if(str_key == "edges")
+			b_edges = atoi(c_val) != 0;
+		else if(str_key == "seed")
+			u_seed = unsigned(strtoul(c_val, NULL, 10));
+		else if(str_key == "max_error")
+			d_maxerr = atof(c_val);
+		else if(str_key == "mean_error")
+			d_meanerr = atof(c_val);
+		else
+			b_ok = false;
+
+		if(!b_ok)
+		{
+			std::cerr << "error: bad argument '" << str_arg << "'" << std::endl;
+			return 1;
+		}
+	}
+
+	int    i_rtn   = 1;
+	size_t sz_edit = 0;
+	try
+	{
+		TFuzzyModel fm_ref;
+		TFuzzyModel fm_cand;
+		TFuzzyImage fi_cand;
+		TFuzzyExec  fe_ref;
+		TFuzzyExec  fe_cand;
+
+		loadModel(str_ref, fm_ref);
+		fe_ref.model(&fm_ref);
+
+		if(str_cand == "image" || str_cand == "binary")
+		{
+			str_bin = "fuzzy_accuracy.yafl";
+			fm_ref.saveToBinary(str_bin);
+			if(str_cand == "image")
+			{
+				fi_cand.map(str_bin);
+				fe_cand.image(&fi_cand);
+			}
+			else
+			{
+				fm_cand.loadFromBinary(str_bin);
+				fe_cand.model(&fm_cand);
+			}
+		}
+		else if(str_cand == "optimized")
+		{
+			loadModel(str_ref, fm_cand);
+			fm_cand.optimize();
+			fe_cand.model(&fm_cand);
+		}
+		else if(str_cand == "edited")
+		{
+			loadModel(str_ref, fm_cand);
+			sz_edit = editModel(fm_cand, fm_ref);
+			fe_cand.model(&fm_cand);
+		}
+		else if(isBinaryModel(str_cand))
+		{
+			fi_cand.map(str_cand);
+			fe_cand.image(&fi_cand);
+		}
+		else
+		{
+			fm_cand.loadFromFile(str_cand);
+			fe_cand.model(&fm_cand);
+		}
+
+		TFuzzyAccuracy fa_acc(fe_ref, fe_cand);
+
+		if(b_edges)
+			fa_acc.edges();
+		if(sz_grid)
+			fa_acc.grid(sz_grid);
+		if(sz_random)
+			fa_acc.random(sz_random, u_seed);
+
+		std::cout << fa_acc.text();
+
+		i_rtn = 0;
+		if(d_maxerr >= 0.0 && !(fa_acc.maxError() <= d_maxerr))
+		{
+			std::cerr << "fail: max error " << fa_acc.maxError() << " (max " << d_maxerr << ")" << std::endl;
+			i_rtn = 1;
+		}
+		if(d_meanerr >= 0.0 && !(fa_acc.meanError() <= d_meanerr))
+		{
+			std::cerr << "fail: mean error " << fa_acc.meanError() << " (max " << d_meanerr << ")" << std::endl;
+			i_rtn = 1;
+		}
+		if(sz_edit)
+		{
+			std::cerr << "fail: " << sz_edit << " edited values not precompiled" << std::endl;
+			i_rtn = 1;
+		}
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+
+	if(!str_bin.empty())
+		std::remove(str_bin.c_str());
+
+	return i_rtn;
+}
+//-----------------------------------------------------------------------------
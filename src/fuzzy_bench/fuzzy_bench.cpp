@@ -0,0 +1,922 @@
+/**
+ * \file fuzzy_bench.cpp
+ *
+ *  Benchmarks for the fuzzy library. Measures how model loading scales with
+ *  the size of the model and with the number of threads and, with --json, runs
+ *  a suite of microbenchmarks of every phase of the execution.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzmodel.hpp"
+#include "fzimage.hpp"
+#include "fzexecution.hpp"
+#include "fzgenerator.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <thread>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+/** Nmero de valores de cada conjunto de los modelos generados */
+#define FB_VALUES_PER_SET	3
+/** Reglas por cada conjunto de los modelos generados */
+#define FB_RULES_PER_SET	10
+/** Tamao a partir del cual se compara el coste por regla */
+#define FB_MIN_SCALING		1000
+/** Modelos cargados en la prueba de carga en paralelo */
+#define FB_PARALLEL_MODELS	32
+/** Reglas de cada modelo de la prueba de carga en paralelo */
+#define FB_PARALLEL_RULES	1000
+/** Duracin mnima de cada tanda de una medida, en ns */
+#define FB_MIN_BATCH		10000000
+/** Tandas de cada medida (se toma la mejor) */
+#define FB_BATCHES			5
+/** Clculos medidos con el perfil del ejecutor */
+#define FB_PROFILE_CALCS	2000
+//-----------------------------------------------------------------------------
+
+/**
+ * Generador pseudoaleatorio (LCG) para que las entradas de las medidas sean
+ * siempre las mismas en todas las ejecuciones.
+ */
+static unsigned int nextRandom(unsigned int& uiSeed)
+{
+	uiSeed = uiSeed * 1103515245u + 12345u;
+	return (uiSeed >> 8);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo donde escribir el modelo
+ * \param [in] szRules Nmero de reglas del modelo
+ *
+ * Escribe con TFuzzyGenerator un modelo sinttico de szRules reglas y
+ * szRules / FB_RULES_PER_SET conjuntos (al menos 4), la mitad de entrada y la
+ * mitad de salida, de FB_VALUES_PER_SET valores cada uno. Cada regla tiene
+ * dos antecedentes, la mitad de ellos con modificador.
+ *
+ * \return false si no se ha podido escribir el archivo.
+ */
+static bool writeModel(const std::string& strFile, size_t szRules)
+{
+	SGeneratorConfig gc_config;
+	size_t           sz_sets = szRules / FB_RULES_PER_SET;
+
+	gc_config.Name         = "bench " + std::to_string(szRules);
+	gc_config.Inputs       = sz_sets / 2 > 2 ? sz_sets / 2 : 2;
+	gc_config.Outputs      = sz_sets - sz_sets / 2 > 2 ? sz_sets - sz_sets / 2 : 2;
+	gc_config.Values       = FB_VALUES_PER_SET;
+	gc_config.Rules        = szRules;
+	gc_config.RuleLength   = 2;
+	gc_config.ModifierRate = 0.5;
+
+	try
+	{
+		TFuzzyGenerator(gc_config).save(strFile);
+	}
+	catch(TFuzzyError&)
+	{
+		return false;
+	}
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile   Archivo del modelo
+ * \param [in] szRules   Nmero de reglas esperado
+ * \param [in] bBinary   El archivo est en formato binario
+ *
+ * Carga el modelo varias veces (ms cuanto ms pequeo es) y se queda con el
+ * mejor tiempo, para que los modelos pequeos no queden dominados por el
+ * ruido.
+ *
+ * \return Tiempo de carga en segundos, negativo en caso de error.
+ */
+static double timeLoad(const std::string& strFile, size_t szRules, bool bBinary)
+{
+	int    i_reps = szRules >= 10000 ? 1 : int(10000 / szRules);
+	double d_best = -1.0;
+
+	if(i_reps > 20)
+		i_reps = 20;
+
+	for(int i = 0; i < i_reps; ++i)
+	{
+		TFuzzyModel fm_model;
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		if(bBinary)
+			fm_model.loadFromBinary(strFile);
+		else
+			fm_model.loadFromFile(strFile);
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+		if(fm_model.rules().size() != szRules)
+			return -1.0;
+
+		double d_time = std::chrono::duration<double>(t1 - t0).count();
+		if(d_best < 0.0 || d_time < d_best)
+			d_best = d_time;
+	}
+
+	return d_best;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo binario del modelo
+ * \param [in] szRules Nmero de reglas esperado
+ *
+ * Como timeLoad(), pero proyectando el archivo en memoria (TFuzzyImage), con
+ * la comprobacin completa de ndices.
+ *
+ * \return Tiempo de proyeccin en segundos, negativo en caso de error.
+ */
+static double timeMap(const std::string& strFile, size_t szRules)
+{
+	int    i_reps = szRules >= 10000 ? 1 : int(10000 / szRules);
+	double d_best = -1.0;
+
+	if(i_reps > 20)
+		i_reps = 20;
+
+	for(int i = 0; i < i_reps; ++i)
+	{
+		TFuzzyImage fi_image;
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		fi_image.map(strFile);
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+		if(fi_image.ruleCount() != szRules)
+			return -1.0;
+
+		double d_time = std::chrono::duration<double>(t1 - t0).count();
+		if(d_best < 0.0 || d_time < d_best)
+			d_best = d_time;
+	}
+
+	return d_best;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] szMaxRules Nmero de reglas del mayor modelo
+ * \param [in] dMaxRatio  Mximo crecimiento admitido del coste por regla
+ *
+ * Carga modelos de 10 a szMaxRules reglas (multiplicando por 10) y compara el
+ * coste por regla del mayor de ellos con el del primero que tiene al menos
+ * FB_MIN_SCALING reglas. Si la carga escala de forma lineal la relacin se
+ * mantiene cerca de 1. Tambin muestra, como referencia, el tiempo de carga
+ * del mismo modelo en formato binario y el de su proyeccin en memoria.
+ *
+ * \return 0 si la carga escala correctamente, 1 en caso contrario.
+ */
+static int loadScaling(size_t szMaxRules, double dMaxRatio)
+{
+	std::string str_file = "fuzzy_bench_model.ini";
+	std::string str_bin  = "fuzzy_bench_model.yafl";
+	double      d_base   = -1.0;
+	double      d_last   = -1.0;
+	int         i_rtn    = 0;
+
+	std::cout << "load scaling" << std::endl;
+	std::cout << std::setw(10) << "rules" << std::setw(14) << "load (ms)"
+			  << std::setw(14) << "us/rule" << std::setw(14) << "binary (ms)"
+			  << std::setw(14) << "image (ms)" << std::endl;
+
+	for(size_t sz_rules = 10; sz_rules <= szMaxRules; sz_rules *= 10)
+	{
+		if(!writeModel(str_file, sz_rules))
+		{
+			std::cerr << "cannot write " << str_file << std::endl;
+			return 1;
+		}
+
+		double d_time = timeLoad(str_file, sz_rules, false);
+		double d_bin  = -1.0;
+		double d_map  = -1.0;
+		if(d_time >= 0.0)
+		{
+			TFuzzyModel fm_model;
+			fm_model.loadFromFile(str_file);
+			fm_model.saveToBinary(str_bin);
+			d_bin = timeLoad(str_bin, sz_rules, true);
+			d_map = timeMap(str_bin, sz_rules);
+		}
+		if(d_time < 0.0 || d_bin < 0.0 || d_map < 0.0)
+		{
+			std::cerr << "model with " << sz_rules << " rules did not load" << std::endl;
+			i_rtn = 1;
+			break;
+		}
+
+		double d_rule = 1E+6 * d_time / sz_rules;
+		std::cout << std::setw(10) << sz_rules
+				  << std::setw(14) << std::fixed << std::setprecision(3) << 1E+3 * d_time
+				  << std::setw(14) << d_rule
+				  << std::setw(14) << 1E+3 * d_bin
+				  << std::setw(14) << 1E+3 * d_map << std::endl;
+
+		if(sz_rules >= FB_MIN_SCALING)
+		{
+			if(d_base < 0.0)
+				d_base = d_rule;
+			d_last = d_rule;
+		}
+	}
+	std::remove(str_file.c_str());
+	std::remove(str_bin.c_str());
+
+	if(i_rtn == 0 && d_base > 0.0)
+	{
+		double d_ratio = d_last / d_base;
+
+		std::cout << "per-rule cost ratio " << std::setprecision(2) << d_ratio
+				  << " (max " << dMaxRatio << ")" << std::endl;
+		if(d_ratio > dMaxRatio)
+		{
+			std::cerr << "load time does not scale linearly" << std::endl;
+			i_rtn = 1;
+		}
+	}
+
+	return i_rtn;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Carga FB_PARALLEL_MODELS modelos de FB_PARALLEL_RULES reglas, primero uno
+ * tras otro con TFuzzyModel::loadFromFile() y despus con
+ * TFuzzyModels::load(), y muestra la aceleracin obtenida. La aceleracin
+ * depende de la mquina, as que slo se informa de ella.
+ *
+ * \return 0 si todos los modelos se han cargado, 1 en caso contrario.
+ */
+static int parallelLoad()
+{
+	std::vector<std::string> v_files;
+	int                      i_rtn = 0;
+
+	std::cout << "parallel load (" << FB_PARALLEL_MODELS << " models x "
+			  << FB_PARALLEL_RULES << " rules, " << std::thread::hardware_concurrency()
+			  << " threads)" << std::endl;
+
+	for(int i = 0; i < FB_PARALLEL_MODELS; ++i)
+	{
+		std::stringstream ss;
+		ss << "fuzzy_bench_model_" << i << ".ini";
+		v_files.push_back(ss.str());
+		if(!writeModel(v_files.back(), FB_PARALLEL_RULES))
+		{
+			std::cerr << "cannot write " << v_files.back() << std::endl;
+			i_rtn = 1;
+			break;
+		}
+	}
+
+	if(i_rtn == 0)
+	{
+		TFuzzyModels fm_serial;
+		TFuzzyModels fm_parallel;
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < v_files.size(); ++i)
+			fm_serial[fm_serial.add()].loadFromFile(v_files[i]);
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		std::vector<fzhndl> v_handles = fm_parallel.load(v_files);
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+		for(size_t i = 0; i < v_handles.size(); ++i)
+		{
+			if(fm_parallel[v_handles[i]].rules().size() != FB_PARALLEL_RULES)
+				i_rtn = 1;
+		}
+		if(i_rtn != 0 || fm_parallel.size() != FB_PARALLEL_MODELS)
+		{
+			std::cerr << "parallel load did not load every model" << std::endl;
+			i_rtn = 1;
+		}
+
+		double d_serial   = std::chrono::duration<double>(t1 - t0).count();
+		double d_parallel = std::chrono::duration<double>(t2 - t1).count();
+		std::cout << std::setw(14) << "serial (ms)" << std::setw(14) << "parallel (ms)"
+				  << std::setw(14) << "speedup" << std::endl;
+		std::cout << std::setw(14) << std::fixed << std::setprecision(3) << 1E+3 * d_serial
+				  << std::setw(14) << 1E+3 * d_parallel
+				  << std::setw(14) << std::setprecision(2) << d_serial / d_parallel << std::endl;
+	}
+
+	for(size_t i = 0; i < v_files.size(); ++i)
+		std::remove(v_files[i].c_str());
+
+	return i_rtn;
+}
+//-----------------------------------------------------------------------------
+
+/** Resultado de una medida de la batera de --json */
+struct SBenchResult
+{
+	/** Grupo (qu se mide), caso y tamao (segn el grupo) */
+	std::string Group;
+	std::string Case;
+	size_t      Size;
+	/** Tiempo por operacin en ns (negativo si no se ha podido medir) */
+	double      Nanos;
+
+	SBenchResult(const std::string& strGroup, const std::string& strCase, size_t szSize, double dNanos)
+		: Group(strGroup), Case(strCase), Size(szSize), Nanos(dNanos) {}
+};
+//-----------------------------------------------------------------------------
+
+/** Destino de los resultados, para que el compilador no elimine los clculos */
+static volatile fuzzvar fb_sink;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in,out] tCase Caso a medir: tCase(n) hace n operaciones
+ *
+ * Busca el nmero de operaciones que llena una tanda de FB_MIN_BATCH ns y
+ * repite FB_BATCHES tandas.
+ *
+ * \return El mejor tiempo por operacin, en ns.
+ */
+template<class T> static double timeCase(T& tCase)
+{
+	size_t sz_ops = 1;
+	double d_best = -1.0;
+
+	for(;;)
+	{
+		uint64_t ui_start = TFuzzyTrace::now();
+		tCase(sz_ops);
+		if(TFuzzyTrace::now() - ui_start >= FB_MIN_BATCH || sz_ops >= (size_t(1) << 30))
+			break;
+		sz_ops *= 2;
+	}
+
+	for(int i = 0; i < FB_BATCHES; ++i)
+	{
+		uint64_t ui_start = TFuzzyTrace::now();
+		tCase(sz_ops);
+
+		double d_time = double(TFuzzyTrace::now() - ui_start) / double(sz_ops);
+		if(d_best < 0.0 || d_time < d_best)
+			d_best = d_time;
+	}
+
+	return d_best;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile  Archivo donde escribir el modelo
+ * \param [in] szValues Valores de cada conjunto
+ * \param [in] szRules  Nmero de reglas
+ *
+ * Escribe con TFuzzyGenerator un modelo sin ciclos con dos conjuntos de
+ * entrada (in0 e in1) y uno de salida (out0) de szValues valores, y szRules
+ * reglas "if in0.vA and in1.vB then out0.vC" distintas, hasta un mximo de
+ * szValues^3.
+ *
+ * \return false si no se ha podido escribir el archivo.
+ */
+static bool writeShapedModel(const std::string& strFile, size_t szValues, size_t szRules)
+{
+	SGeneratorConfig gc_config;
+
+	gc_config.Name       = "bench " + std::to_string(szValues) + "x" + std::to_string(szRules);
+	gc_config.Inputs     = 2;
+	gc_config.Outputs    = 1;
+	gc_config.Values     = szValues;
+	gc_config.Rules      = szRules;
+	gc_config.RuleLength = 2;
+
+	try
+	{
+		TFuzzyGenerator(gc_config).save(strFile);
+	}
+	catch(TFuzzyError&)
+	{
+		return false;
+	}
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/** Caso de la batera: una funcin de pertenencia en todo su rango */
+struct SFunctionCase
+{
+	SFuzzyFunction* Function;
+	fuzzlist        Params;
+
+	void operator()(size_t szOps)
+	{
+		fuzzvar fv_sum = 0.0;
+		for(size_t i = 0; i < szOps; ++i)
+			fv_sum += Function->Function(Params, fuzzvar(1 + i % 100));
+		fb_sink = fv_sum;
+	}
+};
+//-----------------------------------------------------------------------------
+
+/** Caso de la batera: la misma funcin con los coeficientes precalculados */
+struct SCompiledCase
+{
+	FFuzzyCompiled Compiled;
+	SFuzzyCoefs    Coefs;
+
+	void operator()(size_t szOps)
+	{
+		fuzzvar fv_sum = 0.0;
+		for(size_t i = 0; i < szOps; ++i)
+			fv_sum += Compiled(Coefs, fuzzvar(1 + i % 100));
+		fb_sink = fv_sum;
+	}
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * Caso de la batera: entradas al azar y calculate() de un ejecutor. Las
+ * entradas se dan por posicin (TFuzzyExec::index()), como hara una
+ * aplicacin que las guarda.
+ */
+struct SCalculateCase
+{
+	TFuzzyExec*           Exec;
+	std::vector<uint32_t> Inputs;
+	std::vector<fuzzvar>  Min;
+	std::vector<fuzzvar>  Range;
+	uint32_t              Output;
+	unsigned int          Seed;
+
+	SCalculateCase(TFuzzyExec* feExec) : Exec(feExec), Output(0), Seed(1) {}
+
+	void operator()(size_t szOps)
+	{
+		for(size_t k = 0; k < szOps; ++k)
+		{
+			for(size_t i = 0; i < Inputs.size(); ++i)
+				Exec->inputAt(Inputs[i], Min[i] + Range[i] * fuzzvar(nextRandom(Seed) % 10000) / 10000.0f);
+			Exec->calculate();
+		}
+		fb_sink = Exec->outputAt(Output);
+	}
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * Caso de la batera: el muestreo de la curva de salida de un conjunto de
+ * FB_VALUES_PER_SET valores con curvas ya calculadas (lo que hace
+ * TExecData::fuzzyfy() con definiciones compartidas) y su defuzzyfy(), con
+ * un nmero de puntos cualquiera.
+ */
+struct SSampleCase
+{
+	size_t               Points;
+	std::vector<fuzzvar> Curves;
+	fuzzvar              Limits[FB_VALUES_PER_SET];
+	fuzzlist             Output;
+	bool                 Sample;
+
+	SSampleCase(size_t szPoints, bool bSample) : Points(szPoints), Sample(bSample)
+	{
+		Curves.resize(FB_VALUES_PER_SET * (Points + 1));
+		for(size_t i = 0; i <= Points; ++i)
+		{
+			fuzzvar x = fuzzvar(i) / fuzzvar(Points);
+			Curves[i]                  = 1.0f - x;
+			Curves[(Points + 1) + i]   = 1.0f - 2.0f * (x > 0.5f ? x - 0.5f : 0.5f - x);
+			Curves[2 * (Points + 1) + i] = x;
+		}
+		for(int j = 0; j < FB_VALUES_PER_SET; ++j)
+			Limits[j] = 0.25f * (j + 1);
+		sample();
+	}
+
+	void sample()
+	{
+		Output.resize(2 * (Points + 1));
+		for(size_t i = 0; i <= Points; ++i)
+		{
+			fuzzvar fv_out = 0.0;
+			for(int j = 0; j < FB_VALUES_PER_SET; ++j)
+			{
+				fuzzvar fv_val = Curves[j * (Points + 1) + i];
+				fv_val = fv_val < Limits[j] ? fv_val : Limits[j];
+				fv_out = fv_out > fv_val ? fv_out : fv_val;
+			}
+			Output[2 * i]     = fuzzvar(i) * 100.0f / fuzzvar(Points);
+			Output[2 * i + 1] = fv_out;
+		}
+	}
+
+	void operator()(size_t szOps)
+	{
+		fuzzvar fv_sum = 0.0;
+		for(size_t k = 0; k < szOps; ++k)
+		{
+			if(Sample)
+				sample();
+			fv_sum += TExecData::defuzzyfy(Output);
+		}
+		fb_sink = fv_sum;
+	}
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] feExec Ejecutor con el perfil activado
+ * \param [in] strSet Conjunto
+ * \param [in] ppPhase Fase
+ *
+ * \return El tiempo medio de la fase en el conjunto, en ns (negativo si no
+ * se ha medido, por ejemplo al compilar con FL_NO_PROFILE).
+ */
+static double phaseTime(const TFuzzyExec& feExec, const std::string& strSet, TProfilePhase ppPhase)
+{
+	SFuzzyProfile fp_prof = feExec.profile();
+
+	for(size_t i = 0; i < fp_prof.Sets.size(); ++i)
+	{
+		const SPhaseTimes& pt_times = fp_prof.Sets[i].Phases[ppPhase];
+		if(fp_prof.Sets[i].Set == strSet && pt_times.Calls)
+			return double(pt_times.Nanos) / double(pt_times.Calls);
+	}
+
+	return -1.0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     fmModel Modelo
+ * \param [in,out] ccCase  Caso a preparar
+ *
+ * Toma como entradas los conjuntos que no calcula ninguna regla (con valores
+ * al azar en su rango) y como salida el ltimo de los calculados.
+ */
+static void calculateInputs(TFuzzyModel& fmModel, SCalculateCase& ccCase)
+{
+	std::set<fzhndl> s_outputs;
+	TFuzzyRules&     fr_rules = fmModel.rules();
+
+	for(size_t i = 0; i < fr_rules.size(); ++i)
+	{
+		const SFuzzyRule& fr_rule = fr_rules[i];
+		s_outputs.insert(fr_rules.value(fr_rules.atoms(fr_rule)[fr_rule.AtomCount - 1])->parent()->handle());
+	}
+
+	for(size_t j = 0; j < fmModel.sets().size(); ++j)
+	{
+		TFuzzySet& fs_set = fmModel.sets()[int(j)];
+
+		if(s_outputs.count(fs_set.handle()))
+			ccCase.Output = ccCase.Exec->index(fs_set.name());
+		else
+		{
+			ccCase.Inputs.push_back(ccCase.Exec->index(fs_set.name()));
+			ccCase.Min.push_back(fs_set.min());
+			ccCase.Range.push_back(fs_set.max() - fs_set.min());
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     strFile Modelo
+ * \param [in]     strCase Nombre del caso
+ * \param [in]     szSize  Tamao del caso
+ * \param [in,out] vResults Resultados
+ *
+ * Mide calculate() del modelo y de su imagen.
+ */
+static void benchCalculate(const std::string& strFile, const std::string& strCase, size_t szSize,
+						   std::vector<SBenchResult>& vResults)
+{
+	std::string str_bin = "fuzzy_bench_calc.yafl";
+	TFuzzyModel fm_model;
+
+	fm_model.loadFromFile(strFile);
+	fm_model.saveToBinary(str_bin);
+	{
+		TFuzzyImage    fi_image(str_bin);
+		TFuzzyExec     fe_model;
+		TFuzzyExec     fe_image;
+		SCalculateCase cc_model(&fe_model);
+		SCalculateCase cc_image(&fe_image);
+
+		fe_model.model(&fm_model);
+		fe_image.image(&fi_image);
+		calculateInputs(fm_model, cc_model);
+		calculateInputs(fm_model, cc_image);
+
+		vResults.push_back(SBenchResult("calculate", strCase + " model", szSize, timeCase(cc_model)));
+		vResults.push_back(SBenchResult("calculate", strCase + " image", szSize, timeCase(cc_image)));
+	}
+	std::remove(str_bin.c_str());
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     vModels  Modelos propios a medir adems de los generados
+ * \param [in,out] vResults Resultados
+ *
+ * La batera de --json: cada funcin estndar, la fuzzificacin de un
+ * conjunto segn su nmero de valores, setLimits() segn el nmero de
+ * reglas, el muestreo y defuzzyfy() segn el nmero de puntos, calculate()
+ * de modelos generados y propios y la carga segn el tamao del modelo.
+ * Las fases de la ejecucin se miden con el perfil del ejecutor
+ * (TFuzzyExec::profileEnable()).
+ */
+static void microBench(const std::vector<std::string>& vModels, std::vector<SBenchResult>& vResults)
+{
+	static const size_t c_values[] = { 2, 4, 8, 16, 32, 64 };
+	static const size_t c_rules[]  = { 10, 100, 1000, 10000 };
+	static const size_t c_points[] = { 100, 1000, 10000 };
+	std::string         str_file   = "fuzzy_bench_micro.ini";
+	TFuzzyFunctions     ff_funcs;
+
+	//-- Funciones de pertenencia, en [0, 100] y con los parmetros a la mitad
+	for(int i = 0; ff_funcs[i]; ++i)
+	{
+		SFunctionCase fc_case;
+
+		fc_case.Function = ff_funcs[i];
+		if(fc_case.Function->name() == "Interpolate")
+		{
+			fuzzvar c_points[6] = { 0, 0, 50, 1, 100, 0 };
+			fc_case.Params.assign(c_points, c_points + 6);
+		}
+		else
+		{
+			fc_case.Params.push_back(0.0);
+			fc_case.Params.push_back(100.0);
+			for(int j = 0; j < fc_case.Function->ParamCount; ++j)
+				fc_case.Params.push_back(50.0);
+		}
+		vResults.push_back(SBenchResult("function", fc_case.Function->name(), fc_case.Params.size(),
+										timeCase(fc_case)));
+
+		SCompiledCase cc_case;
+
+		cc_case.Compiled = fc_case.Function->Compiled;
+		if(cc_case.Compiled && fc_case.Function->Compile(fc_case.Params, cc_case.Coefs))
+			vResults.push_back(SBenchResult("function", fc_case.Function->name() + " (compiled)",
+											fc_case.Params.size(), timeCase(cc_case)));
+	}
+
+	//-- Fuzzificacin (TExecData::execute()) segn los valores del conjunto
+	for(size_t i = 0; i < sizeof(c_values) / sizeof(c_values[0]); ++i)
+	{
+		TFuzzyModel fm_model;
+		TFuzzyExec  fe_exec;
+
+		if(!writeShapedModel(str_file, c_values[i], 10))
+			throw TFuzzyError("microBench", "No se puede escribir el modelo", __LINE__, __FILE__);
+		fm_model.loadFromFile(str_file);
+		fe_exec.model(&fm_model);
+
+		SCalculateCase cc_case(&fe_exec);
+		calculateInputs(fm_model, cc_case);
+		fe_exec.profileEnable();
+		cc_case(FB_PROFILE_CALCS);
+		vResults.push_back(SBenchResult("fuzzify", "execute", c_values[i], phaseTime(fe_exec, "in0", ppExecute)));
+	}
+
+	//-- setLimits() segn el nmero de reglas (con los valores justos para
+	//   que quepan) y el muestreo y defuzzyfy() reales, con FL_CRV_COUNT
+	//   puntos y FB_VALUES_PER_SET valores
+	for(size_t i = 0; i < sizeof(c_rules) / sizeof(c_rules[0]); ++i)
+	{
+		TFuzzyModel fm_model;
+		TFuzzyExec  fe_exec;
+		size_t      sz_vals = FB_VALUES_PER_SET;
+
+		while(sz_vals * sz_vals * sz_vals < c_rules[i])
+			++sz_vals;
+		if(!writeShapedModel(str_file, sz_vals, c_rules[i]))
+			throw TFuzzyError("microBench", "No se puede escribir el modelo", __LINE__, __FILE__);
+		fm_model.loadFromFile(str_file);
+		fe_exec.model(&fm_model);
+
+		SCalculateCase cc_case(&fe_exec);
+		calculateInputs(fm_model, cc_case);
+		fe_exec.profileEnable();
+		cc_case(FB_PROFILE_CALCS);
+		vResults.push_back(SBenchResult("rules", "setLimits", fm_model.rules().size(),
+										phaseTime(fe_exec, "out0", ppRules)));
+		if(sz_vals == FB_VALUES_PER_SET)
+		{
+			vResults.push_back(SBenchResult("sample", "fuzzyfy", FL_CRV_COUNT, phaseTime(fe_exec, "out0", ppSample)));
+			vResults.push_back(SBenchResult("sample", "defuzzyfy", FL_CRV_COUNT, phaseTime(fe_exec, "out0", ppDefuzzy)));
+		}
+	}
+
+	//-- Muestreo y defuzzyfy() segn el nmero de puntos
+	for(size_t i = 0; i < sizeof(c_points) / sizeof(c_points[0]); ++i)
+	{
+		SSampleCase sc_both(c_points[i], true);
+		SSampleCase sc_defuzzy(c_points[i], false);
+
+		vResults.push_back(SBenchResult("sample", "kernel+defuzzyfy", c_points[i], timeCase(sc_both)));
+		vResults.push_back(SBenchResult("sample", "kernel defuzzyfy", c_points[i], timeCase(sc_defuzzy)));
+	}
+
+	//-- calculate() completo
+	for(size_t i = 0; i < sizeof(c_values) / sizeof(c_values[0]); i += 2)
+	{
+		if(!writeShapedModel(str_file, c_values[i], c_values[i] * c_values[i]))
+			throw TFuzzyError("microBench", "No se puede escribir el modelo", __LINE__, __FILE__);
+		benchCalculate(str_file, "generated", c_values[i] * c_values[i], vResults);
+	}
+	for(size_t i = 0; i < vModels.size(); ++i)
+	{
+		TFuzzyModel fm_model;
+
+		fm_model.loadFromFile(vModels[i]);
+		benchCalculate(vModels[i], vModels[i], fm_model.rules().size(), vResults);
+	}
+
+	//-- Carga segn el tamao del modelo
+	for(size_t sz_rules = 10; sz_rules <= 10000; sz_rules *= 10)
+	{
+		std::string str_bin = "fuzzy_bench_micro.yafl";
+		TFuzzyModel fm_model;
+
+		if(!writeModel(str_file, sz_rules))
+			throw TFuzzyError("microBench", "No se puede escribir el modelo", __LINE__, __FILE__);
+		fm_model.loadFromFile(str_file);
+		fm_model.saveToBinary(str_bin);
+
+		vResults.push_back(SBenchResult("load", "text", sz_rules, 1E+9 * timeLoad(str_file, sz_rules, false)));
+		vResults.push_back(SBenchResult("load", "binary", sz_rules, 1E+9 * timeLoad(str_bin, sz_rules, true)));
+		vResults.push_back(SBenchResult("load", "image", sz_rules, 1E+9 * timeMap(str_bin, sz_rules)));
+		std::remove(str_bin.c_str());
+	}
+	std::remove(str_file.c_str());
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] osOut  Destino
+ * \param [in] strText Texto
+ *
+ * Escribe strText como cadena JSON.
+ */
+static void jsonString(std::ostream& osOut, const std::string& strText)
+{
+	osOut << '"';
+	for(size_t i = 0; i < strText.size(); ++i)
+	{
+		unsigned char c_chr = (unsigned char)strText[i];
+
+		if(c_chr == '"' || c_chr == '\\')
+			osOut << '\\' << char(c_chr);
+		else if(c_chr < 0x20)
+		{
+			char c_esc[8];
+			snprintf(c_esc, sizeof(c_esc), "\\u%04x", c_chr);
+			osOut << c_esc;
+		}
+		else
+			osOut << char(c_chr);
+	}
+	osOut << '"';
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] osOut    Destino
+ * \param [in] vResults Resultados
+ *
+ * Escribe los resultados como JSON: la configuracin de la librera
+ * (FL_CRV_COUNT) y una lista de medidas con su grupo, caso, tamao y ns por
+ * operacin, para compararlas entre versiones.
+ */
+static void writeJson(std::ostream& osOut, const std::vector<SBenchResult>& vResults)
+{
+	char c_num[32];
+
+	osOut << "{\n\"crv_count\": " << FL_CRV_COUNT << ",\n\"threads\": "
+		  << std::thread::hardware_concurrency() << ",\n\"benchmarks\": [";
+	for(size_t i = 0; i < vResults.size(); ++i)
+	{
+		osOut << (i ? ",\n" : "\n") << "{\"group\": ";
+		jsonString(osOut, vResults[i].Group);
+		osOut << ", \"case\": ";
+		jsonString(osOut, vResults[i].Case);
+		snprintf(c_num, sizeof(c_num), "%.3f", vResults[i].Nanos);
+		osOut << ", \"size\": " << vResults[i].Size << ", \"ns\": "
+			  << (vResults[i].Nanos < 0.0 ? "null" : c_num) << "}";
+	}
+	osOut << "\n]\n}\n";
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Uso: fuzzy_bench [max_rules [max_ratio]]
+ *      fuzzy_bench --json output [model...]
+ *
+ * \li max_rules Nmero de reglas del mayor modelo generado (100000).
+ * \li max_ratio Mximo crecimiento admitido del coste por regla (3.0).
+ * \li output    Archivo JSON con los resultados de la batera ("-" para la
+ *               salida estndar).
+ * \li model     Modelos propios de los que medir calculate().
+ */
+int main(int argc, char* argv[])
+{
+	if(argc > 1 && std::string(argv[1]) == "--json")
+	{
+		try
+		{
+			std::vector<SBenchResult> v_results;
+			std::string               str_out = argc > 2 ? argv[2] : "-";
+
+			microBench(std::vector<std::string>(argv + (argc > 3 ? 3 : argc), argv + argc), v_results);
+
+			if(str_out == "-")
+			{
+				writeJson(std::cout, v_results);
+				return std::cout.good() ? 0 : 1;
+			}
+
+			std::ofstream os_file(str_out.c_str(), std::ios::out | std::ios::trunc);
+			writeJson(os_file, v_results);
+			os_file.close();
+			return os_file.fail() ? 1 : 0;
+		}
+		catch(TFuzzyError& e)
+		{
+			std::cerr << "error: " << e.message() << std::endl;
+		}
+		return 1;
+	}
+
+	size_t sz_max   = 100000;
+	double d_ratio  = 3.0;
+	char*  c_end    = NULL;
+	bool   b_ok     = argc <= 3;
+
+	if(b_ok && argc > 1)
+	{
+		sz_max = size_t(strtoull(argv[1], &c_end, 10));
+		b_ok   = *argv[1] >= '0' && *argv[1] <= '9' && !*c_end && sz_max > 0;
+	}
+	if(b_ok && argc > 2)
+	{
+		d_ratio = strtod(argv[2], &c_end);
+		b_ok    = c_end != argv[2] && !*c_end && d_ratio > 0.0;
+	}
+	if(!b_ok)
+	{
+		std::cerr << "usage: fuzzy_bench [max_rules [max_ratio]]" << std::endl
+				  << "       fuzzy_bench --json output [model...]" << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		int i_rtn = loadScaling(sz_max, d_ratio);
+
+		std::cout << std::endl;
+		return parallelLoad() | i_rtn;
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+
+	return 1;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+/**
+ * \file fuzzy_cost.cpp
+ *
+ *  Static cost report of a model. Prints the estimated work and memory of
+ *  each inference and fails if they exceed a budget.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzanalysis.hpp"
+#include "fzbinary.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de modelo
+ *
+ * \return true si el archivo empieza por FL_BIN_MAGIC (formato binario).
+ */
+static bool isBinaryModel(const std::string& strFile)
+{
+	char          c_magic[4] = { 0, 0, 0, 0 };
+	std::ifstream file(strFile.c_str(), std::ios::in | std::ios::binary);
+
+	file.read(c_magic, sizeof(c_magic));
+
+	return file.good() && memcmp(c_magic, FL_BIN_MAGIC, sizeof(c_magic)) == 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * fuzzy_cost model [max_operations [max_bytes]]
+ *
+ * Carga el modelo (texto o binario), escribe su coste estimado y termina con
+ * error si las operaciones por inferencia pasan de max_operations o la
+ * memoria del modelo ms la de un ejecutor pasa de max_bytes (0 o sin
+ * indicar: sin lmite).
+ */
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		std::cerr << "usage: fuzzy_cost model [max_operations [max_bytes]]" << std::endl;
+		return 1;
+	}
+
+	std::string str_file = argv[1];
+	uint64_t    ui_ops   = argc > 2 ? strtoull(argv[2], NULL, 10) : 0;
+	uint64_t    ui_bytes = argc > 3 ? strtoull(argv[3], NULL, 10) : 0;
+
+	try
+	{
+		TFuzzyModel fm_model;
+
+		if(isBinaryModel(str_file))
+			fm_model.loadFromBinary(str_file);
+		else
+			fm_model.loadFromFile(str_file);
+
+		SModelCost mc_cost = TFuzzyAnalysis::cost(fm_model);
+		int        i_rtn   = 0;
+
+		std::cout << mc_cost.text();
+
+		if(ui_ops && mc_cost.operations() > ui_ops)
+		{
+			std::cerr << "fail: " << mc_cost.operations() << " operations per inference (max "
+					  << ui_ops << ")" << std::endl;
+			i_rtn = 1;
+		}
+		if(ui_bytes && uint64_t(mc_cost.ModelBytes + mc_cost.ExecBytes) > ui_bytes)
+		{
+			std::cerr << "fail: " << (mc_cost.ModelBytes + mc_cost.ExecBytes) << " bytes (max "
+					  << ui_bytes << ")" << std::endl;
+			i_rtn = 1;
+		}
+
+		return i_rtn;
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+
+	return 1;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,157 @@
+/**
+ * \file fuzzy_gen.cpp
+ *
+ *  Synthetic model generator. Writes a model of the requested shape, always
+ *  the same for the same seed, to benchmark and stress the engine at scale.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzgenerator.hpp"
+#include <cstdlib>
+#include <iostream>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     strList   Funciones como "nombre[:peso],nombre[:peso]..."
+ * \param [in,out] vFunctions Funciones del generador, cada una repetida
+ *                            tantas veces como su peso
+ *
+ * \return false si algn peso no es vlido.
+ */
+static bool parseFunctions(const std::string& strList, std::vector<std::string>& vFunctions)
+{
+	size_t sz_begin = 0;
+
+	vFunctions.clear();
+	while(sz_begin <= strList.size())
+	{
+		size_t      sz_end   = strList.find(',', sz_begin);
+		std::string str_func = strList.substr(sz_begin, sz_end == std::string::npos ? std::string::npos
+																					 : sz_end - sz_begin);
+		size_t      sz_colon = str_func.find(':');
+		long        l_weight = 1;
+
+		if(sz_colon != std::string::npos)
+		{
+			l_weight = strtol(str_func.c_str() + sz_colon + 1, NULL, 10);
+			str_func.erase(sz_colon);
+		}
+		if(l_weight < 1 || str_func.empty())
+			return false;
+		vFunctions.insert(vFunctions.end(), size_t(l_weight), str_func);
+
+		if(sz_end == std::string::npos)
+			break;
+		sz_begin = sz_end + 1;
+	}
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * fuzzy_gen model.ini [clave=valor ...]
+ *
+ * Genera un modelo con TFuzzyGenerator y lo guarda en model.ini. Las claves
+ * (ver SGeneratorConfig) son name, inputs, intermediates, outputs, depth,
+ * values, functions ("Triangle:2,S-Curve"), rules, length (antecedentes por
+ * regla), modifiers (proporcin de antecedentes con modificador) y seed.
+ */
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		std::cerr << "usage: fuzzy_gen model.ini [name=N] [inputs=N] [intermediates=N] [outputs=N]"
+				  << " [depth=N] [values=N] [functions=F[:W],...] [rules=N] [length=N]"
+				  << " [modifiers=R] [seed=N]" << std::endl;
+		return 1;
+	}
+
+	SGeneratorConfig gc_config;
+
+	for(int i = 2; i < argc; ++i)
+	{
+		std::string str_arg = argv[i];
+		size_t      sz_eq   = str_arg.find('=');
+		std::string str_key = str_arg.substr(0, sz_eq);
+		std::string str_val = sz_eq == std::string::npos ? "" : str_arg.substr(sz_eq + 1);
+		size_t      sz_val  = size_t(strtoull(str_val.c_str(), NULL, 10));
+		bool        b_ok    = sz_eq != std::string::npos;
+
+		if(str_key == "name")
+			gc_config.Name = str_val;
+		else if(str_key == "inputs")
+			gc_config.Inputs = sz_val;
+		else if(str_key == "intermediates")
+			gc_config.Intermediates = sz_val;
+		else if(str_key == "outputs")
+			gc_config.Outputs = sz_val;
+		else if(str_key == "depth")
+			gc_config.Depth = sz_val;
+		else if(str_key == "values")
+			gc_config.Values = sz_val;
+		else if(str_key == "functions")
+			b_ok = b_ok && parseFunctions(str_val, gc_config.Functions);
+		else if(str_key == "rules")
+			gc_config.Rules = sz_val;
+		else if(str_key == "length")
+			gc_config.RuleLength = sz_val;
+		else if(str_key == "modifiers")
+			gc_config.ModifierRate = strtod(str_val.c_str(), NULL);
+		else if(str_key == "seed")
+			gc_config.Seed = unsigned(sz_val);
+		else
+			b_ok = false;
+
+		if(!b_ok)
+		{
+			std::cerr << "error: bad argument '" << str_arg << "'" << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		TFuzzyGenerator fg_gen(gc_config);
+		TFuzzyModel     fm_model;
+
+		fg_gen.generate(fm_model);
+		fm_model.saveToFile(argv[1], false);
+
+		std::cout << argv[1] << ": " << fm_model.sets().size() << " sets, " << fm_model.rules().size()
+				  << " rules (" << gc_config.Rules << " requested), seed " << gc_config.Seed << std::endl;
+
+		return 0;
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+
+	return 1;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,655 @@
+/**
+ * \file fuzzy_load.cpp
+ *
+ *  Concurrent load generator. Drives N threads, each with its own executor,
+ *  at an open-loop target rate (or as fast as possible) with configurable
+ *  input distributions, and reports throughput, scalability across thread
+ *  counts and tail latency.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzexecution.hpp"
+#include "fzbinary.hpp"
+#include "fzhistogram.hpp"
+#include "fzimage.hpp"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+/** Clculos de calentamiento de cada hilo, antes de empezar a medir */
+#define FD_WARMUP_CALCS		1000
+/** A partir de esta espera (ns) se duerme en lugar de esperar activamente */
+#define FD_SLEEP_NS			200000
+/** Pasos de un recorrido completo del rango con la distribucin sweep */
+#define FD_SWEEP_STEPS		1000
+//-----------------------------------------------------------------------------
+
+typedef std::chrono::steady_clock fdclock;
+//-----------------------------------------------------------------------------
+
+/** Distribucin de los valores de una entrada */
+enum TInputDist { idUniform, idNormal, idSweep, idFixed };
+//-----------------------------------------------------------------------------
+
+/** Cmo comparten el modelo los hilos */
+enum TLoadMode
+{
+	/** Cada hilo carga su propio modelo */
+	lmPrivate,
+	/** Un nico modelo y un ejecutor por hilo */
+	lmShared,
+	/** Una nica imagen (TFuzzyImage) y un ejecutor por hilo */
+	lmImage
+};
+//-----------------------------------------------------------------------------
+
+/** Una entrada del modelo */
+struct SLoadInput
+{
+	std::string Set;
+	fuzzvar     Min;
+	fuzzvar     Range;
+	TInputDist  Dist;
+};
+//-----------------------------------------------------------------------------
+
+/** Configuracin de la prueba */
+struct SLoadConfig
+{
+	std::string              File;
+	TLoadMode                Mode;
+	std::vector<unsigned>    Threads;
+	/** Clculos por segundo entre todos los hilos (0: tan rpido como se
+	 * pueda, en lazo cerrado) */
+	double                   Rate;
+	/** Llegadas de Poisson (true) o a intervalos fijos */
+	bool                     Poisson;
+	/** Duracin de cada medida, en segundos */
+	double                   Duration;
+	unsigned                 Seed;
+	std::vector<SLoadInput>  Inputs;
+
+	SLoadConfig() : Mode(lmPrivate), Rate(0.0), Poisson(false), Duration(5.0), Seed(1) {}
+};
+//-----------------------------------------------------------------------------
+
+/** Arranque simultneo de los hilos de una medida */
+struct SLoadStart
+{
+	std::mutex              Mutex;
+	std::condition_variable Ready;
+	unsigned                Waiting;
+	bool                    Go;
+	fdclock::time_point     Start;
+	fdclock::time_point     End;
+
+	SLoadStart() : Waiting(0), Go(false) {}
+};
+//-----------------------------------------------------------------------------
+
+/** Un hilo de carga: su ejecutor, sus entradas y sus medidas */
+struct SLoadThread
+{
+	const SLoadConfig*  Config;
+	SLoadStart*         Start;
+	TFuzzyModel*        Shared;
+	TFuzzyImage*        Image;
+	unsigned            Index;
+	unsigned            Threads;
+
+	/** Tiempo desde la llegada prevista hasta el final del clculo, en ns */
+	TFuzzyHistogram     Latency;
+	/** Tiempo de calculate(), en ns */
+	TFuzzyHistogram     Service;
+	uint64_t            Calcs;
+	std::string         Error;
+
+	void run();
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de modelo
+ *
+ * \return true si el archivo empieza por FL_BIN_MAGIC (formato binario).
+ */
+static bool isBinaryModel(const std::string& strFile)
+{
+	char          c_magic[4] = { 0, 0, 0, 0 };
+	std::ifstream file(strFile.c_str(), std::ios::in | std::ios::binary);
+
+	file.read(c_magic, sizeof(c_magic));
+
+	return file.good() && memcmp(c_magic, FL_BIN_MAGIC, sizeof(c_magic)) == 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  strFile  Archivo de modelo
+ * \param [out] fmModel  Modelo cargado
+ */
+static void loadModel(const std::string& strFile, TFuzzyModel& fmModel)
+{
+	if(isBinaryModel(strFile))
+		fmModel.loadFromBinary(strFile);
+	else
+		fmModel.loadFromFile(strFile);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Generador pseudoaleatorio (LCG) de cada hilo, para que las entradas sean
+ * siempre las mismas con la misma semilla.
+ *
+ * \return Un nmero entre 0 y 1, sin llegar a 1.
+ */
+static double nextRandom(unsigned int& uiSeed)
+{
+	uiSeed = uiSeed * 1103515245u + 12345u;
+	return double((uiSeed >> 8) & 0xFFFFFF) / double(0x1000000);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]     liInput Entrada
+ * \param [in]     uiCalc  Nmero de clculo del hilo
+ * \param [in,out] uiSeed  Estado del generador del hilo
+ *
+ * \return El siguiente valor de la entrada segn su distribucin: uniforme
+ * en su rango, normal centrada con el rango a seis desviaciones (recortada
+ * al rango), un recorrido de ida y vuelta por el rango o fija en el centro.
+ */
+static fuzzvar inputValue(const SLoadInput& liInput, uint64_t uiCalc, unsigned int& uiSeed)
+{
+	double d_pos = 0.5;
+
+	switch(liInput.Dist)
+	{
+	case idUniform:
+		d_pos = nextRandom(uiSeed);
+		break;
+	case idNormal:
+		{
+			double d_u1 = nextRandom(uiSeed) + 1.0 / double(0x1000000);
+			double d_u2 = nextRandom(uiSeed);
+			d_pos = 0.5 + sqrt(-2.0 * log(d_u1)) * cos(2.0 * M_PI * d_u2) / 6.0;
+			d_pos = d_pos < 0.0 ? 0.0 : (d_pos > 1.0 ? 1.0 : d_pos);
+		}
+		break;
+	case idSweep:
+		d_pos = double(uiCalc % (2 * FD_SWEEP_STEPS)) / FD_SWEEP_STEPS;
+		d_pos = d_pos > 1.0 ? 2.0 - d_pos : d_pos;
+		break;
+	case idFixed:
+		break;
+	}
+
+	return liInput.Min + fuzzvar(d_pos) * liInput.Range;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * Prepara el ejecutor del hilo (y su modelo si no se comparte), calienta,
+ * espera al arranque comn y lanza clculos hasta el final de la medida.
+ *
+ * Con una tasa objetivo las llegadas se programan de antemano (lazo
+ * abierto), a Config->Rate / Threads por segundo en cada hilo, y la latencia
+ * se mide desde la llegada programada, de manera que si el hilo se retrasa
+ * el retraso cuenta en la latencia en lugar de frenar las llegadas. Sin
+ * tasa cada clculo empieza al acabar el anterior y la latencia es el tiempo
+ * del clculo.
+ */
+void SLoadThread::run()
+{
+	TFuzzyModel           fm_model;
+	TFuzzyExec            fe_exec;
+	std::vector<uint32_t> v_inputs;
+	unsigned int          ui_seed = Config->Seed + 7919u * Index;
+	double                d_rate  = Config->Rate / Threads;
+
+	Calcs = 0;
+	try
+	{
+		if(Image)
+			fe_exec.image(Image);
+		else if(Shared)
+			fe_exec.model(Shared);
+		else
+		{
+			loadModel(Config->File, fm_model);
+			fe_exec.model(&fm_model);
+		}
+
+		for(size_t i = 0; i < Config->Inputs.size(); ++i)
+			v_inputs.push_back(fe_exec.index(Config->Inputs[i].Set));
+
+		for(uint64_t k = 0; k < FD_WARMUP_CALCS; ++k)
+		{
+			for(size_t i = 0; i < v_inputs.size(); ++i)
+				fe_exec.inputAt(v_inputs[i], inputValue(Config->Inputs[i], k, ui_seed));
+			fe_exec.calculate();
+		}
+	}
+	catch(TFuzzyError& e)
+	{
+		Error = e.message();
+	}
+
+	//-- Arranque comn (tambin si ha fallado, para no bloquear a los dems)
+	fdclock::time_point t_start, t_end;
+	{
+		std::unique_lock<std::mutex> lock(Start->Mutex);
+		++Start->Waiting;
+		Start->Ready.notify_all();
+		while(!Start->Go)
+			Start->Ready.wait(lock);
+		t_start = Start->Start;
+		t_end   = Start->End;
+	}
+	if(!Error.empty())
+		return;
+
+	//-- Cada hilo empieza en un punto distinto del intervalo entre llegadas
+	fdclock::time_point t_next = t_start;
+	if(d_rate > 0.0)
+		t_next += std::chrono::nanoseconds(int64_t(1.0E9 / d_rate * Index / Threads));
+
+	try
+	{
+		for(uint64_t k = FD_WARMUP_CALCS; ; ++k)
+		{
+			fdclock::time_point t_now;
+
+			for(size_t i = 0; i < v_inputs.size(); ++i)
+				fe_exec.inputAt(v_inputs[i], inputValue(Config->Inputs[i], k, ui_seed));
+
+			if(d_rate > 0.0)
+			{
+				if(t_next >= t_end)
+					break;
+				t_now = fdclock::now();
+				if(t_next - t_now > std::chrono::nanoseconds(FD_SLEEP_NS))
+					std::this_thread::sleep_until(t_next - std::chrono::nanoseconds(FD_SLEEP_NS / 2));
+				while((t_now = fdclock::now()) < t_next)
+					;
+			}
+			else
+			{
+				t_now = fdclock::now();
+				if(t_now >= t_end)
+					break;
+				t_next = t_now;
+			}
+
+			fe_exec.calculate();
+
+			fdclock::time_point t_done = fdclock::now();
+			Service.add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t_done - t_now).count()));
+			Latency.add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t_done - t_next).count()));
+			++Calcs;
+
+			if(d_rate > 0.0)
+			{
+				double d_gap = Config->Poisson ? -log(1.0 - nextRandom(ui_seed)) / d_rate : 1.0 / d_rate;
+				t_next += std::chrono::nanoseconds(int64_t(1.0E9 * d_gap));
+			}
+		}
+	}
+	catch(TFuzzyError& e)
+	{
+		Error = e.message();
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] fmModel Modelo
+ * \param [in] idDist  Distribucin de todas las entradas
+ * \param [in] mDists  Distribucin de entradas concretas, por nombre
+ * \param [out] vInputs Entradas
+ *
+ * Toma como entradas los conjuntos que no calcula ninguna regla, con su
+ * rango de valores.
+ */
+static void modelInputs(TFuzzyModel& fmModel, TInputDist idDist, const std::map<std::string, TInputDist>& mDists,
+						std::vector<SLoadInput>& vInputs)
+{
+	std::set<fzhndl> s_outputs;
+	TFuzzyRules&     fr_rules = fmModel.rules();
+
+	for(size_t i = 0; i < fr_rules.size(); ++i)
+	{
+		const SFuzzyRule& fr_rule = fr_rules[i];
+		s_outputs.insert(fr_rules.value(fr_rules.atoms(fr_rule)[fr_rule.AtomCount - 1])->parent()->handle());
+	}
+
+	for(size_t j = 0; j < fmModel.sets().size(); ++j)
+	{
+		TFuzzySet& fs_set = fmModel.sets()[int(j)];
+		SLoadInput li_input;
+
+		if(s_outputs.count(fs_set.handle()))
+			continue;
+
+		std::map<std::string, TInputDist>::const_iterator found = mDists.find(fs_set.name());
+
+		li_input.Set   = fs_set.name();
+		li_input.Min   = fs_set.min();
+		li_input.Range = fs_set.max() - fs_set.min();
+		li_input.Dist  = found != mDists.end() ? found->second : idDist;
+		vInputs.push_back(li_input);
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  strName Nombre de la distribucin
+ * \param [out] idDist  Distribucin
+ *
+ * \return false si el nombre no es vlido.
+ */
+static bool parseDist(const std::string& strName, TInputDist& idDist)
+{
+	static const char*      c_names[4] = { "uniform", "normal", "sweep", "fixed" };
+	static const TInputDist c_dists[4] = { idUniform, idNormal, idSweep, idFixed };
+
+	for(int i = 0; i < 4; ++i)
+	{
+		if(strName == c_names[i])
+		{
+			idDist = c_dists[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  strList   Nmeros separados por comas
+ * \param [out] vThreads  Nmeros ledos
+ *
+ * \return false si alguno no es vlido.
+ */
+static bool parseThreads(const std::string& strList, std::vector<unsigned>& vThreads)
+{
+	std::stringstream ss(strList);
+	std::string       str_item;
+
+	vThreads.clear();
+	while(std::getline(ss, str_item, ','))
+	{
+		long l_threads = strtol(str_item.c_str(), NULL, 10);
+		if(l_threads < 1)
+			return false;
+		vThreads.push_back(unsigned(l_threads));
+	}
+
+	return !vThreads.empty();
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  lcConfig Configuracin
+ * \param [in]  uThreads Hilos de la medida
+ * \param [in]  fmShared Modelo comn (NULL si cada hilo carga el suyo)
+ * \param [in]  fiImage  Imagen comn (NULL si no se ejecuta una imagen)
+ * \param [out] fhLatency Latencias de todos los hilos
+ * \param [out] fhService Tiempos de clculo de todos los hilos
+ * \param [out] dSeconds  Duracin real de la medida
+ *
+ * Lanza uThreads hilos de carga durante lcConfig.Duration segundos.
+ *
+ * \return Clculos hechos entre todos los hilos.
+ */
+static uint64_t runStep(const SLoadConfig& lcConfig, unsigned uThreads, TFuzzyModel* fmShared,
+						TFuzzyImage* fiImage, TFuzzyHistogram& fhLatency, TFuzzyHistogram& fhService,
+						double& dSeconds)
+{
+	std::vector<SLoadThread*> v_loads;
+	std::vector<std::thread>  v_threads;
+	SLoadStart                ls_start;
+	uint64_t                  ui_calcs = 0;
+	std::string               str_error;
+
+	for(unsigned i = 0; i < uThreads; ++i)
+	{
+		SLoadThread* lt_load = new SLoadThread();
+
+		lt_load->Config  = &lcConfig;
+		lt_load->Start   = &ls_start;
+		lt_load->Shared  = fmShared;
+		lt_load->Image   = fiImage;
+		lt_load->Index   = i;
+		lt_load->Threads = uThreads;
+		v_loads.push_back(lt_load);
+		v_threads.push_back(std::thread(&SLoadThread::run, lt_load));
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(ls_start.Mutex);
+		while(ls_start.Waiting < uThreads)
+			ls_start.Ready.wait(lock);
+		ls_start.Start = fdclock::now() + std::chrono::milliseconds(1);
+		ls_start.End   = ls_start.Start + std::chrono::nanoseconds(int64_t(1.0E9 * lcConfig.Duration));
+		ls_start.Go    = true;
+		ls_start.Ready.notify_all();
+	}
+
+	for(unsigned i = 0; i < uThreads; ++i)
+	{
+		v_threads[i].join();
+		fhLatency.merge(v_loads[i]->Latency);
+		fhService.merge(v_loads[i]->Service);
+		ui_calcs += v_loads[i]->Calcs;
+		if(str_error.empty())
+			str_error = v_loads[i]->Error;
+		delete v_loads[i];
+	}
+	dSeconds = std::chrono::duration<double>(fdclock::now() - ls_start.Start).count();
+
+	if(!str_error.empty())
+		throw TFuzzyError("runStep", str_error.c_str(), __LINE__, __FILE__);
+
+	return ui_calcs;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * fuzzy_load model [clave=valor ...]
+ *
+ * Mide el modelo con cada nmero de hilos de threads (1,2,4,8... por
+ * defecto, hasta el nmero de ncleos). Las claves son:
+ *
+ * \li threads: nmeros de hilos, separados por comas.
+ * \li rate: clculos por segundo entre todos los hilos (0: lazo cerrado).
+ * \li arrivals: constant o poisson.
+ * \li duration: segundos de cada medida.
+ * \li dist: distribucin de todas las entradas (uniform, normal, sweep o
+ * fixed) y dist.<conjunto> la de una entrada.
+ * \li mode: private (un modelo por hilo), shared (un modelo para todos) o
+ * image (una imagen para todos; un modelo de texto se convierte antes).
+ * \li seed: semilla de las entradas y las llegadas.
+ */
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		std::cerr << "usage: fuzzy_load model [threads=N,N...] [rate=N] [arrivals=constant|poisson]"
+				  << " [duration=S] [dist=uniform|normal|sweep|fixed] [dist.<set>=D]"
+				  << " [mode=private|shared|image] [seed=N]" << std::endl;
+		return 1;
+	}
+
+	SLoadConfig                       lc_config;
+	TInputDist                        id_dist = idUniform;
+	std::map<std::string, TInputDist> m_dists;
+	std::string                       str_bin;
+
+	lc_config.File = argv[1];
+	for(unsigned u = 1; u <= std::thread::hardware_concurrency(); u *= 2)
+		lc_config.Threads.push_back(u);
+	if(lc_config.Threads.empty())
+		lc_config.Threads.push_back(1);
+
+	for(int i = 2; i < argc; ++i)
+	{
+		std::string str_arg = argv[i];
+		size_t      sz_eq   = str_arg.find('=');
+		std::string str_key = str_arg.substr(0, sz_eq);
+		std::string str_val = sz_eq == std::string::npos ? "" : str_arg.substr(sz_eq + 1);
+		bool        b_ok    = sz_eq != std::string::npos;
+
+		if(str_key == "threads")
+			b_ok = b_ok && parseThreads(str_val, lc_config.Threads);
+		else if(str_key == "rate")
+			lc_config.Rate = strtod(str_val.c_str(), NULL);
+		else if(str_key == "arrivals")
+		{
+			lc_config.Poisson = str_val == "poisson";
+			b_ok = b_ok && (lc_config.Poisson || str_val == "constant");
+		}
+		else if(str_key == "duration")
+			b_ok = b_ok && (lc_config.Duration = strtod(str_val.c_str(), NULL)) > 0.0;
+		else if(str_key == "dist")
+			b_ok = b_ok && parseDist(str_val, id_dist);
+		else if(str_key.compare(0, 5, "dist.") == 0)
+			b_ok = b_ok && parseDist(str_val, m_dists[str_key.substr(5)]);
+		else if(str_key == "mode")
+		{
+			lc_config.Mode = str_val == "shared" ? lmShared : (str_val == "image" ? lmImage : lmPrivate);
+			b_ok = b_ok && (lc_config.Mode != lmPrivate || str_val == "private");
+		}
+		else if(str_key == "seed")
+			lc_config.Seed = unsigned(strtoul(str_val.c_str(), NULL, 10));
+		else
+			b_ok = false;
+
+		if(!b_ok || lc_config.Rate < 0.0)
+		{
+			std::cerr << "error: bad argument '" << str_arg << "'" << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		TFuzzyModel fm_model;
+		TFuzzyImage fi_image;
+		double      d_base = 0.0;
+
+		loadModel(lc_config.File, fm_model);
+		modelInputs(fm_model, id_dist, m_dists, lc_config.Inputs);
+		for(std::map<std::string, TInputDist>::iterator iter = m_dists.begin(); iter != m_dists.end(); ++iter)
+		{
+			size_t j = 0;
+			while(j < lc_config.Inputs.size() && lc_config.Inputs[j].Set != iter->first)
+				++j;
+			if(j == lc_config.Inputs.size())
+				throw TFuzzyError("main", ("No es una entrada del modelo: " + iter->first).c_str(),
+						__LINE__, __FILE__);
+		}
+
+		if(lc_config.Mode == lmImage)
+		{
+			if(isBinaryModel(lc_config.File))
+				fi_image.map(lc_config.File);
+			else
+			{
+				str_bin = "fuzzy_load.yafl";
+				fm_model.saveToBinary(str_bin);
+				fi_image.map(str_bin);
+			}
+		}
+
+		static const char* c_modes[3] = { "private models", "shared model", "shared image" };
+		std::cout << lc_config.File << ": " << lc_config.Inputs.size() << " inputs, "
+				  << fm_model.rules().size() << " rules, " << c_modes[lc_config.Mode] << ", ";
+		if(lc_config.Rate > 0.0)
+			std::cout << (lc_config.Poisson ? "poisson" : "constant") << " arrivals at "
+					  << lc_config.Rate << "/s";
+		else
+			std::cout << "closed loop";
+		std::cout << ", " << lc_config.Duration << " s per step" << std::endl;
+
+		char c_line[192];
+		snprintf(c_line, sizeof(c_line), "%8s %12s %12s %8s %10s %10s %10s %10s %10s\n", "threads",
+				 "target/s", "calcs/s", "scaling", "calc (us)", "p50 (us)", "p99 (us)", "p999 (us)", "max (us)");
+		std::cout << c_line;
+
+		for(size_t i = 0; i < lc_config.Threads.size(); ++i)
+		{
+			TFuzzyHistogram fh_latency;
+			TFuzzyHistogram fh_service;
+			double          d_secs  = 0.0;
+			uint64_t        ui_calc = runStep(lc_config, lc_config.Threads[i],
+											  lc_config.Mode == lmShared ? &fm_model : NULL,
+											  lc_config.Mode == lmImage ? &fi_image : NULL,
+											  fh_latency, fh_service, d_secs);
+			double          d_rate  = double(ui_calc) / d_secs;
+
+			//-- Escalado: rendimiento por hilo respecto al de la primera medida
+			if(i == 0)
+				d_base = d_rate / lc_config.Threads[0];
+			snprintf(c_line, sizeof(c_line), "%8u %12.0f %12.0f %8.2f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+					 lc_config.Threads[i], lc_config.Rate, d_rate,
+					 d_base > 0.0 ? d_rate / lc_config.Threads[i] / d_base : 0.0,
+					 fh_service.mean() / 1.0E3, double(fh_latency.percentile(50.0)) / 1.0E3,
+					 double(fh_latency.percentile(99.0)) / 1.0E3, double(fh_latency.percentile(99.9)) / 1.0E3,
+					 double(fh_latency.max()) / 1.0E3);
+			std::cout << c_line << std::flush;
+		}
+
+		if(!str_bin.empty())
+		{
+			fi_image.unmap();
+			std::remove(str_bin.c_str());
+		}
+
+		return 0;
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+	if(!str_bin.empty())
+		std::remove(str_bin.c_str());
+
+	return 1;
+}
+//-----------------------------------------------------------------------------
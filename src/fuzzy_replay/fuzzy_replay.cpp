@@ -0,0 +1,133 @@
+/**
+ * \file fuzzy_replay.cpp
+ *
+ *  Replays an execution log through a model and reports throughput, latency
+ *  and the deviation of the outputs from the recorded ones.
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzreplay.hpp"
+#include "fzbinary.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] strFile Archivo de modelo
+ *
+ * \return true si el archivo empieza por FL_BIN_MAGIC (formato binario).
+ */
+static bool isBinaryModel(const std::string& strFile)
+{
+	char          c_magic[4] = { 0, 0, 0, 0 };
+	std::ifstream file(strFile.c_str(), std::ios::in | std::ios::binary);
+
+	file.read(c_magic, sizeof(c_magic));
+
+	return file.good() && memcmp(c_magic, FL_BIN_MAGIC, sizeof(c_magic)) == 0;
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * fuzzy_replay model log [repeat [max_deviation [min_throughput]]]
+ *
+ * Reproduce repeat veces (1 si no se indica) el registro log, grabado con
+ * TFuzzyExec::logOpen(), con el modelo indicado. Un modelo binario se
+ * ejecuta como imagen (TFuzzyImage). Termina con error si alguna salida se
+ * desva de la grabada ms de max_deviation o si se hacen menos de
+ * min_throughput clculos por segundo (sin indicar: sin lmite). Tambin si
+ * la comparacin no es vlida (TFuzzyReplay::valid()): el registro perdi
+ * clculos o a alguno le faltan entradas.
+ */
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		std::cerr << "usage: fuzzy_replay model log [repeat [max_deviation [min_throughput]]]" << std::endl;
+		return 1;
+	}
+
+	std::string str_model = argv[1];
+	unsigned    ui_repeat = argc > 3 ? unsigned(atol(argv[3])) : 1;
+	double      d_maxdev  = argc > 4 ? atof(argv[4]) : -1.0;
+	double      d_minops  = argc > 5 ? atof(argv[5]) : 0.0;
+
+	try
+	{
+		TFuzzyModel  fm_model;
+		TFuzzyImage  fi_image;
+		TFuzzyExec   fe_exec;
+		TFuzzyReplay fr_replay;
+		int          i_rtn = 0;
+
+		if(isBinaryModel(str_model))
+		{
+			fi_image.map(str_model);
+			fe_exec.image(&fi_image);
+		}
+		else
+		{
+			fm_model.loadFromFile(str_model);
+			fe_exec.model(&fm_model);
+		}
+
+		fr_replay.load(argv[2]);
+		fr_replay.run(fe_exec, ui_repeat ? ui_repeat : 1);
+
+		std::cout << fr_replay.text();
+
+		if(!fr_replay.valid())
+		{
+			std::cerr << "fail: " << fr_replay.dropped() << " calculations dropped, "
+					  << fr_replay.incomplete() << " without all the inputs" << std::endl;
+			i_rtn = 1;
+		}
+		if(d_maxdev >= 0.0 && fr_replay.maxDeviation() > d_maxdev)
+		{
+			std::cerr << "fail: deviation " << fr_replay.maxDeviation() << " (max " << d_maxdev << ")"
+					  << std::endl;
+			i_rtn = 1;
+		}
+		if(fr_replay.throughput() < d_minops)
+		{
+			std::cerr << "fail: " << fr_replay.throughput() << " calculations/s (min " << d_minops << ")"
+					  << std::endl;
+			i_rtn = 1;
+		}
+
+		return i_rtn;
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+
+	return 1;
+}
+//-----------------------------------------------------------------------------
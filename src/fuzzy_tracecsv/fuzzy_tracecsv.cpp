@@ -0,0 +1,169 @@
+/**
+ * \file fuzzy_tracecsv.cpp
+ *
+ *  Converts an execution log written by TFuzzyExec::logOpen() to CSV, one
+ *  row per calculate().
+ */
+
+/*     Copyright (C) 2026  agent
+ *
+ *    This program is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along
+ *    with this program; if not, write to the Free Software Foundation, Inc.,
+ *    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ *    created: 18/10/2026
+ *    author: agent
+ *    e-mail: agent@local
+ *
+ */
+//-----------------------------------------------------------------------------
+#include "fzlog.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+//-----------------------------------------------------------------------------
+using namespace nsFuzzy;
+//-----------------------------------------------------------------------------
+
+/** Columnas del CSV: conjuntos de entrada, reglas y conjuntos calculados */
+struct SCsvColumns
+{
+	std::set<uint32_t> Inputs;
+	std::set<uint32_t> Rules;
+	std::set<uint32_t> Outputs;
+};
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in]  vValues Valores anotados
+ * \param [out] sIds    Identificadores de los valores
+ */
+static void addIds(const std::vector<SLogValue>& vValues, std::set<uint32_t>& sIds)
+{
+	for(size_t i = 0; i < vValues.size(); ++i)
+		sIds.insert(vValues[i].Id);
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * \param [in] osOut   Destino
+ * \param [in] sIds    Columnas
+ * \param [in] vValues Valores del clculo
+ *
+ * Escribe una celda por columna con el ltimo valor anotado con ese
+ * identificador, o vaca si no hay ninguno.
+ */
+static void writeValues(std::ostream& osOut, const std::set<uint32_t>& sIds,
+						const std::vector<SLogValue>& vValues)
+{
+	char c_val[32];
+
+	for(std::set<uint32_t>::const_iterator iter = sIds.begin(); iter != sIds.end(); ++iter)
+	{
+		osOut << ',';
+		for(size_t i = vValues.size(); i > 0; --i)
+		{
+			if(vValues[i - 1].Id == *iter)
+			{
+				snprintf(c_val, sizeof(c_val), "%.9g", double(vValues[i - 1].Value));
+				osOut << c_val;
+				break;
+			}
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+
+/**
+ * fuzzy_tracecsv log [csv]
+ *
+ * Escribe el registro log como CSV (en csv o en la salida estndar). Cada
+ * fila es un clculo: su secuencia, su instante en ns, el valor de cada
+ * entrada (in:conjunto), la fuerza de cada regla evaluada (rule:posicin)
+ * y el resultado de cada conjunto calculado (out:conjunto).
+ */
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		std::cerr << "usage: fuzzy_tracecsv log [csv]" << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		TFuzzyLogReader lr_log;
+		SLogCalculate   lc_calc;
+		SCsvColumns     cc_cols;
+		uint64_t        ui_rows = 0;
+
+		//-- Primera pasada: columnas
+		lr_log.open(argv[1]);
+		while(lr_log.next(lc_calc))
+		{
+			addIds(lc_calc.Inputs, cc_cols.Inputs);
+			addIds(lc_calc.Rules, cc_cols.Rules);
+			addIds(lc_calc.Outputs, cc_cols.Outputs);
+		}
+
+		std::ofstream os_file;
+		if(argc > 2)
+		{
+			os_file.open(argv[2], std::ios::trunc | std::ios::out);
+			if(!os_file.is_open())
+			{
+				std::cerr << "error: cannot write " << argv[2] << std::endl;
+				return 1;
+			}
+		}
+		std::ostream& os_out = argc > 2 ? os_file : std::cout;
+
+		os_out << "sequence,time_ns";
+		for(std::set<uint32_t>::iterator iter = cc_cols.Inputs.begin(); iter != cc_cols.Inputs.end(); ++iter)
+			os_out << ",in:" << lr_log.name(*iter);
+		for(std::set<uint32_t>::iterator iter = cc_cols.Rules.begin(); iter != cc_cols.Rules.end(); ++iter)
+			os_out << ",rule:" << *iter;
+		for(std::set<uint32_t>::iterator iter = cc_cols.Outputs.begin(); iter != cc_cols.Outputs.end(); ++iter)
+			os_out << ",out:" << lr_log.name(*iter);
+		os_out << "\n";
+
+		//-- Segunda pasada: filas
+		lr_log.open(argv[1]);
+		while(lr_log.next(lc_calc))
+		{
+			os_out << lc_calc.Sequence << ',' << lc_calc.Time;
+			writeValues(os_out, cc_cols.Inputs, lc_calc.Inputs);
+			writeValues(os_out, cc_cols.Rules, lc_calc.Rules);
+			writeValues(os_out, cc_cols.Outputs, lc_calc.Outputs);
+			os_out << "\n";
+			++ui_rows;
+		}
+		os_out.flush();
+
+		std::cerr << ui_rows << " calculations";
+		if(lr_log.dropped())
+			std::cerr << ", " << lr_log.dropped() << " dropped";
+		std::cerr << std::endl;
+
+		return os_out.good() ? 0 : 1;
+	}
+	catch(TFuzzyError& e)
+	{
+		std::cerr << "error: " << e.message() << std::endl;
+	}
+
+	return 1;
+}
+//-----------------------------------------------------------------------------
@@ -29,15 +29,22 @@
 #include "ini_file.hpp"
 #include <fstream>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
 //-----------------------------------------------------------------------------
 using namespace nsIniFile;
 //-----------------------------------------------------------------------------
+//-- Tamao a partir del cual saveFile() vuelca lo escrito al archivo
+#define INI_WRITE_BUFFER	65536
+//-----------------------------------------------------------------------------
 
 TParam::TParam(std::string strName)
 {
 	m_strName    = strName;
 	m_strComment = "";
-	m_ssValue.clear();
+	m_cText      = NULL;
+	m_szText     = 0;
+	m_ssValue    = NULL;
 }
 //-----------------------------------------------------------------------------
 
@@ -45,7 +52,102 @@ TParam::~TParam()
 {
 	m_strName    = "";
 	m_strComment = "";
-	m_ssValue.clear();
+	if(m_ssValue)
+		delete m_ssValue;
+	m_ssValue = NULL;
+}
+//-----------------------------------------------------------------------------
+
+/*
+ * Asigna el valor ledo del archivo sin copiarlo. Si el parmetro ya tena
+ * valor (est repetido en la seccin), el nuevo se aade a continuacin, como
+ * si se escribiese en value().
+ */
+void TParam::view(const char* cText, size_t szLen)
+{
+	if(m_ssValue || m_szText)
+		value().write(cText, szLen);
+	else
+	{
+		m_cText  = cText;
+		m_szText = szLen;
+	}
+}
+//-----------------------------------------------------------------------------
+
+/*
+ * Crea el stream la primera vez que se usa, con el valor ledo del archivo.
+ */
+std::stringstream& TParam::value()
+{
+	if(!m_ssValue)
+	{
+		m_ssValue = new std::stringstream();
+		if(m_szText)
+			m_ssValue->write(m_cText, m_szText);
+		m_cText  = NULL;
+		m_szText = 0;
+	}
+
+	return *m_ssValue;
+}
+//-----------------------------------------------------------------------------
+
+std::string TParam::text()
+{
+	if(m_ssValue)
+		return m_ssValue->str();
+
+	return m_szText ? std::string(m_cText, m_szText) : std::string("");
+}
+//-----------------------------------------------------------------------------
+
+/*
+ * Interpreta el comienzo de cText como un nmero, igual que value() >> x.
+ * Los espacios iniciales se saltan aqu para que la conversin no contine en
+ * la lnea siguiente si el valor est vaco. Por lo dems, un valor ledo del
+ * archivo termina siempre antes de un carcter que no forma parte de un nmero
+ * (fin de lnea, espacio o '#'), por lo que la conversin no sale de l.
+ */
+template<typename T>
+static bool toNumber(const char* cText, size_t szLen, T (*fConvert)(const char*, char**), T& tValue)
+{
+	size_t i     = 0;
+	char*  c_end = NULL;
+
+	tValue = 0;
+	while(i < szLen && (cText[i] == ' ' || cText[i] == '\t'))
+		++i;
+	if(i == szLen)
+		return false;
+
+	tValue = fConvert(cText + i, &c_end);
+
+	return c_end != cText + i;
+}
+//-----------------------------------------------------------------------------
+
+bool TParam::number(float& fValue)
+{
+	if(m_ssValue)
+	{
+		std::string str_aux = m_ssValue->str();
+		return toNumber(str_aux.c_str(), str_aux.size(), strtof, fValue);
+	}
+
+	return toNumber(m_cText, m_szText, strtof, fValue);
+}
+//-----------------------------------------------------------------------------
+
+bool TParam::number(double& dValue)
+{
+	if(m_ssValue)
+	{
+		std::string str_aux = m_ssValue->str();
+		return toNumber(str_aux.c_str(), str_aux.size(), strtod, dValue);
+	}
+
+	return toNumber(m_cText, m_szText, strtod, dValue);
 }
 //-----------------------------------------------------------------------------
 
@@ -81,6 +183,8 @@ TParam* TSection::add(std::string strName, std::string strComment)
 
 		param->comment()   = strComment;
 		m_mParams[strName] = param;
+		m_itCursor         = m_mParams.begin();
+		m_uiCursor         = 0;
 
 		return param;
 	}
@@ -98,6 +202,8 @@ bool TSection::del(std::string strName)
 	{
 		delete found->second;
 		m_mParams.erase(found);
+		m_itCursor = m_mParams.begin();
+		m_uiCursor = 0;
 
 		b_ret = true;
 	}
@@ -109,15 +215,14 @@ bool TSection::del(std::string strName)
 bool TSection::del(unsigned int uiIndex)
 {
 	bool b_ret = false;
-	std::map<std::string, TParam*>::iterator iter = m_mParams.begin();
-
-	for(unsigned int i = 0; i < uiIndex && iter != m_mParams.end(); ++i)
-		++iter;
+	std::map<std::string, TParam*>::iterator iter = seek(uiIndex);
 
 	if(iter != m_mParams.end())
 	{
 		delete iter->second;
 		m_mParams.erase(iter);
+		m_itCursor = m_mParams.begin();
+		m_uiCursor = 0;
 
 		b_ret = true;
 	}
@@ -134,6 +239,8 @@ void TSection::clear()
 		m_mParams.erase(m_mParams.begin());
 	}
 	m_mParams.clear();
+	m_itCursor = m_mParams.begin();
+	m_uiCursor = 0;
 }
 //-----------------------------------------------------------------------------
 
@@ -147,15 +254,34 @@ TParam* TSection::operator[](std::string strName)
 
 TParam* TSection::operator[](unsigned int uiIndex)
 {
-	std::map<std::string, TParam*>::iterator iter = m_mParams.begin();
-
-	for(unsigned int i = 0; i < uiIndex && iter != m_mParams.end(); ++i)
-		++iter;
+	std::map<std::string, TParam*>::iterator iter = seek(uiIndex);
 
 	return iter == m_mParams.end() ? NULL : iter->second;
 }
 //-----------------------------------------------------------------------------
 
+/*
+ * Avanza el cursor hasta la posicin uiIndex. Slo vuelve al principio si se
+ * pide una posicin anterior a la del cursor, de manera que un recorrido
+ * secuencial es lineal en lugar de cuadrtico.
+ */
+std::map<std::string, TParam*>::iterator TSection::seek(unsigned int uiIndex)
+{
+	if(uiIndex < m_uiCursor)
+	{
+		m_itCursor = m_mParams.begin();
+		m_uiCursor = 0;
+	}
+	while(m_uiCursor < uiIndex && m_itCursor != m_mParams.end())
+	{
+		++m_itCursor;
+		++m_uiCursor;
+	}
+
+	return m_uiCursor == uiIndex ? m_itCursor : m_mParams.end();
+}
+//-----------------------------------------------------------------------------
+
 
 
 
@@ -174,34 +300,43 @@ TIniFile::~TIniFile()
 }
 //-----------------------------------------------------------------------------
 
-void TIniFile::readLine(char* cLine, TSection*& sSection, TParam*& pParam)
+/*
+ * Interpreta una lnea (sin el fin de lnea) directamente sobre el contenido
+ * ledo del archivo. Los valores de los parmetros no se copian: quedan como
+ * vistas sobre dicho contenido (ver TParam).
+ */
+void TIniFile::readLine(const char* cLine, size_t szLen, TSection*& sSection, TParam*& pParam)
 {
-	std::string str_line(cLine);
-	size_t      pos = str_line.find_first_of("#[=");
-	size_t      end = 0;
-	size_t      com = 0;
+	size_t pos = 0;
+	size_t end = 0;
+	size_t com = 0;
+
+	while(pos < szLen && cLine[pos] != '#' && cLine[pos] != '[' && cLine[pos] != '=')
+		++pos;
 
-	if(str_line.empty())
+	if(szLen == 0)
 	{
 		if(m_strHeader.empty())
 			m_strHeader = m_strComments;
 		m_strComments.clear();
 	}
-	else if(pos != std::string::npos)
+	else if(pos < szLen)
 	{
-		switch(str_line[pos])
+		switch(cLine[pos])
 		{
 		case '[':
-			end = str_line.find(']', pos + 1);
-			if(end != std::string::npos)
+			end = pos + 1;
+			while(end < szLen && cLine[end] != ']')
+				++end;
+			if(end < szLen)
 			{
-				sSection = add(str_line.substr(pos + 1, end - pos - 1));
+				sSection = add(std::string(cLine + pos + 1, end - pos - 1));
 				sSection->comment() = m_strComments;
 				m_strComments.clear();
 			}
 			else
 			{
-				// TODO: Lanzar error de formato de sección. No se encuentra
+				// TODO: Lanzar error de formato de seccin. No se encuentra
 				// el terminador ']'
 			}
 			break;
@@ -209,37 +344,38 @@ void TIniFile::readLine(char* cLine, TSection*& sSection, TParam*& pParam)
 		case '=':
 			if(sSection)
 			{
-				pParam = sSection->add(str_line.substr(0, pos));
-				com = str_line.find('#', pos + 1);
-				if(com != std::string::npos)
+				pParam = sSection->add(std::string(cLine, pos));
+				com = pos + 1;
+				while(com < szLen && cLine[com] != '#')
+					++com;
+				if(com < szLen)
 				{
 					end = com;
-					while(str_line[end - 1] == ' ')
+					while(cLine[end - 1] == ' ')
 						--end;
-					while(str_line[com + 1] == ' ')
+					while(com + 1 < szLen && cLine[com + 1] == ' ')
 						++com;
 
-					pParam->value() << str_line.substr(pos + 1, end - pos - 1);
-					pParam->comment() = str_line.substr(com + 1);
+					pParam->view(cLine + pos + 1, end - pos - 1);
+					pParam->comment().assign(cLine + com + 1, szLen - com - 1);
 				}
 				else
 				{
-					pParam->value() << str_line.substr(pos + 1);
+					pParam->view(cLine + pos + 1, szLen - pos - 1);
 				}
 			}
 			else
 			{
-				// TODO: Lanzar error de formato. No existe sección para el
-				// parámetro dado
+				// TODO: Lanzar error de formato. No existe seccin para el
+				// parmetro dado
 			}
 			break;
 
 		case '#':
-			end = str_line.size();
-			if(end == str_line.rfind(' ') + 1)
-				while(str_line[end - 1] == ' ')
-					--end;
-			while(str_line[pos + 1] == ' ')
+			end = szLen;
+			while(cLine[end - 1] == ' ')
+				--end;
+			while(pos + 1 < szLen && cLine[pos + 1] == ' ')
 				++pos;
 			if(end == pos + 1)
 			{
@@ -249,7 +385,8 @@ void TIniFile::readLine(char* cLine, TSection*& sSection, TParam*& pParam)
 			{
 				if(!m_strComments.empty())
 					m_strComments += std::string("\n");
-				m_strComments += str_line.substr(pos + 1, end - pos - 1);
+				if(end > pos + 1)
+					m_strComments.append(cLine + pos + 1, end - pos - 1);
 			}
 			break;
 
@@ -260,90 +397,156 @@ void TIniFile::readLine(char* cLine, TSection*& sSection, TParam*& pParam)
 }
 //-----------------------------------------------------------------------------
 
+/*
+ * Lee el archivo completo de una vez y lo recorre lnea a lnea sin copiarlo,
+ * por lo que no hay lmite de longitud de lnea. El contenido se conserva
+ * hasta close() o clear(), ya que los parmetros apuntan a l.
+ */
 void TIniFile::loadFile(std::string strFilename)
 {
-	std::fstream file;
-
-	file.open(strFilename.c_str(), std::fstream::in);
+	std::ifstream file(strFilename.c_str(), std::ios::in | std::ios::binary);
 
 	if(!file.is_open())
 		return;
 
-	char      c_line[1024];
-	int       i_size  = 1024;
-	TSection* section = NULL;
-	TParam*   param   = NULL;
+	file.seekg(0, std::ios::end);
+	std::streamoff so_size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if(so_size < 0)
+		return;
 
-	while(!file.eof())
+	m_lBuffers.push_back(std::string());
+	std::string& str_data = m_lBuffers.back();
+
+	str_data.resize(size_t(so_size));
+	if(so_size > 0)
+		file.read(&str_data[0], so_size);
+	str_data.resize(size_t(file.gcount()));
+	file.close();
+
+	const char* c_line  = str_data.c_str();
+	const char* c_end   = c_line + str_data.size();
+	const char* c_eol   = NULL;
+	size_t      sz_len  = 0;
+	TSection*   section = NULL;
+	TParam*     param   = NULL;
+
+	while(true)
 	{
-		file.getline(c_line, i_size);
-		readLine(c_line, section, param);
+		c_eol  = (const char*)memchr(c_line, '\n', c_end - c_line);
+		sz_len = (c_eol ? c_eol : c_end) - c_line;
+		//-- Archivos con fin de lnea de Windows
+		if(sz_len > 0 && c_line[sz_len - 1] == '\r')
+			--sz_len;
+
+		readLine(c_line, sz_len, section, param);
+
+		if(!c_eol)
+			break;
+		c_line = c_eol + 1;
 	}
+}
+//-----------------------------------------------------------------------------
 
-	file.close();
+/*
+ * Escribe un comentario, una lnea "# ..." por cada lnea del mismo.
+ */
+static void writeComment(std::string& strOut, const std::string& strComment)
+{
+	size_t pos = 0;
+	size_t end = 0;
+
+	while((end = strComment.find('\n', pos)) != std::string::npos)
+	{
+		strOut += "# ";
+		strOut.append(strComment, pos, end - pos);
+		strOut += '\n';
+		pos = end + 1;
+	}
+	strOut += "# ";
+	strOut.append(strComment, pos, std::string::npos);
+	strOut += '\n';
 }
 //-----------------------------------------------------------------------------
 
-void TIniFile::saveFile(std::string strFilename)
+/*
+ * Vuelca al archivo lo escrito en strOut si supera INI_WRITE_BUFFER (o
+ * siempre, si bForce es true).
+ */
+static void writeFlush(std::ofstream& file, std::string& strOut, bool bForce)
 {
-	std::fstream file;
+	if(bForce || strOut.size() >= INI_WRITE_BUFFER)
+	{
+		file.write(strOut.data(), strOut.size());
+		strOut.clear();
+	}
+}
+//-----------------------------------------------------------------------------
 
-	file.open(strFilename.c_str(), std::fstream::out | std::fstream::trunc);
+/*
+ * Escribe el archivo por bloques de INI_WRITE_BUFFER bytes, recorriendo cada
+ * seccin y sus parmetros una sola vez.
+ */
+void TIniFile::saveFile(std::string strFilename)
+{
+	std::ofstream file(strFilename.c_str(), std::ios::out | std::ios::trunc);
 
 	if(!file.is_open())
 		return;
 
 	std::map<std::string, TSection*>::iterator iter = m_mSections.begin();
-	TParam* param = NULL;
+	TSection*   section = NULL;
+	TParam*     param   = NULL;
+	std::string str_out;
+
+	str_out.reserve(2 * INI_WRITE_BUFFER);
 
 	if(!m_strHeader.empty())
 	{
-		size_t      pos;
-		std::string str_aux = m_strHeader;
-		while((pos = str_aux.find('\n')) != std::string::npos)
-		{
-			file << "# " << str_aux.substr(0, pos) << std::endl;
-			str_aux = str_aux.substr(pos + 1);
-		}
-		file << "# " << str_aux.substr(0, pos) << std::endl << std::endl;
+		writeComment(str_out, m_strHeader);
+		str_out += '\n';
 	}
 
 	while(iter != m_mSections.end())
 	{
-		if(iter->second)
+		section = iter->second;
+		if(section)
 		{
 			if(iter != m_mSections.begin())
-				file << std::endl;
+				str_out += '\n';
 
-			if(iter->second->comment().size())
-			{
-				size_t      pos;
-				std::string comment = iter->second->comment();
-				while((pos = comment.find('\n')) != std::string::npos)
-				{
-					file << "# " << comment.substr(0, pos) << std::endl;
-					comment = comment.substr(pos + 1);
-				}
-				file << "# " << comment.substr(0, pos) << std::endl;
-			}
+			if(section->comment().size())
+				writeComment(str_out, section->comment());
 
-			file << "[" << iter->second->name() << "]" << std::endl;
-			for(size_t i = 0; i < iter->second->size(); ++i)
+			str_out += '[';
+			str_out += section->name();
+			str_out += "]\n";
+			for(size_t i = 0; i < section->size(); ++i)
 			{
-				param = (*(iter->second))[i];
+				param = (*section)[i];
 				if(param)
 				{
-					file << param->name() << "=" << param->value().str();
+					str_out += param->name();
+					str_out += '=';
+					if(param->m_ssValue)
+						str_out += param->m_ssValue->str();
+					else if(param->m_szText)
+						str_out.append(param->m_cText, param->m_szText);
 					if(param->comment().size())
-						file << " # " << param->comment();
-					file << std::endl;
+					{
+						str_out += " # ";
+						str_out += param->comment();
+					}
+					str_out += '\n';
 				}
+				writeFlush(file, str_out, false);
 			}
 		}
 
 		++iter;
 	}
 
+	writeFlush(file, str_out, true);
 	file.close();
 }
 //-----------------------------------------------------------------------------
@@ -364,6 +567,8 @@ TSection* TIniFile::add(std::string strName)
 	{
 		TSection* section = new TSection(strName);
 		m_mSections[strName] = section;
+		m_itCursor = m_mSections.begin();
+		m_uiCursor = 0;
 
 		return section;
 	}
@@ -381,6 +586,8 @@ bool TIniFile::del(std::string strName)
 	{
 		delete found->second;
 		m_mSections.erase(found);
+		m_itCursor = m_mSections.begin();
+		m_uiCursor = 0;
 
 		b_ret = true;
 	}
@@ -392,15 +599,14 @@ bool TIniFile::del(std::string strName)
 bool TIniFile::del(unsigned int uiIndex)
 {
 	bool b_ret = false;
-	std::map<std::string, TSection*>::iterator iter = m_mSections.begin();
-
-	for(unsigned int i = 0; i < uiIndex && iter != m_mSections.end(); ++i)
-		++iter;
+	std::map<std::string, TSection*>::iterator iter = seek(uiIndex);
 
 	if(iter != m_mSections.end())
 	{
 		delete iter->second;
 		m_mSections.erase(iter);
+		m_itCursor = m_mSections.begin();
+		m_uiCursor = 0;
 
 		b_ret = true;
 	}
@@ -412,6 +618,7 @@ bool TIniFile::del(unsigned int uiIndex)
 void TIniFile::clear()
 {
 	m_strComments = "";
+	m_lBuffers.clear();
 
 	while(m_mSections.size() > 0)
 	{
@@ -419,6 +626,8 @@ void TIniFile::clear()
 		m_mSections.erase(m_mSections.begin());
 	}
 	m_mSections.clear();
+	m_itCursor = m_mSections.begin();
+	m_uiCursor = 0;
 }
 //-----------------------------------------------------------------------------
 
@@ -432,11 +641,28 @@ TSection* TIniFile::operator[](std::string strName)
 
 TSection* TIniFile::operator[](unsigned int uiIndex)
 {
-	std::map<std::string, TSection*>::iterator iter = m_mSections.begin();
-
-	for(unsigned int i = 0; i < uiIndex && iter != m_mSections.end(); ++i)
-		++iter;
+	std::map<std::string, TSection*>::iterator iter = seek(uiIndex);
 
 	return iter == m_mSections.end() ? NULL : iter->second;
 }
 //-----------------------------------------------------------------------------
+
+/*
+ * Ver TSection::seek()
+ */
+std::map<std::string, TSection*>::iterator TIniFile::seek(unsigned int uiIndex)
+{
+	if(uiIndex < m_uiCursor)
+	{
+		m_itCursor = m_mSections.begin();
+		m_uiCursor = 0;
+	}
+	while(m_uiCursor < uiIndex && m_itCursor != m_mSections.end())
+	{
+		++m_itCursor;
+		++m_uiCursor;
+	}
+
+	return m_uiCursor == uiIndex ? m_itCursor : m_mSections.end();
+}
+//-----------------------------------------------------------------------------
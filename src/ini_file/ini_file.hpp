@@ -32,6 +32,7 @@
 #include <string>
 #include <sstream>
 #include <map>
+#include <list>
 #include <vector>
 //-----------------------------------------------------------------------------
 
@@ -39,12 +40,24 @@ namespace nsIniFile
 {
 	//-------------------------------------------------------------------------
 
+	/*
+	 * Parmetro de una seccin. Al leer un archivo, el valor es una vista sobre
+	 * el contenido ledo por TIniFile (no se copia). El stream de value() slo
+	 * se crea cuando se usa, para escribir o leer el valor con formato; para
+	 * obtener el texto o un nmero basta con text() y number().
+	 */
 	class TParam
 	{
+		friend class TIniFile;
+
 	private:
-		std::string       m_strName;
-		std::string       m_strComment;
-		std::stringstream m_ssValue;
+		std::string        m_strName;
+		std::string        m_strComment;
+		const char*        m_cText;
+		size_t             m_szText;
+		std::stringstream* m_ssValue;
+
+		void view(const char* cText, size_t szLen);
 
 	protected:
 	public:
@@ -53,7 +66,11 @@ namespace nsIniFile
 
 		inline std::string        name()    { return m_strName;    }
 		inline std::string&       comment() { return m_strComment; }
-		inline std::stringstream& value()   { return m_ssValue;    }
+
+		std::stringstream& value();
+		std::string        text();
+		bool               number(float& fValue);
+		bool               number(double& dValue);
 	};
 	//-------------------------------------------------------------------------
 
@@ -63,6 +80,12 @@ namespace nsIniFile
 		std::string                    m_strName;
 		std::string                    m_strComment;
 		std::map<std::string, TParam*> m_mParams;
+		//-- Cursor de acceso por posicin: recorrer los parmetros en orden
+		//   mediante operator[](unsigned int) no vuelve a empezar cada vez
+		std::map<std::string, TParam*>::iterator m_itCursor;
+		unsigned int                             m_uiCursor;
+
+		std::map<std::string, TParam*>::iterator seek(unsigned int uiIndex);
 
 	protected:
 	public:
@@ -90,9 +113,17 @@ namespace nsIniFile
 		std::string                      m_strHeader;
 		std::string                      m_strComments;
 		std::map<std::string, TSection*> m_mSections;
+		//-- Contenido de los archivos ledos, sobre el que apuntan los valores
+		//   de los parmetros
+		std::list<std::string>           m_lBuffers;
+		//-- Cursor de acceso por posicin (ver TSection)
+		std::map<std::string, TSection*>::iterator m_itCursor;
+		unsigned int                               m_uiCursor;
+
+		std::map<std::string, TSection*>::iterator seek(unsigned int uiIndex);
 
 	protected:
-		virtual void readLine(char* cLine, TSection*& sSection, TParam*& pParam);
+		virtual void readLine(const char* cLine, size_t szLen, TSection*& sSection, TParam*& pParam);
 
 	public:
 		TIniFile();